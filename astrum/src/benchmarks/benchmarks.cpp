@@ -0,0 +1,12 @@
+#include "gravity.h"
+#include "importing.h"
+#include "terrain.h"
+
+int main()
+{
+  astrum::benchmark_gravity();
+  astrum::benchmark_importing();
+  astrum::benchmark_terrain();
+
+  return 0;
+}
@@ -0,0 +1,95 @@
+#include <random>
+
+#include <ludo/benchmarking.h>
+
+#include "../physics/gravity.h"
+#include "gravity.h"
+
+namespace astrum
+{
+  void benchmark_gravity()
+  {
+    ludo::benchmark_group("gravity");
+
+    for (auto body_count : { 10u, 100u, 1000u, 10000u, 100000u })
+    {
+      // A flattened disc of debris, like rings or an asteroid belt
+      auto random = std::mt19937(1);
+      auto distribution = std::uniform_real_distribution<float>(-1.0f, 1.0f);
+
+      auto buffer = gravity_buffer();
+      while (buffer.masses.size() < body_count)
+      {
+        auto position = ludo::vec3 { distribution(random) * 1000.0f, distribution(random) * 100.0f, distribution(random) * 1000.0f };
+        if (ludo::length(position) <= 1000.0f)
+        {
+          add(buffer, position, (distribution(random) + 1.5f) * gravitational_constant);
+        }
+      }
+
+      auto positions = std::vector<ludo::vec3>(body_count);
+      for (auto index = uint32_t(0); index < body_count; index++)
+      {
+        positions[index] = { buffer.xs[index], buffer.ys[index], buffer.zs[index] };
+      }
+
+      auto suffix = " (" + std::to_string(body_count) + " bodies)";
+      auto pairwise_iterations = std::max(uint64_t(1), uint64_t(100000000) / (uint64_t(body_count) * body_count));
+      auto barnes_hut_iterations = std::max(uint64_t(1), uint64_t(1000000) / body_count);
+
+      auto all_pairs_accelerations = std::vector<ludo::vec3>();
+      if (body_count <= 10000)
+      {
+        // What simulate_gravity used to do: a scalar loop over each pair, normalizing each relative position
+        auto accelerations = std::vector<ludo::vec3>(body_count);
+        ludo::benchmark("pairwise (scalar)" + suffix, pairwise_iterations, [&]()
+        {
+          std::fill(accelerations.begin(), accelerations.end(), ludo::vec3_zero);
+
+          for (auto index_a = uint32_t(0); index_a < body_count - 1; index_a++)
+          {
+            for (auto index_b = index_a + 1; index_b < body_count; index_b++)
+            {
+              auto relative_position = positions[index_b] - positions[index_a];
+              auto force_normal = relative_position;
+              ludo::normalize(force_normal);
+
+              auto force = force_normal * gravitational_constant * buffer.masses[index_a] * buffer.masses[index_b] / ludo::length2(relative_position);
+              accelerations[index_a] += force / buffer.masses[index_a];
+              accelerations[index_b] -= force / buffer.masses[index_b];
+            }
+          }
+
+          ludo::benchmark_keep(accelerations[0]);
+        });
+
+        ludo::benchmark("all pairs" + suffix, pairwise_iterations, [&]()
+        {
+          accelerate(buffer, { .barnes_hut_threshold = std::numeric_limits<uint32_t>::max() });
+          ludo::benchmark_keep(buffer.accelerations[0]);
+        });
+
+        all_pairs_accelerations = buffer.accelerations;
+      }
+
+      auto barnes_hut_time = ludo::benchmark("barnes-hut" + suffix, barnes_hut_iterations, [&]()
+      {
+        accelerate(buffer, { .barnes_hut_threshold = 0 });
+        ludo::benchmark_keep(buffer.accelerations[0]);
+      });
+
+      ludo::benchmark_report("barnes-hut throughput" + suffix, body_count / barnes_hut_time, "bodies/s");
+
+      if (!all_pairs_accelerations.empty())
+      {
+        auto error = 0.0;
+        for (auto index = uint32_t(0); index < body_count; index++)
+        {
+          error += ludo::length(buffer.accelerations[index] - all_pairs_accelerations[index]) / ludo::length(all_pairs_accelerations[index]);
+        }
+
+        ludo::benchmark_report("barnes-hut mean relative error" + suffix, 100.0 * error / body_count, "%");
+      }
+    }
+  }
+}
@@ -0,0 +1,57 @@
+#include <string>
+#include <vector>
+
+#include <ludo/api.h>
+#include <ludo/benchmarking.h>
+
+#include "importing.h"
+
+namespace astrum
+{
+  void benchmark_importing()
+  {
+    ludo::benchmark_group("importing");
+
+    // The minifig is left out, importing its texture requires a rendering context
+    auto model_names = std::vector<std::string> { "fruit-tree", "oak-tree", "palm-tree", "pine-tree", "spaceship" };
+
+    auto indices = ludo::allocate_heap(16 * 1024 * 1024);
+    auto vertices = ludo::allocate_heap(64 * 1024 * 1024);
+
+    // Mirrors what a launch does with each model, i.e. counts its vertices (to size the heaps) and then imports it
+    auto import_model = [&](const std::string& file_name, bool cache)
+    {
+      auto counts = ludo::import_counts(file_name, { .cache = cache });
+      auto results = ludo::import(file_name, indices, vertices, { .cache = cache });
+      ludo::benchmark_keep(counts);
+
+      for (auto& mesh : results.meshes)
+      {
+        ludo::de_init(mesh, indices, vertices);
+      }
+    };
+
+    for (auto& model_name : model_names)
+    {
+      auto file_name = ludo::asset_folder + "/models/" + model_name + ".dae";
+
+      auto assimp_time = ludo::benchmark("import " + model_name + " (assimp)", 3, [&]()
+      {
+        import_model(file_name, false);
+      });
+
+      // Builds the cache (if it is missing or stale)
+      import_model(file_name, true);
+
+      auto cached_time = ludo::benchmark("import " + model_name + " (cached)", 10, [&]()
+      {
+        import_model(file_name, true);
+      });
+
+      ludo::benchmark_report("import " + model_name + " speedup", assimp_time / cached_time, "x");
+    }
+
+    ludo::deallocate(indices);
+    ludo::deallocate(vertices);
+  }
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+namespace astrum
+{
+  void benchmark_importing();
+}
@@ -0,0 +1,86 @@
+#include <vector>
+
+#include <ludo/benchmarking.h>
+
+#include "../constants.h"
+#include "../entities/terra.h"
+#include "../terrain/mesh.h"
+#include "../terrain/terrain_chunk.h"
+#include "terrain.h"
+
+namespace astrum
+{
+  void benchmark_terrain()
+  {
+    ludo::benchmark_group("terrain");
+
+    auto terrain = astrum::terrain
+    {
+      .format = ludo::vertex_format_pc,
+      .lods = terra_lods,
+      .height_func = terra_height,
+      .heights_func = terra_heights,
+      .color_func = [](float longitude, const std::array<float, 3>& heights, float gradient) { return ludo::vec4_one; }
+    };
+
+    // Mirror add_terrain, which stores the low and high detail vertices side by side (without normals, they are derived when rendering)
+    terrain.format.components.insert(terrain.format.components.end(), terrain.format.components.begin(), terrain.format.components.end());
+    terrain.format.size *= 2;
+
+    auto lod_index = static_cast<uint32_t>(terrain.lods.size() - 1);
+    auto vertex_count = 3 * static_cast<uint32_t>(std::pow(4, terrain.lods[lod_index].level - terrain.lods[0].level));
+
+    auto positions = std::vector<ludo::vec3>(vertex_count);
+    auto xs = std::vector<float>(vertex_count);
+    auto ys = std::vector<float>(vertex_count);
+    auto zs = std::vector<float>(vertex_count);
+    auto heights = std::vector<float>(vertex_count);
+    for (auto index = uint32_t(0); index < vertex_count; index++)
+    {
+      // Spread the positions over a patch of the sphere roughly the size of a chunk
+      auto angle = static_cast<float>(index) / static_cast<float>(vertex_count) * ludo::two_pi;
+      positions[index] = { std::cos(angle) * 0.01f, 1.0f, std::sin(angle) * 0.01f * static_cast<float>(index % 64) / 64.0f };
+      ludo::normalize(positions[index]);
+
+      xs[index] = positions[index][0];
+      ys[index] = positions[index][1];
+      zs[index] = positions[index][2];
+    }
+
+    auto single_time = ludo::benchmark("terra_height (" + std::to_string(vertex_count) + " positions)", 10, [&]()
+    {
+      for (auto index = uint32_t(0); index < vertex_count; index++)
+      {
+        heights[index] = terra_height(positions[index]);
+      }
+
+      ludo::benchmark_keep(heights[0]);
+    });
+
+    auto batch_time = ludo::benchmark("terra_heights (" + std::to_string(vertex_count) + " positions)", 10, [&]()
+    {
+      terra_heights(xs, ys, zs, heights);
+      ludo::benchmark_keep(heights[0]);
+    });
+
+    ludo::benchmark_report("terra_height throughput", vertex_count / single_time, "heights/s");
+    ludo::benchmark_report("terra_heights throughput", vertex_count / batch_time, "heights/s");
+
+    auto chunk_vertex_count = terrain_vertex_count(terrain.lods[lod_index].level - terrain.lods[0].level);
+    auto mesh = ludo::mesh
+    {
+      .vertex_buffer = ludo::allocate(chunk_vertex_count * terrain.format.size)
+    };
+
+    auto chunk_time = ludo::benchmark("load_terrain_chunk (level " + std::to_string(terrain.lods[lod_index].level) + ")", 10, [&]()
+    {
+      load_terrain_chunk(terrain, terra_radius, 0, lod_index, mesh);
+      ludo::benchmark_keep(mesh.vertex_buffer.data[0]);
+    });
+
+    // Chunks hold each vertex once, so every vertex is given a height exactly once
+    ludo::benchmark_report("load_terrain_chunk throughput", chunk_vertex_count / chunk_time, "heights/s");
+
+    ludo::deallocate(mesh.vertex_buffer);
+  }
+}
@@ -8,6 +8,8 @@ namespace astrum
 {
   // Game
   const auto visualize_physics = true;
+  const auto profile_trace_path = std::string(); // Writes a Chrome trace of the final frames on exit if not empty
+  const auto headless_frame_count = uint64_t(1000); // The number of frames to run when built against the null backend (ASTRUM_HEADLESS)
 
   // Assets
   const auto import_assets = false;
@@ -15,11 +17,14 @@ namespace astrum
   // Rendering
   // TODO Handle this better, 16 here crashed on my new laptop (Zephyrus G14)
   const auto msaa_samples = uint8_t(8);
+  const auto terrain_chunk_cache_ram_size = uint64_t(256 * 1024 * 1024); // The number of bytes of recently used terrain chunk meshes kept in RAM
 
   // Physics
   const auto astronomical_unit = 149597870700.0f * 0.00005f;
   const auto gravitational_constant = 0.0000000000667408f * 10000000000.0f;
   const auto planetary_scale = 0.001f;
+  const auto gravity_barnes_hut_threshold = uint32_t(1024);
+  const auto gravity_opening_angle = 0.5f;
 
   // Controllers
   const auto camera_rotate_speed = ludo::pi / 2.0f;
@@ -36,9 +41,10 @@ namespace astrum
 
   // Paths
   const auto show_paths = false;
-  const auto path_delta_time = 60.0f;
-  const auto path_steps = uint32_t(60);
+  const auto path_delta_time = 1.0f;
+  const auto path_steps = uint32_t(3600);
   const auto path_central_index = int32_t(0);
+  const auto path_tolerance = 0.001f; // The distance (relative to the central point mass) the point masses can stray from their paths before they are predicted again
 
   // Sol
   const auto sol_radius = 695508000.0f * planetary_scale;
@@ -19,8 +19,9 @@ namespace astrum
     auto render_program = ludo::add(inst, ludo::render_program(), "people");
     ludo::init(*render_program, ludo::format(true, true, true, true), render_commands, 1);
 
-    auto render_mesh = ludo::add(inst, ludo::render_mesh(), "people");
-    ludo::init(*render_mesh, *render_program, *mesh, indices, vertices, 1);
+    auto person_render_mesh = ludo::render_mesh();
+    ludo::init(person_render_mesh, *render_program, *mesh, indices, vertices, 1);
+    auto render_mesh = ludo::add(inst, person_render_mesh, "people");
 
     ludo::instance_transform(*render_mesh) = ludo::mat4(initial_transform.position, ludo::mat3(initial_transform.rotation));
     ludo::add(*grid, *render_mesh, initial_transform.position);
@@ -50,10 +51,6 @@ namespace astrum
 
   void simulate_people(ludo::instance& inst)
   {
-    auto& animation = *ludo::first<ludo::animation>(inst, "people");
-    auto& armature = *ludo::first<ludo::armature>(inst, "people");
-    auto& render_meshes = ludo::data<ludo::render_mesh>(inst, "people");
-
     auto& celestial_body_point_masses = ludo::data<point_mass>(inst, "celestial-bodies");
 
     auto solar_system = ludo::first<astrum::solar_system>(inst);
@@ -63,8 +60,6 @@ namespace astrum
 
     for (auto index = 0; index < people.length; index++)
     {
-      auto& render_mesh = render_meshes[index];
-
       auto& person_controls = person_controls_list[index];
       auto& person = people[index];
       auto& point_mass = point_masses[index];
@@ -106,9 +101,36 @@ namespace astrum
       {
         person.walk_animation_time = 0.25f;
       }
+    }
+  }
+
+  void animate_people(ludo::instance& inst)
+  {
+    auto& animation_clip = *ludo::first<ludo::animation_clip>(inst, "people");
+    auto& render_meshes = ludo::data<ludo::render_mesh>(inst, "people");
+
+    auto& people = ludo::data<astrum::person>(inst, "people");
+
+    // Everyone is animated together once they have moved
+    // The buffers are kept between frames so that they are only allocated when the crowd grows.
+    static auto animation_times = std::vector<float>();
+    static auto animation_bone_transforms = std::vector<ludo::mat4*>();
+    animation_times.clear();
+    animation_bone_transforms.clear();
+
+    for (auto index = 0; index < people.length; index++)
+    {
+      auto& person = people[index];
+      if (!person.standing)
+      {
+        continue;
+      }
 
-      ludo::interpolate(animation, armature, person.walk_animation_time, ludo::instance_bone_transforms(render_mesh));
+      animation_times.push_back(person.walk_animation_time);
+      animation_bone_transforms.push_back(ludo::instance_bone_transforms(render_meshes[index]));
     }
+
+    ludo::interpolate(animation_clip, animation_times.data(), animation_bone_transforms.data(), static_cast<uint32_t>(animation_times.size()));
   }
 
   void map_controls(ludo::instance& inst, const person_controls& person_controls, person& person, point_mass& point_mass)
@@ -7,4 +7,6 @@ namespace astrum
   void add_person(ludo::instance& inst, const ludo::transform& initial_transform, const ludo::vec3& initial_velocity);
 
   void simulate_people(ludo::instance& inst);
+
+  void animate_people(ludo::instance& inst);
 }
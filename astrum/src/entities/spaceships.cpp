@@ -17,8 +17,9 @@ namespace astrum
     auto render_program = ludo::add(inst, ludo::render_program(), "spaceships");
     ludo::init(*render_program, ludo::vertex_format_pn, render_commands, 1);
 
-    auto render_mesh = ludo::add(inst, ludo::render_mesh(), "spaceships");
-    ludo::init(*render_mesh, *render_program, *mesh, indices, vertices, 1);
+    auto spaceship_render_mesh = ludo::render_mesh();
+    ludo::init(spaceship_render_mesh, *render_program, *mesh, indices, vertices, 1);
+    auto render_mesh = ludo::add(inst, spaceship_render_mesh, "spaceships");
 
     ludo::instance_transform(*render_mesh) = ludo::mat4(initial_transform.position, ludo::mat3(initial_transform.rotation));
     ludo::add(*grid, *render_mesh, initial_transform.position);
@@ -1,25 +1,34 @@
 #include <iostream>
-#include <random>
+#include <mutex>
 
 #include <libnoise/noise.h>
 
 #include "../constants.h"
-#include "../terrain/mesh.h"
+#include "../meshes/ico_chunks.h"
 #include "../terrain/terrain.h"
+#include "../util.h"
 #include "terra.h"
 
 namespace astrum
 {
-  float terra_height(const ludo::vec3& position);
+  // The noise graph is built once and shared, libnoise modules can be evaluated concurrently.
+  struct terra_noise
+  {
+    noise::module::Perlin perlin_continent;
+    noise::module::Perlin perlin_detail;
+    noise::module::Perlin perlin_mountain_mask;
+    noise::module::RidgedMulti ridge_mountain;
+    noise::module::Perlin perlin_forest;
+  };
+
+  const terra_noise& get_terra_noise();
   ludo::vec4 terra_color(float longitude, const std::array<float, 3>& heights, float gradient);
   std::array<std::vector<tree>, tree_type_count> terra_tree(const terrain& terrain, float radius, uint32_t chunk_index);
-  void terra_tree_internal(uint32_t divisions, noise::module::Perlin& perlin_forest, const std::array<ludo::vec3, 3>& face, std::vector<ludo::vec3>& positions);
+  void terra_tree_internal(uint32_t divisions, const noise::module::Perlin& perlin_forest, counter_random& random, const std::array<ludo::vec3, 3>& face, std::vector<ludo::vec3>& positions);
 
   const auto beach_max_height = 1.0001f;
 
   auto seed = 123456;
-  auto tree_random = std::mt19937(seed);
-  std::uniform_real_distribution<float> tree_distribution(0.0f, 1.0f);
 
   void add_terra(ludo::instance& inst, const ludo::transform& initial_transform, const ludo::vec3& initial_velocity)
   {
@@ -52,6 +61,7 @@ namespace astrum
         .format = ludo::vertex_format_pnc,
         .lods = terra_lods,
         .height_func = terra_height,
+        .heights_func = terra_heights,
         .color_func = terra_color,
         .tree_func = terra_tree
       },
@@ -62,36 +72,74 @@ namespace astrum
 
   float terra_height(const ludo::vec3& position)
   {
-    auto perlin_continent = noise::module::Perlin();
-    perlin_continent.SetSeed(seed);
-    perlin_continent.SetFrequency(2.0f);
-
-    auto perlin_detail = noise::module::Perlin();
-    perlin_detail.SetSeed(seed);
-    perlin_detail.SetFrequency(50.0f);
+    auto height = 0.0f;
+    terra_heights(std::span(&position[0], 1), std::span(&position[1], 1), std::span(&position[2], 1), std::span(&height, 1));
 
-    auto perlin_mountain_mask = noise::module::Perlin();
-    perlin_mountain_mask.SetSeed(seed);
+    return height;
+  }
 
-    auto ridge_mountain = noise::module::RidgedMulti();
-    ridge_mountain.SetSeed(seed);
+  void terra_heights(std::span<const float> xs, std::span<const float> ys, std::span<const float> zs, std::span<float> heights)
+  {
+    auto& noise = get_terra_noise();
+    auto count = heights.size();
 
-    auto noise = 0.0f;
+    // Each layer is applied to every position before moving on to the next, keeping the loops tight and the noise modules hot in cache.
 
     // Continents
-    noise += static_cast<float>(perlin_continent.GetValue(position[0], position[1], position[2])) * 0.05f;
+    for (auto index = size_t(0); index < count; index++)
+    {
+      heights[index] = static_cast<float>(noise.perlin_continent.GetValue(xs[index], ys[index], zs[index])) * 0.05f;
+    }
 
     // Mountains
-    auto mountain_mask = static_cast<float>(perlin_mountain_mask.GetValue(position[0], position[1], position[2]));
-    if (noise > 0.0f && mountain_mask < 0.0f)
+    for (auto index = size_t(0); index < count; index++)
     {
-      noise += (static_cast<float>(ridge_mountain.GetValue(position[0], position[1], position[2])) + 1.0f) * noise * std::pow(-mountain_mask, 2.0f) * 5.0f;
+      if (heights[index] <= 0.0f)
+      {
+        continue;
+      }
+
+      auto mountain_mask = static_cast<float>(noise.perlin_mountain_mask.GetValue(xs[index], ys[index], zs[index]));
+      if (mountain_mask < 0.0f)
+      {
+        heights[index] += (static_cast<float>(noise.ridge_mountain.GetValue(xs[index], ys[index], zs[index])) + 1.0f) * heights[index] * mountain_mask * mountain_mask * 5.0f;
+      }
     }
 
     // Details
-    noise += static_cast<float>(perlin_detail.GetValue(position[0], position[1], position[2])) * 0.0005f;
+    for (auto index = size_t(0); index < count; index++)
+    {
+      heights[index] += static_cast<float>(noise.perlin_detail.GetValue(xs[index], ys[index], zs[index])) * 0.0005f;
+    }
 
-    return 1.0f + std::max(noise, 0.0f);
+    for (auto index = size_t(0); index < count; index++)
+    {
+      heights[index] = 1.0f + std::max(heights[index], 0.0f);
+    }
+  }
+
+  const terra_noise& get_terra_noise()
+  {
+    static auto noise = terra_noise();
+    static auto built = std::once_flag();
+
+    std::call_once(built, []
+    {
+      noise.perlin_continent.SetSeed(seed);
+      noise.perlin_continent.SetFrequency(2.0f);
+
+      noise.perlin_detail.SetSeed(seed);
+      noise.perlin_detail.SetFrequency(50.0f);
+
+      noise.perlin_mountain_mask.SetSeed(seed);
+
+      noise.ridge_mountain.SetSeed(seed);
+
+      noise.perlin_forest.SetSeed(seed);
+      noise.perlin_forest.SetFrequency(2.0f);
+    });
+
+    return noise;
   }
 
   ludo::vec4 terra_color(float longitude, const std::array<float, 3>& heights, float gradient)
@@ -139,64 +187,43 @@ namespace astrum
   // which in the case of a planet could be hundreds of thousands and memory was a problem (as well as speed).
   // Perhaps more sophisticated poisson disc sampling does not have these same limitations?
   // For now, placing them at regular intervals and applying some jitter to their positions seems adequate.
+  // The random sequence is keyed by the chunk, so a chunk always gets the same trees no matter when (or on which thread) it is loaded.
   std::array<std::vector<tree>, tree_type_count> terra_tree(const terrain& terrain, float radius, uint32_t chunk_index)
   {
-    auto perlin_forest = noise::module::Perlin();
-    perlin_forest.SetSeed(seed);
-    perlin_forest.SetFrequency(2.0f);
-
-    auto temp_mesh = ludo::mesh
-    {
-      .index_buffer = ludo::allocate(3 * sizeof(uint32_t)),
-      .vertex_buffer = ludo::allocate(3 * sizeof(ludo::vec3))
-    };
-
-    terrain_mesh(terrain, radius, temp_mesh, ludo::vertex_format_p, ludo::vertex_format_p, false, chunk_index, 5, 5, 5);
-
-    auto vertex_stream = ludo::stream(temp_mesh.vertex_buffer);
-    auto face = std::array<ludo::vec3, 3>
-    {
-      read<ludo::vec3>(vertex_stream),
-      read<ludo::vec3>(vertex_stream),
-      read<ludo::vec3>(vertex_stream)
-    };
-
-    ludo::normalize(face[0]);
-    ludo::normalize(face[1]);
-    ludo::normalize(face[2]);
+    auto& noise = get_terra_noise();
+    auto random = make_counter_random(seed, chunk_index);
 
-    ludo::deallocate(temp_mesh.index_buffer);
-    ludo::deallocate(temp_mesh.vertex_buffer);
+    auto face = sphere_ico_chunk(5, chunk_index);
 
     auto positions = std::vector<ludo::vec3>();
-    terra_tree_internal(6, perlin_forest, face, positions);
+    terra_tree_internal(6, noise.perlin_forest, random, face, positions);
 
     auto trees = std::array<std::vector<tree>, tree_type_count>();
     for (auto& position : positions)
     {
       auto jitter = ludo::vec3
       {
-        tree_distribution(tree_random) * 2.0f / radius,
-        tree_distribution(tree_random) * 2.0f / radius,
-        tree_distribution(tree_random) * 2.0f / radius
+        random_float(random) * 2.0f / radius,
+        random_float(random) * 2.0f / radius,
+        random_float(random) * 2.0f / radius
       };
 
       position += jitter;
       ludo::normalize(position);
 
-      auto type = uint32_t(tree_distribution(tree_random) * tree_type_count);
+      auto type = uint32_t(random_float(random) * tree_type_count);
       trees[type].emplace_back(tree
       {
         .position = position,
-        .rotation = tree_distribution(tree_random) * ludo::two_pi,
-        .scale = tree_distribution(tree_random) * 0.5f + 0.5f
+        .rotation = random_float(random) * ludo::two_pi,
+        .scale = random_float(random) * 0.5f + 0.5f
       });
     }
 
     return trees;
   }
 
-  void terra_tree_internal(uint32_t divisions, noise::module::Perlin& perlin_forest, const std::array<ludo::vec3, 3>& face, std::vector<ludo::vec3>& positions)
+  void terra_tree_internal(uint32_t divisions, const noise::module::Perlin& perlin_forest, counter_random& random, const std::array<ludo::vec3, 3>& face, std::vector<ludo::vec3>& positions)
   {
     if (divisions == 0)
     {
@@ -219,7 +246,7 @@ namespace astrum
       if (noise < 0.6666f)
       {
         auto tree_cover = (noise - 0.3333f) / 0.3333f / 10.0f;
-        if (tree_distribution(tree_random) > tree_cover)
+        if (random_float(random) > tree_cover)
         {
           return;
         }
@@ -250,7 +277,7 @@ namespace astrum
 
     for (auto face_index = uint32_t(0); face_index < divided_faces.size(); face_index++)
     {
-      terra_tree_internal(divisions - 1, perlin_forest, divided_faces[face_index], positions);
+      terra_tree_internal(divisions - 1, perlin_forest, random, divided_faces[face_index], positions);
     }
   }
 }
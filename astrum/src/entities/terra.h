@@ -7,4 +7,8 @@
 namespace astrum
 {
   void add_terra(ludo::instance& inst, const ludo::transform& initial_transform, const ludo::vec3& initial_velocity);
+
+  float terra_height(const ludo::vec3& position);
+
+  void terra_heights(std::span<const float> xs, std::span<const float> ys, std::span<const float> zs, std::span<float> heights);
 }
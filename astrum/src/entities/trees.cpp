@@ -1,24 +1,33 @@
+#include <mutex>
+#include <queue>
+
 #include "../meshes/lod_shaders.h"
 #include "../types.h"
 #include "trees.h"
 
 namespace astrum
 {
+  // Tree transforms relative to the center of the celestial body, per tree type.
+  using tree_transforms = std::array<std::vector<ludo::mat4>, tree_type_count>;
+
+  tree_transforms place_trees(const terrain& terrain, float radius, uint32_t chunk_index);
   std::array<ludo::render_mesh*, tree_type_count> add_trees(
     ludo::instance& inst,
     ludo::heap& indices,
     ludo::heap& vertices,
-    terrain& terrain,
     ludo::render_program& render_program,
-    float radius,
     const ludo::vec3& position,
-    uint32_t chunk_index,
     uint32_t lod_index,
+    const tree_transforms& transforms,
     const std::array<ludo::array<ludo::mesh>, tree_type_count>& meshes
   );
 
   const auto tree_instance_size = sizeof(ludo::mat4) + sizeof(uint32_t) + 12; // align 16
 
+  // Trees are placed on worker threads and handed back to the main thread here, the same way terrain chunks are.
+  static auto new_trees = std::queue<std::tuple<uint32_t, tree_transforms>>();
+  static auto new_trees_mutex = std::mutex();
+
   void add_trees(ludo::instance& inst, uint32_t celestial_body_index)
   {
     auto& fruit_tree_meshes = ludo::data<ludo::mesh>(inst, "fruit-trees");
@@ -84,6 +93,7 @@ namespace astrum
           },
           .cell_count_1d = 16,
           .cell_capacity = 48,
+          .morton = true
         },
       "trees"
     );
@@ -101,7 +111,6 @@ namespace astrum
     auto& oak_tree_meshes = ludo::data<ludo::mesh>(inst, "oak-trees");
     auto& palm_tree_meshes = ludo::data<ludo::mesh>(inst, "palm-trees");
     auto& pine_tree_meshes = ludo::data<ludo::mesh>(inst, "pine-trees");
-    auto& render_meshes = ludo::data<ludo::render_mesh>(inst, "trees");
     auto rendering_context = ludo::first<ludo::rendering_context>(inst);
     auto render_program = ludo::first<ludo::render_program>(inst, "trees");
 
@@ -120,11 +129,55 @@ namespace astrum
     grid->bounds.max = point_mass.transform.position + bounds_half_dimensions;
     ludo::commit_header(*grid);
 
+    auto added_grid_render_meshes = std::vector<ludo::render_mesh>();
+    auto added_grid_positions = std::vector<ludo::vec3>();
+
     auto push_required = false;
+
+    new_trees_mutex.lock();
+    while (!new_trees.empty())
+    {
+      auto [ chunk_index, transforms ] = std::move(new_trees.front());
+      new_trees.pop();
+
+      auto& chunk = terrain.chunks[chunk_index];
+      chunk.trees_locked = false;
+
+      auto chunk_position = point_mass.transform.position + chunk.center;
+      auto lod_index = find_lod_index(tree_lods, camera_position, chunk_position, chunk.normal);
+
+      // The chunk left tree range while its trees were being placed.
+      if (lod_index == 0)
+      {
+        continue;
+      }
+
+      auto added_render_meshes = add_trees(inst, indices, vertices, *render_program, point_mass.transform.position, lod_index, transforms, meshes);
+
+      chunk.trees_loaded = true;
+      chunk.treeless = true;
+      for (auto tree_type = 0; tree_type < added_render_meshes.size(); tree_type++)
+      {
+        if (!added_render_meshes[tree_type])
+        {
+          chunk.tree_render_mesh_ids[tree_type] = 0;
+          continue;
+        }
+
+        chunk.treeless = false;
+        chunk.tree_render_mesh_ids[tree_type] = added_render_meshes[tree_type]->id;
+        added_grid_render_meshes.push_back(*added_render_meshes[tree_type]);
+        added_grid_positions.push_back(chunk_position);
+      }
+
+      push_required = true;
+    }
+    new_trees_mutex.unlock();
+
     for (auto chunk_index = uint32_t(0); chunk_index < terrain.chunks.size(); chunk_index++)
     {
       auto& chunk = terrain.chunks[chunk_index];
-      if (chunk.treeless)
+      if (chunk.treeless || chunk.trees_locked)
       {
         continue;
       }
@@ -134,35 +187,16 @@ namespace astrum
 
       if (lod_index > 0 && !chunk.trees_loaded)
       {
-        auto added_render_meshes = add_trees(
-          inst,
-          indices,
-          vertices,
-          terrain,
-          *render_program,
-          celestial_body.radius,
-          point_mass.transform.position,
-          chunk_index,
-          lod_index,
-          meshes
-        );
-
-        chunk.trees_loaded = true;
-        chunk.treeless = true;
-        for (auto tree_type = 0; tree_type < added_render_meshes.size(); tree_type++)
-        {
-          if (!added_render_meshes[tree_type])
-          {
-            chunk.tree_render_mesh_ids[tree_type] = 0;
-            continue;
-          }
+        chunk.trees_locked = true;
 
-          chunk.treeless = false;
-          chunk.tree_render_mesh_ids[tree_type] = added_render_meshes[tree_type]->id;
-          ludo::add(*grid, *added_render_meshes[tree_type], chunk_position);
-        }
+        ludo::thread_pool_enqueue([&terrain, radius = celestial_body.radius, chunk_index]()
+        {
+          auto transforms = place_trees(terrain, radius, chunk_index);
 
-        push_required = true;
+          new_trees_mutex.lock();
+          new_trees.emplace(std::tuple { chunk_index, std::move(transforms) });
+          new_trees_mutex.unlock();
+        }, {}, {}, ludo::job_priority::low);
       }
       else if (lod_index == 0 && chunk.trees_loaded)
       {
@@ -170,15 +204,17 @@ namespace astrum
         {
           if (tree_render_mesh_id)
           {
-            auto render_mesh = ludo::find_by_id(render_meshes.begin(), render_meshes.end(), tree_render_mesh_id);
+            auto render_mesh = ludo::get<ludo::render_mesh>(inst, "trees", tree_render_mesh_id);
 
             ludo::remove(*grid, *render_mesh, chunk_position);
             tree_render_mesh_id = 0;
             push_required = true;
 
+            // The render mesh is removed before it is de-initialized, while its ID still matches the index.
             ludo::disconnect(*render_mesh, *render_program);
-            ludo::de_init(*render_mesh);
+            auto old_render_mesh = *render_mesh;
             ludo::remove(inst, render_mesh, "trees");
+            ludo::de_init(old_render_mesh);
           }
         }
 
@@ -190,7 +226,7 @@ namespace astrum
         {
           if (chunk.tree_render_mesh_ids[tree_type])
           {
-            auto render_mesh = ludo::find_by_id(render_meshes.begin(), render_meshes.end(), chunk.tree_render_mesh_ids[tree_type]);
+            auto render_mesh = ludo::get<ludo::render_mesh>(inst, "trees", chunk.tree_render_mesh_ids[tree_type]);
             if (lod_index != ludo::cast<uint32_t>(render_mesh->instance_buffer, sizeof(ludo::mat4)))
             {
               ludo::connect(*render_mesh, meshes[tree_type][lod_index - 1], indices, vertices);
@@ -211,6 +247,8 @@ namespace astrum
       }
     }
 
+    ludo::add(*grid, added_grid_render_meshes, added_grid_positions);
+
     if (push_required)
     {
       // TODO not while render could be happening!!!
@@ -219,47 +257,66 @@ namespace astrum
     }
   }
 
+  tree_transforms place_trees(const terrain& terrain, float radius, uint32_t chunk_index)
+  {
+    auto transforms = tree_transforms();
+
+    auto trees = terrain.tree_func(terrain, radius, chunk_index);
+    for (auto tree_type = 0; tree_type < trees.size(); tree_type++)
+    {
+      auto& trees_of_type = trees[tree_type];
+      auto& transforms_of_type = transforms[tree_type];
+      transforms_of_type.reserve(trees_of_type.size());
+
+      for (auto& tree : trees_of_type)
+      {
+        auto tree_position = tree.position * terrain.height_func(tree.position) * radius;
+        auto tree_rotation = ludo::mat3(ludo::vec3_unit_y, tree.position) * ludo::mat3(ludo::vec3_unit_y, tree.rotation);
+        auto tree_transform = ludo::mat4(tree_position, tree_rotation);
+        ludo::scale(tree_transform, { tree.scale, tree.scale, tree.scale });
+        transforms_of_type.push_back(tree_transform);
+      }
+    }
+
+    return transforms;
+  }
+
   std::array<ludo::render_mesh*, tree_type_count> add_trees(
     ludo::instance& inst,
     ludo::heap& indices,
     ludo::heap& vertices,
-    terrain& terrain,
     ludo::render_program& render_program,
-    float radius,
     const ludo::vec3& position,
-    uint32_t chunk_index,
     uint32_t lod_index,
+    const tree_transforms& transforms,
     const std::array<ludo::array<ludo::mesh>, tree_type_count>& meshes
   )
   {
     auto render_meshes = std::array<ludo::render_mesh*, tree_type_count>();
 
-    auto trees = terrain.tree_func(terrain, radius, chunk_index);
-    for (auto tree_type = 0; tree_type < trees.size(); tree_type++)
+    for (auto tree_type = 0; tree_type < transforms.size(); tree_type++)
     {
       auto& meshes_of_type = meshes[tree_type];
-      auto& trees_of_type = trees[tree_type];
-      if (trees_of_type.empty())
+      auto& transforms_of_type = transforms[tree_type];
+      if (transforms_of_type.empty())
       {
         render_meshes[tree_type] = nullptr;
         continue;
       }
 
-      auto render_mesh = ludo::add(inst, ludo::render_mesh(), "trees");
-      ludo::init(*render_mesh, render_program, meshes_of_type[lod_index - 1], indices, vertices, trees_of_type.size());
+      auto tree_render_mesh = ludo::render_mesh();
+      ludo::init(tree_render_mesh, render_program, meshes_of_type[lod_index - 1], indices, vertices, transforms_of_type.size());
+      auto render_mesh = ludo::add(inst, tree_render_mesh, "trees");
       render_mesh->instances =
       {
         .start = static_cast<uint32_t>((render_mesh->instance_buffer.data - render_program.instance_buffer_back.data) / render_program.instance_size),
-        .count = static_cast<uint32_t>(trees_of_type.size())
+        .count = static_cast<uint32_t>(transforms_of_type.size())
       };
 
-      for (auto tree_index = uint32_t(0); tree_index < trees_of_type.size(); tree_index++)
+      for (auto tree_index = uint32_t(0); tree_index < transforms_of_type.size(); tree_index++)
       {
-        auto& tree = trees_of_type[tree_index];
-        auto tree_position = position + tree.position * terrain.height_func(tree.position) * radius;
-        auto tree_rotation = ludo::mat3(ludo::vec3_unit_y, tree.position) * ludo::mat3(ludo::vec3_unit_y, tree.rotation);
-        auto tree_transform = ludo::mat4(tree_position, tree_rotation);
-        ludo::scale(tree_transform, { tree.scale, tree.scale, tree.scale });
+        auto tree_transform = transforms_of_type[tree_index];
+        ludo::position(tree_transform, ludo::position(tree_transform) + position);
         ludo::instance_transform(*render_mesh, tree_index) = tree_transform;
         ludo::cast<uint32_t>(render_mesh->instance_buffer, tree_index * tree_instance_size + sizeof(ludo::mat4)) = lod_index;
       }
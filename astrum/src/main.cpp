@@ -1,8 +1,11 @@
+#include <fstream>
 #include <iomanip>
 #include <iostream>
 
 #include <ludo/api.h>
-#include <ludo/opengl/util.h>
+#if defined(ASTRUM_HEADLESS)
+#include <ludo/null/statistics.h>
+#endif
 
 #include "constants.h"
 #include "post-processing/atmosphere.h"
@@ -27,10 +30,10 @@ int main()
   auto luna_mesh_counts = astrum::terrain_counts(astrum::luna_lods);
   auto tree_counts = std::array<std::pair<uint32_t, uint32_t>, astrum::tree_type_count>
   {
-    astrum::import_assets ? ludo::import_counts(ludo::asset_folder + "/models/fruit-tree.dae") : ludo::mesh_counts(ludo::asset_folder + "/meshes/fruit-tree-0.lmesh"),
-    astrum::import_assets ? ludo::import_counts(ludo::asset_folder + "/models/oak-tree.dae") : ludo::mesh_counts(ludo::asset_folder + "/meshes/oak-tree-0.lmesh"),
-    astrum::import_assets ? ludo::import_counts(ludo::asset_folder + "/models/palm-tree.dae") : ludo::mesh_counts(ludo::asset_folder + "/meshes/palm-tree-0.lmesh"),
-    astrum::import_assets ? ludo::import_counts(ludo::asset_folder + "/models/pine-tree.dae") : ludo::mesh_counts(ludo::asset_folder + "/meshes/pine-tree-0.lmesh")
+    astrum::import_assets ? ludo::import_counts(ludo::asset_folder + "/models/fruit-tree.dae") : ludo::mesh_counts(ludo::asset_folder + "/meshes/fruit-tree.lmesh"),
+    astrum::import_assets ? ludo::import_counts(ludo::asset_folder + "/models/oak-tree.dae") : ludo::mesh_counts(ludo::asset_folder + "/meshes/oak-tree.lmesh"),
+    astrum::import_assets ? ludo::import_counts(ludo::asset_folder + "/models/palm-tree.dae") : ludo::mesh_counts(ludo::asset_folder + "/meshes/palm-tree.lmesh"),
+    astrum::import_assets ? ludo::import_counts(ludo::asset_folder + "/models/pine-tree.dae") : ludo::mesh_counts(ludo::asset_folder + "/meshes/pine-tree.lmesh")
   };
   auto person_mesh_counts = ludo::import_counts(ludo::asset_folder + "/models/minifig.dae");
   auto spaceship_mesh_counts = ludo::import_counts(ludo::asset_folder + "/models/spaceship.dae");
@@ -82,8 +85,7 @@ int main()
   ludo::allocate<ludo::physics_context>(inst, 1);
   ludo::allocate<ludo::rendering_context>(inst, 1);
 
-  ludo::allocate<ludo::animation>(inst, 1);
-  ludo::allocate<ludo::armature>(inst, 1);
+  ludo::allocate<ludo::animation_clip>(inst, 1);
   ludo::allocate<ludo::compute_program>(inst, 5);
   ludo::allocate<ludo::dynamic_body>(inst, 0);
   ludo::allocate<ludo::dynamic_body_shape>(inst, 3);
@@ -91,12 +93,12 @@ int main()
   ludo::allocate<ludo::ghost_body>(inst, 1);
   ludo::allocate<ludo::grid3>(inst, 5);
   ludo::allocate<ludo::kinematic_body>(inst, 2);
-  ludo::allocate<ludo::mesh>(inst, max_rendered_instances);
-  ludo::allocate<ludo::render_mesh>(inst, max_rendered_instances);
+  ludo::index_ids(ludo::allocate<ludo::mesh>(inst, max_rendered_instances));
+  ludo::index_ids(ludo::allocate<ludo::render_mesh>(inst, max_rendered_instances));
   ludo::allocate<ludo::render_program>(inst, 12);
-  ludo::allocate<ludo::script>(inst, 36);
-  ludo::allocate<ludo::static_body>(inst, max_terrain_bodies);
-  ludo::allocate<ludo::texture>(inst, 21);
+  ludo::allocate<ludo::script>(inst, 38);
+  ludo::index_ids(ludo::allocate<ludo::static_body>(inst, max_terrain_bodies));
+  ludo::index_ids(ludo::allocate<ludo::texture>(inst, 21));
   ludo::allocate<ludo::window>(inst, 1);
 
   ludo::allocate<astrum::celestial_body>(inst, 3);
@@ -135,10 +137,13 @@ int main()
   default_grid->compute_program_id = ludo::add(inst, ludo::build_compute_program(*default_grid))->id;
   ludo::init(*default_grid);
 
-  auto msaa_color_texture = ludo::add(inst, ludo::texture { .datatype = ludo::pixel_datatype::FLOAT16, .width = window->width, .height = window->height });
-  ludo::init(*msaa_color_texture, { .samples = astrum::msaa_samples });
-  auto msaa_depth_texture = ludo::add(inst, ludo::texture { .components = ludo::pixel_components::DEPTH, .datatype = ludo::pixel_datatype::FLOAT32, .width = window->width, .height = window->height });
-  ludo::init(*msaa_depth_texture, { .samples = astrum::msaa_samples });
+  // Textures and render meshes are indexed by ID, so they are initialized before they are added.
+  auto msaa_color_texture_init = ludo::texture { .datatype = ludo::pixel_datatype::FLOAT16, .width = window->width, .height = window->height };
+  ludo::init(msaa_color_texture_init, { .samples = astrum::msaa_samples });
+  auto msaa_color_texture = ludo::add(inst, msaa_color_texture_init);
+  auto msaa_depth_texture_init = ludo::texture { .components = ludo::pixel_components::DEPTH, .datatype = ludo::pixel_datatype::FLOAT32, .width = window->width, .height = window->height };
+  ludo::init(msaa_depth_texture_init, { .samples = astrum::msaa_samples });
+  auto msaa_depth_texture = ludo::add(inst, msaa_depth_texture_init);
   auto msaa_frame_buffer = ludo::add(inst, ludo::frame_buffer { .width = window->width, .height = window->height, .color_texture_ids = { msaa_color_texture->id }, .depth_texture_id = msaa_depth_texture->id });
   ludo::init(*msaa_frame_buffer);
 
@@ -157,41 +162,53 @@ int main()
 
   ludo::commit(*default_grid);
 
-  ludo::add<ludo::script>(inst, [](ludo::instance& inst)
+  ludo::add(inst, ludo::script
   {
-    auto window = ludo::first<ludo::window>(inst);
+    .name = "ludo::receive_input",
+    .function = [](ludo::instance& inst)
+    {
+      auto window = ludo::first<ludo::window>(inst);
 
-    ludo::receive_input(*window, inst);
+      ludo::receive_input(*window, inst);
 
-    if (window->active_window_frame_button_states[ludo::window_frame_button::CLOSE] == ludo::button_state::UP)
-    {
-      ludo::stop(inst);
+      if (window->active_window_frame_button_states[ludo::window_frame_button::CLOSE] == ludo::button_state::UP)
+      {
+        ludo::stop(inst);
+      }
     }
   });
 
-  ludo::add<ludo::script>(inst, [](ludo::instance& inst)
+  ludo::add(inst, ludo::script
   {
-    auto msaa_frame_buffer = ludo::first<ludo::frame_buffer>(inst);
-    auto rendering_context = ludo::first<ludo::rendering_context>(inst);
-    auto& render_programs = ludo::data<ludo::render_program>(inst);
-    auto window = ludo::first<ludo::window>(inst);
+    .name = "ludo::start_render_transaction",
+    .function = [](ludo::instance& inst)
+    {
+      auto msaa_frame_buffer = ludo::first<ludo::frame_buffer>(inst);
+      auto rendering_context = ludo::first<ludo::rendering_context>(inst);
+      auto& render_programs = ludo::data<ludo::render_program>(inst);
+      auto window = ludo::first<ludo::window>(inst);
 
-    ludo::start_render_transaction(*rendering_context, render_programs);
-    ludo::swap_buffers(*window);
+      ludo::start_render_transaction(*rendering_context, render_programs);
+      ludo::swap_buffers(*window);
 
-    ludo::use_and_clear(*msaa_frame_buffer);
+      ludo::use_and_clear(*msaa_frame_buffer);
+    }
   });
 
-  ludo::add<ludo::script>(inst, [](ludo::instance& inst)
+  ludo::add(inst, ludo::script
   {
-    auto& grids = ludo::data<ludo::grid3>(inst);
-    auto rendering_context = ludo::first<ludo::rendering_context>(inst);
-    auto& compute_programs = ludo::data<ludo::compute_program>(inst);
-    auto& render_programs = ludo::data<ludo::render_program>(inst);
+    .name = "ludo::add_render_commands/geometry",
+    .function = [](ludo::instance& inst)
+    {
+      auto& grids = ludo::data<ludo::grid3>(inst);
+      auto rendering_context = ludo::first<ludo::rendering_context>(inst);
+      auto& compute_programs = ludo::data<ludo::compute_program>(inst);
+      auto& render_programs = ludo::data<ludo::render_program>(inst);
 
-    auto& render_commands = ludo::data_heap(inst, "ludo::vram_render_commands");
+      auto& render_commands = ludo::data_heap(inst, "ludo::vram_render_commands");
 
-    ludo::add_render_commands(grids, compute_programs, render_programs, render_commands, ludo::get_camera(*rendering_context));
+      ludo::add_render_commands(grids, compute_programs, render_programs, render_commands, ludo::get_camera(*rendering_context));
+    }
   });
 
   if (astrum::visualize_physics)
@@ -199,34 +216,44 @@ int main()
     auto bullet_debug_render_program = ludo::add(inst, ludo::render_program { .primitive = ludo::mesh_primitive::LINE_LIST }, "physics");
     ludo::init(*bullet_debug_render_program, ludo::vertex_format_pc, render_commands, 1);
 
-    auto bullet_debug_mesh = ludo::add(inst, ludo::mesh(), "physics");
-    ludo::init(*bullet_debug_mesh, indices, vertices, bullet_debug_counts.first, bullet_debug_counts.second, bullet_debug_render_program->format.size);
+    auto debug_mesh = ludo::mesh();
+    ludo::init(debug_mesh, indices, vertices, bullet_debug_counts.first, bullet_debug_counts.second, bullet_debug_render_program->format.size);
+    auto bullet_debug_mesh = ludo::add(inst, debug_mesh, "physics");
 
-    auto bullet_debug_render_mesh = ludo::add(inst, ludo::render_mesh(), "physics");
-    ludo::init(*bullet_debug_render_mesh, *bullet_debug_render_program, *bullet_debug_mesh, indices, vertices, 1);
+    auto debug_render_mesh = ludo::render_mesh();
+    ludo::init(debug_render_mesh, *bullet_debug_render_program, *bullet_debug_mesh, indices, vertices, 1);
+    ludo::add(inst, debug_render_mesh, "physics");
 
-    ludo::add<ludo::script>(inst, [](ludo::instance& inst)
+    ludo::add(inst, ludo::script
     {
-      auto mesh = ludo::first<ludo::mesh>(inst, "physics");
-      auto physics_context = ludo::first<ludo::physics_context>(inst);
-      auto render_mesh = ludo::first<ludo::render_mesh>(inst, "physics");
-      auto render_program = ludo::first<ludo::render_program>(inst, "physics");
+      .name = "ludo::add_render_commands/geometry/physics",
+      .function = [](ludo::instance& inst)
+      {
+        auto mesh = ludo::first<ludo::mesh>(inst, "physics");
+        auto physics_context = ludo::first<ludo::physics_context>(inst);
+        auto render_mesh = ludo::first<ludo::render_mesh>(inst, "physics");
+        auto render_program = ludo::first<ludo::render_program>(inst, "physics");
 
-      ludo::visualize(*physics_context, *mesh);
-      ludo::add_render_command(*render_program, *render_mesh);
+        ludo::visualize(*physics_context, *mesh);
+        ludo::add_render_command(*render_program, *render_mesh);
+      }
     });
   }
 
-  ludo::add<ludo::script>(inst, [](ludo::instance& inst)
+  ludo::add(inst, ludo::script
   {
-    auto rendering_context = ludo::first<ludo::rendering_context>(inst);
-    auto& render_programs = ludo::data<ludo::render_program>(inst);
+    .name = "ludo::commit_render_commands/geometry",
+    .function = [](ludo::instance& inst)
+    {
+      auto rendering_context = ludo::first<ludo::rendering_context>(inst);
+      auto& render_programs = ludo::data<ludo::render_program>(inst);
 
-    auto& render_commands = ludo::data_heap(inst, "ludo::vram_render_commands");
-    auto& indices = ludo::data_heap(inst, "ludo::vram_indices");
-    auto& vertices = ludo::data_heap(inst, "ludo::vram_vertices");
+      auto& render_commands = ludo::data_heap(inst, "ludo::vram_render_commands");
+      auto& indices = ludo::data_heap(inst, "ludo::vram_indices");
+      auto& vertices = ludo::data_heap(inst, "ludo::vram_vertices");
 
-    ludo::commit_render_commands(*rendering_context, render_programs, render_commands, indices, vertices);
+      ludo::commit_render_commands(*rendering_context, render_programs, render_commands, indices, vertices);
+    }
   });
 
   // Post-processing
@@ -238,14 +265,40 @@ int main()
   astrum::add_tone_mapping(inst, *post_processing_render_mesh);
   astrum::add_pass(inst, true);
 
-  ludo::add<ludo::script>(inst, [](ludo::instance& inst)
+  ludo::add(inst, ludo::script
   {
-    ludo::commit_render_transaction(*ludo::first<ludo::rendering_context>(inst));
+    .name = "ludo::commit_render_transaction",
+    .function = [](ludo::instance& inst)
+    {
+      ludo::commit_render_transaction(*ludo::first<ludo::rendering_context>(inst));
+    }
   });
 
-  ludo::add<ludo::script>(inst, astrum::print_timings);
+  ludo::add(inst, ludo::script { .name = "astrum::print_timings", .function = astrum::print_timings });
 
   std::cout << std::fixed << std::setprecision(4) << "remaining load time: " << ludo::elapsed(timer) << "s" << std::endl;
 
+#if defined(ASTRUM_HEADLESS)
+  ludo::set_null_frame_limit(astrum::headless_frame_count);
+  ludo::reset_null_statistics();
+#endif
+
   ludo::play(inst);
+
+  ludo::thread_pool_stop();
+  astrum::close_terrain_chunk_caches();
+
+#if defined(ASTRUM_HEADLESS)
+  auto& statistics = ludo::get_null_statistics();
+  std::cout << "frames: " << statistics.frames << std::endl;
+  std::cout << "draws: " << statistics.draw_calls << " calls, " << statistics.draw_commands << " commands, " << statistics.draw_indices << " indices, " << statistics.draw_instances << " instances (" << statistics.draw_instance_bytes << " bytes)" << std::endl;
+  std::cout << "dispatches: " << statistics.dispatches << " (" << statistics.work_groups << " work groups)" << std::endl;
+  std::cout << "vram: " << statistics.vram_allocations << " allocations (" << statistics.vram_allocated_bytes << " bytes), " << statistics.committed_bytes << " bytes committed" << std::endl;
+#endif
+
+  if (!astrum::profile_trace_path.empty())
+  {
+    auto stream = std::ofstream(astrum::profile_trace_path);
+    ludo::write_profile_trace(stream);
+  }
 }
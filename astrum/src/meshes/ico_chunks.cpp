@@ -1,60 +1,51 @@
-#include "ico_faces.h"
 #include "ico_chunks.h"
 
 namespace astrum
 {
-  void find_sphere_ico_chunks(std::unordered_map<uint32_t, std::array<ludo::vec3, 3>>& sections, uint32_t cumulative_index, uint32_t section_divisions, const std::function<bool(const std::array<ludo::vec3, 3>& triangle)>& test, const std::array<ludo::vec3, 3>& positions);
-
   std::unordered_map<uint32_t, std::array<ludo::vec3, 3>> find_sphere_ico_chunks(uint32_t section_divisions, const std::function<bool(const std::array<ludo::vec3, 3>& triangle)>& test)
   {
     std::unordered_map<uint32_t, std::array<ludo::vec3, 3>> sections;
 
-    auto sections_per_face = static_cast<uint32_t>(std::pow(4, section_divisions - 1));
-
-    auto& ico_faces = get_ico_faces();
-
-    for (auto index = 0; index < ico_faces.size(); index++)
+    find_each_sphere_ico_chunk(section_divisions, test, [&](uint32_t index, const std::array<ludo::vec3, 3>& triangle)
     {
-      if (test(ico_faces[index]))
-      {
-        find_sphere_ico_chunks(sections, index * sections_per_face, section_divisions - 1, test, ico_faces[index]);
-      }
-    }
+      sections[index] = triangle;
+    });
 
     return sections;
   }
 
-  void find_sphere_ico_chunks(std::unordered_map<uint32_t, std::array<ludo::vec3, 3>>& sections, uint32_t cumulative_index, uint32_t section_divisions, const std::function<bool(const std::array<ludo::vec3, 3>& triangle)>& test, const std::array<ludo::vec3, 3>& positions)
+  std::array<ludo::vec3, 3> sphere_ico_chunk(uint32_t section_divisions, uint32_t index)
   {
-    if (section_divisions == 0)
-    {
-      sections[cumulative_index] = positions;
-      return;
-    }
+    assert(section_divisions > 0 && section_divisions <= 16 && "invalid section divisions");
 
-    auto sections_per_face = static_cast<uint32_t>(std::pow(4, section_divisions - 1));
+    auto sections_per_face = uint32_t(1) << (2 * (section_divisions - 1));
+    auto ico_face_index = index / sections_per_face;
 
-    auto position_01 = (positions[0] + positions[1]) * 0.5f;
-    auto position_02 = (positions[0] + positions[2]) * 0.5f;
-    auto position_12 = (positions[1] + positions[2]) * 0.5f;
-    normalize(position_01);
-    normalize(position_02);
-    normalize(position_12);
+    auto& ico_faces = get_ico_faces();
+    assert(ico_face_index < ico_faces.size() && "invalid chunk index");
 
-    auto sub_faces = std::array<std::array<ludo::vec3, 3>, 4>
-    {{
-      { positions[0], position_01, position_02 },
-      { position_01, positions[1], position_12 },
-      { position_02, position_12, positions[2] },
-      { position_01, position_12, position_02 }
-    }};
+    auto positions = ico_faces[ico_face_index];
+    index %= sections_per_face;
 
-    for (auto index = 0; index < sub_faces.size(); index++)
+    for (auto divisions = section_divisions - 1; divisions > 0; divisions--)
     {
-      if (test(sub_faces[index]))
-      {
-        find_sphere_ico_chunks(sections, cumulative_index + index * sections_per_face, section_divisions - 1, test, sub_faces[index]);
-      }
+      auto sections_per_sub_face = uint32_t(1) << (2 * (divisions - 1));
+      auto sub_face_index = index / sections_per_sub_face;
+      index %= sections_per_sub_face;
+
+      auto position_01 = (positions[0] + positions[1]) * 0.5f;
+      auto position_02 = (positions[0] + positions[2]) * 0.5f;
+      auto position_12 = (positions[1] + positions[2]) * 0.5f;
+      normalize(position_01);
+      normalize(position_02);
+      normalize(position_12);
+
+      if (sub_face_index == 0) positions = { positions[0], position_01, position_02 };
+      else if (sub_face_index == 1) positions = { position_01, positions[1], position_12 };
+      else if (sub_face_index == 2) positions = { position_02, position_12, positions[2] };
+      else positions = { position_01, position_12, position_02 };
     }
+
+    return positions;
   }
 }
@@ -1,8 +1,24 @@
 #pragma once
 
+#include <span>
+
 #include <ludo/api.h>
 
 namespace astrum
 {
   std::unordered_map<uint32_t, std::array<ludo::vec3, 3>> find_sphere_ico_chunks(uint32_t section_divisions, const std::function<bool(const std::array<ludo::vec3, 3>& triangle)>& test);
+
+  // Returns the triangle of a single chunk by walking its index down through the subdivisions (without building a mesh).
+  std::array<ludo::vec3, 3> sphere_ico_chunk(uint32_t section_divisions, uint32_t index);
+
+  // Visits the chunks (and their triangles) that pass the test without allocating (or recursing).
+  // The visit function is of the form void(uint32_t index, const std::array<ludo::vec3, 3>& triangle).
+  template<typename T, typename V>
+  void find_each_sphere_ico_chunk(uint32_t section_divisions, T&& test, V&& visit);
+
+  // Writes the indices of up to results.size() chunks that pass the test and returns the number of chunks that passed.
+  template<typename T>
+  uint32_t find_sphere_ico_chunks(uint32_t section_divisions, T&& test, std::span<uint32_t> results);
 }
+
+#include "ico_chunks.hpp"
@@ -0,0 +1,87 @@
+#include <cassert>
+
+#include "ico_chunks.h"
+#include "ico_faces.h"
+
+namespace astrum
+{
+  template<typename T, typename V>
+  void find_each_sphere_ico_chunk(uint32_t section_divisions, T&& test, V&& visit)
+  {
+    struct node
+    {
+      std::array<ludo::vec3, 3> positions;
+      uint32_t cumulative_index;
+      uint32_t section_divisions;
+    };
+
+    // Faces are pushed in reverse so that they are visited in order. The 20 ico faces are followed by at most 3 siblings per layer.
+    assert(section_divisions > 0 && section_divisions <= 16 && "invalid section divisions");
+    auto stack = std::array<node, 20 + 3 * 16>();
+    auto stack_size = uint32_t(0);
+
+    auto sections_per_face = uint32_t(1) << (2 * (section_divisions - 1));
+
+    auto& ico_faces = get_ico_faces();
+    for (auto index = static_cast<int32_t>(ico_faces.size()) - 1; index >= 0; index--)
+    {
+      if (test(ico_faces[index]))
+      {
+        stack[stack_size++] = { .positions = ico_faces[index], .cumulative_index = index * sections_per_face, .section_divisions = section_divisions - 1 };
+      }
+    }
+
+    while (stack_size)
+    {
+      auto current = stack[--stack_size];
+      if (current.section_divisions == 0)
+      {
+        visit(current.cumulative_index, current.positions);
+        continue;
+      }
+
+      auto sections_per_sub_face = uint32_t(1) << (2 * (current.section_divisions - 1));
+
+      auto& positions = current.positions;
+      auto position_01 = (positions[0] + positions[1]) * 0.5f;
+      auto position_02 = (positions[0] + positions[2]) * 0.5f;
+      auto position_12 = (positions[1] + positions[2]) * 0.5f;
+      normalize(position_01);
+      normalize(position_02);
+      normalize(position_12);
+
+      auto sub_faces = std::array<std::array<ludo::vec3, 3>, 4>
+      {{
+        { positions[0], position_01, position_02 },
+        { position_01, positions[1], position_12 },
+        { position_02, position_12, positions[2] },
+        { position_01, position_12, position_02 }
+      }};
+
+      for (auto index = static_cast<int32_t>(sub_faces.size()) - 1; index >= 0; index--)
+      {
+        if (test(sub_faces[index]))
+        {
+          stack[stack_size++] = { .positions = sub_faces[index], .cumulative_index = current.cumulative_index + index * sections_per_sub_face, .section_divisions = current.section_divisions - 1 };
+        }
+      }
+    }
+  }
+
+  template<typename T>
+  uint32_t find_sphere_ico_chunks(uint32_t section_divisions, T&& test, std::span<uint32_t> results)
+  {
+    auto count = uint32_t(0);
+    find_each_sphere_ico_chunk(section_divisions, test, [&](uint32_t index, const std::array<ludo::vec3, 3>& triangle)
+    {
+      if (count < results.size())
+      {
+        results[count] = index;
+      }
+
+      count++;
+    });
+
+    return count;
+  }
+}
@@ -2,7 +2,7 @@
  * This file is part of ludo. See the LICENSE file for the full license governing this code.
  */
 
-#include <ludo/opengl/default_shaders.h>
+#include <ludo/rendering.h>
 
 #include "lod_shaders.h"
 
@@ -12,7 +12,7 @@ namespace astrum
   void write_lod_inputs(std::ostream& stream, const ludo::vertex_format& format, bool shared_transform);
   void write_lod_buffers(std::ostream& stream, const ludo::vertex_format& format, bool shared_transform);
   void write_lod_vertex_main(std::ostream& stream, const ludo::vertex_format& format, bool shared_transform);
-  void write_lod_fragment_main(std::ostream& stream, const ludo::vertex_format& format, bool shared_transform);
+  void write_lod_fragment_main(std::ostream& stream, const ludo::vertex_format& format, bool shared_transform, bool face_normals);
 
   std::stringstream lod_vertex_shader_code(const ludo::vertex_format& format, bool shared_transform)
   {
@@ -31,7 +31,7 @@ namespace astrum
     return code;
   }
 
-  std::stringstream lod_fragment_shader_code(const ludo::vertex_format& format, bool shared_transform)
+  std::stringstream lod_fragment_shader_code(const ludo::vertex_format& format, bool shared_transform, bool face_normals)
   {
     auto code = std::stringstream();
     write_header(code, format);
@@ -47,7 +47,7 @@ namespace astrum
     code << std::endl;
     code << "out vec4 color;" << std::endl;
     write_lighting_functions(code, format);
-    write_lod_fragment_main(code, format, shared_transform);
+    write_lod_fragment_main(code, format, shared_transform, face_normals);
 
     return code;
   }
@@ -200,7 +200,7 @@ R"--(
     stream << "}" << std::endl;
   }
 
-  void write_lod_fragment_main(std::ostream& stream, const ludo::vertex_format& format, bool shared_transform)
+  void write_lod_fragment_main(std::ostream& stream, const ludo::vertex_format& format, bool shared_transform, bool face_normals)
   {
     stream <<
 R"--(
@@ -210,7 +210,8 @@ void main()
 
 )--";
 
-    if (format.has_normal) stream << "  local_point.color = apply_point_light(local_point, lights[0], camera);" << std::endl;
+    if (face_normals) stream << "  local_point.normal = normalize(cross(dFdx(local_point.position), dFdy(local_point.position)));" << std::endl;
+    if (format.has_normal || face_normals) stream << "  local_point.color = apply_point_light(local_point, lights[0], camera);" << std::endl;
 
     stream <<
 R"--(
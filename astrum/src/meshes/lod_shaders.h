@@ -13,5 +13,6 @@ namespace astrum
 {
   std::stringstream lod_vertex_shader_code(const ludo::vertex_format& format, bool shared_transform);
 
-  std::stringstream lod_fragment_shader_code(const ludo::vertex_format& format, bool shared_transform);
+  // Face normals are derived from the positions of the fragments, for formats that are lit but have no normals of their own.
+  std::stringstream lod_fragment_shader_code(const ludo::vertex_format& format, bool shared_transform, bool face_normals = false);
 }
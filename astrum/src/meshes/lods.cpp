@@ -2,10 +2,8 @@
 
 namespace astrum
 {
-  std::vector<ludo::mesh> build_lod_meshes(const ludo::mesh& source, const ludo::vertex_format& format, ludo::heap& indices, ludo::heap& vertices, const std::vector<uint32_t>& iterations)
+  ludo::vertex_format lod_vertex_format(const ludo::vertex_format& format)
   {
-    std::vector<ludo::mesh> lod_meshes;
-
     auto lod_format = format;
     lod_format.components.insert(lod_format.components.end(), format.components.begin(), format.components.end());
     lod_format.size *= 2;
@@ -14,6 +12,15 @@ namespace astrum
     lod_format.color_offset += format.size;
     lod_format.texture_coordinate_offset += format.size;
 
+    return lod_format;
+  }
+
+  std::vector<ludo::mesh> build_lod_meshes(const ludo::mesh& source, const ludo::vertex_format& format, ludo::heap& indices, ludo::heap& vertices, const std::vector<uint32_t>& iterations)
+  {
+    std::vector<ludo::mesh> lod_meshes;
+
+    auto lod_format = lod_vertex_format(format);
+
     auto temp_mesh = ludo::mesh();
     temp_mesh.index_buffer = ludo::allocate(source.index_buffer.size);
     temp_mesh.vertex_buffer = ludo::allocate(source.vertex_buffer.size);
@@ -46,7 +53,9 @@ namespace astrum
         );
       }
 
-      ludo::collapse(lod_mesh, lod_format, lod_iterations);
+      // Each collapse removes (at-least) two triangles
+      auto triangle_count = counts.first / 3;
+      ludo::simplify(lod_mesh, lod_format, { .target_triangle_count = triangle_count > lod_iterations * 2 ? triangle_count - lod_iterations * 2 : 0 });
 
       lod_meshes.push_back(lod_mesh);
     }
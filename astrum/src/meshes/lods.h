@@ -10,6 +10,9 @@ namespace astrum
     float max_distance;
   };
 
+  // The format of the vertices of LOD meshes. Each vertex holds the vertex it morphs to (in the source format) followed by its own position, normal, etc.
+  ludo::vertex_format lod_vertex_format(const ludo::vertex_format& format);
+
   std::vector<ludo::mesh> build_lod_meshes(const ludo::mesh& source, const ludo::vertex_format& format, ludo::heap& indices, ludo::heap& vertices, const std::vector<uint32_t>& iterations);
 
   uint32_t find_lod_index(const std::vector<lod>& lods, const ludo::vec3& camera_position, const ludo::vec3& target_position, const ludo::vec3& target_normal);
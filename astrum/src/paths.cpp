@@ -2,8 +2,7 @@
 
 #include "constants.h"
 #include "paths.h"
-#include "physics/gravity.h"
-#include "physics/point_masses.h"
+#include "physics/trajectories.h"
 #include "types.h"
 
 namespace astrum
@@ -40,8 +39,9 @@ namespace astrum
 
     for (auto path_index = 0; path_index < path_count; path_index++)
     {
-      auto mesh = ludo::add(inst, ludo::mesh(), "prediction-paths");
-      ludo::init(*mesh, indices, vertices, path_steps, path_steps, ludo::vertex_format_p.size);
+      auto path_mesh = ludo::mesh();
+      ludo::init(path_mesh, indices, vertices, path_steps, path_steps, ludo::vertex_format_p.size);
+      auto mesh = ludo::add(inst, path_mesh, "prediction-paths");
 
       auto index_stream = ludo::stream(mesh->index_buffer);
       for (auto step_index = uint32_t(0); step_index < path_steps; step_index++)
@@ -49,8 +49,9 @@ namespace astrum
         ludo::write(index_stream, step_index);
       }
 
-      auto render_mesh = ludo::add(inst, ludo::render_mesh(), "prediction-paths");
-      ludo::init(*render_mesh, *render_program, *mesh, indices, vertices, 1);
+      auto path_render_mesh = ludo::render_mesh();
+      ludo::init(path_render_mesh, *render_program, *mesh, indices, vertices, 1);
+      auto render_mesh = ludo::add(inst, path_render_mesh, "prediction-paths");
 
       // TODO this grid is not a thing anymore...
       ludo::add(always_render_grid, *render_mesh, ludo::vec3_zero);
@@ -59,90 +60,76 @@ namespace astrum
 
   void update_prediction_paths(ludo::instance& inst)
   {
-    auto& dynamic_bodies = ludo::data<ludo::dynamic_body>(inst);
+    // The paths are propagated by a worker, they are only read or written here once it is done
+    static auto prediction = trajectories { .delta_time = path_delta_time, .step_count = path_steps };
+    static auto prediction_job = ludo::job_handle();
+
+    if (!ludo::thread_pool_complete(prediction_job))
+    {
+      return;
+    }
+
     auto& meshes = ludo::data<ludo::mesh>(inst, "prediction-paths");
 
     auto& point_masses = ludo::data<point_mass>(inst);
     auto& solar_system = *ludo::first<astrum::solar_system>(inst);
 
-    ludo::instance prediction_inst;
-
-    ludo::allocate<ludo::dynamic_body>(prediction_inst, dynamic_bodies.length);
-    ludo::allocate<ludo::kinematic_body>(prediction_inst, 0); // Required by point mass physics script
-    ludo::allocate<ludo::physics_context>(prediction_inst, 1);
-    ludo::allocate<ludo::script>(prediction_inst, 1);
-    ludo::allocate<ludo::static_body>(prediction_inst, 0); // Required by point mass physics script
-
-    ludo::allocate<point_mass>(prediction_inst, point_masses.length);
-    ludo::allocate<astrum::solar_system>(prediction_inst, 1);
+    auto& celestial_body_point_masses = ludo::data<point_mass>(inst, "celestial-bodies");
 
-    ludo::add(prediction_inst, ludo::physics_context { .gravity = ludo::vec3_zero });
-    ludo::add(prediction_inst, solar_system);
-
-    for (auto& dynamic_body : dynamic_bodies)
-    {
-      ludo::add(prediction_inst, dynamic_body);
-    }
-
-    for (auto& point_mass : point_masses)
+    auto bodies = std::vector<trajectory_body>(point_masses.length);
+    for (auto index = 0; index < point_masses.length; index++)
     {
-      ludo::add(prediction_inst, point_mass);
+      auto& point_mass = point_masses[index];
+      bodies[index] = { point_mass.transform.position, point_mass.linear_velocity, point_mass.mass, point_mass.resting };
     }
 
-    ludo::add<ludo::script>(prediction_inst, [](ludo::instance& prediction_inst)
+    advance(prediction, inst.total_time);
+    if (diverged(prediction, bodies, path_central_index, inst.total_time, path_tolerance))
     {
-      auto physics_context = ludo::first<ludo::physics_context>(prediction_inst);
+      // Start over from where the point masses actually are
+      auto relative_index = int32_t(-1);
+      if (solar_system.relative_celestial_body_index != -1)
+      {
+        relative_index = static_cast<int32_t>(celestial_body_point_masses.begin() - point_masses.begin()) + solar_system.relative_celestial_body_index;
+      }
 
-      simulate_gravity(prediction_inst);
-      ludo::simulate(*physics_context, prediction_inst.delta_time);
-      simulate_point_mass_physics(prediction_inst, {});
-    });
+      auto start_time = inst.total_time;
+      prediction_job = ludo::thread_pool_enqueue([bodies, relative_index, start_time]()
+      {
+        init(prediction, bodies, relative_index, start_time);
+        extend(prediction);
+      }, {}, {}, ludo::job_priority::low);
 
-    auto& prediction_dynamic_bodies = ludo::data<ludo::dynamic_body>(prediction_inst);
-    auto& prediction_point_masses = ludo::data<point_mass>(prediction_inst);
-    auto prediction_central_start_position = ludo::vec3_zero;
-    if (path_central_index != -1)
-    {
-      prediction_central_start_position = prediction_point_masses[path_central_index].transform.position;
+      return;
     }
 
-    for (auto step = uint32_t(0); step < path_steps; step++)
+    // Draw the paths relative to where the central point mass actually is
+    auto path_count = std::min(static_cast<uint32_t>(meshes.length), static_cast<uint32_t>(point_masses.length));
+    for (auto path_index = uint32_t(0); path_index < path_count; path_index++)
     {
-      auto path_index = uint32_t(0);
-      auto byte_index = step * ludo::vertex_format_p.size;
+      auto& mesh = meshes[path_index];
 
-      auto relative_position = ludo::vec3_zero;
-      if (path_central_index != -1)
+      for (auto step = uint32_t(0); step < path_steps; step++)
       {
-        relative_position = prediction_point_masses[path_central_index].transform.position - prediction_central_start_position;
-      }
+        // The window is a step (or so) short while it is being extended, the remaining vertices are collapsed onto its end
+        auto prediction_step = std::min(step, prediction.length - 1);
 
-      for (auto& prediction_body : prediction_dynamic_bodies)
-      {
-        ludo::cast<ludo::vec3>(meshes[path_index].vertex_buffer, byte_index) = prediction_body.transform.position - relative_position;
-        path_index++;
-        byte_index += path_steps * ludo::vertex_format_p.size;
-      }
+        auto relative_position = ludo::vec3_zero;
+        if (path_central_index != -1)
+        {
+          relative_position = position(prediction, prediction_step, path_central_index) - bodies[path_central_index].position;
+        }
 
-      for (auto& prediction_point_mass : prediction_point_masses)
-      {
-        ludo::cast<ludo::vec3>(meshes[path_index].vertex_buffer, byte_index) = prediction_point_mass.transform.position - relative_position;
-        path_index++;
-        byte_index += path_steps * ludo::vertex_format_p.size;
+        ludo::cast<ludo::vec3>(mesh.vertex_buffer, step * ludo::vertex_format_p.size) = position(prediction, prediction_step, path_index) - relative_position;
       }
-
-      prediction_inst.delta_time = path_delta_time;
-      prediction_inst.total_time += path_delta_time;
-      ludo::frame(prediction_inst);
     }
 
-    ludo::deallocate<ludo::dynamic_body>(prediction_inst);
-    ludo::deallocate<ludo::kinematic_body>(prediction_inst); // Required by point mass physics script
-    ludo::deallocate<ludo::physics_context>(prediction_inst);
-    ludo::deallocate<ludo::script>(prediction_inst);
-    ludo::deallocate<ludo::static_body>(prediction_inst); // Required by point mass physics script
-
-    ludo::deallocate<point_mass>(prediction_inst);
-    ludo::deallocate<astrum::solar_system>(prediction_inst);
+    if (prediction.length < prediction.step_count)
+    {
+      prediction_job = ludo::thread_pool_enqueue([]()
+      {
+        extend(prediction);
+      }, {}, {}, ludo::job_priority::low);
+    }
   }
 }
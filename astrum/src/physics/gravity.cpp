@@ -1,12 +1,66 @@
+#include <numeric>
+
+#include <ludo/math/simd.h>
+
 #include "../types.h"
 #include "gravity.h"
 
 namespace astrum
 {
-  ludo::vec3 gravitational_force(const ludo::vec3& relative_position, float mass_a, float mass_b);
+  const auto gravity_lanes = uint32_t(8); // The bodies acting on others are padded to a multiple of the widest SIMD kernel
+  const auto gravity_leaf_size = uint32_t(8);
+  const auto gravity_group_size = uint32_t(64); // The number of bodies that share the nodes acting on them
+  const auto gravity_max_depth = uint32_t(32); // Guards against endlessly subdividing bodies at the same position
+
+  void accelerate_all_pairs(gravity_buffer& buffer, uint32_t count);
+  void accelerate_barnes_hut(gravity_buffer& buffer, uint32_t count, float opening_angle);
+  uint32_t build_node(gravity_buffer& buffer, const ludo::vec3& center, float half_width, uint32_t begin, uint32_t end, uint32_t depth, float opening_angle);
+  void extend(ludo::vec3& min, ludo::vec3& max, const ludo::vec3& position);
+  float distance2(const ludo::vec3& min, const ludo::vec3& max, const ludo::vec3& position);
+  void pad(std::vector<float>& xs, std::vector<float>& ys, std::vector<float>& zs, std::vector<float>& masses);
+  ludo::vec3 sum_acceleration(const float* xs, const float* ys, const float* zs, const float* masses, uint32_t count, const ludo::vec3& position);
+
+  void clear(gravity_buffer& buffer)
+  {
+    buffer.xs.clear();
+    buffer.ys.clear();
+    buffer.zs.clear();
+    buffer.masses.clear();
+  }
+
+  void add(gravity_buffer& buffer, const ludo::vec3& position, float mass)
+  {
+    buffer.xs.push_back(position[0]);
+    buffer.ys.push_back(position[1]);
+    buffer.zs.push_back(position[2]);
+    buffer.masses.push_back(mass);
+  }
+
+  void accelerate(gravity_buffer& buffer, const gravity_options& options)
+  {
+    auto count = static_cast<uint32_t>(buffer.masses.size());
+    buffer.accelerations.resize(count);
+
+    if (!count)
+    {
+      return;
+    }
+
+    if (count < options.barnes_hut_threshold)
+    {
+      accelerate_all_pairs(buffer, count);
+    }
+    else
+    {
+      accelerate_barnes_hut(buffer, count, options.opening_angle);
+    }
+  }
 
   void simulate_gravity(ludo::instance& inst)
   {
+    // Re-used from frame to frame to avoid allocating
+    static auto buffer = gravity_buffer();
+
     auto& dynamic_bodies = ludo::data<ludo::dynamic_body>(inst);
 
     auto& point_masses = ludo::data<point_mass>(inst);
@@ -14,107 +68,384 @@ namespace astrum
 
     auto& celestial_body_point_masses = ludo::data<point_mass>(inst, "celestial-bodies");
 
-    auto body_accelerations = std::vector<ludo::vec3>(dynamic_bodies.length, ludo::vec3_zero);
-    auto point_mass_accelerations = std::vector<ludo::vec3>(point_masses.length, ludo::vec3_zero);
+    // Bodies and point masses attract each other alike, so they are gathered together (bodies first)
+    clear(buffer);
 
-    // Body <-> body gravitational acceleration
-    for (auto index_a = 0; dynamic_bodies.length && index_a < dynamic_bodies.length - 1; index_a++)
+    for (auto index = 0; index < dynamic_bodies.length; index++)
     {
-      auto& body_a = dynamic_bodies[index_a];
+      auto& body = dynamic_bodies[index];
+      add(buffer, body.transform.position, body.mass);
+    }
 
-      for (auto index_b = index_a + 1; index_b < dynamic_bodies.length; index_b++)
-      {
-        auto& body_b = dynamic_bodies[index_b];
+    for (auto index = 0; index < point_masses.length; index++)
+    {
+      auto& point_mass = point_masses[index];
+      add(buffer, point_mass.transform.position, point_mass.mass);
+    }
+
+    accelerate(buffer);
 
-        auto relative_position = body_b.transform.position - body_a.transform.position;
-        auto force = gravitational_force(relative_position, body_a.mass, body_b.mass);
+    auto& accelerations = buffer.accelerations;
+    auto point_mass_offset = dynamic_bodies.length;
 
-        body_accelerations[index_a] += force / body_a.mass;
-        body_accelerations[index_b] -= force / body_b.mass;
+    // Cancel out the relative celestial body (since it is static!)
+    if (solar_system.relative_celestial_body_index != -1)
+    {
+      auto relative_point_mass_index = celestial_body_point_masses.begin() - point_masses.begin() + solar_system.relative_celestial_body_index;
+      auto relative_point_mass_acceleration = accelerations[point_mass_offset + relative_point_mass_index];
+
+      for (auto& acceleration : accelerations)
+      {
+        acceleration -= relative_point_mass_acceleration;
       }
     }
 
-    // Point mass <-> point mass gravitational acceleration
-    for (auto index_a = 0; index_a < point_masses.length && point_masses.length - 1; index_a++)
+    // Apply gravitational acceleration to bodies and point masses
+    for (auto index = 0; index < dynamic_bodies.length; index++)
     {
-      auto& point_mass_a = point_masses[index_a];
+      auto& body = dynamic_bodies[index];
+      ludo::apply_force(body, body.mass * accelerations[index]);
+    }
 
-      for (auto index_b = index_a + 1; index_b < point_masses.length; index_b++)
+    for (auto index = 0; index < point_masses.length; index++)
+    {
+      auto& point_mass = point_masses[index];
+      if (point_mass.resting)
       {
-        auto& point_mass_b = point_masses[index_b];
+        continue;
+      }
 
-        auto relative_position = point_mass_b.transform.position - point_mass_a.transform.position;
-        if (relative_position == ludo::vec3_zero)
-        {
-          // TODO A bit of a hack, this should only occur when our pilot is in the spaceship. Probably eventually we can get rid of this when we make the overall vehicle system better.
-          continue;
-        }
+      point_mass.linear_velocity += accelerations[point_mass_offset + index] * inst.delta_time;
+    }
+  }
 
-        auto force = gravitational_force(relative_position, point_mass_a.mass, point_mass_b.mass);
+  void accelerate_all_pairs(gravity_buffer& buffer, uint32_t count)
+  {
+    pad(buffer.xs, buffer.ys, buffer.zs, buffer.masses);
+    auto padded_count = static_cast<uint32_t>(buffer.masses.size());
 
-        point_mass_accelerations[index_a] += force / point_mass_a.mass;
-        point_mass_accelerations[index_b] -= force / point_mass_b.mass;
-      }
+    for (auto index = uint32_t(0); index < count; index++)
+    {
+      auto position = ludo::vec3 { buffer.xs[index], buffer.ys[index], buffer.zs[index] };
+      buffer.accelerations[index] = gravitational_constant * sum_acceleration(buffer.xs.data(), buffer.ys.data(), buffer.zs.data(), buffer.masses.data(), padded_count, position);
     }
 
-    // Body <-> point mass gravitational acceleration
-    for (auto index_a = 0; index_a < dynamic_bodies.length; index_a++)
+    // Drop the padding so more bodies can be added
+    buffer.xs.resize(count);
+    buffer.ys.resize(count);
+    buffer.zs.resize(count);
+    buffer.masses.resize(count);
+  }
+
+  void accelerate_barnes_hut(gravity_buffer& buffer, uint32_t count, float opening_angle)
+  {
+    // Bound the bodies with a cube
+    auto min = ludo::vec3 { buffer.xs[0], buffer.ys[0], buffer.zs[0] };
+    auto max = min;
+    for (auto index = uint32_t(1); index < count; index++)
     {
-      auto& body = dynamic_bodies[index_a];
+      extend(min, max, { buffer.xs[index], buffer.ys[index], buffer.zs[index] });
+    }
 
-      for (auto index_b = 0; index_b < point_masses.length; index_b++)
-      {
-        auto& point_mass = point_masses[index_b];
+    auto center = (min + max) * 0.5f;
+    auto half_width = std::max(std::max(max[0] - min[0], max[1] - min[1]), max[2] - min[2]) * 0.5f;
 
-        auto relative_position = point_mass.transform.position - body.transform.position;
-        auto force = gravitational_force(relative_position, body.mass, point_mass.mass);
+    buffer.order.resize(count);
+    buffer.order_scratch.resize(count);
+    buffer.octants.resize(count);
+    std::iota(buffer.order.begin(), buffer.order.end(), 0);
 
-        body_accelerations[index_a] += force / body.mass;
-        point_mass_accelerations[index_b] -= force / point_mass.mass;
-      }
+    buffer.nodes.clear();
+    build_node(buffer, center, half_width, 0, count, 0, opening_angle);
+
+    // Lay the bodies out in tree order so the bodies of each leaf are contiguous
+    buffer.tree_xs.resize(count);
+    buffer.tree_ys.resize(count);
+    buffer.tree_zs.resize(count);
+    buffer.tree_masses.resize(count);
+    for (auto index = uint32_t(0); index < count; index++)
+    {
+      auto body_index = buffer.order[index];
+      buffer.tree_xs[index] = buffer.xs[body_index];
+      buffer.tree_ys[index] = buffer.ys[body_index];
+      buffer.tree_zs[index] = buffer.zs[body_index];
+      buffer.tree_masses[index] = buffer.masses[body_index];
     }
 
-    // Cancel out the relative celestial body (since it is static!)
-    if (solar_system.relative_celestial_body_index != -1)
+    // Each body acts on a group at most once, either directly or through one of the nodes containing it
+    auto node_count = static_cast<uint32_t>(buffer.nodes.size());
+    auto max_interaction_count = count + node_count + gravity_lanes;
+    buffer.interaction_xs.resize(max_interaction_count);
+    buffer.interaction_ys.resize(max_interaction_count);
+    buffer.interaction_zs.resize(max_interaction_count);
+    buffer.interaction_masses.resize(max_interaction_count);
+
+    for (auto group_index = uint32_t(0); group_index < node_count;)
     {
-      auto relative_point_mass_index = celestial_body_point_masses.begin() - point_masses.begin() + solar_system.relative_celestial_body_index;
-      auto relative_point_mass_acceleration = point_mass_accelerations[relative_point_mass_index];
+      // Bodies are grouped by the largest nodes with few enough bodies
+      auto& group = buffer.nodes[group_index];
+      if (!group.leaf && group.end - group.begin > gravity_group_size)
+      {
+        group_index++;
+        continue;
+      }
+
+      group_index = group.next;
+
+      // The nodes acting on a group are found once for all of its bodies, using the bounds of the bodies
+      auto group_min = ludo::vec3 { buffer.tree_xs[group.begin], buffer.tree_ys[group.begin], buffer.tree_zs[group.begin] };
+      auto group_max = group_min;
+      for (auto index = group.begin + 1; index < group.end; index++)
+      {
+        extend(group_min, group_max, { buffer.tree_xs[index], buffer.tree_ys[index], buffer.tree_zs[index] });
+      }
+
+      auto interaction_count = uint32_t(0);
+
+      for (auto node_index = uint32_t(0); node_index < node_count;)
+      {
+        auto& node = buffer.nodes[node_index];
+
+        if (distance2(group_min, group_max, node.center_of_mass) > node.opening_radius2)
+        {
+          // Far enough away to be treated as a single body
+          buffer.interaction_xs[interaction_count] = node.center_of_mass[0];
+          buffer.interaction_ys[interaction_count] = node.center_of_mass[1];
+          buffer.interaction_zs[interaction_count] = node.center_of_mass[2];
+          buffer.interaction_masses[interaction_count] = node.mass;
+          interaction_count++;
+
+          node_index = node.next;
+        }
+        else if (node.leaf)
+        {
+          // Too close, so each of its bodies act on the group (including the bodies of the group itself)
+          std::copy(buffer.tree_xs.begin() + node.begin, buffer.tree_xs.begin() + node.end, buffer.interaction_xs.begin() + interaction_count);
+          std::copy(buffer.tree_ys.begin() + node.begin, buffer.tree_ys.begin() + node.end, buffer.interaction_ys.begin() + interaction_count);
+          std::copy(buffer.tree_zs.begin() + node.begin, buffer.tree_zs.begin() + node.end, buffer.interaction_zs.begin() + interaction_count);
+          std::copy(buffer.tree_masses.begin() + node.begin, buffer.tree_masses.begin() + node.end, buffer.interaction_masses.begin() + interaction_count);
+          interaction_count += node.end - node.begin;
+
+          node_index = node.next;
+        }
+        else
+        {
+          // Too close, so open it (its children follow it)
+          node_index++;
+        }
+      }
 
-      for (auto& body_acceleration : body_accelerations)
+      // Massless bodies have no effect
+      for (; interaction_count % gravity_lanes; interaction_count++)
       {
-        body_acceleration -= relative_point_mass_acceleration;
+        buffer.interaction_masses[interaction_count] = 0.0f;
       }
 
-      for (auto& point_mass_acceleration : point_mass_accelerations)
+      for (auto index = group.begin; index < group.end; index++)
       {
-        point_mass_acceleration -= relative_point_mass_acceleration;
+        auto position = ludo::vec3 { buffer.tree_xs[index], buffer.tree_ys[index], buffer.tree_zs[index] };
+        buffer.accelerations[buffer.order[index]] = gravitational_constant * sum_acceleration(buffer.interaction_xs.data(), buffer.interaction_ys.data(), buffer.interaction_zs.data(), buffer.interaction_masses.data(), interaction_count, position);
       }
     }
+  }
 
-    // Apply gravitational acceleration to bodies and point masses
-    for (auto index = 0; index < dynamic_bodies.length; index++)
+  uint32_t build_node(gravity_buffer& buffer, const ludo::vec3& center, float half_width, uint32_t begin, uint32_t end, uint32_t depth, float opening_angle)
+  {
+    auto node_index = static_cast<uint32_t>(buffer.nodes.size());
+    buffer.nodes.push_back({ .begin = begin, .end = end });
+
+    auto center_of_mass = ludo::vec3_zero;
+    auto mass = 0.0f;
+    auto leaf = end - begin <= gravity_leaf_size || depth == gravity_max_depth;
+
+    if (leaf)
     {
-      auto& body = dynamic_bodies[index];
-      ludo::apply_force(body, body.mass * body_accelerations[index]);
+      for (auto index = begin; index < end; index++)
+      {
+        auto body_index = buffer.order[index];
+        center_of_mass += ludo::vec3 { buffer.xs[body_index], buffer.ys[body_index], buffer.zs[body_index] } * buffer.masses[body_index];
+        mass += buffer.masses[body_index];
+      }
     }
-
-    for (auto index = 0; index < point_masses.length; index++)
+    else
     {
-      auto& point_mass = point_masses[index];
-      if (point_mass.resting)
+      // Sort the bodies of the node by octant
+      auto octant_counts = std::array<uint32_t, 8> {};
+      for (auto index = begin; index < end; index++)
       {
-        continue;
+        auto body_index = buffer.order[index];
+        auto octant = uint8_t((buffer.xs[body_index] >= center[0]) | (buffer.ys[body_index] >= center[1]) << 1 | (buffer.zs[body_index] >= center[2]) << 2);
+
+        buffer.octants[index] = octant;
+        octant_counts[octant]++;
+      }
+
+      auto octant_offsets = std::array<uint32_t, 8>();
+      std::exclusive_scan(octant_counts.begin(), octant_counts.end(), octant_offsets.begin(), begin);
+
+      auto octant_begins = octant_offsets;
+      for (auto index = begin; index < end; index++)
+      {
+        buffer.order_scratch[octant_offsets[buffer.octants[index]]++] = buffer.order[index];
+      }
+
+      std::copy(buffer.order_scratch.begin() + begin, buffer.order_scratch.begin() + end, buffer.order.begin() + begin);
+
+      auto child_half_width = half_width * 0.5f;
+      for (auto octant = uint8_t(0); octant < 8; octant++)
+      {
+        if (!octant_counts[octant])
+        {
+          continue;
+        }
+
+        auto child_center = center + ludo::vec3
+        {
+          octant & 1 ? child_half_width : -child_half_width,
+          octant & 2 ? child_half_width : -child_half_width,
+          octant & 4 ? child_half_width : -child_half_width
+        };
+
+        auto child_index = build_node(buffer, child_center, child_half_width, octant_begins[octant], octant_begins[octant] + octant_counts[octant], depth + 1, opening_angle);
+        auto& child = buffer.nodes[child_index];
+
+        center_of_mass += child.center_of_mass * child.mass;
+        mass += child.mass;
       }
+    }
+
+    auto& node = buffer.nodes[node_index];
+    node.center_of_mass = mass > 0.0f ? center_of_mass / mass : center;
+    node.mass = mass;
+    node.next = static_cast<uint32_t>(buffer.nodes.size());
+    node.leaf = leaf;
+
+    // Widen the opening distance by how far the center of mass is from the center, so that a body can never be inside a node it treats as a single body
+    auto opening_radius = 2.0f * half_width / opening_angle + ludo::length(node.center_of_mass - center);
+    node.opening_radius2 = opening_radius * opening_radius;
+
+    return node_index;
+  }
+
+  void extend(ludo::vec3& min, ludo::vec3& max, const ludo::vec3& position)
+  {
+    for (auto axis = 0; axis < 3; axis++)
+    {
+      min[axis] = std::min(min[axis], position[axis]);
+      max[axis] = std::max(max[axis], position[axis]);
+    }
+  }
 
-      point_mass.linear_velocity += point_mass_accelerations[index] * inst.delta_time;
+  float distance2(const ludo::vec3& min, const ludo::vec3& max, const ludo::vec3& position)
+  {
+    auto distance2 = 0.0f;
+    for (auto axis = 0; axis < 3; axis++)
+    {
+      auto offset = std::max(std::max(min[axis] - position[axis], position[axis] - max[axis]), 0.0f);
+      distance2 += offset * offset;
     }
+
+    return distance2;
+  }
+
+  void pad(std::vector<float>& xs, std::vector<float>& ys, std::vector<float>& zs, std::vector<float>& masses)
+  {
+    // Massless bodies have no effect
+    auto padded_count = (masses.size() + gravity_lanes - 1) / gravity_lanes * gravity_lanes;
+
+    xs.resize(padded_count, 0.0f);
+    ys.resize(padded_count, 0.0f);
+    zs.resize(padded_count, 0.0f);
+    masses.resize(padded_count, 0.0f);
   }
 
-  ludo::vec3 gravitational_force(const ludo::vec3& relative_position, float mass_a, float mass_b)
+  ludo::vec3 sum_acceleration(const float* xs, const float* ys, const float* zs, const float* masses, uint32_t count, const ludo::vec3& position)
   {
-    auto force_normal = relative_position;
-    normalize(force_normal);
+    auto index = uint32_t(0);
+    auto acceleration = ludo::vec3_zero;
+
+    // Each body contributes mass * relative_position / distance^3, bodies at the same position divide by zero and are masked out
+#if defined(LUDO_AVX)
+    auto x = _mm256_set1_ps(position[0]);
+    auto y = _mm256_set1_ps(position[1]);
+    auto z = _mm256_set1_ps(position[2]);
+    auto zero = _mm256_setzero_ps();
+
+    auto acceleration_x = _mm256_setzero_ps();
+    auto acceleration_y = _mm256_setzero_ps();
+    auto acceleration_z = _mm256_setzero_ps();
+
+    for (; index + 8 <= count; index += 8)
+    {
+      auto relative_x = _mm256_sub_ps(_mm256_loadu_ps(&xs[index]), x);
+      auto relative_y = _mm256_sub_ps(_mm256_loadu_ps(&ys[index]), y);
+      auto relative_z = _mm256_sub_ps(_mm256_loadu_ps(&zs[index]), z);
+
+      auto distance2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(relative_x, relative_x), _mm256_mul_ps(relative_y, relative_y)), _mm256_mul_ps(relative_z, relative_z));
+      auto distance3 = _mm256_mul_ps(distance2, _mm256_sqrt_ps(distance2));
+      auto scale = _mm256_and_ps(_mm256_div_ps(_mm256_loadu_ps(&masses[index]), distance3), _mm256_cmp_ps(distance2, zero, _CMP_GT_OQ));
+
+      acceleration_x = _mm256_add_ps(acceleration_x, _mm256_mul_ps(relative_x, scale));
+      acceleration_y = _mm256_add_ps(acceleration_y, _mm256_mul_ps(relative_y, scale));
+      acceleration_z = _mm256_add_ps(acceleration_z, _mm256_mul_ps(relative_z, scale));
+    }
+
+    alignas(32) auto lanes = std::array<std::array<float, 8>, 3>();
+    _mm256_store_ps(lanes[0].data(), acceleration_x);
+    _mm256_store_ps(lanes[1].data(), acceleration_y);
+    _mm256_store_ps(lanes[2].data(), acceleration_z);
+
+    for (auto axis = 0; axis < 3; axis++)
+    {
+      acceleration[axis] = std::accumulate(lanes[axis].begin(), lanes[axis].end(), 0.0f);
+    }
+#elif defined(LUDO_SSE)
+    auto x = _mm_set1_ps(position[0]);
+    auto y = _mm_set1_ps(position[1]);
+    auto z = _mm_set1_ps(position[2]);
+    auto zero = _mm_setzero_ps();
+
+    auto acceleration_x = _mm_setzero_ps();
+    auto acceleration_y = _mm_setzero_ps();
+    auto acceleration_z = _mm_setzero_ps();
+
+    for (; index + 4 <= count; index += 4)
+    {
+      auto relative_x = _mm_sub_ps(_mm_loadu_ps(&xs[index]), x);
+      auto relative_y = _mm_sub_ps(_mm_loadu_ps(&ys[index]), y);
+      auto relative_z = _mm_sub_ps(_mm_loadu_ps(&zs[index]), z);
+
+      auto distance2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(relative_x, relative_x), _mm_mul_ps(relative_y, relative_y)), _mm_mul_ps(relative_z, relative_z));
+      auto distance3 = _mm_mul_ps(distance2, _mm_sqrt_ps(distance2));
+      auto scale = _mm_and_ps(_mm_div_ps(_mm_loadu_ps(&masses[index]), distance3), _mm_cmpgt_ps(distance2, zero));
+
+      acceleration_x = _mm_add_ps(acceleration_x, _mm_mul_ps(relative_x, scale));
+      acceleration_y = _mm_add_ps(acceleration_y, _mm_mul_ps(relative_y, scale));
+      acceleration_z = _mm_add_ps(acceleration_z, _mm_mul_ps(relative_z, scale));
+    }
+
+    alignas(16) auto lanes = std::array<std::array<float, 4>, 3>();
+    _mm_store_ps(lanes[0].data(), acceleration_x);
+    _mm_store_ps(lanes[1].data(), acceleration_y);
+    _mm_store_ps(lanes[2].data(), acceleration_z);
+
+    for (auto axis = 0; axis < 3; axis++)
+    {
+      acceleration[axis] = std::accumulate(lanes[axis].begin(), lanes[axis].end(), 0.0f);
+    }
+#endif
+
+    for (; index < count; index++)
+    {
+      auto relative_position = ludo::vec3 { xs[index], ys[index], zs[index] } - position;
+
+      auto distance2 = ludo::length2(relative_position);
+      if (distance2 > 0.0f)
+      {
+        acceleration += relative_position * (masses[index] / (distance2 * std::sqrt(distance2)));
+      }
+    }
 
-    return force_normal * gravitational_constant * mass_a * mass_b / ludo::length2(relative_position);
+    return acceleration;
   }
 }
@@ -2,7 +2,65 @@
 
 #include <ludo/api.h>
 
+#include "../constants.h"
+
 namespace astrum
 {
+  struct gravity_options
+  {
+    uint32_t barnes_hut_threshold = gravity_barnes_hut_threshold; // Bodies are summed pairwise below this count, otherwise they are approximated with an octree
+    float opening_angle = gravity_opening_angle; // The (width / distance) below which an octree node is treated as a single body
+  };
+
+  struct gravity_node
+  {
+    ludo::vec3 center_of_mass = ludo::vec3_zero;
+    float mass = 0.0f;
+    float opening_radius2 = 0.0f; // The squared distance beyond which the node can be treated as a single body
+
+    uint32_t begin = 0; // The range of bodies (in tree order) within the node
+    uint32_t end = 0;
+    uint32_t next = 0; // The index of the node following this node's subtree
+    bool leaf = false;
+  };
+
+  // Massive bodies laid out as a structure of arrays, along with the scratch space used to compute their accelerations.
+  // Re-using a buffer from frame to frame avoids allocating.
+  struct gravity_buffer
+  {
+    std::vector<float> xs;
+    std::vector<float> ys;
+    std::vector<float> zs;
+    std::vector<float> masses;
+
+    std::vector<ludo::vec3> accelerations;
+
+    // Barnes-Hut
+    std::vector<gravity_node> nodes;
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> order_scratch;
+    std::vector<uint8_t> octants;
+
+    // Bodies in tree order
+    std::vector<float> tree_xs;
+    std::vector<float> tree_ys;
+    std::vector<float> tree_zs;
+    std::vector<float> tree_masses;
+
+    // The bodies and nodes acting on a group of bodies
+    std::vector<float> interaction_xs;
+    std::vector<float> interaction_ys;
+    std::vector<float> interaction_zs;
+    std::vector<float> interaction_masses;
+  };
+
+  void clear(gravity_buffer& buffer);
+
+  void add(gravity_buffer& buffer, const ludo::vec3& position, float mass);
+
+  // Computes the gravitational acceleration of every body in the buffer caused by every other body in the buffer.
+  // Bodies at exactly the same position do not act on each other.
+  void accelerate(gravity_buffer& buffer, const gravity_options& options = {});
+
   void simulate_gravity(ludo::instance& inst);
 }
@@ -7,7 +7,6 @@ namespace astrum
   void simulate_point_mass_physics(ludo::instance& inst, const std::vector<std::string>& kinematic_partitions)
   {
     auto& kinematic_bodies = ludo::data<ludo::kinematic_body>(inst);
-    auto& static_bodies = ludo::data<ludo::static_body>(inst);
 
     auto& point_masses = ludo::data<point_mass>(inst);
 
@@ -37,8 +36,8 @@ namespace astrum
             auto deepest_contacts = astrum::deepest_contacts(contacts);
             for (auto& deepest_contact : deepest_contacts)
             {
-              auto static_body = ludo::find_by_id(static_bodies.begin(), static_bodies.end(), deepest_contact.body_b_id);
-              if (static_body == static_bodies.end())
+              auto static_body = ludo::get<ludo::static_body>(inst, deepest_contact.body_b_id);
+              if (!static_body)
               {
                 continue;
               }
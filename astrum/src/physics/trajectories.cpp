@@ -0,0 +1,135 @@
+#include "trajectories.h"
+
+namespace astrum
+{
+  void accelerate(trajectories& trajectories);
+
+  void init(trajectories& trajectories, const std::vector<trajectory_body>& bodies, int32_t relative_index, float start_time)
+  {
+    assert(trajectories.step_count > 0 && "step count must be greater than zero");
+
+    trajectories.bodies = bodies;
+    trajectories.relative_index = relative_index;
+
+    trajectories.positions.resize(trajectories.step_count * bodies.size());
+    trajectories.head = 0;
+    trajectories.length = 1;
+    trajectories.start_time = start_time;
+
+    for (auto index = uint32_t(0); index < bodies.size(); index++)
+    {
+      trajectories.positions[index] = bodies[index].position;
+    }
+
+    accelerate(trajectories);
+  }
+
+  void extend(trajectories& trajectories)
+  {
+    auto body_count = static_cast<uint32_t>(trajectories.bodies.size());
+    auto half_delta_time = trajectories.delta_time * 0.5f;
+
+    while (trajectories.length < trajectories.step_count)
+    {
+      // Kick, drift, kick
+      for (auto index = uint32_t(0); index < body_count; index++)
+      {
+        auto& body = trajectories.bodies[index];
+        if (!body.resting)
+        {
+          body.linear_velocity += trajectories.accelerations[index] * half_delta_time;
+          body.position += body.linear_velocity * trajectories.delta_time;
+        }
+      }
+
+      accelerate(trajectories);
+
+      auto step = (trajectories.head + trajectories.length) % trajectories.step_count;
+      for (auto index = uint32_t(0); index < body_count; index++)
+      {
+        auto& body = trajectories.bodies[index];
+        if (!body.resting)
+        {
+          body.linear_velocity += trajectories.accelerations[index] * half_delta_time;
+        }
+
+        trajectories.positions[step * body_count + index] = body.position;
+      }
+
+      trajectories.length++;
+    }
+  }
+
+  void advance(trajectories& trajectories, float time)
+  {
+    while (trajectories.length > 1 && time >= trajectories.start_time + trajectories.delta_time)
+    {
+      trajectories.head = (trajectories.head + 1) % trajectories.step_count;
+      trajectories.length--;
+      trajectories.start_time += trajectories.delta_time;
+    }
+  }
+
+  bool diverged(const trajectories& trajectories, const std::vector<trajectory_body>& bodies, int32_t central_index, float time, float tolerance)
+  {
+    if (bodies.size() != trajectories.bodies.size() || trajectories.length < 2)
+    {
+      return true;
+    }
+
+    auto fraction = std::clamp((time - trajectories.start_time) / trajectories.delta_time, 0.0f, 1.0f);
+
+    auto predicted_position = [&](uint32_t body_index)
+    {
+      auto& from = position(trajectories, 0, body_index);
+      auto& to = position(trajectories, 1, body_index);
+
+      return from + (to - from) * fraction;
+    };
+
+    auto predicted_central_position = central_index != -1 ? predicted_position(central_index) : ludo::vec3_zero;
+    auto actual_central_position = central_index != -1 ? bodies[central_index].position : ludo::vec3_zero;
+
+    for (auto index = uint32_t(0); index < bodies.size(); index++)
+    {
+      auto actual_relative_position = bodies[index].position - actual_central_position;
+      auto predicted_relative_position = predicted_position(index) - predicted_central_position;
+
+      if (ludo::length2(actual_relative_position - predicted_relative_position) > tolerance * tolerance * ludo::length2(actual_relative_position))
+      {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  const ludo::vec3& position(const trajectories& trajectories, uint32_t step, uint32_t body_index)
+  {
+    auto ring_step = (trajectories.head + step) % trajectories.step_count;
+
+    return trajectories.positions[ring_step * trajectories.bodies.size() + body_index];
+  }
+
+  void accelerate(trajectories& trajectories)
+  {
+    clear(trajectories.gravity);
+    for (auto& body : trajectories.bodies)
+    {
+      add(trajectories.gravity, body.position, body.mass);
+    }
+
+    accelerate(trajectories.gravity);
+    trajectories.accelerations = trajectories.gravity.accelerations;
+
+    // Cancel out the relative body (since it is static!)
+    if (trajectories.relative_index != -1)
+    {
+      auto relative_acceleration = trajectories.accelerations[trajectories.relative_index];
+      for (auto& acceleration : trajectories.accelerations)
+      {
+        acceleration -= relative_acceleration;
+      }
+    }
+  }
+}
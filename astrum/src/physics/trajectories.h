@@ -0,0 +1,49 @@
+#pragma once
+
+#include <ludo/api.h>
+
+#include "gravity.h"
+
+namespace astrum
+{
+  struct trajectory_body
+  {
+    ludo::vec3 position = ludo::vec3_zero;
+    ludo::vec3 linear_velocity = ludo::vec3_zero;
+    float mass = 0.0f;
+    bool resting = false; // Resting bodies are held in place, as they are by the point mass physics
+  };
+
+  // A window of predicted positions of point masses under their mutual gravity.
+  // The positions are kept in a ring buffer so that the window can be advanced without re-computing it.
+  struct trajectories
+  {
+    float delta_time = 1.0f;
+    uint32_t step_count = 0;
+
+    std::vector<trajectory_body> bodies; // The state of the bodies at the last step
+    int32_t relative_index = -1; // The body that is held static (see solar_system::relative_celestial_body_index)
+
+    std::vector<ludo::vec3> positions; // step_count * bodies.size() positions, one step after the other
+    std::vector<ludo::vec3> accelerations; // The accelerations of the bodies at the last step
+    uint32_t head = 0; // The step within positions that the window starts at
+    uint32_t length = 0; // The number of steps in the window
+    float start_time = 0.0f; // The time of the first step in the window
+
+    gravity_buffer gravity;
+  };
+
+  // Starts a new window, with the given bodies as its first step.
+  void init(trajectories& trajectories, const std::vector<trajectory_body>& bodies, int32_t relative_index, float start_time);
+
+  // Integrates the bodies (with leapfrog integration) to fill the window up to its step count.
+  void extend(trajectories& trajectories);
+
+  // Drops the steps that are more than a step behind the given time.
+  void advance(trajectories& trajectories, float time);
+
+  // Determines if the actual bodies have strayed from their predicted positions (relative to a central body) by more than the tolerance (relative to their distance from the central body).
+  bool diverged(const trajectories& trajectories, const std::vector<trajectory_body>& bodies, int32_t central_index, float time, float tolerance);
+
+  const ludo::vec3& position(const trajectories& trajectories, uint32_t step, uint32_t body_index);
+}
@@ -1,7 +1,6 @@
 #include <fstream>
 
-#include <ludo/opengl/textures.h>
-#include <ludo/opengl/util.h>
+#include <ludo/rendering.h>
 
 #include "../physics/point_masses.h"
 #include "../types.h"
@@ -50,8 +49,9 @@ namespace astrum
     auto atmospheric_density_data = new std::byte[map_data_size];
     atmospheric_density_stream.read(reinterpret_cast<char*>(atmospheric_density_data), map_data_size);
 
-    auto atmospheric_density_texture = ludo::add(inst, ludo::texture { .components = ludo::pixel_components::R, .datatype = ludo::pixel_datatype::FLOAT32, .width = map_size, .height = map_size });
-    ludo::init(*atmospheric_density_texture, { .clamp = true });
+    auto atmospheric_density_texture_init = ludo::texture { .components = ludo::pixel_components::R, .datatype = ludo::pixel_datatype::FLOAT32, .width = map_size, .height = map_size };
+    ludo::init(atmospheric_density_texture_init, { .clamp = true });
+    auto atmospheric_density_texture = ludo::add(inst, atmospheric_density_texture_init);
     ludo::write(*atmospheric_density_texture, atmospheric_density_data);
     ludo::write(stream, ludo::handle(*atmospheric_density_texture));
 
@@ -61,8 +61,9 @@ namespace astrum
     auto optical_depth_data = new std::byte[map_data_size];
     optical_depth_stream.read(reinterpret_cast<char*>(optical_depth_data), map_data_size);
 
-    auto optical_depth_texture = ludo::add(inst, ludo::texture { .components = ludo::pixel_components::R, .datatype = ludo::pixel_datatype::FLOAT32, .width = map_size, .height = map_size });
-    ludo::init(*optical_depth_texture, { .clamp = true });
+    auto optical_depth_texture_init = ludo::texture { .components = ludo::pixel_components::R, .datatype = ludo::pixel_datatype::FLOAT32, .width = map_size, .height = map_size };
+    ludo::init(optical_depth_texture_init, { .clamp = true });
+    auto optical_depth_texture = ludo::add(inst, optical_depth_texture_init);
     ludo::write(*optical_depth_texture, optical_depth_data);
     ludo::write(stream, ludo::handle(*optical_depth_texture));
 
@@ -77,23 +78,27 @@ namespace astrum
     ludo::write(stream, planet_radius);
     ludo::write(stream, atmosphere_radius);
 
-    ludo::add<ludo::script>(inst, [=](ludo::instance& inst)
+    ludo::add(inst, ludo::script
     {
-      auto rendering_context = ludo::first<ludo::rendering_context>(inst);
-      auto& render_programs = ludo::data<ludo::render_program>(inst);
-      auto render_program = ludo::first<ludo::render_program>(inst, "atmosphere");
+      .name = "ludo::commit_render_commands/atmosphere",
+      .function = [=](ludo::instance& inst)
+      {
+        auto rendering_context = ludo::first<ludo::rendering_context>(inst);
+        auto& render_programs = ludo::data<ludo::render_program>(inst);
+        auto render_program = ludo::first<ludo::render_program>(inst, "atmosphere");
 
-      auto& render_commands = ludo::data_heap(inst, "ludo::vram_render_commands");
-      auto& indices = ludo::data_heap(inst, "ludo::vram_indices");
-      auto& vertices = ludo::data_heap(inst, "ludo::vram_vertices");
+        auto& render_commands = ludo::data_heap(inst, "ludo::vram_render_commands");
+        auto& indices = ludo::data_heap(inst, "ludo::vram_indices");
+        auto& vertices = ludo::data_heap(inst, "ludo::vram_vertices");
 
-      auto& celestial_body_point_masses = ludo::data<point_mass>(inst, "celestial-bodies");
+        auto& celestial_body_point_masses = ludo::data<point_mass>(inst, "celestial-bodies");
 
-      ludo::cast<ludo::vec3>(render_program->shader_buffer.back, 5 * sizeof(uint64_t) + 8 /* align 16 */) = celestial_body_point_masses[celestial_body_index].transform.position;
+        ludo::cast<ludo::vec3>(render_program->shader_buffer.back, 5 * sizeof(uint64_t) + 8 /* align 16 */) = celestial_body_point_masses[celestial_body_index].transform.position;
 
-      ludo::use_and_clear(*frame_buffer);
-      ludo::add_render_command(*render_program, render_mesh);
-      ludo::commit_render_commands(*rendering_context, render_programs, render_commands, indices, vertices);
+        ludo::use_and_clear(*frame_buffer);
+        ludo::add_render_command(*render_program, render_mesh);
+        ludo::commit_render_commands(*rendering_context, render_programs, render_commands, indices, vertices);
+      }
     });
   }
 
@@ -1,5 +1,3 @@
-#include <ludo/opengl/util.h>
-
 #include "bloom.h"
 #include "util.h"
 
@@ -26,18 +24,22 @@ namespace astrum
 
     brightness_render_program->shader_buffer = create_post_processing_shader_buffer(previous_frame_buffer->color_texture_ids[0], 0);
 
-    ludo::add<ludo::script>(inst, [=](ludo::instance& inst)
+    ludo::add(inst, ludo::script
     {
-      auto rendering_context = ludo::first<ludo::rendering_context>(inst);
-      auto& render_programs = ludo::data<ludo::render_program>(inst);
+      .name = "ludo::commit_render_commands/bloom/brightness",
+      .function = [=](ludo::instance& inst)
+      {
+        auto rendering_context = ludo::first<ludo::rendering_context>(inst);
+        auto& render_programs = ludo::data<ludo::render_program>(inst);
 
-      auto& render_commands = ludo::data_heap(inst, "ludo::vram_render_commands");
-      auto& indices = ludo::data_heap(inst, "ludo::vram_indices");
-      auto& vertices = ludo::data_heap(inst, "ludo::vram_vertices");
+        auto& render_commands = ludo::data_heap(inst, "ludo::vram_render_commands");
+        auto& indices = ludo::data_heap(inst, "ludo::vram_indices");
+        auto& vertices = ludo::data_heap(inst, "ludo::vram_vertices");
 
-      ludo::use_and_clear(*current_frame_buffer);
-      ludo::add_render_command(*brightness_render_program, render_mesh);
-      ludo::commit_render_commands(*rendering_context, render_programs, render_commands, indices, vertices);
+        ludo::use_and_clear(*current_frame_buffer);
+        ludo::add_render_command(*brightness_render_program, render_mesh);
+        ludo::commit_render_commands(*rendering_context, render_programs, render_commands, indices, vertices);
+      }
     });
 
     for (auto iteration = 0; iteration < iterations; iteration++)
@@ -51,18 +53,22 @@ namespace astrum
       gaussian_render_program->shader_buffer = create_post_processing_shader_buffer(previous_frame_buffer->color_texture_ids[0], 0);
       ludo::cast<bool>(gaussian_render_program->shader_buffer.back, 8) = true;
 
-      ludo::add<ludo::script>(inst, [=](ludo::instance& inst)
+      ludo::add(inst, ludo::script
       {
-        auto rendering_context = ludo::first<ludo::rendering_context>(inst);
-        auto& render_programs = ludo::data<ludo::render_program>(inst);
-
-        auto& render_commands = ludo::data_heap(inst, "ludo::vram_render_commands");
-        auto& indices = ludo::data_heap(inst, "ludo::vram_indices");
-        auto& vertices = ludo::data_heap(inst, "ludo::vram_vertices");
-
-        ludo::use_and_clear(*current_frame_buffer);
-        ludo::add_render_command(*gaussian_render_program, render_mesh);
-        ludo::commit_render_commands(*rendering_context, render_programs, render_commands, indices, vertices);
+        .name = "ludo::commit_render_commands/bloom/horizontal" + std::to_string(iteration),
+        .function = [=](ludo::instance& inst)
+        {
+          auto rendering_context = ludo::first<ludo::rendering_context>(inst);
+          auto& render_programs = ludo::data<ludo::render_program>(inst);
+
+          auto& render_commands = ludo::data_heap(inst, "ludo::vram_render_commands");
+          auto& indices = ludo::data_heap(inst, "ludo::vram_indices");
+          auto& vertices = ludo::data_heap(inst, "ludo::vram_vertices");
+
+          ludo::use_and_clear(*current_frame_buffer);
+          ludo::add_render_command(*gaussian_render_program, render_mesh);
+          ludo::commit_render_commands(*rendering_context, render_programs, render_commands, indices, vertices);
+        }
       });
 
       previous_frame_buffer = current_frame_buffer;
@@ -72,18 +78,22 @@ namespace astrum
       gaussian_render_program->shader_buffer = create_post_processing_shader_buffer(previous_frame_buffer->color_texture_ids[0], 0);
       ludo::cast<bool>(gaussian_render_program->shader_buffer.back, 8) = false;
 
-      ludo::add<ludo::script>(inst, [=](ludo::instance& inst)
+      ludo::add(inst, ludo::script
       {
-        auto rendering_context = ludo::first<ludo::rendering_context>(inst);
-        auto& render_programs = ludo::data<ludo::render_program>(inst);
-
-        auto& render_commands = ludo::data_heap(inst, "ludo::vram_render_commands");
-        auto& indices = ludo::data_heap(inst, "ludo::vram_indices");
-        auto& vertices = ludo::data_heap(inst, "ludo::vram_vertices");
-
-        ludo::use_and_clear(*current_frame_buffer);
-        ludo::add_render_command(*gaussian_render_program, render_mesh);
-        ludo::commit_render_commands(*rendering_context, render_programs, render_commands, indices, vertices);
+        .name = "ludo::commit_render_commands/bloom/vertical" + std::to_string(iteration),
+        .function = [=](ludo::instance& inst)
+        {
+          auto rendering_context = ludo::first<ludo::rendering_context>(inst);
+          auto& render_programs = ludo::data<ludo::render_program>(inst);
+
+          auto& render_commands = ludo::data_heap(inst, "ludo::vram_render_commands");
+          auto& indices = ludo::data_heap(inst, "ludo::vram_indices");
+          auto& vertices = ludo::data_heap(inst, "ludo::vram_vertices");
+
+          ludo::use_and_clear(*current_frame_buffer);
+          ludo::add_render_command(*gaussian_render_program, render_mesh);
+          ludo::commit_render_commands(*rendering_context, render_programs, render_commands, indices, vertices);
+        }
       });
     }
 
@@ -92,18 +102,22 @@ namespace astrum
 
     additive_render_program->shader_buffer = create_post_processing_shader_buffer(original_frame_buffer->color_texture_ids[0], previous_frame_buffer->color_texture_ids[0]);
 
-    ludo::add<ludo::script>(inst, [=](ludo::instance& inst)
+    ludo::add(inst, ludo::script
     {
-      auto rendering_context = ludo::first<ludo::rendering_context>(inst);
-      auto& render_programs = ludo::data<ludo::render_program>(inst);
+      .name = "ludo::commit_render_commands/bloom/additive",
+      .function = [=](ludo::instance& inst)
+      {
+        auto rendering_context = ludo::first<ludo::rendering_context>(inst);
+        auto& render_programs = ludo::data<ludo::render_program>(inst);
 
-      auto& render_commands = ludo::data_heap(inst, "ludo::vram_render_commands");
-      auto& indices = ludo::data_heap(inst, "ludo::vram_indices");
-      auto& vertices = ludo::data_heap(inst, "ludo::vram_vertices");
+        auto& render_commands = ludo::data_heap(inst, "ludo::vram_render_commands");
+        auto& indices = ludo::data_heap(inst, "ludo::vram_indices");
+        auto& vertices = ludo::data_heap(inst, "ludo::vram_vertices");
 
-      ludo::use_and_clear(*current_frame_buffer);
-      ludo::add_render_command(*additive_render_program, render_mesh);
-      ludo::commit_render_commands(*rendering_context, render_programs, render_commands, indices, vertices);
+        ludo::use_and_clear(*current_frame_buffer);
+        ludo::add_render_command(*additive_render_program, render_mesh);
+        ludo::commit_render_commands(*rendering_context, render_programs, render_commands, indices, vertices);
+      }
     });
   }
 }
@@ -12,19 +12,27 @@ namespace astrum
 
     if (target_screen)
     {
-      ludo::add<ludo::script>(inst, [previous_frame_buffer](ludo::instance& inst)
+      ludo::add(inst, ludo::script
       {
-        auto& window = *ludo::first<ludo::window>(inst);
-        ludo::blit(previous_frame_buffer, ludo::frame_buffer { .width = window.width, .height = window.height });
+        .name = "ludo::blit",
+        .function = [previous_frame_buffer](ludo::instance& inst)
+        {
+          auto& window = *ludo::first<ludo::window>(inst);
+          ludo::blit(previous_frame_buffer, ludo::frame_buffer { .width = window.width, .height = window.height });
+        }
       });
     }
     else
     {
       auto frame_buffer = *add_post_processing_frame_buffer(inst, true);
 
-      ludo::add<ludo::script>(inst, [previous_frame_buffer, frame_buffer](ludo::instance& inst)
+      ludo::add(inst, ludo::script
       {
-        ludo::blit(previous_frame_buffer, frame_buffer);
+        .name = "ludo::blit",
+        .function = [previous_frame_buffer, frame_buffer](ludo::instance& inst)
+        {
+          ludo::blit(previous_frame_buffer, frame_buffer);
+        }
       });
     }
   }
@@ -1,5 +1,3 @@
-#include <ludo/opengl/util.h>
-
 #include "tone_mapping.h"
 #include "util.h"
 
@@ -18,18 +16,22 @@ namespace astrum
 
     auto frame_buffer = add_post_processing_frame_buffer(inst);
 
-    ludo::add<ludo::script>(inst, [=](ludo::instance& inst)
+    ludo::add(inst, ludo::script
     {
-      auto rendering_context = ludo::first<ludo::rendering_context>(inst);
-      auto& render_programs = ludo::data<ludo::render_program>(inst);
-
-      auto& render_commands = ludo::data_heap(inst, "ludo::vram_render_commands");
-      auto& indices = ludo::data_heap(inst, "ludo::vram_indices");
-      auto& vertices = ludo::data_heap(inst, "ludo::vram_vertices");
-
-      ludo::use_and_clear(*frame_buffer);
-      ludo::add_render_command(*render_program, render_mesh);
-      ludo::commit_render_commands(*rendering_context, render_programs, render_commands, indices, vertices);
+      .name = "ludo::commit_render_commands/tone_mapping",
+      .function = [=](ludo::instance& inst)
+      {
+        auto rendering_context = ludo::first<ludo::rendering_context>(inst);
+        auto& render_programs = ludo::data<ludo::render_program>(inst);
+
+        auto& render_commands = ludo::data_heap(inst, "ludo::vram_render_commands");
+        auto& indices = ludo::data_heap(inst, "ludo::vram_indices");
+        auto& vertices = ludo::data_heap(inst, "ludo::vram_vertices");
+
+        ludo::use_and_clear(*frame_buffer);
+        ludo::add_render_command(*render_program, render_mesh);
+        ludo::commit_render_commands(*rendering_context, render_programs, render_commands, indices, vertices);
+      }
     });
   }
 }
@@ -1,6 +1,6 @@
 #include <fstream>
 
-#include <ludo/opengl/textures.h>
+#include <ludo/rendering.h>
 
 #include "util.h"
 
@@ -12,12 +12,14 @@ namespace astrum
     auto& vertices = ludo::data_heap(inst, "ludo::vram_vertices");
 
     auto mesh_counts = ludo::rectangle_counts(ludo::vertex_format_pt);
-    auto mesh = ludo::add(inst, ludo::mesh());
-    ludo::init(*mesh, indices, vertices, mesh_counts.first, mesh_counts.second, ludo::vertex_format_pt.size);
+    auto rectangle_mesh = ludo::mesh();
+    ludo::init(rectangle_mesh, indices, vertices, mesh_counts.first, mesh_counts.second, ludo::vertex_format_pt.size);
+    auto mesh = ludo::add(inst, rectangle_mesh);
     ludo::rectangle(*mesh, ludo::vertex_format_pt, 0, 0, { .dimensions = { 2.0f,  2.0f, 0.0f } });
 
-    auto render_mesh = ludo::add(inst, ludo::render_mesh());
-    ludo::init(*render_mesh);
+    auto rectangle_render_mesh = ludo::render_mesh();
+    ludo::init(rectangle_render_mesh);
+    auto render_mesh = ludo::add(inst, rectangle_render_mesh);
     ludo::connect(*render_mesh, *mesh, indices, vertices);
 
     return render_mesh;
@@ -29,14 +31,16 @@ namespace astrum
     auto width = static_cast<uint32_t>(static_cast<float>(window.width) * texture_size);
     auto height = static_cast<uint32_t>(static_cast<float>(window.height) * texture_size);
 
-    auto color_texture = ludo::add(inst, ludo::texture { .datatype = ludo::pixel_datatype::FLOAT16, .width = width, .height = height });
-    ludo::init(*color_texture, { .clamp = true });
+    auto color_texture_init = ludo::texture { .datatype = ludo::pixel_datatype::FLOAT16, .width = width, .height = height };
+    ludo::init(color_texture_init, { .clamp = true });
+    auto color_texture = ludo::add(inst, color_texture_init);
 
     auto depth_texture_id = uint32_t(0);
     if (has_depth)
     {
-      auto depth_texture = ludo::add(inst, ludo::texture { .components = ludo::pixel_components::DEPTH, .datatype = ludo::pixel_datatype::FLOAT32, .width = width, .height = height });
-      ludo::init(*depth_texture, { .clamp = true });
+      auto depth_texture_init = ludo::texture { .components = ludo::pixel_components::DEPTH, .datatype = ludo::pixel_datatype::FLOAT32, .width = width, .height = height };
+      ludo::init(depth_texture_init, { .clamp = true });
+      auto depth_texture = ludo::add(inst, depth_texture_init);
       depth_texture_id = depth_texture->id;
     }
 
@@ -1,3 +1,4 @@
+#include <cassert>
 #include <future>
 
 #include <ludo/api.h>
@@ -36,20 +37,16 @@ namespace astrum
         auto tree_import = ludo::import(ludo::asset_folder + "/models/" + tree_types[tree_type_index] + "-tree.dae", indices, vertices, { .merge_meshes = true });
         tree_lod_meshes[tree_type_index] = build_lod_meshes(tree_import.meshes[0], ludo::vertex_format_pnc, indices, vertices, tree_collapse_iterations);
         std::reverse(tree_lod_meshes[tree_type_index].begin(), tree_lod_meshes[tree_type_index].end());
-        for (auto lod_index = uint32_t(0); lod_index < tree_collapse_iterations.size(); lod_index++)
-        {
-          ludo::save(tree_lod_meshes[tree_type_index][lod_index], ludo::asset_folder + "/meshes/" + tree_types[tree_type_index] + "-tree-" + std::to_string(lod_index) + ".lmesh");
-        }
+        ludo::save(tree_lod_meshes[tree_type_index], lod_vertex_format(ludo::vertex_format_pnc), ludo::asset_folder + "/meshes/" + tree_types[tree_type_index] + "-tree.lmesh");
       }
     }
     else
     {
+      // Each tree file holds one section per LOD.
       for (auto tree_type_index = uint32_t(0); tree_type_index < tree_types.size(); tree_type_index++)
       {
-        for (auto lod_index = uint32_t(0); lod_index < tree_collapse_iterations.size(); lod_index++)
-        {
-          tree_lod_meshes[tree_type_index].emplace_back(ludo::load(ludo::asset_folder + "/meshes/" + tree_types[tree_type_index] + "-tree-" + std::to_string(lod_index) + ".lmesh", indices, vertices));
-        }
+        tree_lod_meshes[tree_type_index] = ludo::load_sections(ludo::asset_folder + "/meshes/" + tree_types[tree_type_index] + "-tree.lmesh", indices, vertices);
+        assert(tree_lod_meshes[tree_type_index].size() == tree_collapse_iterations.size() && "tree mesh file has the wrong number of LODs");
       }
     }
 
@@ -62,8 +59,7 @@ namespace astrum
     }
 
     auto minifig = ludo::import(ludo::asset_folder + "/models/minifig.dae", indices, vertices);
-    ludo::add(inst, minifig.animations[0], "people");
-    ludo::add(inst, minifig.armatures[0], "people");
+    ludo::add(inst, ludo::compile(minifig.animations[0], minifig.armatures[0]), "people");
     ludo::add(inst, minifig.dynamic_body_shapes[0], "people");
     ludo::add(inst, minifig.meshes[0], "people");
     ludo::add(inst, minifig.textures[0], "people");
@@ -129,33 +125,120 @@ namespace astrum
       );
     }
 
-    ludo::add<ludo::script>(inst, center_universe);
-    ludo::add<ludo::script>(inst, relativize_universe);
+    ludo::add(inst, ludo::script { .name = "astrum::center_universe", .function = center_universe });
+    ludo::add(inst, ludo::script { .name = "astrum::relativize_universe", .function = relativize_universe });
 
-    ludo::add<ludo::script>(inst, simulate_gravity);
-    ludo::add<ludo::script>(inst, [](ludo::instance& inst)
+    ludo::add(inst, ludo::script
     {
-      auto physics_context = ludo::first<ludo::physics_context>(inst);
+      .name = "astrum::simulate_gravity",
+      .function = simulate_gravity,
+      .reads = ludo::type_indices<solar_system>(),
+      .writes = ludo::type_indices<ludo::dynamic_body, ludo::physics_context, point_mass>()
+    });
+    ludo::add(inst, ludo::script
+    {
+      .name = "ludo::simulate_physics",
+      .function = [](ludo::instance& inst)
+      {
+        auto physics_context = ludo::first<ludo::physics_context>(inst);
 
-      ludo::simulate(*physics_context, inst.delta_time);
+        ludo::simulate(*physics_context, inst.delta_time);
+      }
+    });
+    ludo::add(inst, ludo::script
+    {
+      .name = "astrum::simulate_point_mass_physics",
+      .function = [](ludo::instance& inst) { simulate_point_mass_physics(inst, { "people", "spaceships" }); }
     });
-    ludo::add<ludo::script, std::vector<std::string>>(inst, simulate_point_mass_physics, { "people", "spaceships" });
 
-    ludo::add<ludo::script>(inst, stream_terrain);
-    ludo::add<ludo::script, uint32_t>(inst, stream_trees, 1);
+    // Adding/removing meshes, render meshes and static bodies shifts their partitions, so those are declared as writes of the whole type.
+    // Streaming the terrain and trees only reads the celestial body point masses, so it overlaps simulating the people and spaceships.
+    ludo::add(inst, ludo::script
+    {
+      .name = "astrum::stream_terrain_static_bodies",
+      .function = stream_terrain_static_bodies,
+      .reads = ludo::type_indices<point_mass>(),
+      .writes = ludo::type_indices<ludo::heap, ludo::mesh, ludo::physics_context, ludo::static_body>(),
+      .partition_reads = ludo::partition_accesses<celestial_body>("celestial-bodies"),
+      .partition_writes = ludo::partition_accesses<terrain>("celestial-bodies")
+    });
+    ludo::add(inst, ludo::script
+    {
+      .name = "astrum::stream_terrain",
+      .function = stream_terrain,
+      .reads = ludo::type_indices<ludo::rendering_context>(),
+      .writes = ludo::type_indices<ludo::heap>(),
+      .partition_reads = ludo::partition_accesses<celestial_body, point_mass>("celestial-bodies"),
+      .partition_writes =
+      {
+        { ludo::type_index<ludo::grid3>(), "terrain" },
+        { ludo::type_index<ludo::mesh>(), "terrain" },
+        { ludo::type_index<ludo::render_mesh>(), "terrain" },
+        { ludo::type_index<ludo::render_program>(), "terrain" },
+        { ludo::type_index<terrain>(), "celestial-bodies" }
+      }
+    });
+    ludo::add(inst, ludo::script
+    {
+      .name = "astrum::stream_trees",
+      .function = [](ludo::instance& inst) { stream_trees(inst, 1); },
+      .reads = ludo::type_indices<ludo::mesh, ludo::rendering_context>(),
+      .writes = ludo::type_indices<ludo::heap, ludo::render_mesh>(),
+      .partition_reads = ludo::partition_accesses<celestial_body, point_mass>("celestial-bodies"),
+      .partition_writes =
+      {
+        { ludo::type_index<ludo::grid3>(), "trees" },
+        { ludo::type_index<ludo::render_program>(), "trees" },
+        { ludo::type_index<terrain>(), "celestial-bodies" }
+      }
+    });
 
-    ludo::add<ludo::script>(inst, sync_light_with_sol);
+    ludo::add(inst, ludo::script
+    {
+      .name = "astrum::sync_light_with_sol",
+      .function = sync_light_with_sol,
+      .writes = ludo::type_indices<ludo::rendering_context>(),
+      .partition_reads = ludo::partition_accesses<point_mass>("celestial-bodies")
+    });
 
-    ludo::add<ludo::script>(inst, simulate_people);
-    ludo::add<ludo::script>(inst, simulate_spaceships);
+    ludo::add(inst, ludo::script
+    {
+      .name = "astrum::simulate_people",
+      .function = simulate_people,
+      .reads = ludo::type_indices<solar_system>(),
+      .partition_reads =
+      {
+        { ludo::type_index<person_controls>(), "people" },
+        { ludo::type_index<point_mass>(), "celestial-bodies" }
+      },
+      .partition_writes = ludo::partition_accesses<person, point_mass>("people")
+    });
+    ludo::add(inst, ludo::script
+    {
+      .name = "astrum::animate_people",
+      .function = animate_people,
+      .partition_reads = ludo::partition_accesses<ludo::animation_clip, person>("people"),
+      .partition_writes = ludo::partition_accesses<ludo::render_mesh>("people")
+    });
+    ludo::add(inst, ludo::script
+    {
+      .name = "astrum::simulate_spaceships",
+      .function = simulate_spaceships,
+      .partition_reads = ludo::partition_accesses<spaceship_controls>("spaceships"),
+      .partition_writes = ludo::partition_accesses<ludo::ghost_body, point_mass>("spaceships") // Committing a ghost body only moves the body, it doesn't touch the physics context.
+    });
 
-    ludo::add<ludo::script>(inst, control_game);
+    ludo::add(inst, ludo::script { .name = "astrum::control_game", .function = control_game });
 
-    ludo::add<ludo::script, std::vector<std::string>>(inst, sync_render_meshes_with_point_masses, { "people", "spaceships" });
+    ludo::add(inst, ludo::script
+    {
+      .name = "astrum::sync_render_meshes_with_point_masses",
+      .function = [](ludo::instance& inst) { sync_render_meshes_with_point_masses(inst, { "people", "spaceships" }); }
+    });
 
     if (show_paths)
     {
-      ludo::add<ludo::script>(inst, update_prediction_paths);
+      ludo::add(inst, ludo::script { .name = "astrum::update_prediction_paths", .function = update_prediction_paths });
     }
   }
 }
@@ -7,8 +7,6 @@
 
 namespace astrum
 {
-  uint32_t find_cell(const icotree& icotree, const std::function<int32_t(const std::array<ludo::vec3, 3>& face)>& test, uint32_t divisions, const std::array<ludo::vec3, 3>& face, uint32_t cumulative_index);
-  void find_cells(const icotree& icotree, const std::function<int32_t(const std::array<ludo::vec3, 3>& face)>& test, uint32_t divisions, const std::array<ludo::vec3, 3>& face, uint32_t cumulative_index, std::vector<uint32_t>& results);
   uint32_t cell_element_index(const icotree& icotree, uint32_t cell_index, const ludo::vec3& element);
   uint64_t cell_offset(const icotree& icotree, uint32_t cell_index);
   std::array<std::array<ludo::vec3, 3>, 4> divided_faces(const std::array<ludo::vec3, 3>& face);
@@ -84,78 +82,56 @@ namespace astrum
 
   uint32_t find_cell(const icotree& icotree, const std::function<int32_t(const std::array<ludo::vec3, 3>& face)>& test)
   {
-    auto& ico_faces = get_ico_faces();
-
-    for (auto face_index = uint32_t(0); face_index < ico_faces.size(); face_index++)
+    struct node
     {
-      auto cell_index = find_cell(icotree, test, icotree.divisions, ico_faces[face_index], face_index);
-      if (cell_index != std::numeric_limits<uint32_t>::max())
-      {
-        return cell_index;
-      }
-    }
+      std::array<ludo::vec3, 3> face;
+      uint32_t cumulative_index;
+      uint32_t divisions;
+    };
 
-    return std::numeric_limits<uint32_t>::max();
-  }
+    // Faces are pushed in reverse so that they are tested in order. The 20 ico faces are followed by at most 3 siblings per layer.
+    assert(icotree.divisions <= 16 && "too many divisions");
+    auto stack = std::array<node, 20 + 3 * 16>();
+    auto stack_size = uint32_t(0);
 
-  std::vector<uint32_t> find_cells(const icotree& icotree, const std::function<int32_t(const std::array<ludo::vec3, 3>& face)>& test)
-  {
-    auto results = std::vector<uint32_t>();
     auto& ico_faces = get_ico_faces();
-
-    for (auto face_index = uint32_t(0); face_index < ico_faces.size(); face_index++)
+    for (auto face_index = static_cast<int32_t>(ico_faces.size()) - 1; face_index >= 0; face_index--)
     {
-      find_cells(icotree, test, icotree.divisions, ico_faces[face_index], face_index, results);
+      stack[stack_size++] = { .face = ico_faces[face_index], .cumulative_index = static_cast<uint32_t>(face_index), .divisions = icotree.divisions };
     }
 
-    return results;
-  }
-
-  uint32_t find_cell(const icotree& icotree, const std::function<int32_t(const std::array<ludo::vec3, 3>& face)>& test, uint32_t divisions, const std::array<ludo::vec3, 3>& face, uint32_t cumulative_index)
-  {
-    auto test_result = test(face);
-    if (test_result == -1)
+    while (stack_size)
     {
-      return std::numeric_limits<uint32_t>::max();
-    }
+      auto current = stack[--stack_size];
+      if (test(current.face) == -1)
+      {
+        continue;
+      }
 
-    if (divisions == 0)
-    {
-      return cumulative_index;
-    }
+      if (current.divisions == 0)
+      {
+        return current.cumulative_index;
+      }
 
-    auto divided_faces = astrum::divided_faces(face);
-    for (auto face_index = uint32_t(0); face_index < divided_faces.size(); face_index++)
-    {
-      auto cell_index = find_cell(icotree, test, divisions - 1, divided_faces[face_index], cumulative_index * 4 + face_index);
-      if (cell_index != std::numeric_limits<uint32_t>::max())
+      auto divided_faces = astrum::divided_faces(current.face);
+      for (auto face_index = static_cast<int32_t>(divided_faces.size()) - 1; face_index >= 0; face_index--)
       {
-        return cell_index;
+        stack[stack_size++] = { .face = divided_faces[face_index], .cumulative_index = current.cumulative_index * 4 + face_index, .divisions = current.divisions - 1 };
       }
     }
 
     return std::numeric_limits<uint32_t>::max();
   }
 
-  void find_cells(const icotree& icotree, const std::function<int32_t(const std::array<ludo::vec3, 3>& face)>& test, uint32_t divisions, const std::array<ludo::vec3, 3>& face, uint32_t cumulative_index, std::vector<uint32_t>& results)
+  std::vector<uint32_t> find_cells(const icotree& icotree, const std::function<int32_t(const std::array<ludo::vec3, 3>& face)>& test)
   {
-    auto test_result = test(face);
-    if (test_result == -1)
-    {
-      return;
-    }
-
-    if (divisions == 0)
+    auto results = std::vector<uint32_t>();
+    find_each_cell(icotree, test, [&](uint32_t cell_index)
     {
-      results.push_back(cumulative_index);
-      return;
-    }
+      results.push_back(cell_index);
+    });
 
-    auto divided_faces = astrum::divided_faces(face);
-    for (auto face_index = uint32_t(0); face_index < divided_faces.size(); face_index++)
-    {
-      find_cells(icotree, test, divisions - 1, divided_faces[face_index], cumulative_index * 4 + face_index, results);
-    }
+    return results;
   }
 
   uint32_t cell_count(const icotree& icotree)
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <span>
+
 #include <ludo/api.h>
 
 namespace astrum
@@ -53,7 +55,27 @@ namespace astrum
   /// \return The matching cell indices.
   std::vector<uint32_t> find_cells(const icotree& icotree, const std::function<int32_t(const std::array<ludo::vec3, 3>& face)>& test);
 
+  ///
+  /// Finds cells within an icotree without allocating (or recursing).
+  /// Faces the test reports as wholly inside have all of their cells visited without dividing them.
+  /// \param icotree The icotree to search.
+  /// \param test The test to perform against the faces, of the form int32_t(const std::array<ludo::vec3, 3>& face). Returns -1 if outside, 0 if intersecting and 1 if inside.
+  /// \param visit The function to call with each matching cell index, of the form void(uint32_t cell_index).
+  template<typename T, typename V>
+  void find_each_cell(const icotree& icotree, T&& test, V&& visit);
+
+  ///
+  /// Finds cells within an icotree without allocating (or recursing).
+  /// \param icotree The icotree to search.
+  /// \param test The test to perform against the faces, of the form int32_t(const std::array<ludo::vec3, 3>& face). Returns -1 if outside, 0 if intersecting and 1 if inside.
+  /// \param results The matching cell indices. Only the first results.size() indices are written.
+  /// \return The number of matching cells (which can be greater than results.size()).
+  template<typename T>
+  uint32_t find_cells(const icotree& icotree, T&& test, std::span<uint32_t> results);
+
   uint32_t cell_count(const icotree& icotree);
 
   ludo::buffer cell_element_data(const icotree& icotree, uint32_t cell_index);
 }
+
+#include "icotree.hpp"
@@ -0,0 +1,81 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <cassert>
+
+#include "../meshes/ico_faces.h"
+#include "icotree.h"
+
+namespace astrum
+{
+  std::array<std::array<ludo::vec3, 3>, 4> divided_faces(const std::array<ludo::vec3, 3>& face);
+
+  template<typename T, typename V>
+  void find_each_cell(const icotree& icotree, T&& test, V&& visit)
+  {
+    struct node
+    {
+      std::array<ludo::vec3, 3> face;
+      uint32_t cumulative_index;
+      uint32_t divisions;
+    };
+
+    // Faces are pushed in reverse so that they are visited in order. The 20 ico faces are followed by at most 3 siblings per layer.
+    assert(icotree.divisions <= 16 && "too many divisions");
+    auto stack = std::array<node, 20 + 3 * 16>();
+    auto stack_size = uint32_t(0);
+
+    auto& ico_faces = get_ico_faces();
+    for (auto face_index = static_cast<int32_t>(ico_faces.size()) - 1; face_index >= 0; face_index--)
+    {
+      stack[stack_size++] = { .face = ico_faces[face_index], .cumulative_index = static_cast<uint32_t>(face_index), .divisions = icotree.divisions };
+    }
+
+    while (stack_size)
+    {
+      auto current = stack[--stack_size];
+
+      auto test_result = test(current.face);
+      if (test_result == -1)
+      {
+        continue;
+      }
+
+      if (current.divisions == 0 || test_result == 1)
+      {
+        // The cells of a face are contiguous, so every cell within a face that is wholly inside can be visited without dividing it.
+        auto cell_count = uint32_t(1) << (2 * current.divisions);
+        for (auto cell_index = current.cumulative_index * cell_count; cell_index < (current.cumulative_index + 1) * cell_count; cell_index++)
+        {
+          visit(cell_index);
+        }
+
+        continue;
+      }
+
+      auto divided_faces = astrum::divided_faces(current.face);
+      for (auto face_index = static_cast<int32_t>(divided_faces.size()) - 1; face_index >= 0; face_index--)
+      {
+        stack[stack_size++] = { .face = divided_faces[face_index], .cumulative_index = current.cumulative_index * 4 + face_index, .divisions = current.divisions - 1 };
+      }
+    }
+  }
+
+  template<typename T>
+  uint32_t find_cells(const icotree& icotree, T&& test, std::span<uint32_t> results)
+  {
+    auto count = uint32_t(0);
+    find_each_cell(icotree, test, [&](uint32_t cell_index)
+    {
+      if (count < results.size())
+      {
+        results[count] = cell_index;
+      }
+
+      count++;
+    });
+
+    return count;
+  }
+}
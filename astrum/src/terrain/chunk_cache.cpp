@@ -0,0 +1,304 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+
+#include "chunk_cache.h"
+#include "terrain_chunk.h"
+
+namespace astrum
+{
+  // Identifies what the baked meshes were built for, the cache is discarded when it doesn't match.
+  struct terrain_chunk_cache_header
+  {
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint32_t vertex_size = 0;
+    uint32_t chunk_count = 0;
+    uint32_t lod_signature = 0;
+  };
+
+  const auto terrain_chunk_cache_magic = uint32_t(0x4b484354); // "TCHK"
+  const auto terrain_chunk_cache_version = uint32_t(2);
+
+  static_assert(sizeof(terrain_chunk_cache_header) == 20);
+  static_assert(sizeof(terrain_chunk_cache_entry) == 24);
+
+  terrain_chunk_cache_header build_terrain_chunk_cache_header(const terrain& terrain);
+  uint64_t terrain_chunk_cache_key(uint32_t chunk_index, uint32_t lod_index);
+  std::shared_ptr<const std::vector<std::byte>> find_terrain_chunk(terrain_chunk_cache& cache, uint64_t key);
+  std::shared_ptr<const std::vector<std::byte>> read_terrain_chunk(terrain_chunk_cache& cache, const terrain_chunk_cache_entry& entry);
+  void retain_terrain_chunk(terrain_chunk_cache& cache, uint64_t key, const std::shared_ptr<const std::vector<std::byte>>& data);
+  void write_terrain_chunk(terrain_chunk_cache& cache, const terrain_chunk_cache_entry& entry, const std::vector<std::byte>& data);
+
+  void open_terrain_chunk_cache(terrain_chunk_cache& cache, const std::string& file_name, const terrain& terrain, uint64_t ram_capacity)
+  {
+    close_terrain_chunk_cache(cache);
+
+    cache.file_name = file_name;
+    cache.ram_capacity = ram_capacity;
+
+    // Without a file, chunks are only cached in RAM.
+    if (file_name.empty())
+    {
+      return;
+    }
+
+    auto header = build_terrain_chunk_cache_header(terrain);
+    auto existing_header = terrain_chunk_cache_header();
+
+    auto index_stream = std::ifstream(file_name + ".index", std::ios::binary);
+    if (index_stream.is_open() &&
+        index_stream.read(reinterpret_cast<char*>(&existing_header), sizeof(terrain_chunk_cache_header)) &&
+        std::memcmp(&existing_header, &header, sizeof(terrain_chunk_cache_header)) == 0 &&
+        std::filesystem::exists(file_name))
+    {
+      // Later entries of the same chunk and LOD supersede earlier ones.
+      auto entry = terrain_chunk_cache_entry();
+      while (index_stream.read(reinterpret_cast<char*>(&entry), sizeof(terrain_chunk_cache_entry)))
+      {
+        cache.entries[terrain_chunk_cache_key(entry.chunk_index, entry.lod_index)] = entry;
+      }
+
+      // Drop anything a previous run didn't finish writing.
+      cache.data_size = std::filesystem::file_size(file_name);
+      std::erase_if(cache.entries, [&cache](const auto& pair)
+      {
+        return pair.second.offset + pair.second.size > cache.data_size;
+      });
+
+      cache.mapping = ludo::map_file(file_name);
+
+      return;
+    }
+
+    index_stream.close();
+
+    auto data_stream = std::ofstream(file_name, std::ios::binary | std::ios::trunc);
+    auto new_index_stream = std::ofstream(file_name + ".index", std::ios::binary | std::ios::trunc);
+    new_index_stream.write(reinterpret_cast<const char*>(&header), sizeof(terrain_chunk_cache_header));
+  }
+
+  void close_terrain_chunk_cache(terrain_chunk_cache& cache)
+  {
+    if (cache.mapping.data)
+    {
+      ludo::unmap_file(cache.mapping);
+    }
+
+    cache.data_size = 0;
+    cache.entries.clear();
+
+    cache.ram_order.clear();
+    cache.ram_entries.clear();
+    cache.ram_size = 0;
+  }
+
+  void load_terrain_chunk(terrain_chunk_cache& cache, const terrain& terrain, float radius, uint32_t chunk_index, uint32_t lod_index, ludo::mesh& mesh)
+  {
+    auto key = terrain_chunk_cache_key(chunk_index, lod_index);
+    auto size = mesh.vertex_buffer.size;
+
+    auto data = std::shared_ptr<const std::vector<std::byte>>();
+    auto entry = std::optional<terrain_chunk_cache_entry>();
+    {
+      auto lock = std::lock_guard(cache.mutex);
+
+      data = find_terrain_chunk(cache, key);
+      if (!data)
+      {
+        auto entry_iter = cache.entries.find(key);
+        if (entry_iter != cache.entries.end() && entry_iter->second.size == size)
+        {
+          entry = entry_iter->second;
+        }
+      }
+    }
+
+    // Entries are only ever appended, so they can be read without holding the lock.
+    if (entry)
+    {
+      data = read_terrain_chunk(cache, *entry);
+
+      auto lock = std::lock_guard(cache.mutex);
+      retain_terrain_chunk(cache, key, data);
+    }
+
+    if (data && data->size() == size)
+    {
+      std::memcpy(mesh.vertex_buffer.data, data->data(), size);
+
+      return;
+    }
+
+    // Generate into RAM rather than straight into the mesh, so that the cache never has to read back from (possibly write-combined) VRAM.
+    auto new_data = std::make_shared<std::vector<std::byte>>(size);
+    auto ram_mesh = mesh;
+    ram_mesh.vertex_buffer.data = new_data->data();
+
+    load_terrain_chunk(terrain, radius, chunk_index, lod_index, ram_mesh);
+
+    std::memcpy(mesh.vertex_buffer.data, new_data->data(), size);
+
+    {
+      auto lock = std::lock_guard(cache.mutex);
+      retain_terrain_chunk(cache, key, new_data);
+    }
+
+    // RAM-only caches have nowhere to write the chunk to.
+    if (cache.file_name.empty())
+    {
+      return;
+    }
+
+    auto new_entry = terrain_chunk_cache_entry
+    {
+      .chunk_index = chunk_index,
+      .lod_index = lod_index,
+      .size = size
+    };
+
+    ludo::thread_pool_enqueue([&cache, new_entry, new_data]()
+    {
+      write_terrain_chunk(cache, new_entry, *new_data);
+    }, {}, {}, ludo::job_priority::low);
+  }
+
+  terrain_chunk_cache_header build_terrain_chunk_cache_header(const terrain& terrain)
+  {
+    auto lod_signature = uint32_t(terrain.lods.size());
+    for (auto& lod : terrain.lods)
+    {
+      lod_signature = lod_signature * 31 + lod.level;
+    }
+
+    return
+    {
+      .magic = terrain_chunk_cache_magic,
+      .version = terrain_chunk_cache_version,
+      .vertex_size = terrain.format.size,
+      .chunk_count = static_cast<uint32_t>(terrain.chunks.size()),
+      .lod_signature = lod_signature
+    };
+  }
+
+  uint64_t terrain_chunk_cache_key(uint32_t chunk_index, uint32_t lod_index)
+  {
+    return uint64_t(chunk_index) << 32 | lod_index;
+  }
+
+  std::shared_ptr<const std::vector<std::byte>> find_terrain_chunk(terrain_chunk_cache& cache, uint64_t key)
+  {
+    auto iter = cache.ram_entries.find(key);
+    if (iter == cache.ram_entries.end())
+    {
+      return {};
+    }
+
+    cache.ram_order.splice(cache.ram_order.begin(), cache.ram_order, iter->second.second);
+
+    return iter->second.first;
+  }
+
+  std::shared_ptr<const std::vector<std::byte>> read_terrain_chunk(terrain_chunk_cache& cache, const terrain_chunk_cache_entry& entry)
+  {
+    auto data = std::make_shared<std::vector<std::byte>>(entry.size);
+
+    if (entry.offset + entry.size <= cache.mapping.size)
+    {
+      std::memcpy(data->data(), cache.mapping.data + entry.offset, entry.size);
+    }
+    else
+    {
+      auto stream = std::ifstream(cache.file_name, std::ios::binary);
+      stream.seekg(static_cast<std::streamoff>(entry.offset));
+      stream.read(reinterpret_cast<char*>(data->data()), static_cast<std::streamsize>(entry.size));
+    }
+
+    return data;
+  }
+
+  void retain_terrain_chunk(terrain_chunk_cache& cache, uint64_t key, const std::shared_ptr<const std::vector<std::byte>>& data)
+  {
+    if (cache.ram_entries.contains(key))
+    {
+      return;
+    }
+
+    cache.ram_order.push_front(key);
+    cache.ram_entries[key] = { data, cache.ram_order.begin() };
+    cache.ram_size += data->size();
+
+    // Always keep the newest entry, even if it alone exceeds the capacity.
+    while (cache.ram_size > cache.ram_capacity && cache.ram_order.size() > 1)
+    {
+      auto oldest = cache.ram_entries.find(cache.ram_order.back());
+      cache.ram_size -= oldest->second.first->size();
+      cache.ram_entries.erase(oldest);
+      cache.ram_order.pop_back();
+    }
+  }
+
+  void write_terrain_chunk(terrain_chunk_cache& cache, const terrain_chunk_cache_entry& entry, const std::vector<std::byte>& data)
+  {
+    auto zone = ludo::profile_zone("astrum::write_terrain_chunk");
+
+    // Only one write is in flight at a time, the entries are locked just to check and publish it.
+    auto file_lock = std::lock_guard(cache.file_mutex);
+
+    // Another thread may have baked the same chunk in the meantime.
+    auto key = terrain_chunk_cache_key(entry.chunk_index, entry.lod_index);
+    {
+      auto lock = std::lock_guard(cache.mutex);
+      if (cache.entries.contains(key))
+      {
+        return;
+      }
+    }
+
+    // The offset is taken from the end of the data file rather than from data_size, since a failed write may have left part of its data behind.
+    auto data_stream = std::ofstream(cache.file_name, std::ios::binary | std::ios::app | std::ios::ate);
+    auto offset = static_cast<std::streamoff>(data_stream.tellp());
+    if (!data_stream || offset < 0)
+    {
+      return;
+    }
+
+    auto written_entry = entry;
+    written_entry.offset = static_cast<uint64_t>(offset);
+
+    // The data is written before its entry, so that an interrupted write never leaves an entry pointing past the end of the data file.
+    data_stream.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    data_stream.close();
+    if (!data_stream)
+    {
+      return;
+    }
+
+    // Likewise, cut off any partially written entry so that the entries appended after it stay aligned.
+    auto index_file_name = cache.file_name + ".index";
+    auto error = std::error_code();
+    auto index_size = std::filesystem::file_size(index_file_name, error);
+    if (error || index_size < sizeof(terrain_chunk_cache_header))
+    {
+      return;
+    }
+
+    auto entries_size = index_size - sizeof(terrain_chunk_cache_header);
+    if (entries_size % sizeof(terrain_chunk_cache_entry) != 0)
+    {
+      std::filesystem::resize_file(index_file_name, index_size - entries_size % sizeof(terrain_chunk_cache_entry), error);
+      if (error)
+      {
+        return;
+      }
+    }
+
+    auto index_stream = std::ofstream(index_file_name, std::ios::binary | std::ios::app);
+    index_stream.write(reinterpret_cast<const char*>(&written_entry), sizeof(terrain_chunk_cache_entry));
+
+    auto lock = std::lock_guard(cache.mutex);
+    cache.data_size = written_entry.offset + data.size();
+    cache.entries[key] = written_entry;
+  }
+}
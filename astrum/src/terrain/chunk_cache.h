@@ -0,0 +1,52 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>
+
+#include <ludo/api.h>
+
+#include "../types.h"
+
+namespace astrum
+{
+  // Where a baked chunk mesh lives within the data file of a cache.
+  struct terrain_chunk_cache_entry
+  {
+    uint32_t chunk_index = 0;
+    uint32_t lod_index = 0;
+    uint64_t offset = 0;
+    uint64_t size = 0; // The size of the vertices in bytes (chunks share the indices of their LOD, so only the vertices are stored)
+  };
+
+  // Baked chunk meshes of a terrain, keyed by (chunk, LOD).
+  // Lookups try a RAM tier of recently used meshes first, then the memory-mapped data file, before falling back to generating the mesh.
+  struct terrain_chunk_cache
+  {
+    std::string file_name; // The data file, the index of its entries lives alongside it in file_name + ".index"
+    uint64_t ram_capacity = 0; // The number of bytes the RAM tier may hold
+
+    ludo::buffer mapping; // The data file as it was when the cache was opened, entries appended since are read from the file
+    uint64_t data_size = 0;
+    std::unordered_map<uint64_t, terrain_chunk_cache_entry> entries;
+
+    std::list<uint64_t> ram_order; // Most recently used first
+    std::unordered_map<uint64_t, std::pair<std::shared_ptr<const std::vector<std::byte>>, std::list<uint64_t>::iterator>> ram_entries;
+    uint64_t ram_size = 0;
+
+    std::mutex mutex; // Guards the entries and the RAM tier
+    std::mutex file_mutex; // Serializes writes to the files, so that lookups never wait on them
+  };
+
+  // Opens (or creates) the cache files of a terrain. They are discarded if they were baked with a different vertex format, chunk count or set of LODs.
+  // Changes to the height or color functions are not detected, delete the files to re-bake them.
+  // Any files the cache already had open are closed first.
+  // An empty file name keeps chunks in RAM only.
+  void open_terrain_chunk_cache(terrain_chunk_cache& cache, const std::string& file_name, const terrain& terrain, uint64_t ram_capacity);
+
+  // Unmaps the data file and forgets the entries of the cache. No loads or writes of the cache may be in flight.
+  void close_terrain_chunk_cache(terrain_chunk_cache& cache);
+
+  // Fills the vertices of the mesh with the chunk at the given LOD. Misses are generated and written back to the cache asynchronously.
+  void load_terrain_chunk(terrain_chunk_cache& cache, const terrain& terrain, float radius, uint32_t chunk_index, uint32_t lod_index, ludo::mesh& mesh);
+}
@@ -1,11 +1,76 @@
 #include "../meshes/ico_faces.h"
 #include "mesh.h"
+#include "terrain.h"
 
 namespace astrum
 {
-  uint32_t face(const terrain& terrain, float radius, ludo::mesh& mesh, const ludo::vertex_format& low_detail_format, const ludo::vertex_format& high_detail_format, bool write_low_detail_vertices, uint32_t vertex_index, uint32_t low_detail_divisions, uint32_t high_detail_divisions, const std::array<ludo::vec3, 3>& positions);
-  uint32_t low_detail_face(const terrain& terrain, ludo::mesh& mesh, const ludo::vertex_format& format, uint32_t vertex_index, uint32_t divisions, const std::array<ludo::vec3, 3>& positions, const ludo::vec3& normal, const ludo::vec4& color);
-  uint32_t high_detail_face(const terrain& terrain, float radius, ludo::mesh& mesh, const ludo::vertex_format& format, uint32_t vertex_index, uint32_t divisions, const std::array<ludo::vec3, 3>& positions);
+  // The vertices of a subdivided face form a triangular lattice. Each vertex is stored once, in structure-of-arrays form, so that its height is evaluated once.
+  struct height_lattice
+  {
+    uint32_t size = 0; // The number of edges along each side of the face
+
+    std::vector<float> xs;
+    std::vector<float> ys;
+    std::vector<float> zs;
+    std::vector<float> heights;
+  };
+
+  struct lattice_point
+  {
+    uint32_t i = 0;
+    uint32_t j = 0;
+  };
+
+  void build_height_lattice(const terrain& terrain, height_lattice& lattice, uint32_t divisions, const std::array<ludo::vec3, 3>& positions);
+  void build_height_lattice_positions(height_lattice& lattice, uint32_t divisions, const std::array<lattice_point, 3>& points);
+  uint32_t lattice_index(const height_lattice& lattice, const lattice_point& point);
+  uint32_t lattice_index(uint32_t size, const lattice_point& point);
+  ludo::vec3 lattice_position(const height_lattice& lattice, const lattice_point& point);
+  lattice_point lattice_midpoint(const lattice_point& point_a, const lattice_point& point_b);
+  std::array<lattice_point, 3> lattice_triangle(uint32_t i, uint32_t j, bool upper);
+
+  void face(const terrain& terrain, float radius, ludo::mesh& mesh, const ludo::vertex_format& low_detail_format, const ludo::vertex_format& high_detail_format, bool write_low_detail_vertices, uint32_t low_detail_divisions, uint32_t high_detail_divisions, const std::array<ludo::vec3, 3>& positions);
+  void write_terrain_vertex(ludo::mesh& mesh, const ludo::vertex_format& format, uint32_t vertex_index, const ludo::vec3& position, const ludo::vec3& normal, const ludo::vec4& color);
+
+  uint32_t terrain_vertex_count(uint32_t divisions)
+  {
+    auto size = uint32_t(1) << divisions;
+
+    return (size + 1) * (size + 2) / 2;
+  }
+
+  uint32_t terrain_index_count(uint32_t divisions)
+  {
+    auto size = uint32_t(1) << divisions;
+
+    return 3 * size * size;
+  }
+
+  void terrain_indices(ludo::buffer& index_buffer, uint32_t divisions)
+  {
+    auto size = uint32_t(1) << divisions;
+    auto stream = ludo::stream(index_buffer);
+
+    // Each row of the lattice holds an upward facing triangle per edge and a downward facing triangle between each pair of them.
+    for (auto j = uint32_t(0); j < size; j++)
+    {
+      for (auto i = uint32_t(0); i < size - j; i++)
+      {
+        for (auto upper : { false, true })
+        {
+          if (upper && i + j + 1 == size)
+          {
+            continue;
+          }
+
+          for (auto& point : lattice_triangle(i, j, upper))
+          {
+            ludo::write(stream, lattice_index(size, point));
+          }
+        }
+      }
+    }
+  }
 
   void terrain_mesh(const terrain& terrain, float radius, ludo::mesh& mesh, const ludo::vertex_format& low_detail_format, const ludo::vertex_format& high_detail_format, bool write_low_detail_vertices, uint32_t index, uint32_t chunk_divisions, uint32_t low_detail_divisions, uint32_t high_detail_divisions)
   {
@@ -24,7 +89,7 @@ namespace astrum
     if (chunk_divisions == 0)
     {
       assert(index >= 0 && index < 4);
-      face(terrain, radius, mesh, low_detail_format, high_detail_format, write_low_detail_vertices, 0, low_detail_divisions, high_detail_divisions, positions);
+      face(terrain, radius, mesh, low_detail_format, high_detail_format, write_low_detail_vertices, low_detail_divisions, high_detail_divisions, positions);
       return;
     }
 
@@ -49,109 +114,222 @@ namespace astrum
     terrain_mesh(terrain, radius, mesh, low_detail_format, high_detail_format, write_low_detail_vertices, index % chunks_per_face, chunk_divisions - 1, low_detail_divisions - 1, high_detail_divisions - 1, face_positions);
   }
 
-  uint32_t face(const terrain& terrain, float radius, ludo::mesh& mesh, const ludo::vertex_format& low_detail_format, const ludo::vertex_format& high_detail_format, bool write_low_detail_vertices, uint32_t vertex_index, uint32_t low_detail_divisions, uint32_t high_detail_divisions, const std::array<ludo::vec3, 3>& positions)
+  void face(const terrain& terrain, float radius, ludo::mesh& mesh, const ludo::vertex_format& low_detail_format, const ludo::vertex_format& high_detail_format, bool write_low_detail_vertices, uint32_t low_detail_divisions, uint32_t high_detail_divisions, const std::array<ludo::vec3, 3>& positions)
   {
-    if (low_detail_divisions == 0)
+    auto lattice = height_lattice();
+    build_height_lattice(terrain, lattice, high_detail_divisions, positions);
+
+    auto count = static_cast<uint32_t>(lattice.heights.size());
+    auto world_positions = std::vector<ludo::vec3>(count);
+    for (auto index = uint32_t(0); index < count; index++)
     {
-      if (write_low_detail_vertices)
-      {
-        auto height_0 = terrain.height_func(positions[0]);
-        auto height_1 = terrain.height_func(positions[1]);
-        auto height_2 = terrain.height_func(positions[2]);
+      world_positions[index] = ludo::vec3 { lattice.xs[index], lattice.ys[index], lattice.zs[index] } * radius * lattice.heights[index];
+    }
 
-        auto position_0 = positions[0] * radius * height_0;
-        auto position_1 = positions[1] * radius * height_1;
-        auto position_2 = positions[2] * radius * height_2;
+    // Each vertex takes the average normal of the faces around it within the chunk.
+    // Rendering derives the normals of faces in the fragment shader, so these are mainly used to color the vertices.
+    auto normals = std::vector<ludo::vec3>(count, ludo::vec3_zero);
+    for (auto j = uint32_t(0); j < lattice.size; j++)
+    {
+      for (auto i = uint32_t(0); i < lattice.size - j; i++)
+      {
+        for (auto upper : { false, true })
+        {
+          if (upper && i + j + 1 == lattice.size)
+          {
+            continue;
+          }
+
+          auto points = lattice_triangle(i, j, upper);
+          auto index_0 = lattice_index(lattice, points[0]);
+          auto index_1 = lattice_index(lattice, points[1]);
+          auto index_2 = lattice_index(lattice, points[2]);
+
+          auto normal = ludo::cross(world_positions[index_1] - world_positions[index_0], world_positions[index_2] - world_positions[index_0]);
+          normals[index_0] += normal;
+          normals[index_1] += normal;
+          normals[index_2] += normal;
+        }
+      }
+    }
 
-        auto normal = ludo::cross(position_1 - position_0, position_2 - position_0);
-        ludo::normalize(normal);
+    auto colors = std::vector<ludo::vec4>(count);
+    for (auto index = uint32_t(0); index < count; index++)
+    {
+      ludo::normalize(normals[index]);
 
-        auto color = terrain.color_func(positions[0][1], { height_0, height_1, height_2 }, ludo::dot(normal, positions[0]));
+      auto unit_position = ludo::vec3 { lattice.xs[index], lattice.ys[index], lattice.zs[index] };
+      auto height = lattice.heights[index];
+      colors[index] = terrain.color_func(unit_position[1], { height, height, height }, ludo::dot(normals[index], unit_position));
 
-        low_detail_face(terrain, mesh, low_detail_format, vertex_index, high_detail_divisions, { position_0, position_1, position_2 }, normal, color);
-      }
+      write_terrain_vertex(mesh, high_detail_format, index, world_positions[index], normals[index], colors[index]);
+    }
 
-      return high_detail_face(terrain, radius, mesh, high_detail_format, vertex_index, high_detail_divisions, positions);
+    if (!write_low_detail_vertices)
+    {
+      return;
     }
 
-    auto position_01 = (positions[0] + positions[1]) * 0.5f;
-    auto position_02 = (positions[0] + positions[2]) * 0.5f;
-    auto position_12 = (positions[1] + positions[2]) * 0.5f;
-    normalize(position_01);
-    normalize(position_02);
-    normalize(position_12);
+    // The low detail lattice is a subset of the high detail lattice, every stride-th vertex along each side.
+    // Each high detail vertex morphs towards the point beneath it on the low detail surface.
+    auto stride = uint32_t(1) << (high_detail_divisions - low_detail_divisions);
+    auto low_detail_size = lattice.size / stride;
 
-    vertex_index = face(terrain, radius, mesh, low_detail_format, high_detail_format, write_low_detail_vertices, vertex_index, low_detail_divisions - 1, high_detail_divisions - 1, { positions[0], position_01, position_02 });
-    vertex_index = face(terrain, radius, mesh, low_detail_format, high_detail_format, write_low_detail_vertices, vertex_index, low_detail_divisions - 1, high_detail_divisions - 1, { position_01, positions[1], position_12 });
-    vertex_index = face(terrain, radius, mesh, low_detail_format, high_detail_format, write_low_detail_vertices, vertex_index, low_detail_divisions - 1, high_detail_divisions - 1, { position_02, position_12, positions[2] });
-    vertex_index = face(terrain, radius, mesh, low_detail_format, high_detail_format, write_low_detail_vertices, vertex_index, low_detail_divisions - 1, high_detail_divisions - 1, { position_01, position_12, position_02 });
+    for (auto j = uint32_t(0); j <= lattice.size; j++)
+    {
+      for (auto i = uint32_t(0); i <= lattice.size - j; i++)
+      {
+        auto low_i = std::min(i / stride, low_detail_size - 1);
+        auto low_j = std::min(j / stride, low_detail_size - 1);
+        auto fraction_i = static_cast<float>(i - low_i * stride) / static_cast<float>(stride);
+        auto fraction_j = static_cast<float>(j - low_j * stride) / static_cast<float>(stride);
+
+        auto corners = std::array<lattice_point, 3>();
+        auto weights = std::array<float, 3>();
+        if (fraction_i == 0.0f && fraction_j == 0.0f)
+        {
+          // Points on the low detail lattice don't move (and the lower triangle of those along the far edge would lie outside of it)
+          corners = {{ { low_i, low_j }, { low_i, low_j }, { low_i, low_j } }};
+          weights = { 1.0f, 0.0f, 0.0f };
+        }
+        else if (fraction_i + fraction_j <= 1.0f)
+        {
+          corners = {{ { low_i, low_j }, { low_i + 1, low_j }, { low_i, low_j + 1 } }};
+          weights = { 1.0f - fraction_i - fraction_j, fraction_i, fraction_j };
+        }
+        else
+        {
+          corners = {{ { low_i + 1, low_j + 1 }, { low_i, low_j + 1 }, { low_i + 1, low_j } }};
+          weights = { fraction_i + fraction_j - 1.0f, 1.0f - fraction_i, 1.0f - fraction_j };
+        }
+
+        auto low_detail_position = ludo::vec3_zero;
+        auto low_detail_normal = ludo::vec3_zero;
+        auto low_detail_color = ludo::vec4_zero;
+        for (auto corner_index = uint32_t(0); corner_index < 3; corner_index++)
+        {
+          auto corner_index_in_lattice = lattice_index(lattice, { corners[corner_index].i * stride, corners[corner_index].j * stride });
+          assert(corner_index_in_lattice < lattice.heights.size() && "morph target outside of lattice");
+
+          low_detail_position += world_positions[corner_index_in_lattice] * weights[corner_index];
+          low_detail_normal += normals[corner_index_in_lattice] * weights[corner_index];
+          low_detail_color += colors[corner_index_in_lattice] * weights[corner_index];
+        }
+
+        ludo::normalize(low_detail_normal);
+
+        write_terrain_vertex(mesh, low_detail_format, lattice_index(lattice, { i, j }), low_detail_position, low_detail_normal, low_detail_color);
+      }
+    }
+  }
 
-    return vertex_index;
+  void write_terrain_vertex(ludo::mesh& mesh, const ludo::vertex_format& format, uint32_t vertex_index, const ludo::vec3& position, const ludo::vec3& normal, const ludo::vec4& color)
+  {
+    auto byte_index = vertex_index * format.size;
+    ludo::cast<ludo::vec3>(mesh.vertex_buffer, byte_index + format.position_offset) = position;
+    if (format.has_normal) ludo::cast<ludo::vec3>(mesh.vertex_buffer, byte_index + format.normal_offset) = normal;
+    if (format.has_color) ludo::cast<ludo::vec4>(mesh.vertex_buffer, byte_index + format.color_offset) = color;
   }
 
-  uint32_t low_detail_face(const terrain& terrain, ludo::mesh& mesh, const ludo::vertex_format& format, uint32_t vertex_index, uint32_t divisions, const std::array<ludo::vec3, 3>& positions, const ludo::vec3& normal, const ludo::vec4& color)
+  void build_height_lattice(const terrain& terrain, height_lattice& lattice, uint32_t divisions, const std::array<ludo::vec3, 3>& positions)
   {
-    if (divisions == 0)
+    lattice.size = uint32_t(1) << divisions;
+
+    auto count = (lattice.size + 1) * (lattice.size + 2) / 2;
+    lattice.xs.resize(count);
+    lattice.ys.resize(count);
+    lattice.zs.resize(count);
+    lattice.heights.resize(count);
+
+    auto corners = std::array<lattice_point, 3>
+    {{
+      { 0, 0 },
+      { lattice.size, 0 },
+      { 0, lattice.size }
+    }};
+
+    for (auto corner_index = uint32_t(0); corner_index < 3; corner_index++)
     {
-      auto i = vertex_index;
-      auto v = vertex_index;
-      ludo::write_vertex(mesh, format, i, v, positions[0], normal, color, { 0.0f, 0.0f }, false);
-      ludo::write_vertex(mesh, format, i, v, positions[1], normal, color, { 0.0f, 0.0f }, false);
-      ludo::write_vertex(mesh, format, i, v, positions[2], normal, color, { 0.0f, 0.0f }, false);
-
-      return vertex_index + 3;
+      auto index = lattice_index(lattice, corners[corner_index]);
+      lattice.xs[index] = positions[corner_index][0];
+      lattice.ys[index] = positions[corner_index][1];
+      lattice.zs[index] = positions[corner_index][2];
     }
 
-    auto position_01 = (positions[0] + positions[1]) * 0.5f;
-    auto position_02 = (positions[0] + positions[2]) * 0.5f;
-    auto position_12 = (positions[1] + positions[2]) * 0.5f;
-
-    vertex_index = low_detail_face(terrain, mesh, format, vertex_index, divisions - 1, { positions[0], position_01, position_02 }, normal, color);
-    vertex_index = low_detail_face(terrain, mesh, format, vertex_index, divisions - 1, { position_01, positions[1], position_12 }, normal, color);
-    vertex_index = low_detail_face(terrain, mesh, format, vertex_index, divisions - 1, { position_02, position_12, positions[2] }, normal, color);
-    vertex_index = low_detail_face(terrain, mesh, format, vertex_index, divisions - 1, { position_01, position_12, position_02 }, normal, color);
+    build_height_lattice_positions(lattice, divisions, corners);
 
-    return vertex_index;
+    terrain_heights(terrain, lattice.xs, lattice.ys, lattice.zs, lattice.heights);
   }
 
-  uint32_t high_detail_face(const terrain& terrain, float radius, ludo::mesh& mesh, const ludo::vertex_format& format, uint32_t vertex_index, uint32_t divisions, const std::array<ludo::vec3, 3>& positions)
+  void build_height_lattice_positions(height_lattice& lattice, uint32_t divisions, const std::array<lattice_point, 3>& points)
   {
     if (divisions == 0)
     {
-      auto height_0 = terrain.height_func(positions[0]);
-      auto height_1 = terrain.height_func(positions[1]);
-      auto height_2 = terrain.height_func(positions[2]);
-
-      auto position_0 = positions[0] * radius * height_0;
-      auto position_1 = positions[1] * radius * height_1;
-      auto position_2 = positions[2] * radius * height_2;
+      return;
+    }
 
-      auto normal = ludo::cross(position_1 - position_0, position_2 - position_0);
-      ludo::normalize(normal);
+    auto point_01 = lattice_midpoint(points[0], points[1]);
+    auto point_02 = lattice_midpoint(points[0], points[2]);
+    auto point_12 = lattice_midpoint(points[1], points[2]);
 
-      auto color = terrain.color_func(positions[0][1], { height_0, height_1, height_2 }, ludo::dot(normal, positions[0]));
+    // Shared edges write the same midpoint twice, but since floating point addition is commutative both writes are identical.
+    auto midpoints = std::array<std::pair<lattice_point, std::pair<lattice_point, lattice_point>>, 3>
+    {{
+      { point_01, { points[0], points[1] } },
+      { point_02, { points[0], points[2] } },
+      { point_12, { points[1], points[2] } }
+    }};
 
-      auto i = vertex_index;
-      auto v = vertex_index;
-      ludo::write_vertex(mesh, format, i, v, position_0, normal, color, { 0.0f, 0.0f }, false);
-      ludo::write_vertex(mesh, format, i, v, position_1, normal, color, { 0.0f, 0.0f }, false);
-      ludo::write_vertex(mesh, format, i, v, position_2, normal, color, { 0.0f, 0.0f }, false);
+    for (auto& [midpoint, edge] : midpoints)
+    {
+      auto position = (lattice_position(lattice, edge.first) + lattice_position(lattice, edge.second)) * 0.5f;
+      normalize(position);
 
-      return vertex_index + 3;
+      auto index = lattice_index(lattice, midpoint);
+      lattice.xs[index] = position[0];
+      lattice.ys[index] = position[1];
+      lattice.zs[index] = position[2];
     }
 
-    auto position_01 = (positions[0] + positions[1]) * 0.5f;
-    auto position_02 = (positions[0] + positions[2]) * 0.5f;
-    auto position_12 = (positions[1] + positions[2]) * 0.5f;
-    normalize(position_01);
-    normalize(position_02);
-    normalize(position_12);
+    build_height_lattice_positions(lattice, divisions - 1, { points[0], point_01, point_02 });
+    build_height_lattice_positions(lattice, divisions - 1, { point_01, points[1], point_12 });
+    build_height_lattice_positions(lattice, divisions - 1, { point_02, point_12, points[2] });
+    build_height_lattice_positions(lattice, divisions - 1, { point_01, point_12, point_02 });
+  }
+
+  uint32_t lattice_index(const height_lattice& lattice, const lattice_point& point)
+  {
+    return lattice_index(lattice.size, point);
+  }
 
-    vertex_index = high_detail_face(terrain, radius, mesh, format, vertex_index, divisions - 1, { positions[0], position_01, position_02 });
-    vertex_index = high_detail_face(terrain, radius, mesh, format, vertex_index, divisions - 1, { position_01, positions[1], position_12 });
-    vertex_index = high_detail_face(terrain, radius, mesh, format, vertex_index, divisions - 1, { position_02, position_12, positions[2] });
-    vertex_index = high_detail_face(terrain, radius, mesh, format, vertex_index, divisions - 1, { position_01, position_12, position_02 });
+  uint32_t lattice_index(uint32_t size, const lattice_point& point)
+  {
+    assert(point.i + point.j <= size && "point outside of lattice");
+
+    // Row j holds size + 1 - j points
+    return point.j * (size + 1) - point.j * (point.j - 1) / 2 + point.i;
+  }
+
+  ludo::vec3 lattice_position(const height_lattice& lattice, const lattice_point& point)
+  {
+    auto index = lattice_index(lattice, point);
+
+    return { lattice.xs[index], lattice.ys[index], lattice.zs[index] };
+  }
+
+  lattice_point lattice_midpoint(const lattice_point& point_a, const lattice_point& point_b)
+  {
+    return { (point_a.i + point_b.i) / 2, (point_a.j + point_b.j) / 2 };
+  }
+
+  std::array<lattice_point, 3> lattice_triangle(uint32_t i, uint32_t j, bool upper)
+  {
+    // Both orientations wind the same way as the face the lattice subdivides.
+    if (upper)
+    {
+      return {{ { i + 1, j }, { i + 1, j + 1 }, { i, j + 1 } }};
+    }
 
-    return vertex_index;
+    return {{ { i, j }, { i + 1, j }, { i, j + 1 } }};
   }
 }
@@ -6,6 +6,14 @@
 
 namespace astrum
 {
+  // Terrain meshes hold the unique vertices of a lattice over their face in a canonical order,
+  // so every terrain mesh with the same number of divisions can share the same indices.
+  uint32_t terrain_vertex_count(uint32_t divisions);
+
+  uint32_t terrain_index_count(uint32_t divisions);
+
+  void terrain_indices(ludo::buffer& index_buffer, uint32_t divisions);
+
   void terrain_mesh(const terrain& terrain, float radius, ludo::mesh& mesh, const ludo::vertex_format& low_detail_format, const ludo::vertex_format& high_detail_format, bool write_low_detail_vertices, uint32_t index, uint32_t chunk_divisions, uint32_t low_detail_divisions, uint32_t high_detail_divisions);
 
   void terrain_mesh(const terrain& terrain, float radius, ludo::mesh& mesh, const ludo::vertex_format& low_detail_format, const ludo::vertex_format& high_detail_format, bool write_low_detail_vertices, uint32_t index, uint32_t chunk_divisions, uint32_t low_detail_divisions, uint32_t high_detail_divisions, const std::array<ludo::vec3, 3>& positions);
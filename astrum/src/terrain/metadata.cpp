@@ -56,21 +56,18 @@ namespace astrum
 
   std::vector<ludo::vec3> build_positions(const terrain& terrain, float radius, uint32_t index, uint32_t patch_divisions, uint32_t divisions)
   {
-    auto patch_count = 20 * static_cast<uint32_t>(std::pow(4, patch_divisions - 1));
-    auto vertex_count = 20 * 3 * static_cast<uint32_t>(std::pow(4, divisions - 1)) / patch_count;
+    auto vertex_count = terrain_vertex_count(divisions - patch_divisions);
     auto patch_positions = std::vector<ludo::vec3>(vertex_count);
 
     // TODO move out of this function! Slow!
     auto temp_mesh = ludo::mesh
     {
-      .index_buffer = ludo::allocate(vertex_count * sizeof(uint32_t)),
       .vertex_buffer = ludo::allocate(vertex_count * sizeof(ludo::vec3))
     };
 
     terrain_mesh(terrain, radius, temp_mesh, ludo::vertex_format_p, ludo::vertex_format_p, false, index, patch_divisions, divisions, divisions);
     std::memcpy(patch_positions.data(), temp_mesh.vertex_buffer.data, vertex_count * sizeof(ludo::vec3));
 
-    ludo::deallocate(temp_mesh.index_buffer);
     ludo::deallocate(temp_mesh.vertex_buffer);
 
     return patch_positions;
@@ -53,20 +53,25 @@ namespace astrum
         continue;
       }
 
-      auto mesh_count = 3 * static_cast<uint32_t>(std::pow(4, most_detailed_lod.level - second_most_detailed_lod.level));
-      auto static_body_mesh = ludo::add(inst, ludo::mesh(), "celestial-bodies");
-      static_body_mesh->id = ludo::next_id++; // TODO!
-      static_body_mesh->index_buffer = ludo::allocate(mesh_count * sizeof(uint32_t));
-      static_body_mesh->vertex_buffer = ludo::allocate(mesh_count * ludo::vertex_format_p.size);
+      auto divisions = most_detailed_lod.level - second_most_detailed_lod.level;
+      auto static_body_mesh = ludo::add(inst, ludo::mesh
+      {
+        .id = ludo::next_id++, // TODO!
+        .index_buffer = ludo::allocate(terrain_index_count(divisions) * sizeof(uint32_t)),
+        .vertex_buffer = ludo::allocate(terrain_vertex_count(divisions) * ludo::vertex_format_p.size)
+      }, "celestial-bodies");
+      terrain_indices(static_body_mesh->index_buffer, divisions);
 
       auto chunks_per_ico_face = static_cast<uint32_t>(std::pow(4, second_most_detailed_lod.level));
       auto index = static_cast<uint32_t>(static_cast<float>(section.first) / static_cast<float>(chunks_per_ico_face));
 
-      terrain_mesh(terrain, radius, *static_body_mesh, ludo::vertex_format_p, ludo::vertex_format_p, false, index, 0, most_detailed_lod.level - second_most_detailed_lod.level, most_detailed_lod.level - second_most_detailed_lod.level, section.second);
+      terrain_mesh(terrain, radius, *static_body_mesh, ludo::vertex_format_p, ludo::vertex_format_p, false, index, 0, divisions, divisions, section.second);
 
-      auto static_body = ludo::add(inst, ludo::static_body { .transform = { .position = position } }, "celestial-bodies");
-      ludo::init(*static_body, *physics_context);
-      ludo::connect(*static_body, *physics_context, *static_body_mesh, ludo::vertex_format_p);
+      // Static bodies are indexed by ID, so they are initialized before they are added.
+      auto section_static_body = ludo::static_body { .transform = { .position = position } };
+      ludo::init(section_static_body, *physics_context);
+      ludo::connect(section_static_body, *physics_context, *static_body_mesh, ludo::vertex_format_p);
+      auto static_body = ludo::add(inst, section_static_body, "celestial-bodies");
 
       terrain.static_body_ids[section.first] = static_body->id;
       terrain.static_body_mesh_ids[section.first] = static_body_mesh->id;
@@ -81,15 +86,17 @@ namespace astrum
       }
 
       auto static_body_mesh = ludo::get<ludo::mesh>(inst, "celestial-bodies", terrain.static_body_mesh_ids[static_body_iter->first]);
-      ludo::deallocate(static_body_mesh->index_buffer);
-      ludo::deallocate(static_body_mesh->vertex_buffer);
-      ludo::de_init(*static_body_mesh, indices, vertices);
+      auto old_static_body_mesh = *static_body_mesh;
       ludo::remove(inst, static_body_mesh, "celestial-bodies");
+      ludo::deallocate(old_static_body_mesh.index_buffer);
+      ludo::deallocate(old_static_body_mesh.vertex_buffer);
+      ludo::de_init(old_static_body_mesh, indices, vertices);
       terrain.static_body_mesh_ids.erase(static_body_iter->first);
 
       auto static_body = ludo::get<ludo::static_body>(inst, "celestial-bodies", static_body_iter->second);
-      ludo::de_init(*static_body, *physics_context);
+      auto old_static_body = *static_body;
       ludo::remove(inst, static_body, "celestial-bodies");
+      ludo::de_init(old_static_body, *physics_context);
       static_body_iter = terrain.static_body_ids.erase(static_body_iter);
     }
   }
@@ -2,8 +2,10 @@
 #include <queue>
 #include <thread>
 
+#include "chunk_cache.h"
 #include "constants.h"
 #include "meshes/lod_shaders.h"
+#include "mesh.h"
 #include "metadata.h"
 #include "terrain.h"
 #include "static_bodies.h"
@@ -13,6 +15,7 @@ namespace astrum
 {
   static auto new_chunks = std::queue<std::tuple<uint32_t, uint32_t, ludo::mesh, uint32_t>>();
   static auto new_chunks_mutex = std::mutex();
+  static auto chunk_caches = std::unordered_map<uint64_t, terrain_chunk_cache>(); // By terrain ID
 
   void add_terrain(ludo::instance& inst, const terrain& init, const celestial_body& celestial_body, const std::string& partition)
   {
@@ -26,6 +29,7 @@ namespace astrum
     auto& point_mass = point_masses[point_masses.length - 1];
 
     auto terrain = add(inst, init, partition);
+    terrain->id = ludo::next_id++; // Keys the chunk cache of the terrain
 
     auto metadata_file_name = ludo::asset_folder + "/meshes/" + celestial_body.name + ".terrain";
     auto read_stream = std::ifstream(metadata_file_name, std::ios::binary);
@@ -40,9 +44,23 @@ namespace astrum
       write_terrain_metadata(write_stream, *terrain);
     }
 
+    // Faces are lit using normals derived in the fragment shader, so the vertices only need positions and colors.
+    auto lit = terrain->format.has_normal;
+    terrain->format = ludo::format(false, terrain->format.has_color);
+
     terrain->format.components.insert(terrain->format.components.end(), terrain->format.components.begin(), terrain->format.components.end());
     terrain->format.size *= 2;
 
+    for (auto& lod : terrain->lods)
+    {
+      auto divisions = lod.level - terrain->lods[0].level;
+      auto& lod_index_buffer = terrain->lod_index_buffers.emplace_back(ludo::allocate(indices, terrain_index_count(divisions) * sizeof(uint32_t)));
+      terrain_indices(lod_index_buffer, divisions);
+    }
+
+    auto& chunk_cache = chunk_caches[terrain->id];
+    open_terrain_chunk_cache(chunk_cache, ludo::user_file_name("terrain-cache/" + celestial_body.name + ".chunks"), *terrain, terrain_chunk_cache_ram_size);
+
     auto render_program = ludo::add(
       inst,
       ludo::render_program
@@ -55,7 +73,7 @@ namespace astrum
     );
 
     auto vertex_shader_code = lod_vertex_shader_code(terrain->format, true);
-    auto fragment_shader_code = lod_fragment_shader_code(terrain->format, true);
+    auto fragment_shader_code = lod_fragment_shader_code(terrain->format, true, lit);
     ludo::init(*render_program, vertex_shader_code, fragment_shader_code, render_commands, terrain->chunks.size());
 
     auto stream = ludo::stream(render_program->shader_buffer.back);
@@ -85,7 +103,8 @@ namespace astrum
           .min = point_mass.transform.position - bounds_half_dimensions,
           .max = point_mass.transform.position + bounds_half_dimensions
         },
-        .cell_count_1d = 16
+        .cell_count_1d = 16,
+        .morton = true
       },
       "terrain"
     );
@@ -95,18 +114,24 @@ namespace astrum
     auto camera = ludo::get_camera(*rendering_context);
     auto camera_position = ludo::position(camera.view);
 
+    auto grid_render_meshes = std::vector<ludo::render_mesh>();
+    auto grid_positions = std::vector<ludo::vec3>();
+    grid_render_meshes.reserve(terrain->chunks.size());
+    grid_positions.reserve(terrain->chunks.size());
+
     for (auto chunk_index = uint32_t(0); chunk_index < terrain->chunks.size(); chunk_index++)
     {
       auto& chunk = terrain->chunks[chunk_index];
       chunk.lod_index = find_lod_index(terrain->lods, camera_position, point_mass.transform.position + chunk.center, chunk.normal);
 
-      auto count = 3 * static_cast<uint32_t>(std::pow(4, init.lods[chunk.lod_index].level - init.lods[0].level));
+      // Meshes and render meshes are indexed by ID, so they are initialized before they are added.
+      auto chunk_mesh = ludo::mesh();
+      init_terrain_chunk_mesh(chunk_mesh, *terrain, chunk.lod_index, vertices);
+      auto mesh = ludo::add(inst, chunk_mesh, "terrain");
 
-      auto mesh = ludo::add(inst, ludo::mesh(), "terrain");
-      ludo::init(*mesh, indices, vertices, count, count, render_program->format.size);
-
-      auto render_mesh = add(inst, ludo::render_mesh { .instances = { .start = chunk_index, .count = 1 } }, "terrain" );
-      ludo::init(*render_mesh);
+      auto chunk_render_mesh = ludo::render_mesh { .instances = { .start = chunk_index, .count = 1 } };
+      ludo::init(chunk_render_mesh);
+      auto render_mesh = add(inst, chunk_render_mesh, "terrain");
       ludo::connect(*render_mesh, *render_program, 1);
       ludo::connect(*render_mesh, *mesh, indices, vertices);
       ludo::cast<uint32_t>(render_mesh->instance_buffer, 0) = chunk.lod_index;
@@ -114,28 +139,71 @@ namespace astrum
       chunk.mesh_id = mesh->id;
       chunk.render_mesh_id = render_mesh->id;
 
-      load_terrain_chunk(*terrain, celestial_body.radius, chunk_index, chunk.lod_index, *mesh);
+      load_terrain_chunk(chunk_cache, *terrain, celestial_body.radius, chunk_index, chunk.lod_index, *mesh);
 
-      ludo::add(*grid, *render_mesh, point_mass.transform.position + chunk.center);
+      grid_render_meshes.push_back(*render_mesh);
+      grid_positions.push_back(point_mass.transform.position + chunk.center);
     }
 
+    ludo::add(*grid, grid_render_meshes, grid_positions);
     ludo::commit(*grid);
 
     update_terrain_static_bodies(inst, *terrain, celestial_body.radius, point_mass.transform.position, celestial_body.radius * 1.25f);
   }
 
+  void close_terrain_chunk_caches()
+  {
+    for (auto& [ terrain_id, chunk_cache ] : chunk_caches)
+    {
+      close_terrain_chunk_cache(chunk_cache);
+    }
+  }
+
   std::pair<uint32_t, uint32_t> terrain_counts(const std::vector<lod>& lods)
   {
     // TODO I think this will supply waaaay more space than is needed...
 
-    auto total = uint32_t(0);
+    auto chunk_count = 20 * static_cast<uint32_t>(std::pow(4, lods[0].level - 1));
+
+    auto index_count = uint32_t(0);
+    auto vertex_count = uint32_t(0);
     for (auto& lod : lods)
     {
-      total += static_cast<uint32_t>(20 * 3 * std::pow(4, lod.level - 1));
+      index_count += terrain_index_count(lod.level - lods[0].level);
+      vertex_count += chunk_count * terrain_vertex_count(lod.level - lods[0].level);
+    }
+
+    return { index_count, vertex_count };
+  }
+
+  void terrain_heights(const terrain& terrain, std::span<const float> xs, std::span<const float> ys, std::span<const float> zs, std::span<float> heights)
+  {
+    assert(xs.size() == heights.size() && ys.size() == heights.size() && zs.size() == heights.size() && "mismatched position and height counts");
+
+    if (terrain.heights_func)
+    {
+      terrain.heights_func(xs, ys, zs, heights);
+      return;
+    }
+
+    for (auto index = uint32_t(0); index < heights.size(); index++)
+    {
+      heights[index] = terrain.height_func({ xs[index], ys[index], zs[index] });
     }
-    auto unique = total;
+  }
+
+  void stream_terrain_static_bodies(ludo::instance& inst)
+  {
+    auto& celestial_bodies = ludo::data<celestial_body>(inst, "celestial-bodies");
+    auto& point_masses = ludo::data<point_mass>(inst, "celestial-bodies");
+    auto& terrains = ludo::data<terrain>(inst, "celestial-bodies");
+
+    for (auto index = uint32_t(0); index < terrains.length; index++)
+    {
+      auto& celestial_body = celestial_bodies[index];
 
-    return { total, unique };
+      update_terrain_static_bodies(inst, terrains[index], celestial_body.radius, point_masses[index].transform.position, celestial_body.radius * 1.25f);
+    }
   }
 
   void stream_terrain(ludo::instance& inst)
@@ -163,6 +231,7 @@ namespace astrum
       auto& celestial_body = celestial_bodies[index];
       auto& point_mass = point_masses[index];
       auto& terrain = terrains[index];
+      auto& chunk_cache = chunk_caches[terrain.id];
 
       auto old_position = ludo::position(ludo::cast<ludo::mat4>(render_program.shader_buffer.back, 0));
       auto new_position = point_mass.transform.position;
@@ -177,8 +246,6 @@ namespace astrum
         ludo::cast<ludo::mat4>(render_program.shader_buffer.back, 0) = ludo::mat4(new_position, ludo::mat3(point_mass.transform.rotation));
       }
 
-      update_terrain_static_bodies(inst, terrain, celestial_body.radius, new_position, celestial_body.radius * 1.25f);
-
       for (auto chunk_index = uint32_t(0); chunk_index < terrain.chunks.size(); chunk_index++)
       {
         auto& chunk = terrain.chunks[chunk_index];
@@ -192,29 +259,20 @@ namespace astrum
         {
           chunk.locked = true;
 
-          auto count = 3 * static_cast<uint32_t>(std::pow(4, terrain.lods[new_lod_index].level - terrain.lods[0].level));
-
-          auto new_mesh = ludo::add(inst, ludo::mesh(), "terrain");
-          ludo::init(*new_mesh, indices, vertices, count, count, render_program.format.size);
+          // The new mesh is only added to the partitioned_array (in place of the old one) once it has been loaded.
+          auto new_mesh = ludo::mesh();
+          init_terrain_chunk_mesh(new_mesh, terrain, new_lod_index, vertices);
 
-          // Purposely take a copy of the new mesh!
-          // Otherwise, it may get shifted in the partitioned_buffer and cause all sorts of havoc.
-          auto new_mesh_copy = *new_mesh;
-
-          ludo::thread_pool_enqueue([&celestial_body, &terrain, index, chunk_index, new_mesh_copy, new_lod_index]()
+          ludo::thread_pool_enqueue([&celestial_body, &terrain, &chunk_cache, index, chunk_index, new_mesh, new_lod_index]() mutable
           {
-            auto local_new_mesh = new_mesh_copy;
-            load_terrain_chunk(terrain, celestial_body.radius, chunk_index, new_lod_index, local_new_mesh);
+            load_terrain_chunk(chunk_cache, terrain, celestial_body.radius, chunk_index, new_lod_index, new_mesh);
 
             new_chunks_mutex.lock();
-            new_chunks.emplace(std::tuple { index, chunk_index, new_mesh_copy, new_lod_index });
+            new_chunks.emplace(std::tuple { index, chunk_index, new_mesh, new_lod_index });
             new_chunks_mutex.unlock();
-          });
+          }, {}, {}, ludo::job_priority::low);
         }
       }
-
-      // TODO not while render could be happening!!!
-      ludo::commit(grid);
     }
 
     new_chunks_mutex.lock();
@@ -231,13 +289,15 @@ namespace astrum
       auto& chunk = terrain.chunks[chunk_index];
 
       auto render_mesh = ludo::get<ludo::render_mesh>(inst, "terrain", chunk.render_mesh_id);
+      // The new mesh replaces the old one in place (keeping its ID), so that swapping chunks never shifts the other meshes.
       auto mesh = ludo::get<ludo::mesh>(inst, "terrain", chunk.mesh_id);
-      ludo::de_init(*mesh, indices, vertices);
-      ludo::remove(inst, mesh, "terrain");
+      auto old_mesh = *mesh;
+      *mesh = new_mesh;
+      mesh->id = old_mesh.id;
+      de_init_terrain_chunk_mesh(old_mesh, vertices);
 
-      ludo::connect(*render_mesh, new_mesh, indices, vertices);
+      ludo::connect(*render_mesh, *mesh, indices, vertices);
 
-      chunk.mesh_id = new_mesh.id;
       chunk.lod_index = new_lod_index;
       chunk.locked = false;
 
@@ -245,10 +305,14 @@ namespace astrum
       ludo::add(grid, *render_mesh, point_mass.transform.position + chunk.center);
 
       ludo::cast<uint32_t>(render_mesh->instance_buffer, 0) = chunk.lod_index;
+    }
+    new_chunks_mutex.unlock();
 
-      // TODO not while render could be happening!!!
+    // Swapped chunks are committed together, copying only the cells they changed.
+    // TODO not while render could be happening!!!
+    for (auto& grid : grids)
+    {
       ludo::commit(grid);
     }
-    new_chunks_mutex.unlock();
   }
 }
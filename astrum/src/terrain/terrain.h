@@ -8,7 +8,16 @@ namespace astrum
 {
   void add_terrain(ludo::instance& inst, const terrain& init, const celestial_body& celestial_body, const std::string& partition = "default");
 
+  // Closes the chunk caches of all terrains, once the thread pool has stopped.
+  void close_terrain_chunk_caches();
+
   std::pair<uint32_t, uint32_t> terrain_counts(const std::vector<lod>& lods);
 
+  void terrain_heights(const terrain& terrain, std::span<const float> xs, std::span<const float> ys, std::span<const float> zs, std::span<float> heights);
+
+  // Adds/removes the static bodies of the terrain around the point masses near it (reads every point mass).
+  void stream_terrain_static_bodies(ludo::instance& inst);
+
+  // Swaps the LODs of the terrain chunks around the camera (reads only the celestial body point masses).
   void stream_terrain(ludo::instance& inst);
 }
@@ -3,8 +3,28 @@
 
 namespace astrum
 {
+  void init_terrain_chunk_mesh(ludo::mesh& mesh, const terrain& terrain, uint32_t lod_index, ludo::heap& vertices)
+  {
+    auto divisions = terrain.lods[lod_index].level - terrain.lods[0].level;
+
+    mesh.id = ludo::next_id++;
+    mesh.index_buffer = terrain.lod_index_buffers[lod_index];
+    mesh.vertex_buffer = ludo::allocate(vertices, terrain_vertex_count(divisions) * terrain.format.size, terrain.format.size);
+    mesh.vertex_size = terrain.format.size;
+  }
+
+  void de_init_terrain_chunk_mesh(ludo::mesh& mesh, ludo::heap& vertices)
+  {
+    mesh.id = 0;
+    mesh.index_buffer = {};
+
+    ludo::deallocate(vertices, mesh.vertex_buffer);
+  }
+
   void load_terrain_chunk(const terrain& terrain, float radius, uint32_t chunk_index, uint32_t lod_index, ludo::mesh& mesh)
   {
+    auto zone = ludo::profile_zone("astrum::load_terrain_chunk");
+
     auto& lowest_detail_lod = terrain.lods[0];
 
     auto& low_detail_lod = terrain.lods[lod_index > 0 ? lod_index - 1 : 0];
@@ -6,5 +6,10 @@
 
 namespace astrum
 {
+  // Chunk meshes share the index buffer of their LOD, only their vertices are allocated.
+  void init_terrain_chunk_mesh(ludo::mesh& mesh, const terrain& terrain, uint32_t lod_index, ludo::heap& vertices);
+
+  void de_init_terrain_chunk_mesh(ludo::mesh& mesh, ludo::heap& vertices);
+
   void load_terrain_chunk(const terrain& terrain, float radius, uint32_t chunk_index, uint32_t lod_index, ludo::mesh& mesh);
 }
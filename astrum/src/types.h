@@ -1,5 +1,7 @@
 #pragma once
 
+#include <span>
+
 #include <ludo/api.h>
 
 #include "constants.h"
@@ -30,6 +32,7 @@ namespace astrum
 
     bool trees_loaded = false;
     bool treeless = false;
+    bool trees_locked = false;
     bool locked = false;
   };
 
@@ -40,10 +43,12 @@ namespace astrum
     ludo::vertex_format format;
     std::vector<lod> lods;
     std::function<float(const ludo::vec3& position)> height_func;
+    std::function<void(std::span<const float> xs, std::span<const float> ys, std::span<const float> zs, std::span<float> heights)> heights_func; // Optional, evaluates many heights at once
     std::function<ludo::vec4(float longitude, const std::array<float, 3>& heights, float gradient)> color_func;
     std::function<std::array<std::vector<tree>, tree_type_count>(const terrain& terrain, float radius, uint32_t chunk_index)> tree_func;
 
     std::vector<terrain_chunk> chunks;
+    std::vector<ludo::buffer> lod_index_buffers; // The indices shared by every chunk of each LOD
 
     std::unordered_map<uint32_t, uint64_t> static_body_ids;
     std::unordered_map<uint32_t, uint64_t> static_body_mesh_ids;
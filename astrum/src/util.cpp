@@ -1,102 +1,88 @@
+#include <algorithm>
 #include <iostream>
 
 #include <ludo/api.h>
 
-#include "constants.h"
 #include "util.h"
 
 namespace astrum
 {
+  uint64_t mix(uint64_t value);
+
   auto last_print_time = 0.0f;
   auto frame_count = 0;
 
-  auto script_names = std::vector<std::string>
+  counter_random make_counter_random(uint64_t seed, uint64_t stream)
+  {
+    return { .key = mix(seed ^ mix(stream + 0x9e3779b97f4a7c15)) };
+  }
+
+  float random_float(counter_random& random)
   {
-    "astrum::center_universe",
-    "astrum::relativize_universe",
-
-    "astrum::simulate_gravity",
-    "ludo::simulate_physics",
-    "astrum::simulate_point_mass_physics",
-
-    "astrum::stream_terrain",
-    "astrum::stream_trees",
-
-    "astrum::sync_light_with_sol",
-
-    "astrum::simulate_people",
-    "astrum::simulate_spaceships",
-
-    "astrum::control_game",
-
-    "astrum::sync_render_meshes_with_point_masses",
-
-    "ludo::receive_input",
-    "ludo::start_render_transaction",
-    "ludo::add_render_commands/geometry",
-    "ludo::commit_render_commands/geometry",
-    "ludo::blit",
-    "ludo::commit_render_commands/atmosphere",
-    "ludo::commit_render_commands/bloom/brightness",
-    "ludo::commit_render_commands/bloom/horizontal0",
-    "ludo::commit_render_commands/bloom/vertical0",
-    "ludo::commit_render_commands/bloom/horizontal1",
-    "ludo::commit_render_commands/bloom/vertical1",
-    "ludo::commit_render_commands/bloom/horizontal2",
-    "ludo::commit_render_commands/bloom/vertical2",
-    "ludo::commit_render_commands/bloom/horizontal3",
-    "ludo::commit_render_commands/bloom/vertical3",
-    "ludo::commit_render_commands/bloom/horizontal4",
-    "ludo::commit_render_commands/bloom/vertical4",
-    "ludo::commit_render_commands/bloom/additive",
-    "ludo::commit_render_commands/tone_mapping",
-    "ludo::blit",
-    "ludo::commit_render_transaction",
-
-    "astrum::print_timings"
-  };
+    auto bits = mix(random.key + random.counter++ * 0x9e3779b97f4a7c15);
+
+    // The top 24 bits fill a float's mantissa exactly.
+    return static_cast<float>(bits >> 40) / static_cast<float>(uint32_t(1) << 24);
+  }
 
   void print_timings(ludo::instance& inst)
   {
+    frame_count++;
+
     if (inst.total_time - last_print_time > 1.0f)
     {
       last_print_time = inst.total_time;
 
-      auto final_script_names = script_names;
-      if (visualize_physics)
+      auto summaries = ludo::profile_summaries();
+
+      auto longest_name_size = std::size_t(0);
+      for (auto& summary : summaries)
       {
-        final_script_names.insert(final_script_names.begin() + 16, "ludo::add_render_commands/geometry/physics");
+        longest_name_size = std::max(summary.name.size(), longest_name_size);
       }
-      if (show_paths)
+
+      std::cout << "FPS: " << frame_count << ", zone times (avg/min/p99/max, over " << (summaries.empty() ? 0 : summaries[0].frames) << " frames):" << std::endl;
+      for (auto& summary : summaries)
       {
-        final_script_names.insert(final_script_names.begin() + 27, "astrum::update_prediction_paths");
+        auto padding_size = longest_name_size - summary.name.size() + 2;
+        std::cout << "  " << summary.name << std::string(padding_size, ' ')
+                  << summary.average * 1000.0f << "ms / "
+                  << summary.min * 1000.0f << "ms / "
+                  << summary.p99 * 1000.0f << "ms / "
+                  << summary.max * 1000.0f << "ms"
+                  << " (" << summary.calls << " calls)" << std::endl;
       }
 
-      auto longest_script_name_size = std::size_t(0);
-      for (auto& script_name : final_script_names)
+      // Scripts executed concurrently add up to more time than the frames they are executed in.
+      auto& scripts = ludo::data<ludo::script>(inst);
+      auto script_time = 0.0f;
+      auto frame_time = 0.0f;
+      for (auto& summary : summaries)
       {
-        longest_script_name_size = std::max(script_name.size(), longest_script_name_size);
+        if (summary.name == "ludo::frame")
+        {
+          frame_time = summary.average;
+        }
+        else if (std::any_of(scripts.begin(), scripts.end(), [&summary](const ludo::script& script) { return script.name == summary.name; }))
+        {
+          script_time += summary.average;
+        }
       }
 
-      std::cout << "FPS: " << frame_count << ", Average script times:" << std::endl;
-      auto average_frame_time = 0.0f;
-      for (auto index = 0; index < ludo::total_script_times.size(); index++)
+      if (frame_time > 0.0f)
       {
-        auto script_name = final_script_names[index];
-        auto padding_size = longest_script_name_size - script_name.size() + 2;
-
-        auto average_script_time = ludo::total_script_times[index] / static_cast<float>(frame_count) * 1000.0f;
-        average_frame_time += average_script_time;
-        std::cout << "  " << script_name << std::string(padding_size, ' ') << average_script_time << "ms" << std::endl;
+        std::cout << "script overlap: " << script_time * 1000.0f << "ms of scripts per " << frame_time * 1000.0f << "ms frame (" << script_time / frame_time << "x)" << std::endl;
       }
 
-      auto padding_size = longest_script_name_size - std::string("all_scripts").size() + 2;
-      std::cout << "  all_scripts" + std::string(padding_size, ' ') << average_frame_time << "ms" << std::endl;
-
-      ludo::total_script_times.clear();
       frame_count = 0;
     }
+  }
 
-    frame_count++;
+  // The SplitMix64 finalizer, see https://prng.di.unimi.it/splitmix64.c
+  uint64_t mix(uint64_t value)
+  {
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+    return value ^ (value >> 31);
   }
 }
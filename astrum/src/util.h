@@ -4,5 +4,18 @@
 
 namespace astrum
 {
+  // A counter-based random number generator. A sequence only depends on the seed and stream it was created with,
+  // not on the order (or thread) in which other sequences are drawn from.
+  struct counter_random
+  {
+    uint64_t key = 0;
+    uint64_t counter = 0;
+  };
+
+  counter_random make_counter_random(uint64_t seed, uint64_t stream);
+
+  // Returns the next number in the sequence, in the range [0, 1).
+  float random_float(counter_random& random);
+
   void print_timings(ludo::instance& inst);
 }
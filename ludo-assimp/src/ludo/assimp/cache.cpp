@@ -0,0 +1,520 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include <ludo/animation.h>
+#include <ludo/files.h>
+
+#include "cache.h"
+
+namespace ludo
+{
+  struct import_cache_header
+  {
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint64_t key = 0;
+    uint32_t merge_meshes = 0;
+    uint32_t index_count = 0;
+    uint32_t vertex_count = 0;
+    uint32_t mesh_count = 0;
+    uint32_t dynamic_body_shape_count = 0;
+    uint32_t armature_count = 0;
+    uint32_t animation_count = 0;
+    uint32_t texture_count = 0;
+  };
+
+  const auto import_cache_magic = uint32_t(0x504d494c); // "LIMP"
+  const auto import_cache_version = uint32_t(1);
+
+  static_assert(sizeof(import_cache_header) == 48);
+
+  std::string import_cache_file_name(const std::string& file_name);
+  bool read_import_cache_header(std::istream& stream, uint64_t key, import_cache_header& header);
+  bool valid(const import_cache_header& header, uint64_t key);
+
+  bool read_bytes(stream& stream, void* data, uint64_t size);
+  template<typename T>
+  bool read_value(stream& stream, T& value);
+  template<typename T>
+  bool read_values(stream& stream, std::vector<T>& values);
+  bool read_string(stream& stream, std::string& value);
+  template<typename T>
+  bool read_keyframes(stream& stream, std::vector<std::pair<float, T>>& keyframes);
+  bool read_armature(stream& stream, armature& armature);
+  bool read_animation(stream& stream, animation& animation);
+  bool read_meshes(stream& stream, heap& indices, heap& vertices, const import_cache_header& header, const std::vector<armature>& armatures, const std::vector<animation>& animations, import_results& results);
+
+  template<typename T>
+  void write_value(std::ostream& stream, const T& value);
+  template<typename T>
+  void write_values(std::ostream& stream, const std::vector<T>& values);
+  void write_string(std::ostream& stream, const std::string& value);
+  template<typename T>
+  void write_keyframes(std::ostream& stream, const std::vector<std::pair<float, T>>& keyframes);
+  void write_armature(std::ostream& stream, const armature& armature);
+  void write_animation(std::ostream& stream, const animation& animation);
+
+  uint64_t import_cache_key(const std::string& file_name)
+  {
+    auto file = map_file(file_name);
+    if (!file.data)
+    {
+      return 0;
+    }
+
+    // FNV-1a
+    auto key = uint64_t(0xcbf29ce484222325);
+    for (auto byte_index = uint64_t(0); byte_index < file.size; byte_index++)
+    {
+      key = (key ^ static_cast<uint64_t>(file.data[byte_index])) * 0x100000001b3;
+    }
+
+    unmap_file(file);
+
+    return key;
+  }
+
+  bool read_import_cache_counts(const std::string& file_name, uint64_t key, std::pair<uint32_t, uint32_t>& counts)
+  {
+    auto stream = std::ifstream(import_cache_file_name(file_name), std::ios::binary);
+    auto header = import_cache_header();
+    if (!read_import_cache_header(stream, key, header))
+    {
+      return false;
+    }
+
+    counts = { header.index_count, header.vertex_count };
+
+    return true;
+  }
+
+  bool read_import_cache(const std::string& file_name, uint64_t key, heap& indices, heap& vertices, const import_options& options, import_results& results)
+  {
+    auto file = map_file(import_cache_file_name(file_name));
+    if (!file.data)
+    {
+      return false;
+    }
+
+    auto file_stream = stream(file);
+    auto header = import_cache_header();
+    auto cached_results = import_results();
+
+    auto success = read_value(file_stream, header) && valid(header, key) && header.merge_meshes == options.merge_meshes;
+
+    for (auto index = uint32_t(0); success && index < header.dynamic_body_shape_count; index++)
+    {
+      auto& dynamic_body_shape = cached_results.dynamic_body_shapes.emplace_back();
+
+      auto hull_count = uint32_t(0);
+      success = read_value(file_stream, hull_count);
+      for (auto hull_index = uint32_t(0); success && hull_index < hull_count; hull_index++)
+      {
+        success = read_values(file_stream, dynamic_body_shape.convex_hulls.emplace_back());
+      }
+    }
+
+    for (auto index = uint32_t(0); success && index < header.armature_count; index++)
+    {
+      success = read_armature(file_stream, cached_results.armatures.emplace_back());
+    }
+
+    for (auto index = uint32_t(0); success && index < header.animation_count; index++)
+    {
+      success = read_animation(file_stream, cached_results.animations.emplace_back());
+    }
+
+    success = success && read_meshes(file_stream, indices, vertices, header, cached_results.armatures, cached_results.animations, cached_results);
+
+    unmap_file(file);
+
+    if (!success)
+    {
+      for (auto& texture : cached_results.textures)
+      {
+        de_init(texture);
+      }
+
+      return false;
+    }
+
+    // Body shapes are only initialized once the whole cache is known to be valid.
+    for (auto& dynamic_body_shape : cached_results.dynamic_body_shapes)
+    {
+      init(dynamic_body_shape);
+    }
+
+    results = std::move(cached_results);
+
+    return true;
+  }
+
+  void write_import_cache(const std::string& file_name, uint64_t key, const std::pair<uint32_t, uint32_t>& counts, const std::vector<std::string>& texture_file_names, const import_options& options, const import_results& results)
+  {
+    assert(texture_file_names.size() == results.meshes.size() && "mismatched texture file name and mesh counts");
+
+    auto cache_file_name = import_cache_file_name(file_name);
+    if (cache_file_name.empty())
+    {
+      return;
+    }
+
+    auto temp_file_name = cache_file_name + ".tmp";
+
+    auto stream = std::ofstream(temp_file_name, std::ios::binary | std::ios::trunc);
+    if (!stream.is_open())
+    {
+      return;
+    }
+
+    write_value(stream, import_cache_header
+    {
+      .magic = import_cache_magic,
+      .version = import_cache_version,
+      .key = key,
+      .merge_meshes = options.merge_meshes,
+      .index_count = counts.first,
+      .vertex_count = counts.second,
+      .mesh_count = static_cast<uint32_t>(results.meshes.size()),
+      .dynamic_body_shape_count = static_cast<uint32_t>(results.dynamic_body_shapes.size()),
+      .armature_count = static_cast<uint32_t>(results.armatures.size()),
+      .animation_count = static_cast<uint32_t>(results.animations.size()),
+      .texture_count = static_cast<uint32_t>(results.textures.size())
+    });
+
+    for (auto& dynamic_body_shape : results.dynamic_body_shapes)
+    {
+      write_value(stream, static_cast<uint32_t>(dynamic_body_shape.convex_hulls.size()));
+      for (auto& convex_hull : dynamic_body_shape.convex_hulls)
+      {
+        write_values(stream, convex_hull);
+      }
+    }
+
+    for (auto& armature : results.armatures)
+    {
+      write_armature(stream, armature);
+    }
+
+    for (auto& animation : results.animations)
+    {
+      write_animation(stream, animation);
+    }
+
+    // Armatures and animations are referenced by their index within the results, since IDs are assigned anew when the cache is read.
+    for (auto mesh_index = uint32_t(0); mesh_index < results.meshes.size(); mesh_index++)
+    {
+      auto& mesh = results.meshes[mesh_index];
+
+      auto armature_iter = std::find_if(results.armatures.begin(), results.armatures.end(), [&mesh](const armature& armature) { return armature.id == mesh.armature_id; });
+      auto armature_index = mesh.armature_id && armature_iter != results.armatures.end() ? static_cast<int32_t>(armature_iter - results.armatures.begin()) : -1;
+
+      auto animation_indices = std::vector<uint32_t>();
+      for (auto animation_id : mesh.animation_ids)
+      {
+        auto animation_iter = std::find_if(results.animations.begin(), results.animations.end(), [animation_id](const animation& animation) { return animation.id == animation_id; });
+        if (animation_iter != results.animations.end())
+        {
+          animation_indices.push_back(static_cast<uint32_t>(animation_iter - results.animations.begin()));
+        }
+      }
+
+      write_value(stream, static_cast<uint32_t>(mesh.vertex_size));
+      write_value(stream, static_cast<uint32_t>(mesh.index_buffer.size / sizeof(uint32_t)));
+      write_value(stream, static_cast<uint32_t>(mesh.vertex_size ? mesh.vertex_buffer.size / mesh.vertex_size : 0));
+      write_string(stream, mesh.texture_id ? texture_file_names[mesh_index] : std::string());
+      write_value(stream, armature_index);
+      write_values(stream, animation_indices);
+
+      stream.write(reinterpret_cast<const char*>(mesh.index_buffer.data), static_cast<std::streamsize>(mesh.index_buffer.size));
+      stream.write(reinterpret_cast<const char*>(mesh.vertex_buffer.data), static_cast<std::streamsize>(mesh.vertex_buffer.size));
+    }
+
+    stream.close();
+
+    // The cache only replaces the previous one once it has been written in full.
+    auto error = std::error_code();
+    if (stream)
+    {
+      std::filesystem::rename(temp_file_name, cache_file_name, error);
+    }
+
+    if (!stream || error)
+    {
+      std::filesystem::remove(temp_file_name, error);
+    }
+  }
+
+  std::string import_cache_file_name(const std::string& file_name)
+  {
+    // The model may be in the (read-only) asset folder, so the cache is kept in the user folder keyed by the path of the model.
+    auto path = std::filesystem::absolute(file_name).lexically_normal().string();
+
+    // FNV-1a
+    auto path_key = uint64_t(0xcbf29ce484222325);
+    for (auto character : path)
+    {
+      path_key = (path_key ^ static_cast<uint8_t>(character)) * 0x100000001b3;
+    }
+
+    auto path_key_string = std::array<char, 17>();
+    std::snprintf(path_key_string.data(), path_key_string.size(), "%016llx", static_cast<unsigned long long>(path_key));
+
+    return user_file_name("import-cache/" + std::filesystem::path(file_name).stem().string() + "-" + path_key_string.data() + ".limport");
+  }
+
+  bool read_import_cache_header(std::istream& stream, uint64_t key, import_cache_header& header)
+  {
+    return stream.read(reinterpret_cast<char*>(&header), sizeof(import_cache_header)) && valid(header, key);
+  }
+
+  bool valid(const import_cache_header& header, uint64_t key)
+  {
+    return header.magic == import_cache_magic && header.version == import_cache_version && header.key == key;
+  }
+
+  bool read_bytes(stream& stream, void* data, uint64_t size)
+  {
+    if (size > stream.size - stream.position)
+    {
+      return false;
+    }
+
+    std::memcpy(data, stream.data + stream.position, size);
+    stream.position += size;
+
+    return true;
+  }
+
+  template<typename T>
+  bool read_value(stream& stream, T& value)
+  {
+    return read_bytes(stream, &value, sizeof(T));
+  }
+
+  template<typename T>
+  bool read_values(stream& stream, std::vector<T>& values)
+  {
+    auto count = uint32_t(0);
+    if (!read_value(stream, count) || count > (stream.size - stream.position) / sizeof(T))
+    {
+      return false;
+    }
+
+    values.resize(count);
+
+    return read_bytes(stream, values.data(), count * sizeof(T));
+  }
+
+  bool read_string(stream& stream, std::string& value)
+  {
+    auto length = uint32_t(0);
+    if (!read_value(stream, length) || length > stream.size - stream.position)
+    {
+      return false;
+    }
+
+    value.resize(length);
+
+    return read_bytes(stream, value.data(), length);
+  }
+
+  template<typename T>
+  bool read_keyframes(stream& stream, std::vector<std::pair<float, T>>& keyframes)
+  {
+    auto count = uint32_t(0);
+    if (!read_value(stream, count) || count > (stream.size - stream.position) / (sizeof(float) + sizeof(T)))
+    {
+      return false;
+    }
+
+    keyframes.resize(count);
+    for (auto& keyframe : keyframes)
+    {
+      if (!read_value(stream, keyframe.first) || !read_value(stream, keyframe.second))
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  bool read_armature(stream& stream, armature& armature)
+  {
+    auto child_count = uint32_t(0);
+    if (!read_value(stream, armature.transform) || !read_value(stream, armature.bone_index) || !read_value(stream, armature.bone_offset) || !read_value(stream, child_count))
+    {
+      return false;
+    }
+
+    init(armature);
+
+    for (auto child_index = uint32_t(0); child_index < child_count; child_index++)
+    {
+      if (!read_armature(stream, armature.children.emplace_back()))
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  bool read_animation(stream& stream, animation& animation)
+  {
+    auto node_count = uint32_t(0);
+    if (!read_string(stream, animation.name) || !read_value(stream, animation.ticks) || !read_value(stream, animation.ticks_per_second) || !read_value(stream, node_count))
+    {
+      return false;
+    }
+
+    init(animation);
+
+    for (auto node_index = uint32_t(0); node_index < node_count; node_index++)
+    {
+      auto& node = animation.nodes.emplace_back();
+      if (!read_value(stream, node.bone_index) || !read_keyframes(stream, node.position_keyframes) || !read_keyframes(stream, node.rotation_keyframes) || !read_keyframes(stream, node.scale_keyframes))
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  bool read_meshes(stream& stream, heap& indices, heap& vertices, const import_cache_header& header, const std::vector<armature>& armatures, const std::vector<animation>& animations, import_results& results)
+  {
+    for (auto mesh_index = uint32_t(0); mesh_index < header.mesh_count; mesh_index++)
+    {
+      auto vertex_size = uint32_t(0);
+      auto index_count = uint32_t(0);
+      auto vertex_count = uint32_t(0);
+      auto texture_file_name = std::string();
+      auto armature_index = int32_t(-1);
+      auto animation_indices = std::vector<uint32_t>();
+
+      auto success = read_value(stream, vertex_size) && read_value(stream, index_count) && read_value(stream, vertex_count) &&
+        read_string(stream, texture_file_name) && read_value(stream, armature_index) && read_values(stream, animation_indices) &&
+        armature_index < static_cast<int32_t>(armatures.size()) &&
+        uint64_t(index_count) * sizeof(uint32_t) + uint64_t(vertex_count) * vertex_size <= stream.size - stream.position;
+
+      for (auto animation_index : animation_indices)
+      {
+        success = success && animation_index < animations.size();
+      }
+
+      if (!success)
+      {
+        // Release the meshes and textures read so far, the import will be performed from scratch.
+        for (auto& mesh : results.meshes)
+        {
+          de_init(mesh, indices, vertices);
+        }
+        results.meshes.clear();
+
+        for (auto& texture : results.textures)
+        {
+          de_init(texture);
+        }
+        results.textures.clear();
+
+        return false;
+      }
+
+      auto& mesh = results.meshes.emplace_back();
+      init(mesh, indices, vertices, index_count, vertex_count, static_cast<uint8_t>(vertex_size));
+      read_bytes(stream, mesh.index_buffer.data, mesh.index_buffer.size);
+      read_bytes(stream, mesh.vertex_buffer.data, mesh.vertex_buffer.size);
+
+      if (!texture_file_name.empty())
+      {
+        auto texture = load(texture_file_name);
+        if (texture.id)
+        {
+          results.textures.push_back(texture);
+          mesh.texture_id = texture.id;
+        }
+      }
+
+      if (armature_index >= 0)
+      {
+        mesh.armature_id = armatures[armature_index].id;
+      }
+
+      for (auto animation_index : animation_indices)
+      {
+        mesh.animation_ids.push_back(animations[animation_index].id);
+      }
+    }
+
+    return true;
+  }
+
+  template<typename T>
+  void write_value(std::ostream& stream, const T& value)
+  {
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  template<typename T>
+  void write_values(std::ostream& stream, const std::vector<T>& values)
+  {
+    write_value(stream, static_cast<uint32_t>(values.size()));
+    stream.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+  }
+
+  void write_string(std::ostream& stream, const std::string& value)
+  {
+    write_value(stream, static_cast<uint32_t>(value.size()));
+    stream.write(value.data(), static_cast<std::streamsize>(value.size()));
+  }
+
+  template<typename T>
+  void write_keyframes(std::ostream& stream, const std::vector<std::pair<float, T>>& keyframes)
+  {
+    write_value(stream, static_cast<uint32_t>(keyframes.size()));
+    for (auto& keyframe : keyframes)
+    {
+      write_value(stream, keyframe.first);
+      write_value(stream, keyframe.second);
+    }
+  }
+
+  void write_armature(std::ostream& stream, const armature& armature)
+  {
+    write_value(stream, armature.transform);
+    write_value(stream, armature.bone_index);
+    write_value(stream, armature.bone_offset);
+    write_value(stream, static_cast<uint32_t>(armature.children.size()));
+
+    for (auto& child : armature.children)
+    {
+      write_armature(stream, child);
+    }
+  }
+
+  void write_animation(std::ostream& stream, const animation& animation)
+  {
+    write_string(stream, animation.name);
+    write_value(stream, animation.ticks);
+    write_value(stream, animation.ticks_per_second);
+    write_value(stream, static_cast<uint32_t>(animation.nodes.size()));
+
+    for (auto& node : animation.nodes)
+    {
+      write_value(stream, node.bone_index);
+      write_keyframes(stream, node.position_keyframes);
+      write_keyframes(stream, node.rotation_keyframes);
+      write_keyframes(stream, node.scale_keyframes);
+    }
+  }
+}
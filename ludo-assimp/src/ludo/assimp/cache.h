@@ -0,0 +1,22 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#pragma once
+
+#include <ludo/importing.h>
+
+namespace ludo
+{
+  // Import caches live in the "import-cache" folder of the user folder, named after the imported file and a hash of its path.
+  // They hold everything an import produces and are keyed by a hash of the contents of the imported file, so they are rebuilt whenever it changes.
+
+  uint64_t import_cache_key(const std::string& file_name);
+
+  bool read_import_cache_counts(const std::string& file_name, uint64_t key, std::pair<uint32_t, uint32_t>& counts);
+
+  bool read_import_cache(const std::string& file_name, uint64_t key, heap& indices, heap& vertices, const import_options& options, import_results& results);
+
+  // The texture file names (one per mesh, empty for meshes without a texture) are stored in place of the textures themselves, which are loaded again when the cache is read.
+  void write_import_cache(const std::string& file_name, uint64_t key, const std::pair<uint32_t, uint32_t>& counts, const std::vector<std::string>& texture_file_names, const import_options& options, const import_results& results);
+}
@@ -10,9 +10,11 @@
 #include <ludo/animation.h>
 #include <ludo/importing.h>
 
+#include "cache.h"
 #include "math.h"
 #include "meshes.h"
 #include "physics.h"
+#include "textures.h"
 #include "util.h"
 
 namespace ludo
@@ -22,6 +24,16 @@ namespace ludo
 
   import_results import(const std::string& file_name, heap& indices, heap& vertices, const import_options& options)
   {
+    auto cache_key = options.cache ? import_cache_key(file_name) : uint64_t(0);
+    if (cache_key)
+    {
+      auto results = import_results();
+      if (read_import_cache(file_name, cache_key, indices, vertices, options, results))
+      {
+        return results;
+      }
+    }
+
     Assimp::Importer importer;
     auto assimp_scene = importer.ReadFile(file_name, aiProcessPreset_TargetRealtime_MaxQuality);
     if (assimp_scene == nullptr)
@@ -42,11 +54,33 @@ namespace ludo
     import_body_shapes(results, *assimp_scene, rigid_body_objects);
     import_meshes(results, indices, vertices, folder, *assimp_scene, mesh_objects, options);
 
+    if (cache_key)
+    {
+      // Merged meshes are untextured, otherwise there is a mesh per mesh object.
+      auto texture_file_names = std::vector<std::string>(results.meshes.size());
+      if (!options.merge_meshes)
+      {
+        for (auto index = 0; index < mesh_objects.size(); index++)
+        {
+          texture_file_names[index] = folder + texture_file_name(*assimp_scene, mesh_objects[index]);
+        }
+      }
+
+      write_import_cache(file_name, cache_key, import_counts(*assimp_scene, mesh_objects), texture_file_names, options, results);
+    }
+
     return results;
   }
 
-  std::pair<uint32_t, uint32_t> import_counts(const std::string& file_name)
+  std::pair<uint32_t, uint32_t> import_counts(const std::string& file_name, const import_options& options)
   {
+    auto cache_key = options.cache ? import_cache_key(file_name) : uint64_t(0);
+    auto counts = std::pair<uint32_t, uint32_t>();
+    if (cache_key && read_import_cache_counts(file_name, cache_key, counts))
+    {
+      return counts;
+    }
+
     Assimp::Importer importer;
     auto assimp_scene = importer.ReadFile(file_name, aiProcessPreset_TargetRealtime_MaxQuality);
     if (assimp_scene == nullptr)
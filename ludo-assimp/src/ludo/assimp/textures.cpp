@@ -6,16 +6,23 @@
 
 namespace ludo
 {
-  texture import_texture(const std::string& folder, const aiScene& assimp_scene, const import_object& mesh_object)
+  std::string texture_file_name(const aiScene& assimp_scene, const import_object& mesh_object)
   {
     auto assimp_material = assimp_scene.mMaterials[assimp_scene.mMeshes[mesh_object.mesh_index]->mMaterialIndex];
     auto texture_path = aiString();
     assimp_material->Get(AI_MATKEY_TEXTURE(aiTextureType_DIFFUSE, 0), texture_path);
-    if (!texture_path.length)
+
+    return texture_path.C_Str();
+  }
+
+  texture import_texture(const std::string& folder, const aiScene& assimp_scene, const import_object& mesh_object)
+  {
+    auto file_name = texture_file_name(assimp_scene, mesh_object);
+    if (file_name.empty())
     {
       return {};
     }
 
-    return ludo::load(folder + texture_path.C_Str());
+    return ludo::load(folder + file_name);
   }
 }
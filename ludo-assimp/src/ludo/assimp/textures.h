@@ -12,5 +12,7 @@
 
 namespace ludo
 {
+  std::string texture_file_name(const aiScene& assimp_scene, const import_object& mesh_object);
+
   texture import_texture(const std::string& folder, const aiScene& assimp_scene, const import_object& mesh_object);
 }
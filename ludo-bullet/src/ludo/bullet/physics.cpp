@@ -5,6 +5,7 @@
 #include <btBulletDynamicsCommon.h>
 
 #include <ludo/physics.h>
+#include <ludo/profiling.h>
 
 #include "debug.h"
 #include "math.h"
@@ -77,6 +78,8 @@ namespace ludo
 
   void simulate(physics_context& physics_context, float delta_time)
   {
+    auto zone = profile_zone("ludo::simulate(bullet)");
+
     auto bullet_world = reinterpret_cast<btDiscreteDynamicsWorld*>(physics_context.id);
 
     bullet_world->stepSimulation(delta_time);
@@ -161,7 +164,7 @@ namespace ludo
     auto bullet_mesh = btIndexedMesh();
     bullet_mesh.m_vertexBase = reinterpret_cast<const unsigned char*>(mesh.vertex_buffer.data);
     bullet_mesh.m_vertexStride = static_cast<int>(format.size);
-    bullet_mesh.m_numVertices = static_cast<int>(mesh.index_buffer.size / sizeof(uint32_t));
+    bullet_mesh.m_numVertices = static_cast<int>(mesh.vertex_buffer.size / format.size);
     bullet_mesh.m_triangleIndexBase = reinterpret_cast<const unsigned char*>(mesh.index_buffer.data);
     bullet_mesh.m_triangleIndexStride = 3 * sizeof(uint32_t);
     bullet_mesh.m_numTriangles = static_cast<int>(mesh.index_buffer.size / (3 * sizeof(uint32_t)));
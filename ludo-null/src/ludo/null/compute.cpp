@@ -0,0 +1,43 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <fstream>
+
+#include <ludo/compute.h>
+
+#include "statistics.h"
+
+namespace ludo
+{
+  void init(compute_program& compute_program, const std::string& shader_file_name)
+  {
+    auto shader_code = std::ifstream(shader_file_name);
+
+    init(compute_program, shader_code);
+  }
+
+  void init(compute_program& compute_program, std::istream& code)
+  {
+    compute_program.id = next_id++;
+  }
+
+  void de_init(compute_program& compute_program)
+  {
+    compute_program.id = 0;
+
+    if (compute_program.shader_buffer.data)
+    {
+      deallocate_vram(compute_program.shader_buffer);
+    }
+  }
+
+  void execute(compute_program& compute_program, uint32_t groups_x, uint32_t groups_y, uint32_t groups_z)
+  {
+    assert(compute_program.id && "compute program not initialized");
+
+    auto& statistics = get_null_statistics();
+    statistics.dispatches++;
+    statistics.work_groups += uint64_t(groups_x) * groups_y * groups_z;
+  }
+}
@@ -0,0 +1,28 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <ludo/data/buffers.h>
+
+#include "../statistics.h"
+
+namespace ludo
+{
+  buffer allocate_vram(uint64_t size, vram_buffer_access_hint access_hint)
+  {
+    auto& statistics = get_null_statistics();
+    statistics.vram_allocations++;
+    statistics.vram_allocated_bytes += size;
+    statistics.vram_live_bytes += size;
+
+    // VRAM is just RAM here.
+    return allocate(size);
+  }
+
+  void deallocate_vram(buffer& buffer)
+  {
+    get_null_statistics().vram_live_bytes -= buffer.size;
+
+    deallocate(buffer);
+  }
+}
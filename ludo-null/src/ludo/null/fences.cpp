@@ -0,0 +1,27 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <ludo/rendering.h>
+
+namespace ludo
+{
+  // There is no GPU to wait for, so fences are signaled as soon as they are initialized.
+
+  void init(fence& fence)
+  {
+    fence.id = next_id++;
+  }
+
+  void de_init(fence& fence)
+  {
+    fence.id = 0;
+  }
+
+  void wait(fence& fence)
+  {
+    assert(fence.id && "fence not initialized");
+
+    de_init(fence);
+  }
+}
@@ -0,0 +1,31 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <ludo/rendering.h>
+
+namespace ludo
+{
+  void init(frame_buffer& frame_buffer)
+  {
+    frame_buffer.id = next_id++;
+  }
+
+  void de_init(frame_buffer& frame_buffer)
+  {
+    frame_buffer.id = 0;
+  }
+
+  void use(const frame_buffer& frame_buffer)
+  {
+  }
+
+  void use_and_clear(const frame_buffer& frame_buffer, const vec4& color)
+  {
+    use(frame_buffer);
+  }
+
+  void blit(const frame_buffer& source, const frame_buffer& dest)
+  {
+  }
+}
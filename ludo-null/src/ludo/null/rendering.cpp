@@ -0,0 +1,59 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <ludo/rendering.h>
+
+#include "statistics.h"
+
+namespace ludo
+{
+  void start_render_transaction(rendering_context& rendering_context, array<render_program>& render_programs)
+  {
+    if (rendering_context.fence.id)
+    {
+      wait(rendering_context.fence);
+    }
+
+    for (auto& render_program : render_programs)
+    {
+      render_program.active_commands.start = 0;
+    }
+  }
+
+  void commit_render_commands(rendering_context& rendering_context, array<render_program>& render_programs, const heap& render_commands, const heap& indices, const heap& vertices)
+  {
+    auto& statistics = get_null_statistics();
+
+    commit(rendering_context.shader_buffer);
+
+    for (auto& render_program : render_programs)
+    {
+      if (!render_program.active_commands.count)
+      {
+        continue;
+      }
+
+      use(render_program);
+
+      // Record what a multi-draw of the active commands would have drawn.
+      statistics.draw_calls++;
+      statistics.draw_commands += render_program.active_commands.count;
+      for (auto index = render_program.active_commands.start; index < render_program.active_commands.start + render_program.active_commands.count; index++)
+      {
+        auto& command = cast<render_command>(render_program.command_buffer, index * sizeof(render_command));
+        statistics.draw_indices += uint64_t(command.index_count) * command.instance_count;
+        statistics.draw_instances += command.instance_count;
+        statistics.draw_instance_bytes += uint64_t(command.instance_count) * render_program.instance_size;
+      }
+
+      render_program.active_commands.start += render_program.active_commands.count;
+      render_program.active_commands.count = 0;
+    }
+  }
+
+  void commit_render_transaction(rendering_context& rendering_context)
+  {
+    init(rendering_context.fence);
+  }
+}
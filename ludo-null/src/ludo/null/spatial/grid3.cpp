@@ -0,0 +1,36 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <sstream>
+
+#include <ludo/spatial/grid3.h>
+
+#include "../statistics.h"
+
+namespace ludo
+{
+  compute_program build_compute_program(const grid3& grid)
+  {
+    auto code = std::stringstream();
+
+    auto program = compute_program();
+    init(program, code);
+
+    return program;
+  }
+
+  void add_render_commands(array<grid3>& grids, array<compute_program>& compute_programs, array<render_program>& render_programs, const heap& render_commands, const camera& camera)
+  {
+    // The culling is done on the CPU instead, but the dispatches the OpenGL backend would have issued are still recorded.
+    for (auto& grid : grids)
+    {
+      auto compute_program = find_by_id(compute_programs.begin(), compute_programs.end(), grid.compute_program_id);
+      assert(compute_program != compute_programs.end() && "compute program not found");
+
+      execute(*compute_program, grid.cell_count_1d / 8, grid.cell_count_1d / 4, grid.cell_count_1d);
+    }
+
+    add_render_commands(grids, render_programs, camera);
+  }
+}
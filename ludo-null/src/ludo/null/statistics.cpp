@@ -0,0 +1,32 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include "statistics.h"
+
+namespace ludo
+{
+  auto issued_statistics = null_statistics();
+  auto null_frame_limit = uint64_t(0);
+
+  null_statistics& get_null_statistics()
+  {
+    return issued_statistics;
+  }
+
+  void reset_null_statistics()
+  {
+    // The VRAM still allocated is carried over, it will be deallocated later.
+    issued_statistics = null_statistics { .vram_live_bytes = issued_statistics.vram_live_bytes };
+  }
+
+  void set_null_frame_limit(uint64_t frame_count)
+  {
+    null_frame_limit = frame_count;
+  }
+
+  uint64_t get_null_frame_limit()
+  {
+    return null_frame_limit;
+  }
+}
@@ -0,0 +1,55 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace ludo
+{
+  ///
+  /// The work issued to the null backend. Nothing is drawn or dispatched, it is only counted.
+  /// Like a real rendering context, the null backend expects to be driven from a single thread.
+  struct null_statistics
+  {
+    uint64_t frames = 0; ///< The number of times window buffers were swapped.
+
+    uint64_t draw_calls = 0; ///< The number of multi-draw calls (one per render program with active commands).
+    uint64_t draw_commands = 0; ///< The number of render commands drawn.
+    uint64_t draw_indices = 0; ///< The number of indices drawn (across all instances).
+    uint64_t draw_instances = 0; ///< The number of instances drawn.
+    uint64_t draw_instance_bytes = 0; ///< The size (in bytes) of the instance data read by the drawn instances.
+
+    uint64_t dispatches = 0; ///< The number of compute dispatches.
+    uint64_t work_groups = 0; ///< The number of compute work groups dispatched.
+
+    uint64_t vram_allocations = 0; ///< The number of VRAM buffers allocated.
+    uint64_t vram_allocated_bytes = 0; ///< The size (in bytes) of all the VRAM buffers allocated.
+    uint64_t vram_live_bytes = 0; ///< The size (in bytes) of the VRAM buffers currently allocated.
+    uint64_t committed_bytes = 0; ///< The size (in bytes) of the render program data committed to VRAM.
+
+    uint64_t texture_read_bytes = 0; ///< The size (in bytes) of the texture data read.
+    uint64_t texture_written_bytes = 0; ///< The size (in bytes) of the texture data written.
+  };
+
+  ///
+  /// Retrieves the work issued to the null backend since it was last reset.
+  /// \return The statistics.
+  null_statistics& get_null_statistics();
+
+  ///
+  /// Resets the work issued to the null backend.
+  void reset_null_statistics();
+
+  ///
+  /// Sets the number of frames after which windows report that their close button was pressed.
+  /// This allows a frame loop to run for a fixed number of frames.
+  /// \param frame_count The number of frames. 0 will never close the windows.
+  void set_null_frame_limit(uint64_t frame_count);
+
+  ///
+  /// Retrieves the number of frames after which windows report that their close button was pressed.
+  /// \return The number of frames. 0 will never close the windows.
+  uint64_t get_null_frame_limit();
+}
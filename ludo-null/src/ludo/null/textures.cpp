@@ -0,0 +1,52 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <unordered_map>
+
+#include <ludo/rendering.h>
+
+#include "statistics.h"
+
+namespace ludo
+{
+  // The pixels of each texture, by texture ID.
+  auto texture_data = std::unordered_map<uint64_t, std::vector<std::byte>>();
+
+  void init(texture& texture, const texture_options& options)
+  {
+    texture.id = next_id++;
+    texture_data[texture.id] = std::vector<std::byte>(texture.width * texture.height * pixel_depth(texture));
+  }
+
+  void de_init(texture& texture)
+  {
+    texture_data.erase(texture.id);
+    texture.id = 0;
+  }
+
+  std::vector<std::byte> read(const texture& texture)
+  {
+    auto data = texture_data.find(texture.id);
+    assert(data != texture_data.end() && "texture not initialized");
+
+    get_null_statistics().texture_read_bytes += data->second.size();
+
+    return data->second;
+  }
+
+  void write(texture& texture, const std::byte* data)
+  {
+    auto existing_data = texture_data.find(texture.id);
+    assert(existing_data != texture_data.end() && "texture not initialized");
+
+    std::memcpy(existing_data->second.data(), data, existing_data->second.size());
+
+    get_null_statistics().texture_written_bytes += existing_data->second.size();
+  }
+
+  uint64_t handle(const texture& texture)
+  {
+    return texture.id;
+  }
+}
@@ -0,0 +1,81 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <ludo/windowing.h>
+
+#include "statistics.h"
+
+namespace ludo
+{
+  void init(window& window)
+  {
+    window.id = next_id++;
+  }
+
+  void de_init(window& window)
+  {
+    window.id = 0;
+  }
+
+  void swap_buffers(window& window)
+  {
+    get_null_statistics().frames++;
+  }
+
+  void receive_input(window& window, instance& instance)
+  {
+    for (auto& active_keyboard_button_state : window.active_keyboard_button_states)
+    {
+      if (active_keyboard_button_state.second == button_state::DOWN)
+      {
+        active_keyboard_button_state.second = button_state::HOLD;
+      }
+      else if (active_keyboard_button_state.second == button_state::UP)
+      {
+        active_keyboard_button_state.second = button_state::NONE;
+      }
+    }
+
+    for (auto& active_mouse_button_state : window.active_mouse_button_states)
+    {
+      if (active_mouse_button_state.second == button_state::DOWN)
+      {
+        active_mouse_button_state.second = button_state::HOLD;
+      }
+      else if (active_mouse_button_state.second == button_state::UP)
+      {
+        active_mouse_button_state.second = button_state::NONE;
+      }
+    }
+
+    for (auto& active_window_frame_button_states : window.active_window_frame_button_states)
+    {
+      if (active_window_frame_button_states.second == button_state::UP)
+      {
+        active_window_frame_button_states.second = button_state::NONE;
+      }
+    }
+
+    window.mouse_movement = { 0, 0 };
+
+    window.mouse_scroll = { 0.0f, 0.0f };
+
+    // There are no events to poll, the only input is the close button once the frame limit is reached.
+    auto frame_limit = get_null_frame_limit();
+    if (frame_limit && get_null_statistics().frames >= frame_limit)
+    {
+      window.active_window_frame_button_states[window_frame_button::CLOSE] = button_state::UP;
+    }
+  }
+
+  void capture_mouse(window& window)
+  {
+    window.mouse_captured = true;
+  }
+
+  void release_mouse(window& window)
+  {
+    window.mouse_captured = false;
+  }
+}
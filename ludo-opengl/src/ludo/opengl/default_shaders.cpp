@@ -3,8 +3,7 @@
  */
 
 #include <ludo/animation.h>
-
-#include "default_shaders.h"
+#include <ludo/rendering.h>
 
 namespace ludo
 {
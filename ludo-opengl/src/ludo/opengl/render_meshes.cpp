@@ -3,8 +3,7 @@
  */
 
 #include <ludo/meshes.h>
-
-#include "./textures.h"
+#include <ludo/rendering.h>
 
 namespace ludo
 {
@@ -8,7 +8,6 @@
 #include <ludo/animation.h>
 #include <ludo/physics.h>
 
-#include "default_shaders.h"
 #include "shaders.h"
 
 namespace ludo
@@ -101,10 +101,47 @@ int get_render_program_index(uint64_t id)
 
   return -1;
 }
+)--";
+
+    if (grid.morton)
+    {
+      code <<
+R"--(
+uint spread_bits(uint value)
+{
+  value &= 0x000003ffu;
+  value = (value | (value << 16)) & 0x030000ffu;
+  value = (value | (value << 8)) & 0x0300f00fu;
+  value = (value | (value << 4)) & 0x030c30c3u;
+  value = (value | (value << 2)) & 0x09249249u;
+
+  return value;
+}
+
+// The cells are laid out in Morton order (see ludo::morton_encode).
+uint get_cell_index(uvec3 cell_coordinates, uint cell_count_1d)
+{
+  return (spread_bits(cell_coordinates.x) << 2) | (spread_bits(cell_coordinates.y) << 1) | spread_bits(cell_coordinates.z);
+}
+)--";
+    }
+    else
+    {
+      code <<
+R"--(
+uint get_cell_index(uvec3 cell_coordinates, uint cell_count_1d)
+{
+  return cell_coordinates.x * cell_count_1d * cell_count_1d + cell_coordinates.y * cell_count_1d + cell_coordinates.z;
+}
+)--";
+    }
 
+    code <<
+R"--(
 // Based on https://old.cescg.org/CESCG-2002/DSykoraJJelinek/index.html
 int frustum_test(aabb_t bounds)
 {
+  int result = 1;
   for (uint index = 0; index < 6; index++)
   {
     vec4 plane = planes[index];
@@ -136,22 +173,20 @@ int frustum_test(aabb_t bounds)
     );
 
     // Check if the n-vertex is within the negative halfspace.
+    // Keep testing the remaining planes, the AABB may still be fully within the negative halfspace of one of them.
     if (dot(plane, closest_positive) < 0.0)
     {
-      return 0;
+      result = 0;
     }
   }
 
-  return 1;
+  return result;
 }
 
 void main()
 {
   uint cell_count_1d = gl_NumWorkGroups.x * gl_WorkGroupSize.x;
-  uint cell_index =
-    gl_GlobalInvocationID.x * cell_count_1d * cell_count_1d +
-    gl_GlobalInvocationID.y * cell_count_1d +
-    gl_GlobalInvocationID.z;
+  uint cell_index = get_cell_index(gl_GlobalInvocationID, cell_count_1d);
 
   vec3 cell_min = bounds.min + gl_GlobalInvocationID * cell_dimensions;
 
@@ -2,7 +2,8 @@
  * This file is part of ludo. See the LICENSE file for the full license governing this code.
  */
 
-#include "textures.h"
+#include <ludo/rendering.h>
+
 #include "util.h"
 
 namespace ludo
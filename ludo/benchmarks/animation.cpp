@@ -0,0 +1,74 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <vector>
+
+#include <ludo/animation.h>
+#include <ludo/benchmarking.h>
+
+#include "animation.h"
+
+namespace ludo
+{
+  void benchmark_animation()
+  {
+    benchmark_group("animation");
+
+    // A chain of bones under a root that is not a bone (like an imported character), each with a second of keyframes at 30 per second
+    auto keyframe_count = 30;
+    auto armature = ludo::armature { .transform = mat4_identity };
+    auto animation = ludo::animation { .ticks = static_cast<float>(keyframe_count - 1), .ticks_per_second = 30.0f };
+
+    auto parent = &armature;
+    for (auto bone_index = int32_t(0); bone_index < static_cast<int32_t>(max_bones_per_armature); bone_index++)
+    {
+      parent->children.push_back({ .transform = mat4_identity, .bone_index = bone_index, .bone_offset = mat4(vec3 { 0.0f, -1.0f, 0.0f }, mat3_identity) });
+      parent = &parent->children.back();
+
+      auto animation_node = ludo::animation_node { .bone_index = bone_index };
+      for (auto keyframe_index = 0; keyframe_index < keyframe_count; keyframe_index++)
+      {
+        auto time = static_cast<float>(keyframe_index);
+        animation_node.position_keyframes.emplace_back(time, vec3 { 0.0f, 1.0f, 0.0f });
+        animation_node.rotation_keyframes.emplace_back(time, quat(vec3_unit_x, 0.01f * time * static_cast<float>(bone_index + 1)));
+        animation_node.scale_keyframes.emplace_back(time, vec3_one);
+      }
+
+      animation.nodes.push_back(animation_node);
+    }
+
+    auto animation_clip = compile(animation, armature);
+
+    auto instance_count = uint32_t(1000);
+    auto times = std::vector<float>(instance_count);
+    auto final_transforms = std::vector<mat4>(instance_count * max_bones_per_armature);
+    auto final_transform_pointers = std::vector<mat4*>(instance_count);
+    for (auto index = uint32_t(0); index < instance_count; index++)
+    {
+      times[index] = static_cast<float>(index) * 0.37f;
+      final_transform_pointers[index] = &final_transforms[index * max_bones_per_armature];
+    }
+
+    auto suffix = " (" + std::to_string(instance_count) + " instances, " + std::to_string(max_bones_per_armature) + " bones)";
+
+    auto animation_time = benchmark("interpolate animation" + suffix, 100, [&]()
+    {
+      for (auto index = uint32_t(0); index < instance_count; index++)
+      {
+        interpolate(animation, armature, times[index], final_transform_pointers[index]);
+      }
+
+      benchmark_keep(final_transforms[0]);
+    });
+
+    auto animation_clip_time = benchmark("interpolate animation clip" + suffix, 100, [&]()
+    {
+      interpolate(animation_clip, times.data(), final_transform_pointers.data(), instance_count);
+      benchmark_keep(final_transforms[0]);
+    });
+
+    benchmark_report("interpolate animation throughput", instance_count / animation_time, "instances/s");
+    benchmark_report("interpolate animation clip throughput", instance_count / animation_clip_time, "instances/s");
+  }
+}
@@ -4,9 +4,7 @@
 
 #pragma once
 
-#include <ludo/rendering.h>
-
 namespace ludo
 {
-  uint64_t handle(const texture& texture);
+  void benchmark_animation();
 }
@@ -0,0 +1,62 @@
+#include <ludo/rendering.h>
+#include <ludo/spatial/grid3.h>
+
+#include "animation.h"
+#include "data/arrays.h"
+#include "data/data.h"
+#include "data/heaps.h"
+#include "math/mat.h"
+#include "math/quat.h"
+#include "math/vec.h"
+#include "meshes/simplify.h"
+#include "meshes/util.h"
+#include "profiling.h"
+#include "spatial/grid3.h"
+#include "spatial/loose_octree.h"
+#include "spatial/octree.h"
+#include "spatial/quadtree.h"
+#include "thread_pool.h"
+
+int main()
+{
+  ludo::benchmark_animation();
+  ludo::benchmark_arrays();
+  ludo::benchmark_data();
+  ludo::benchmark_heaps();
+  ludo::benchmark_math_mat();
+  ludo::benchmark_math_quat();
+  ludo::benchmark_math_vec();
+  ludo::benchmark_meshes_simplify();
+  ludo::benchmark_meshes_util();
+  ludo::benchmark_profiling();
+  ludo::benchmark_spatial_grid3();
+  ludo::benchmark_spatial_loose_octree();
+  ludo::benchmark_spatial_octree();
+  ludo::benchmark_spatial_quadtree();
+  ludo::benchmark_thread_pool();
+
+  return 0;
+}
+
+// stubs
+namespace ludo
+{
+  compute_program* add_grid_compute_program(instance& instance, const grid3& octree)
+  {
+    return new compute_program();
+  }
+
+  buffer allocate_vram(uint64_t size, vram_buffer_access_hint access_hint)
+  {
+    return allocate(size);
+  }
+
+  void deallocate_vram(buffer& buffer)
+  {
+    deallocate(buffer);
+  }
+
+  void set_instance_texture(render_mesh& render_mesh, const texture& texture, uint32_t instance_index)
+  {
+  }
+}
@@ -0,0 +1,160 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <array>
+#include <random>
+
+#include <ludo/algorithm.h>
+#include <ludo/benchmarking.h>
+#include <ludo/data/arrays.h>
+
+#include "arrays.h"
+
+namespace ludo
+{
+  struct benchmark_array_element
+  {
+    uint64_t id = 0;
+    std::array<float, 14> payload; // Roughly the size of a render mesh
+  };
+
+  void benchmark_arrays_find_by_id(uint32_t count);
+  void benchmark_arrays_remove(uint32_t count);
+
+  void benchmark_arrays()
+  {
+    benchmark_group("arrays");
+
+    benchmark_arrays_find_by_id(10000);
+    benchmark_arrays_find_by_id(100000);
+    benchmark_arrays_remove(10000);
+    benchmark_arrays_remove(100000);
+  }
+
+  void benchmark_arrays_find_by_id(uint32_t count)
+  {
+    auto random = std::mt19937(count);
+    auto id_distribution = std::uniform_int_distribution<uint64_t>(1, count);
+
+    auto linear_array = allocate_partitioned_array<benchmark_array_element>(count);
+    auto indexed_array = allocate_partitioned_array<benchmark_array_element>(count);
+    index_ids(indexed_array);
+
+    for (auto id = uint64_t(1); id <= count; id++)
+    {
+      // Fill the partitions in order to avoid shifting elements during setup.
+      auto partition = "partition-" + std::to_string((id - 1) * 4 / count);
+      add(linear_array, { .id = id }, partition);
+      add(indexed_array, { .id = id }, partition);
+    }
+
+    auto suffix = " (" + std::to_string(count) + " elements)";
+    auto iterations = uint64_t(1000000000) / count / 10;
+
+    benchmark("find_by_id linear" + suffix, iterations, [&]()
+    {
+      auto element = find_by_id(linear_array.begin(), linear_array.end(), id_distribution(random));
+      benchmark_keep(*element);
+    });
+
+    benchmark("find_by_id indexed" + suffix, iterations * 100, [&]()
+    {
+      auto element = find_by_id(indexed_array, id_distribution(random));
+      benchmark_keep(*element);
+    });
+
+    benchmark("remove + add linear" + suffix, iterations, [&]()
+    {
+      auto element = find_by_id(linear_array.begin(), linear_array.end(), id_distribution(random));
+      auto partition = linear_array.partitions.begin();
+      while (element >= partition->second.end())
+      {
+        partition++;
+      }
+
+      auto replacement = benchmark_array_element { .id = element->id };
+      remove(linear_array, element, partition->first);
+      add(linear_array, replacement, partition->first);
+    });
+
+    benchmark("remove + add indexed" + suffix, iterations, [&]()
+    {
+      auto element = find_by_id(indexed_array, id_distribution(random));
+      auto partition = indexed_array.partitions.begin();
+      while (element >= partition->second.end())
+      {
+        partition++;
+      }
+
+      auto replacement = benchmark_array_element { .id = element->id };
+      remove(indexed_array, element, partition->first);
+      add(indexed_array, replacement, partition->first);
+    });
+
+    deallocate(linear_array);
+    deallocate(indexed_array);
+  }
+
+  void benchmark_arrays_remove(uint32_t count)
+  {
+    auto random = std::mt19937(count);
+    auto position_distribution = std::uniform_int_distribution<uint32_t>(0, count - 1);
+
+    auto shifting_array = allocate_partitioned_array<benchmark_array_element>(count);
+    auto swapping_array = allocate_partitioned_array<benchmark_array_element>(count);
+    use_swapping(swapping_array);
+
+    for (auto id = uint64_t(1); id <= count; id++)
+    {
+      auto partition = "partition-" + std::to_string((id - 1) * 4 / count);
+      add(shifting_array, { .id = id }, partition);
+      add(swapping_array, { .id = id }, partition);
+    }
+
+    auto suffix = " (" + std::to_string(count) + " elements)";
+    auto iterations = uint64_t(1000000000) / count / 10;
+
+    benchmark("remove + add shifting" + suffix, iterations, [&]()
+    {
+      auto element = shifting_array.data + position_distribution(random);
+      auto partition = shifting_array.partitions.begin();
+      while (element >= partition->second.end())
+      {
+        partition++;
+      }
+
+      auto replacement = *element;
+      remove(shifting_array, element, partition->first);
+      add(shifting_array, replacement, partition->first);
+    });
+
+    benchmark("remove + add swapping" + suffix, iterations * 100, [&]()
+    {
+      auto element = swapping_array.data + position_distribution(random);
+      auto partition = swapping_array.partitions.begin();
+      while (element >= partition->second.end())
+      {
+        partition++;
+      }
+
+      auto replacement = *element;
+      remove(swapping_array, element, partition->first);
+      add(swapping_array, replacement, partition->first);
+    });
+
+    auto handles = std::vector<handle>();
+    for (auto& element : swapping_array)
+    {
+      handles.push_back(handle_of(swapping_array, &element));
+    }
+
+    benchmark("get by handle" + suffix, iterations * 100, [&]()
+    {
+      benchmark_keep(*get(swapping_array, handles[position_distribution(random)]));
+    });
+
+    deallocate(shifting_array);
+    deallocate(swapping_array);
+  }
+}
@@ -0,0 +1,91 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <typeinfo>
+#include <unordered_map>
+
+#include <ludo/benchmarking.h>
+#include <ludo/data/data.h>
+
+#include "data.h"
+
+namespace ludo
+{
+  template<uint32_t N>
+  struct benchmark_element
+  {
+    uint64_t id = 0;
+  };
+
+  void benchmark_data()
+  {
+    benchmark_group("data");
+
+    const auto iterations = uint64_t(1000000);
+
+    auto instance = ludo::instance();
+    allocate<benchmark_element<0>>(instance, 16);
+    allocate<benchmark_element<1>>(instance, 16);
+    allocate<benchmark_element<2>>(instance, 16);
+    allocate<benchmark_element<3>>(instance, 16);
+    add(instance, benchmark_element<3> { .id = 1 });
+    allocate_heap(instance, "ludo::vram_render_commands", 16);
+    allocate_heap(instance, "ludo::vram_indices", 16);
+    allocate_heap(instance, "ludo::vram_vertices", 16);
+
+    // The string-keyed lookup that ludo::instance used previously, for comparison.
+    auto keyed_data = std::unordered_map<std::string, void*>();
+    keyed_data[std::string("ludo::partitioned_array::") + typeid(benchmark_element<0>).name()] = &data<benchmark_element<0>>(instance);
+    keyed_data[std::string("ludo::partitioned_array::") + typeid(benchmark_element<1>).name()] = &data<benchmark_element<1>>(instance);
+    keyed_data[std::string("ludo::partitioned_array::") + typeid(benchmark_element<2>).name()] = &data<benchmark_element<2>>(instance);
+    keyed_data[std::string("ludo::partitioned_array::") + typeid(benchmark_element<3>).name()] = &data<benchmark_element<3>>(instance);
+    keyed_data[std::string("ludo::heap::") + "ludo::vram_render_commands"] = &data_heap(instance, "ludo::vram_render_commands");
+    keyed_data[std::string("ludo::heap::") + "ludo::vram_indices"] = &data_heap(instance, "ludo::vram_indices");
+    keyed_data[std::string("ludo::heap::") + "ludo::vram_vertices"] = &data_heap(instance, "ludo::vram_vertices");
+
+    benchmark("data<T> (string-keyed, previous)", iterations, [&]()
+    {
+      benchmark_keep(keyed_data.at(std::string("ludo::partitioned_array::") + typeid(benchmark_element<3>).name()));
+    });
+
+    benchmark("data<T>", iterations, [&]()
+    {
+      benchmark_keep(data<benchmark_element<3>>(instance));
+    });
+
+    benchmark("first<T> (string-keyed, previous)", iterations, [&]()
+    {
+      auto array_iter = keyed_data.find(std::string("ludo::partitioned_array::") + typeid(benchmark_element<3>).name());
+      auto array = array_iter == keyed_data.end() ? nullptr : static_cast<partitioned_array<benchmark_element<3>>*>(array_iter->second);
+      benchmark_keep(*(array && array->length ? array->begin() : nullptr));
+    });
+
+    benchmark("first<T>", iterations, [&]()
+    {
+      benchmark_keep(*first<benchmark_element<3>>(instance));
+    });
+
+    benchmark("exists<T> (string-keyed, previous)", iterations, [&]()
+    {
+      auto exists = keyed_data.contains(std::string("ludo::partitioned_array::") + typeid(benchmark_element<3>).name());
+      benchmark_keep(exists);
+    });
+
+    benchmark("exists<T>", iterations, [&]()
+    {
+      auto exists = ludo::exists<benchmark_element<3>>(instance);
+      benchmark_keep(exists);
+    });
+
+    benchmark("data_heap (string-keyed, previous)", iterations, [&]()
+    {
+      benchmark_keep(keyed_data.at(std::string("ludo::heap::") + "ludo::vram_vertices"));
+    });
+
+    benchmark("data_heap", iterations, [&]()
+    {
+      benchmark_keep(data_heap(instance, "ludo::vram_vertices"));
+    });
+  }
+}
@@ -0,0 +1,218 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <ludo/benchmarking.h>
+#include <ludo/data/heaps.h>
+
+#include "heaps.h"
+
+namespace ludo
+{
+  struct benchmark_heap_operation
+  {
+    bool allocate = false;
+    uint32_t slot = 0;
+    uint64_t index_size = 0;
+    uint64_t vertex_size = 0;
+  };
+
+  std::vector<std::vector<benchmark_heap_operation>> benchmark_heaps_terrain_trace(uint32_t chunk_count, uint32_t step_count, uint32_t& slot_count);
+  void benchmark_heaps_replay(heap& indices, heap& vertices, std::vector<buffer>& index_buffers, std::vector<buffer>& vertex_buffers, const std::vector<benchmark_heap_operation>& operations);
+  float benchmark_heaps_fragmentation(const heap& heap);
+
+  const auto benchmark_heaps_vertex_size = uint8_t(80); // The size of a position-normal-color vertex
+
+  void benchmark_heaps()
+  {
+    benchmark_group("heaps");
+
+    auto slot_count = uint32_t(0);
+    auto trace = benchmark_heaps_terrain_trace(5120, 500, slot_count);
+
+    auto operation_count = uint64_t(0);
+    auto index_capacity = uint64_t(0);
+    auto vertex_capacity = uint64_t(0);
+    {
+      auto index_size = uint64_t(0);
+      auto vertex_size = uint64_t(0);
+      auto sizes = std::vector<std::pair<uint64_t, uint64_t>>(slot_count);
+      for (auto& step : trace)
+      {
+        for (auto& operation : step)
+        {
+          if (operation.allocate)
+          {
+            sizes[operation.slot] = { operation.index_size, operation.vertex_size };
+            index_size += operation.index_size;
+            vertex_size += operation.vertex_size;
+          }
+          else
+          {
+            index_size -= sizes[operation.slot].first;
+            vertex_size -= sizes[operation.slot].second;
+          }
+
+          index_capacity = std::max(index_capacity, index_size);
+          vertex_capacity = std::max(vertex_capacity, vertex_size);
+        }
+
+        operation_count += step.size();
+      }
+    }
+
+    // Leave some headroom, the heaps in astrum are sized generously but not excessively.
+    auto indices = allocate_heap(index_capacity * 5 / 4);
+    auto vertices = allocate_heap(vertex_capacity * 5 / 4);
+    auto index_buffers = std::vector<buffer>(slot_count);
+    auto vertex_buffers = std::vector<buffer>(slot_count);
+
+    benchmark_report("terrain streaming trace (operations)", static_cast<double>(operation_count * 2), "ops");
+
+    auto time = benchmark("terrain streaming trace (replay)", 20, [&]()
+    {
+      for (auto& step : trace)
+      {
+        benchmark_heaps_replay(indices, vertices, index_buffers, vertex_buffers, step);
+      }
+
+      clear(indices);
+      clear(vertices);
+    });
+
+    benchmark_report("terrain streaming trace (throughput)", static_cast<double>(operation_count * 2) / time, "ops/s");
+
+    auto total_fragmentation = 0.0f;
+    auto max_fragmentation = 0.0f;
+    for (auto& step : trace)
+    {
+      benchmark_heaps_replay(indices, vertices, index_buffers, vertex_buffers, step);
+
+      auto fragmentation = benchmark_heaps_fragmentation(vertices);
+      total_fragmentation += fragmentation;
+      max_fragmentation = std::max(max_fragmentation, fragmentation);
+    }
+
+    benchmark_report("terrain streaming trace (average vertex fragmentation)", total_fragmentation / static_cast<float>(trace.size()) * 100.0f, "%");
+    benchmark_report("terrain streaming trace (max vertex fragmentation)", max_fragmentation * 100.0f, "%");
+    benchmark_report("terrain streaming trace (final vertex fragmentation)", benchmark_heaps_fragmentation(vertices) * 100.0f, "%");
+
+    deallocate(indices);
+    deallocate(vertices);
+  }
+
+  std::vector<std::vector<benchmark_heap_operation>> benchmark_heaps_terrain_trace(uint32_t chunk_count, uint32_t step_count, uint32_t& slot_count)
+  {
+    // Mirrors the terra LODs of astrum, where a chunk at LOD level n has 3 * 4^(n - 5) vertices (and as many indices).
+    const auto levels = std::array<uint32_t, 5> { 5, 6, 8, 10, 12 };
+    const auto max_angles = std::array<float, 5> { 4.0f, 1.2f, 0.3f, 0.075f, 0.02f };
+
+    auto random = std::mt19937(chunk_count);
+    auto distribution = std::normal_distribution<float>();
+
+    auto chunk_directions = std::vector<std::array<float, 3>>(chunk_count);
+    for (auto& direction : chunk_directions)
+    {
+      direction = { distribution(random), distribution(random), distribution(random) };
+      auto length = std::sqrt(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+      direction = { direction[0] / length, direction[1] / length, direction[2] / length };
+    }
+
+    auto chunk_slots = std::vector<uint32_t>(chunk_count);
+    auto chunk_levels = std::vector<uint32_t>(chunk_count, 0);
+    auto free_slots = std::vector<uint32_t>();
+    auto pending_frees = std::vector<uint32_t>();
+
+    auto trace = std::vector<std::vector<benchmark_heap_operation>>();
+    for (auto step = uint32_t(0); step <= step_count; step++)
+    {
+      auto& operations = trace.emplace_back();
+
+      // Old meshes are only deallocated once their replacements have loaded (a step later).
+      for (auto slot : pending_frees)
+      {
+        operations.push_back({ .slot = slot });
+        free_slots.push_back(slot);
+      }
+
+      pending_frees.clear();
+
+      // The camera skims the surface of the planet along a great circle.
+      auto angle = static_cast<float>(step) / static_cast<float>(step_count) * 6.2832f;
+      auto camera_direction = std::array<float, 3> { std::cos(angle), std::sin(angle) * 0.8f, std::sin(angle) * 0.6f };
+
+      for (auto chunk_index = uint32_t(0); chunk_index < chunk_count; chunk_index++)
+      {
+        auto& direction = chunk_directions[chunk_index];
+        auto dot = direction[0] * camera_direction[0] + direction[1] * camera_direction[1] + direction[2] * camera_direction[2];
+        auto chunk_angle = std::acos(std::clamp(dot, -1.0f, 1.0f));
+
+        auto level_index = uint32_t(0);
+        while (level_index + 1 < levels.size() && chunk_angle < max_angles[level_index + 1])
+        {
+          level_index++;
+        }
+
+        if (step > 0 && level_index == chunk_levels[chunk_index])
+        {
+          continue;
+        }
+
+        if (step > 0)
+        {
+          pending_frees.push_back(chunk_slots[chunk_index]);
+        }
+
+        auto slot = slot_count++;
+        if (!free_slots.empty())
+        {
+          slot = free_slots.back();
+          free_slots.pop_back();
+          slot_count--;
+        }
+
+        auto count = 3 * static_cast<uint64_t>(std::pow(4, levels[level_index] - levels[0]));
+        operations.push_back({ .allocate = true, .slot = slot, .index_size = count * sizeof(uint32_t), .vertex_size = count * benchmark_heaps_vertex_size });
+
+        chunk_slots[chunk_index] = slot;
+        chunk_levels[chunk_index] = level_index;
+      }
+    }
+
+    return trace;
+  }
+
+  void benchmark_heaps_replay(heap& indices, heap& vertices, std::vector<buffer>& index_buffers, std::vector<buffer>& vertex_buffers, const std::vector<benchmark_heap_operation>& operations)
+  {
+    for (auto& operation : operations)
+    {
+      if (operation.allocate)
+      {
+        index_buffers[operation.slot] = allocate(indices, operation.index_size);
+        vertex_buffers[operation.slot] = allocate(vertices, operation.vertex_size, benchmark_heaps_vertex_size);
+      }
+      else
+      {
+        deallocate(indices, index_buffers[operation.slot]);
+        deallocate(vertices, vertex_buffers[operation.slot]);
+      }
+    }
+  }
+
+  float benchmark_heaps_fragmentation(const heap& heap)
+  {
+    auto free = free_size(heap);
+    if (!free)
+    {
+      return 0.0f;
+    }
+
+    return 1.0f - static_cast<float>(largest_free_size(heap)) / static_cast<float>(free);
+  }
+}
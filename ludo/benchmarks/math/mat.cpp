@@ -0,0 +1,79 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <random>
+#include <vector>
+
+#include <ludo/benchmarking.h>
+#include <ludo/math/mat.h>
+
+#include "mat.h"
+
+namespace ludo
+{
+  void benchmark_math_mat()
+  {
+    benchmark_group("math/mat");
+
+    auto random = std::mt19937(123456);
+    auto distribution = std::uniform_real_distribution<float>(-1.0f, 1.0f);
+
+    auto matrices = std::vector<mat4>(1024);
+    for (auto& matrix : matrices)
+    {
+      for (auto& value : matrix)
+      {
+        value = distribution(random);
+      }
+    }
+
+    auto vectors = std::vector<vec4>(4096);
+    for (auto& vector : vectors)
+    {
+      vector = { distribution(random), distribution(random), distribution(random), 1.0f };
+    }
+
+    auto product = mat4_identity;
+    benchmark("mat4 multiply mat4 (1024 matrices)", 10000, [&]()
+    {
+      for (auto& matrix : matrices)
+      {
+        product = matrix * product;
+      }
+
+      benchmark_keep(product);
+    });
+
+    auto inverses = matrices;
+    benchmark("mat4 invert (1024 matrices)", 10000, [&]()
+    {
+      for (auto index = size_t(0); index < matrices.size(); index++)
+      {
+        inverses[index] = matrices[index];
+        invert(inverses[index]);
+      }
+
+      benchmark_keep(inverses[0]);
+    });
+
+    auto products = std::vector<vec4>(vectors.size());
+    auto single_time = benchmark("mat4 multiply vec4 (4096 vectors)", 10000, [&]()
+    {
+      for (auto index = size_t(0); index < vectors.size(); index++)
+      {
+        products[index] = matrices[0] * vectors[index];
+      }
+
+      benchmark_keep(products[0]);
+    });
+
+    auto batch_time = benchmark("mat4 multiply vec4 batch (4096 vectors)", 10000, [&]()
+    {
+      multiply(matrices[0], vectors.data(), products.data(), vectors.size());
+      benchmark_keep(products[0]);
+    });
+
+    benchmark_report("mat4 multiply vec4 batch speedup", single_time / batch_time, "x");
+  }
+}
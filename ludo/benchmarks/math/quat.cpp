@@ -0,0 +1,52 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <random>
+#include <vector>
+
+#include <ludo/benchmarking.h>
+#include <ludo/math/quat.h>
+
+#include "quat.h"
+
+namespace ludo
+{
+  void benchmark_math_quat()
+  {
+    benchmark_group("math/quat");
+
+    auto random = std::mt19937(123456);
+    auto distribution = std::uniform_real_distribution<float>(-1.0f, 1.0f);
+
+    auto quaternions = std::vector<quat>(1024);
+    for (auto& quaternion : quaternions)
+    {
+      quaternion = { distribution(random), distribution(random), distribution(random), distribution(random) };
+      normalize(quaternion);
+    }
+
+    // The kind of work done per bone while animating
+    auto results = std::vector<quat>(quaternions.size() - 1);
+    benchmark("slerp (1023 pairs)", 10000, [&]()
+    {
+      for (auto index = size_t(0); index < results.size(); index++)
+      {
+        results[index] = slerp(quaternions[index], quaternions[index + 1], 0.25f);
+      }
+
+      benchmark_keep(results[0]);
+    });
+
+    auto product = quat_identity;
+    benchmark("quat multiply quat (1024 quaternions)", 10000, [&]()
+    {
+      for (auto& quaternion : quaternions)
+      {
+        product = quaternion * product;
+      }
+
+      benchmark_keep(product);
+    });
+  }
+}
@@ -0,0 +1,53 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <random>
+#include <vector>
+
+#include <ludo/benchmarking.h>
+#include <ludo/math/vec.h>
+
+#include "vec.h"
+
+namespace ludo
+{
+  void benchmark_math_vec()
+  {
+    benchmark_group("math/vec");
+
+    auto random = std::mt19937(123456);
+    auto distribution = std::uniform_real_distribution<float>(-1.0f, 1.0f);
+
+    auto vectors = std::vector<vec3>(4096);
+    for (auto& vector : vectors)
+    {
+      vector = { distribution(random), distribution(random), distribution(random) };
+    }
+
+    // The kind of work done per triangle while meshing terrain
+    auto normals = std::vector<vec3>(vectors.size() - 2);
+    benchmark("triangle normal (4094 triangles)", 10000, [&]()
+    {
+      for (auto index = size_t(0); index < normals.size(); index++)
+      {
+        auto normal = cross(vectors[index + 1] - vectors[index], vectors[index + 2] - vectors[index]);
+        normalize(normal);
+        normals[index] = normal;
+      }
+
+      benchmark_keep(normals[0]);
+    });
+
+    auto sum = vec3_zero;
+    benchmark("add and scale (4096 vectors)", 10000, [&]()
+    {
+      for (auto& vector : vectors)
+      {
+        sum += vector * 0.5f;
+      }
+
+      benchmark_keep(sum);
+    });
+  }
+}
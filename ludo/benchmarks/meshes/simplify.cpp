@@ -0,0 +1,231 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include <ludo/benchmarking.h>
+#include <ludo/data/heaps.h>
+#include <ludo/meshes/collapse.h>
+#include <ludo/meshes/shapes.h>
+#include <ludo/meshes/simplify.h>
+
+#include "simplify.h"
+
+namespace ludo
+{
+  void benchmark_meshes_simplify_compare(const std::string& name, const mesh& source, const vertex_format& format, uint32_t iterations);
+  void benchmark_meshes_simplify_quality(const std::string& name, const mesh& source, const mesh& simplified, const vertex_format& format);
+  uint32_t benchmark_meshes_simplify_triangle_count(const mesh& mesh, const vertex_format& format);
+  float benchmark_meshes_simplify_distance(const vec3& point, const vec3& a, const vec3& b, const vec3& c);
+
+  void benchmark_meshes_simplify()
+  {
+    benchmark_group("meshes/simplify");
+
+    // An icosphere with some bumps in it
+    auto sphere_options = shape_options { .divisions = 4 };
+    auto [ sphere_index_count, sphere_vertex_count ] = sphere_ico_counts(vertex_format_pnc, sphere_options);
+    auto sphere = mesh();
+    sphere.index_buffer = allocate(sphere_index_count * sizeof(uint32_t));
+    sphere.vertex_buffer = allocate(sphere_vertex_count * vertex_format_pnc.size);
+    sphere_ico(sphere, vertex_format_pnc, 0, 0, sphere_options);
+    for (auto vertex_index = uint32_t(0); vertex_index < sphere_vertex_count; vertex_index++)
+    {
+      auto& position = cast<vec3>(sphere.vertex_buffer, vertex_index * vertex_format_pnc.size + vertex_format_pnc.position_offset);
+      position *= 1.0f + 0.05f * std::sin(7.0f * position[0]) * std::sin(5.0f * position[1]) * std::sin(3.0f * position[2]);
+    }
+
+    benchmark_meshes_simplify_compare("bumpy icosphere", sphere, vertex_format_pnc, 400);
+
+    deallocate(sphere.index_buffer);
+    deallocate(sphere.vertex_buffer);
+
+    // The highest detail tree meshes are stored in the LOD format (two position-normal-color vertices back to back), the first vertex is the original
+    auto tree_format = vertex_format_pnc;
+    tree_format.size *= 2;
+
+    auto indices = allocate_heap(1024 * 1024);
+    auto vertices = allocate_heap(1024 * 1024);
+    for (auto tree_type : { "fruit", "oak", "palm", "pine" })
+    {
+      auto file_name = std::string(LUDO_BENCHMARKS_ASSET_FOLDER) + "/meshes/" + tree_type + "-tree-0.lmesh";
+      if (!std::ifstream(file_name).is_open())
+      {
+        continue;
+      }
+
+      auto tree = load(file_name, indices, vertices);
+      benchmark_meshes_simplify_compare(std::string(tree_type) + " tree", tree, tree_format, 200);
+
+      deallocate(indices, tree.index_buffer);
+      deallocate(vertices, tree.vertex_buffer);
+    }
+    deallocate(indices);
+    deallocate(vertices);
+  }
+
+  void benchmark_meshes_simplify_compare(const std::string& name, const mesh& source, const vertex_format& format, uint32_t iterations)
+  {
+    auto simplified = mesh();
+    simplified.index_buffer = allocate(source.index_buffer.size);
+    simplified.vertex_buffer = allocate(source.vertex_buffer.size);
+    auto reset = [&]()
+    {
+      std::memcpy(simplified.index_buffer.data, source.index_buffer.data, source.index_buffer.size);
+      std::memcpy(simplified.vertex_buffer.data, source.vertex_buffer.data, source.vertex_buffer.size);
+    };
+
+    benchmark_report(name + " (triangles)", benchmark_meshes_simplify_triangle_count(source, format), "triangles");
+
+    benchmark(name + " (collapse, " + std::to_string(iterations) + " iterations)", 10, [&]()
+    {
+      reset();
+      collapse(simplified, format, iterations);
+    });
+
+    // The new simplifier is given the same number of triangles to simplify down to (or half if collapse couldn't simplify the mesh at all)
+    auto triangle_count = benchmark_meshes_simplify_triangle_count(source, format);
+    auto target_triangle_count = benchmark_meshes_simplify_triangle_count(simplified, format);
+    benchmark_report(name + " (collapse, remaining triangles)", target_triangle_count, "triangles");
+    if (target_triangle_count == triangle_count)
+    {
+      target_triangle_count = triangle_count / 2;
+    }
+    benchmark_meshes_simplify_quality(name + " (collapse", source, simplified, format);
+
+    for (auto quadrics : { false, true })
+    {
+      auto simplify_name = name + (quadrics ? " (simplify quadrics" : " (simplify curvature");
+
+      auto remaining = uint32_t(0);
+      benchmark(simplify_name + ")", 10, [&]()
+      {
+        reset();
+        remaining = simplify(simplified, format, { .target_triangle_count = target_triangle_count, .quadrics = quadrics });
+      });
+
+      benchmark_report(simplify_name + ", remaining triangles)", remaining, "triangles");
+      benchmark_meshes_simplify_quality(simplify_name, source, simplified, format);
+    }
+
+    deallocate(simplified.index_buffer);
+    deallocate(simplified.vertex_buffer);
+  }
+
+  void benchmark_meshes_simplify_quality(const std::string& name, const mesh& source, const mesh& simplified, const vertex_format& format)
+  {
+    // The distance from each original vertex to the simplified surface
+    auto triangles = std::vector<std::array<vec3, 3>>();
+    auto index_stream = stream(simplified.index_buffer);
+    while (!ended(index_stream))
+    {
+      auto positions = std::array<vec3, 3>
+      {
+        cast<vec3>(simplified.vertex_buffer, read<uint32_t>(index_stream) * format.size + format.position_offset),
+        cast<vec3>(simplified.vertex_buffer, read<uint32_t>(index_stream) * format.size + format.position_offset),
+        cast<vec3>(simplified.vertex_buffer, read<uint32_t>(index_stream) * format.size + format.position_offset)
+      };
+
+      if (positions[0] != positions[1] && positions[1] != positions[2] && positions[2] != positions[0])
+      {
+        triangles.push_back(positions);
+      }
+    }
+
+    auto total_distance = 0.0f;
+    auto max_distance = 0.0f;
+    auto vertex_count = uint32_t(source.vertex_buffer.size / format.size);
+    for (auto vertex_index = uint32_t(0); vertex_index < vertex_count; vertex_index++)
+    {
+      auto& position = cast<vec3>(source.vertex_buffer, vertex_index * format.size + format.position_offset);
+
+      auto distance = std::numeric_limits<float>::max();
+      for (auto& triangle : triangles)
+      {
+        distance = std::min(distance, benchmark_meshes_simplify_distance(position, triangle[0], triangle[1], triangle[2]));
+      }
+
+      total_distance += distance;
+      max_distance = std::max(max_distance, distance);
+    }
+
+    benchmark_report(name + ", mean distance)", total_distance / static_cast<float>(vertex_count), "units");
+    benchmark_report(name + ", max distance)", max_distance, "units");
+  }
+
+  uint32_t benchmark_meshes_simplify_triangle_count(const mesh& mesh, const vertex_format& format)
+  {
+    auto count = uint32_t(0);
+
+    auto index_stream = stream(mesh.index_buffer);
+    while (!ended(index_stream))
+    {
+      auto& position_0 = cast<vec3>(mesh.vertex_buffer, read<uint32_t>(index_stream) * format.size + format.position_offset);
+      auto& position_1 = cast<vec3>(mesh.vertex_buffer, read<uint32_t>(index_stream) * format.size + format.position_offset);
+      auto& position_2 = cast<vec3>(mesh.vertex_buffer, read<uint32_t>(index_stream) * format.size + format.position_offset);
+
+      if (position_0 != position_1 && position_1 != position_2 && position_2 != position_0)
+      {
+        count++;
+      }
+    }
+
+    return count;
+  }
+
+  // Based on the closest point on a triangle from Real-Time Collision Detection (Ericson)
+  float benchmark_meshes_simplify_distance(const vec3& point, const vec3& a, const vec3& b, const vec3& c)
+  {
+    auto ab = b - a;
+    auto ac = c - a;
+    auto ap = point - a;
+
+    auto d1 = dot(ab, ap);
+    auto d2 = dot(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f)
+    {
+      return length(point - a);
+    }
+
+    auto bp = point - b;
+    auto d3 = dot(ab, bp);
+    auto d4 = dot(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3)
+    {
+      return length(point - b);
+    }
+
+    auto vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+    {
+      return length(point - (a + ab * (d1 / (d1 - d3))));
+    }
+
+    auto cp = point - c;
+    auto d5 = dot(ab, cp);
+    auto d6 = dot(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6)
+    {
+      return length(point - c);
+    }
+
+    auto vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+    {
+      return length(point - (a + ac * (d2 / (d2 - d6))));
+    }
+
+    auto va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+    {
+      return length(point - (b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)))));
+    }
+
+    auto denominator = 1.0f / (va + vb + vc);
+    return length(point - (a + ab * (vb * denominator) + ac * (vc * denominator)));
+  }
+}
@@ -0,0 +1,173 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+#include <ludo/benchmarking.h>
+#include <ludo/data/heaps.h>
+#include <ludo/meshes/clean.h>
+#include <ludo/meshes/util.h>
+
+#include "util.h"
+
+namespace ludo
+{
+  struct benchmark_meshes_vertex
+  {
+    vec3 position;
+    vec3 normal;
+    vec4 color;
+  };
+
+  void benchmark_meshes_util()
+  {
+    benchmark_group("meshes/util");
+
+    // The tree meshes are stored in the LOD format (two position-normal-color vertices back to back), only the first vertex is used here
+    auto source_format = vertex_format_pnc;
+    source_format.size *= 2;
+
+    // The triangle soups that would be passed to write_vertex when cleaning each tree mesh
+    auto soups = std::vector<std::vector<benchmark_meshes_vertex>>();
+    auto meshes = std::vector<mesh>();
+    auto indices = allocate_heap(1024 * 1024);
+    auto vertices = allocate_heap(1024 * 1024);
+    for (auto tree_type : { "fruit", "oak", "palm", "pine" })
+    {
+      for (auto lod_index = 0; lod_index < 3; lod_index++)
+      {
+        auto file_name = std::string(LUDO_BENCHMARKS_ASSET_FOLDER) + "/meshes/" + tree_type + "-tree-" + std::to_string(lod_index) + ".lmesh";
+        if (!std::ifstream(file_name).is_open())
+        {
+          continue;
+        }
+
+        auto& mesh = meshes.emplace_back(load(file_name, indices, vertices));
+        auto& soup = soups.emplace_back();
+        for (auto index_index = uint32_t(0); index_index < mesh.index_buffer.size / sizeof(uint32_t); index_index++)
+        {
+          auto byte_index = cast<uint32_t>(mesh.index_buffer, index_index * sizeof(uint32_t)) * source_format.size;
+          soup.push_back(
+          {
+            .position = cast<vec3>(mesh.vertex_buffer, byte_index + source_format.position_offset),
+            .normal = cast<vec3>(mesh.vertex_buffer, byte_index + source_format.normal_offset),
+            .color = cast<vec4>(mesh.vertex_buffer, byte_index + source_format.color_offset)
+          });
+        }
+      }
+    }
+
+    if (soups.empty())
+    {
+      benchmark_report("tree meshes (missing)", 0.0, "meshes");
+      return;
+    }
+
+    auto max_soup_size = uint32_t(0);
+    auto soup_size = uint32_t(0);
+    for (auto& soup : soups)
+    {
+      max_soup_size = std::max(max_soup_size, static_cast<uint32_t>(soup.size()));
+      soup_size += static_cast<uint32_t>(soup.size());
+    }
+    benchmark_report("tree meshes (count)", static_cast<double>(soups.size()), "meshes");
+    benchmark_report("tree meshes (indices)", static_cast<double>(soup_size), "indices");
+
+    auto destination = mesh();
+    destination.index_buffer = allocate(max_soup_size * sizeof(uint32_t));
+    destination.vertex_buffer = allocate(max_soup_size * vertex_format_pnc.size);
+
+    benchmark("write_vertex (tree meshes, linear search)", 100, [&]()
+    {
+      for (auto& soup : soups)
+      {
+        auto index_index = uint32_t(0);
+        auto vertex_index = uint32_t(0);
+        for (auto& vertex : soup)
+        {
+          write_vertex(destination, vertex_format_pnc, index_index, vertex_index, vertex.position, vertex.normal, vertex.color, vec2_zero);
+        }
+
+        benchmark_keep(vertex_index);
+      }
+    });
+
+    benchmark("write_vertex (tree meshes, welder)", 100, [&]()
+    {
+      for (auto& soup : soups)
+      {
+        auto welder = vertex_welder();
+        auto index_index = uint32_t(0);
+        auto vertex_index = uint32_t(0);
+        for (auto& vertex : soup)
+        {
+          write_vertex(destination, vertex_format_pnc, welder, index_index, vertex_index, vertex.position, vertex.normal, vertex.color, vec2_zero);
+        }
+
+        benchmark_keep(vertex_index);
+      }
+    });
+
+    // All of the tree meshes welded as one, where the cost of the linear search grows quadratically
+    auto combined_soup = std::vector<benchmark_meshes_vertex>();
+    for (auto& soup : soups)
+    {
+      combined_soup.insert(combined_soup.end(), soup.begin(), soup.end());
+    }
+
+    auto combined_destination = mesh();
+    combined_destination.index_buffer = allocate(combined_soup.size() * sizeof(uint32_t));
+    combined_destination.vertex_buffer = allocate(combined_soup.size() * vertex_format_pnc.size);
+
+    benchmark("write_vertex (combined tree meshes, linear search)", 5, [&]()
+    {
+      auto index_index = uint32_t(0);
+      auto vertex_index = uint32_t(0);
+      for (auto& vertex : combined_soup)
+      {
+        write_vertex(combined_destination, vertex_format_pnc, index_index, vertex_index, vertex.position, vertex.normal, vertex.color, vec2_zero);
+      }
+
+      benchmark_keep(vertex_index);
+    });
+
+    benchmark("write_vertex (combined tree meshes, welder)", 100, [&]()
+    {
+      auto welder = vertex_welder();
+      auto index_index = uint32_t(0);
+      auto vertex_index = uint32_t(0);
+      for (auto& vertex : combined_soup)
+      {
+        write_vertex(combined_destination, vertex_format_pnc, welder, index_index, vertex_index, vertex.position, vertex.normal, vertex.color, vec2_zero);
+      }
+
+      benchmark_keep(vertex_index);
+    });
+
+    deallocate(combined_destination.index_buffer);
+    deallocate(combined_destination.vertex_buffer);
+
+    benchmark("clean (tree meshes)", 100, [&]()
+    {
+      for (auto& mesh : meshes)
+      {
+        auto counts = clean(destination, mesh, vertex_format_pnc, source_format);
+        benchmark_keep(counts);
+      }
+    });
+
+    deallocate(destination.index_buffer);
+    deallocate(destination.vertex_buffer);
+
+    for (auto& mesh : meshes)
+    {
+      deallocate(indices, mesh.index_buffer);
+      deallocate(vertices, mesh.vertex_buffer);
+    }
+    deallocate(indices);
+    deallocate(vertices);
+  }
+}
@@ -0,0 +1,40 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <ludo/benchmarking.h>
+#include <ludo/profiling.h>
+
+#include "profiling.h"
+
+namespace ludo
+{
+  void benchmark_profiling()
+  {
+    benchmark_group("profiling");
+
+    auto calls = uint32_t(0);
+    benchmark("zone", 10000000, [&calls]()
+    {
+      auto zone = profile_zone("benchmark/zone");
+
+      // Keep the event ring from filling up
+      if (++calls % 1000 == 0)
+      {
+        profile_frame();
+      }
+    });
+
+    benchmark("profile_frame (1000 zones)", 10000, []()
+    {
+      for (auto index = 0; index < 1000; index++)
+      {
+        auto zone = profile_zone("benchmark/frame");
+      }
+
+      profile_frame();
+    });
+
+    clear_profile();
+  }
+}
@@ -0,0 +1,112 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <ludo/benchmarking.h>
+#include <ludo/spatial/grid3.h>
+#include <ludo/thread_pool.h>
+
+#include "grid3.h"
+
+namespace ludo
+{
+  void benchmark_spatial_grid3()
+  {
+    benchmark_group("grid3");
+
+    auto grids = allocate_array<grid3>(1);
+    auto grid = add(grids, { .bounds = { .min = { -1024.0f, -1024.0f, -1024.0f }, .max = { 1024.0f, 1024.0f, 1024.0f } }, .cell_count_1d = 32 });
+    init(*grid);
+
+    // 8 render meshes in every cell
+    auto render_mesh_count = uint32_t(0);
+    for (auto x = -1020.0f; x < 1024.0f; x += 32.0f)
+    {
+      for (auto y = -1020.0f; y < 1024.0f; y += 32.0f)
+      {
+        for (auto z = -1020.0f; z < 1024.0f; z += 32.0f)
+        {
+          add(*grid, { .id = ++render_mesh_count, .render_program_id = 1 }, { x, y, z });
+        }
+      }
+    }
+
+    // The same render meshes, added all at once to a grid with a Morton layout
+    auto render_meshes = std::vector<render_mesh>();
+    auto positions = std::vector<vec3>();
+    for (auto x = -1020.0f; x < 1024.0f; x += 32.0f)
+    {
+      for (auto y = -1020.0f; y < 1024.0f; y += 32.0f)
+      {
+        for (auto z = -1020.0f; z < 1024.0f; z += 32.0f)
+        {
+          render_meshes.push_back({ .id = static_cast<uint64_t>(render_meshes.size() + 1), .render_program_id = 1 });
+          positions.push_back({ x, y, z });
+        }
+      }
+    }
+
+    auto suffix = " (" + std::to_string(render_mesh_count) + " render meshes, 32768 cells)";
+
+    auto morton_grids = allocate_array<grid3>(1);
+    auto morton_grid = add(morton_grids, { .bounds = grid->bounds, .cell_count_1d = 32, .morton = true });
+    init(*morton_grid);
+
+    benchmark("add (one at a time)" + suffix, 10, [&]()
+    {
+      de_init(*grid);
+      init(*grid);
+      for (auto index = uint32_t(0); index < render_meshes.size(); index++)
+      {
+        add(*grid, render_meshes[index], positions[index]);
+      }
+    });
+
+    benchmark("add (all at once, morton)" + suffix, 10, [&]()
+    {
+      de_init(*morton_grid);
+      init(*morton_grid);
+      add(*morton_grid, render_meshes, positions);
+    });
+
+    auto render_programs = allocate_array<render_program>(1);
+    auto render_program = add(render_programs, { .id = 1, .command_buffer = allocate(render_mesh_count * sizeof(render_command)) });
+
+    auto camera = ludo::camera { .view = mat4_identity, .projection = perspective(60.0f, 16.0f / 9.0f, 0.1f, 1000.0f) };
+
+    auto serial_time = benchmark("add render commands" + suffix, 100, [&]()
+    {
+      render_program->active_commands.count = 0;
+      add_render_commands(grids, render_programs, camera);
+      benchmark_keep(render_program->active_commands.count);
+    });
+
+    benchmark("add render commands (morton)" + suffix, 100, [&]()
+    {
+      render_program->active_commands.count = 0;
+      add_render_commands(morton_grids, render_programs, camera);
+      benchmark_keep(render_program->active_commands.count);
+    });
+
+    thread_pool_start();
+
+    auto parallel_time = benchmark("add render commands (thread pool)" + suffix, 100, [&]()
+    {
+      render_program->active_commands.count = 0;
+      add_render_commands(grids, render_programs, camera);
+      benchmark_keep(render_program->active_commands.count);
+    });
+
+    thread_pool_stop();
+
+    benchmark_report("add render commands throughput", 32768 / serial_time, "cells/s");
+    benchmark_report("add render commands speedup (thread pool)", serial_time / parallel_time, "x");
+
+    deallocate(render_program->command_buffer);
+    deallocate(render_programs);
+    de_init(*morton_grid);
+    deallocate(morton_grids);
+    de_init(*grid);
+    deallocate(grids);
+  }
+}
@@ -0,0 +1,86 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <cmath>
+
+#include <ludo/benchmarking.h>
+#include <ludo/spatial/grid3.h>
+#include <ludo/spatial/loose_octree.h>
+
+#include "loose_octree.h"
+
+namespace ludo
+{
+  void benchmark_spatial_loose_octree()
+  {
+    benchmark_group("loose_octree");
+
+    // Render meshes clustered on the surface of a planet (like terrain chunks), spread with a Fibonacci lattice
+    auto render_mesh_count = uint32_t(5120);
+    auto planet_radius = 1000.0f;
+    auto bounds = aabb3 { .min = { -1024.0f, -1024.0f, -1024.0f }, .max = { 1024.0f, 1024.0f, 1024.0f } };
+
+    auto grids = allocate_array<grid3>(1);
+    auto grid = add(grids, { .bounds = bounds, .cell_count_1d = 16, .cell_capacity = 64 });
+    init(*grid);
+
+    auto octrees = allocate_array<loose_octree>(1);
+    auto octree = add(octrees, { .bounds = bounds });
+    init(*octree);
+
+    for (auto index = uint32_t(0); index < render_mesh_count; index++)
+    {
+      auto y = 1.0f - 2.0f * (static_cast<float>(index) + 0.5f) / static_cast<float>(render_mesh_count);
+      auto ring_radius = std::sqrt(1.0f - y * y);
+      auto angle = static_cast<float>(index) * pi * (3.0f - std::sqrt(5.0f));
+      auto position = vec3 { ring_radius * std::cos(angle), y, ring_radius * std::sin(angle) } * planet_radius;
+
+      auto render_mesh = ludo::render_mesh { .id = index + 1, .render_program_id = 1 };
+      add(*grid, render_mesh, position);
+      add(*octree, render_mesh, position, 20.0f);
+    }
+
+    auto render_programs = allocate_array<render_program>(1);
+    auto render_program = add(render_programs, { .id = 1, .command_buffer = allocate(render_mesh_count * sizeof(render_command)) });
+
+    // Above the surface, looking down at the planet
+    auto camera = ludo::camera { .view = mat4(vec3 { 0.0f, 0.0f, 1200.0f }, mat3_identity), .projection = perspective(60.0f, 16.0f / 9.0f, 0.1f, 2000.0f) };
+
+    auto suffix = " (" + std::to_string(render_mesh_count) + " render meshes)";
+
+    auto grid_visible_count = uint32_t(0);
+    benchmark("add render commands (grid3, 16^3 cells)" + suffix, 100, [&]()
+    {
+      render_program->active_commands.count = 0;
+      add_render_commands(grids, render_programs, camera);
+      grid_visible_count = render_program->active_commands.count;
+    });
+
+    auto octree_visible_count = uint32_t(0);
+    benchmark("add render commands (loose_octree)" + suffix, 100, [&]()
+    {
+      render_program->active_commands.count = 0;
+      add_render_commands(octrees, render_programs, camera);
+      octree_visible_count = render_program->active_commands.count;
+    });
+
+    auto octree_size = octree->nodes.size() * sizeof(loose_octree_node);
+    for (auto& node : octree->nodes)
+    {
+      octree_size += node.render_meshes.capacity() * sizeof(loose_octree_render_mesh);
+    }
+
+    benchmark_report("render commands (grid3)", grid_visible_count, "commands");
+    benchmark_report("render commands (loose_octree)", octree_visible_count, "commands");
+    benchmark_report("memory (grid3)", grid->buffer.back.size / 1024, "KiB");
+    benchmark_report("memory (loose_octree)", octree_size / 1024, "KiB");
+
+    deallocate(render_program->command_buffer);
+    deallocate(render_programs);
+    de_init(*octree);
+    deallocate(octrees);
+    de_init(*grid);
+    deallocate(grids);
+  }
+}
@@ -0,0 +1,107 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <ludo/benchmarking.h>
+#include <ludo/spatial/octree.h>
+
+#include "octree.h"
+
+namespace ludo
+{
+  void benchmark_spatial_octree()
+  {
+    benchmark_group("octree");
+
+    // 8 elements per cell, spread evenly over 32^3 cells
+    auto element_count_1d = uint32_t(64);
+    auto elements = std::vector<uint32_t>();
+    auto positions = std::vector<vec3>();
+    for (auto x = uint32_t(0); x < element_count_1d; x++)
+    {
+      for (auto y = uint32_t(0); y < element_count_1d; y++)
+      {
+        for (auto z = uint32_t(0); z < element_count_1d; z++)
+        {
+          elements.push_back(static_cast<uint32_t>(elements.size()));
+          positions.push_back(vec3 { static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f, static_cast<float>(z) + 0.5f });
+        }
+      }
+    }
+
+    // In a scattered order, as they would be if they were streamed in
+    auto random = uint32_t(1);
+    for (auto index = static_cast<uint32_t>(elements.size()) - 1; index > 0; index--)
+    {
+      random = random * 1664525 + 1013904223;
+      auto swap_index = random % (index + 1);
+      std::swap(elements[index], elements[swap_index]);
+      std::swap(positions[index], positions[swap_index]);
+    }
+
+    auto bounds = aabb3 { .min = { 0.0f, 0.0f, 0.0f }, .max = { 64.0f, 64.0f, 64.0f } };
+    auto octree = ludo::octree { .bounds = bounds, .divisions = 5 };
+    auto morton_octree = ludo::octree { .bounds = bounds, .divisions = 5, .morton = true };
+    init(octree);
+    init(morton_octree);
+
+    auto suffix = " (" + std::to_string(elements.size()) + " elements)";
+
+    benchmark("add (one at a time)" + suffix, 10, [&]()
+    {
+      de_init(octree);
+      init(octree);
+      for (auto index = uint32_t(0); index < elements.size(); index++)
+      {
+        add(octree, elements[index], positions[index]);
+      }
+    });
+
+    benchmark("add (all at once, morton)" + suffix, 10, [&]()
+    {
+      de_init(morton_octree);
+      init(morton_octree);
+      add(morton_octree, elements, positions);
+    });
+
+    // A region holding roughly a tenth of the elements, with a coarse node wholly inside it
+    auto region = aabb3 { .min = { 4.0f, 4.0f, 4.0f }, .max = { 34.0f, 34.0f, 34.0f } };
+    auto test = [&](const aabb3& bounds)
+    {
+      return contains(region, bounds) ? 1 : (intersect(region, bounds) ? 0 : -1);
+    };
+
+    auto function_count = std::size_t(0);
+    auto function_time = benchmark("find (std::function, std::vector)" + suffix, 100, [&]()
+    {
+      auto results = find(octree, test);
+      function_count = results.size();
+      benchmark_keep(results);
+    });
+
+    auto results = std::vector<uint32_t>(elements.size());
+    auto span_count = uint32_t(0);
+    auto span_time = benchmark("find (template, std::span)" + suffix, 100, [&]()
+    {
+      span_count = find(octree, test, std::span<uint32_t>(results));
+      benchmark_keep(results[0]);
+    });
+
+    auto morton_count = uint32_t(0);
+    auto morton_time = benchmark("find (template, std::span, morton)" + suffix, 100, [&]()
+    {
+      morton_count = find(morton_octree, test, std::span<uint32_t>(results));
+      benchmark_keep(results[0]);
+    });
+
+    benchmark_report("matching elements (std::function)", function_count, "elements");
+    benchmark_report("matching elements (template)", span_count, "elements");
+    benchmark_report("matching elements (template, morton)", morton_count, "elements");
+    benchmark_report("queries per second (std::function)", 1.0 / function_time, "queries");
+    benchmark_report("queries per second (template)", 1.0 / span_time, "queries");
+    benchmark_report("queries per second (template, morton)", 1.0 / morton_time, "queries");
+
+    de_init(morton_octree);
+    de_init(octree);
+  }
+}
@@ -0,0 +1,62 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <ludo/benchmarking.h>
+#include <ludo/spatial/quadtree.h>
+
+#include "quadtree.h"
+
+namespace ludo
+{
+  void benchmark_spatial_quadtree()
+  {
+    benchmark_group("quadtree");
+
+    // 4 elements per cell, spread evenly over 256^2 cells
+    auto element_count_1d = uint32_t(512);
+    auto quadtree = ludo::quadtree { .bounds = { .min = { 0.0f, 0.0f }, .max = { 512.0f, 512.0f } }, .divisions = 8 };
+    init(quadtree);
+
+    auto element = uint32_t(0);
+    for (auto x = uint32_t(0); x < element_count_1d; x++)
+    {
+      for (auto y = uint32_t(0); y < element_count_1d; y++)
+      {
+        add(quadtree, element++, vec2 { static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f });
+      }
+    }
+
+    // A region holding roughly a tenth of the elements, with a coarse node wholly inside it
+    auto region = aabb2 { .min = { 32.0f, 32.0f }, .max = { 192.0f, 192.0f } };
+    auto test = [&](const aabb2& bounds)
+    {
+      return contains(region, bounds) ? 1 : (intersect(region, bounds) ? 0 : -1);
+    };
+
+    auto suffix = " (" + std::to_string(element) + " elements)";
+
+    auto function_count = std::size_t(0);
+    auto function_time = benchmark("find (std::function, std::vector)" + suffix, 100, [&]()
+    {
+      auto results = find(quadtree, test);
+      function_count = results.size();
+      benchmark_keep(results);
+    });
+
+    auto results = std::vector<uint32_t>(element);
+    auto span_count = uint32_t(0);
+    auto span_time = benchmark("find (template, std::span)" + suffix, 100, [&]()
+    {
+      span_count = find(quadtree, test, std::span<uint32_t>(results));
+      benchmark_keep(results[0]);
+    });
+
+    benchmark_report("matching elements (std::function)", function_count, "elements");
+    benchmark_report("matching elements (template)", span_count, "elements");
+    benchmark_report("queries per second (std::function)", 1.0 / function_time, "queries");
+    benchmark_report("queries per second (template)", 1.0 / span_time, "queries");
+
+    de_init(quadtree);
+  }
+}
@@ -0,0 +1,60 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <cmath>
+#include <vector>
+
+#include <ludo/benchmarking.h>
+#include <ludo/thread_pool.h>
+
+#include "thread_pool.h"
+
+namespace ludo
+{
+  void benchmark_thread_pool()
+  {
+    benchmark_group("thread_pool");
+
+    thread_pool_start();
+
+    auto handles = std::vector<job_handle>(10000);
+    benchmark("enqueue and wait (10000 empty jobs)", 100, [&]()
+    {
+      for (auto& handle : handles)
+      {
+        handle = thread_pool_enqueue([]() {});
+      }
+
+      for (auto& handle : handles)
+      {
+        thread_pool_wait(handle);
+      }
+    });
+
+    auto values = std::vector<float>(1 << 22);
+    auto work = [&values](uint32_t start, uint32_t end)
+    {
+      for (auto index = start; index < end; index++)
+      {
+        values[index] = std::sqrt(static_cast<float>(index)) * std::sin(static_cast<float>(index));
+      }
+    };
+
+    auto serial_time = benchmark("serial for (4M elements)", 20, [&]()
+    {
+      work(0, static_cast<uint32_t>(values.size()));
+      benchmark_keep(values[0]);
+    });
+
+    auto parallel_time = benchmark("parallel_for (4M elements, batches of 16384)", 20, [&]()
+    {
+      thread_pool_wait(thread_pool_parallel_for(static_cast<uint32_t>(values.size()), 16384, work));
+      benchmark_keep(values[0]);
+    });
+
+    benchmark_report("parallel_for speedup", serial_time / parallel_time, "x");
+
+    thread_pool_stop();
+  }
+}
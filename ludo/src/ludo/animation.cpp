@@ -14,6 +14,10 @@ namespace ludo
   vec3 interpolate_position(float tick_time, const animation_node& animation_node);
   quat interpolate_rotation(float tick_time, const animation_node& animation_node);
   vec3 interpolate_scale(float tick_time, const animation_node& animation_node);
+  void interpolate(const animation_clip& animation_clip, float tick_time, mat4* node_transforms, mat4* final_transforms);
+  vec3 interpolate(const float* times, const vec3* values, uint32_t count, float tick_time);
+  quat interpolate(const float* times, const quat* values, uint32_t count, float tick_time);
+  uint32_t find_keyframe(const float* times, uint32_t count, float tick_time);
 
   void init(armature& armature)
   {
@@ -35,6 +39,16 @@ namespace ludo
     animation.id = 0;
   }
 
+  void init(animation_clip& animation_clip)
+  {
+    animation_clip.id = next_id++;
+  }
+
+  void de_init(animation_clip& animation_clip)
+  {
+    animation_clip.id = 0;
+  }
+
   // This function is based on this tutorial for Assimp animation: https://ogldev.org/www/tutorial38/tutorial38.html
   void interpolate(const animation& animation, const armature& armature, float time, mat4* final_transforms)
   {
@@ -169,4 +183,174 @@ namespace ludo
 
     return scale_keyframe.second + (next_scale_keyframe.second - scale_keyframe.second) * keyframe_time;
   }
+
+  animation_clip compile(const animation& animation, const armature& armature)
+  {
+    auto animation_clip = ludo::animation_clip { .ticks = animation.ticks, .ticks_per_second = animation.ticks_per_second };
+    auto animation_node_channel_indices = std::vector<int32_t>(animation.nodes.size(), -1);
+
+    // Flatten the armature depth first, in the same order it would be walked
+    auto armatures = std::vector<std::pair<const ludo::armature*, int32_t>> { { &armature, -1 } };
+    while (!armatures.empty())
+    {
+      auto [node, parent_index] = armatures.back();
+      armatures.pop_back();
+
+      auto node_index = static_cast<int32_t>(animation_clip.parent_indices.size());
+      animation_clip.parent_indices.push_back(parent_index);
+      animation_clip.bone_indices.push_back(node->bone_index);
+      animation_clip.transforms.push_back(node->transform);
+      animation_clip.bone_offsets.push_back(node->bone_offset);
+
+      auto channel_index = int32_t(-1);
+      if (node->bone_index != -1)
+      {
+        auto animation_node_iter = std::find_if(animation.nodes.begin(), animation.nodes.end(), [node](const ludo::animation_node& animation_node)
+        {
+          return animation_node.bone_index == node->bone_index;
+        });
+
+        if (animation_node_iter != animation.nodes.end())
+        {
+          auto& animation_node = *animation_node_iter;
+          auto& animation_node_channel_index = animation_node_channel_indices[animation_node_iter - animation.nodes.begin()];
+
+          if (animation_node_channel_index == -1)
+          {
+            assert(!animation_node.position_keyframes.empty() && "the node does not have any position keyframes");
+            assert(!animation_node.rotation_keyframes.empty() && "the node does not have any rotation keyframes");
+            assert(!animation_node.scale_keyframes.empty() && "the node does not have any scale keyframes");
+
+            animation_node_channel_index = static_cast<int32_t>(animation_clip.channels.size());
+            animation_clip.channels.push_back(
+            {
+              .position_start = static_cast<uint32_t>(animation_clip.positions.size()),
+              .position_count = static_cast<uint32_t>(animation_node.position_keyframes.size()),
+              .rotation_start = static_cast<uint32_t>(animation_clip.rotations.size()),
+              .rotation_count = static_cast<uint32_t>(animation_node.rotation_keyframes.size()),
+              .scale_start = static_cast<uint32_t>(animation_clip.scales.size()),
+              .scale_count = static_cast<uint32_t>(animation_node.scale_keyframes.size())
+            });
+
+            for (auto& [time, position] : animation_node.position_keyframes)
+            {
+              animation_clip.position_times.push_back(time);
+              animation_clip.positions.push_back(position);
+            }
+
+            for (auto& [time, rotation] : animation_node.rotation_keyframes)
+            {
+              animation_clip.rotation_times.push_back(time);
+              animation_clip.rotations.push_back(rotation);
+            }
+
+            for (auto& [time, scale] : animation_node.scale_keyframes)
+            {
+              animation_clip.scale_times.push_back(time);
+              animation_clip.scales.push_back(scale);
+            }
+          }
+
+          channel_index = animation_node_channel_index;
+        }
+      }
+
+      animation_clip.channel_indices.push_back(channel_index);
+
+      // Reversed so that the children are popped in order
+      for (auto child_iter = node->children.rbegin(); child_iter != node->children.rend(); child_iter++)
+      {
+        armatures.emplace_back(&*child_iter, node_index);
+      }
+    }
+
+    init(animation_clip);
+
+    return animation_clip;
+  }
+
+  void interpolate(const animation_clip& animation_clip, float time, mat4* final_transforms)
+  {
+    interpolate(animation_clip, &time, &final_transforms, 1);
+  }
+
+  void interpolate(const animation_clip& animation_clip, const float* times, mat4* const* final_transforms, uint32_t count)
+  {
+    auto node_transforms = std::vector<mat4>(animation_clip.parent_indices.size());
+
+    for (auto index = uint32_t(0); index < count; index++)
+    {
+      auto tick_time = std::fmod(times[index] * animation_clip.ticks_per_second, animation_clip.ticks);
+
+      interpolate(animation_clip, tick_time, node_transforms.data(), final_transforms[index]);
+    }
+  }
+
+  void interpolate(const animation_clip& animation_clip, float tick_time, mat4* node_transforms, mat4* final_transforms)
+  {
+    for (auto node_index = uint32_t(0); node_index < animation_clip.parent_indices.size(); node_index++)
+    {
+      auto parent_index = animation_clip.parent_indices[node_index];
+      auto& parent_transform = parent_index != -1 ? node_transforms[parent_index] : mat4_identity;
+
+      auto channel_index = animation_clip.channel_indices[node_index];
+      if (channel_index == -1)
+      {
+        node_transforms[node_index] = parent_transform * animation_clip.transforms[node_index];
+        continue;
+      }
+
+      auto& channel = animation_clip.channels[channel_index];
+      auto position = interpolate(&animation_clip.position_times[channel.position_start], &animation_clip.positions[channel.position_start], channel.position_count, tick_time);
+      auto rotation = interpolate(&animation_clip.rotation_times[channel.rotation_start], &animation_clip.rotations[channel.rotation_start], channel.rotation_count, tick_time);
+      auto scale = interpolate(&animation_clip.scale_times[channel.scale_start], &animation_clip.scales[channel.scale_start], channel.scale_count, tick_time);
+
+      // Equivalent to position_matrix * rotation_matrix * scale_matrix
+      auto local_transform = mat4(position, mat3(rotation));
+      for (auto column = 0; column < 3; column++)
+      {
+        for (auto row = 0; row < 3; row++)
+        {
+          local_transform[column * 4 + row] *= scale[column];
+        }
+      }
+
+      node_transforms[node_index] = parent_transform * local_transform;
+      final_transforms[animation_clip.bone_indices[node_index]] = node_transforms[node_index] * animation_clip.bone_offsets[node_index];
+    }
+  }
+
+  vec3 interpolate(const float* times, const vec3* values, uint32_t count, float tick_time)
+  {
+    if (count == 1)
+    {
+      return values[0];
+    }
+
+    auto index = find_keyframe(times, count, tick_time);
+    auto keyframe_time = (tick_time - times[index]) / (times[index + 1] - times[index]);
+
+    return values[index] + (values[index + 1] - values[index]) * keyframe_time;
+  }
+
+  quat interpolate(const float* times, const quat* values, uint32_t count, float tick_time)
+  {
+    if (count == 1)
+    {
+      return values[0];
+    }
+
+    auto index = find_keyframe(times, count, tick_time);
+    auto keyframe_time = (tick_time - times[index]) / (times[index + 1] - times[index]);
+
+    return slerp(values[index], values[index + 1], keyframe_time);
+  }
+
+  uint32_t find_keyframe(const float* times, uint32_t count, float tick_time)
+  {
+    // The last keyframe at or before the time, but never the last keyframe since there is nothing after it to interpolate towards
+    auto next_index = static_cast<uint32_t>(std::upper_bound(times, times + count, tick_time) - times);
+
+    return std::min(std::max(next_index, uint32_t(1)) - 1, count - 2);
+  }
 }
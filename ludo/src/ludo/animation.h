@@ -53,6 +53,43 @@ namespace ludo
     std::vector<animation_node> nodes; ///< The nodes that make up the animation.
   };
 
+  ///
+  /// The ranges of keyframes that animate a node of an animation clip.
+  struct animation_channel
+  {
+    uint32_t position_start = 0; ///< The index of the first position keyframe.
+    uint32_t position_count = 0; ///< The number of position keyframes.
+    uint32_t rotation_start = 0; ///< The index of the first rotation keyframe.
+    uint32_t rotation_count = 0; ///< The number of rotation keyframes.
+    uint32_t scale_start = 0; ///< The index of the first scale keyframe.
+    uint32_t scale_count = 0; ///< The number of scale keyframes.
+  };
+
+  ///
+  /// An animation compiled against an armature.
+  /// The armature is flattened into an array of nodes in topological order (parents before their children) and the keyframes of every channel are stored in flat arrays.
+  struct animation_clip
+  {
+    uint64_t id; ///< The ID of the animation clip.
+
+    float ticks = 0.0f; ///< The duration.
+    float ticks_per_second = 0.0f; ///< The speed to play at.
+
+    std::vector<int32_t> parent_indices; ///< The index of the parent of each node (or -1 for the root).
+    std::vector<int32_t> bone_indices; ///< The index of the bone represented by each node (or -1 if it does not represent a bone).
+    std::vector<mat4> transforms; ///< The transform of each node (used when it is not animated).
+    std::vector<mat4> bone_offsets; ///< The offset to the bone represented by each node.
+    std::vector<int32_t> channel_indices; ///< The index of the channel animating each node (or -1 if it is not animated).
+
+    std::vector<animation_channel> channels; ///< The channels.
+    std::vector<float> position_times; ///< The times of the position keyframes.
+    std::vector<vec3> positions; ///< The positions of the position keyframes.
+    std::vector<float> rotation_times; ///< The times of the rotation keyframes.
+    std::vector<quat> rotations; ///< The rotations of the rotation keyframes.
+    std::vector<float> scale_times; ///< The times of the scale keyframes.
+    std::vector<vec3> scales; ///< The scales of the scale keyframes.
+  };
+
   ///
   /// Initializes an armature.
   /// \param armature The armature.
@@ -80,4 +117,37 @@ namespace ludo
   /// \param time The time within the animation to interpolate to.
   /// \param final_transforms The result of the interpolation.
   void interpolate(const animation& animation, const armature& armature, float time, mat4* final_transforms);
+
+  ///
+  /// Initializes an animation clip.
+  /// \param animation_clip The animation clip.
+  void init(animation_clip& animation_clip);
+
+  ///
+  /// De-initializes an animation clip.
+  /// \param animation_clip The animation clip.
+  void de_init(animation_clip& animation_clip);
+
+  ///
+  /// Compiles an animation against an armature, so that it can be interpolated without searching the animation or walking the armature.
+  /// \param animation The animation to compile.
+  /// \param armature The armature to compile the animation against.
+  /// \return The (initialized) animation clip.
+  animation_clip compile(const animation& animation, const armature& armature);
+
+  ///
+  /// Interpolates an animation clip.
+  /// Keyframes are found with a binary search.
+  /// \param animation_clip The animation clip to interpolate.
+  /// \param time The time within the animation clip to interpolate to.
+  /// \param final_transforms The result of the interpolation.
+  void interpolate(const animation_clip& animation_clip, float time, mat4* final_transforms);
+
+  ///
+  /// Interpolates an animation clip for many instances at once, e.g. into the bone transforms of the instances of a render mesh.
+  /// \param animation_clip The animation clip to interpolate.
+  /// \param times The time within the animation clip to interpolate to for each instance.
+  /// \param final_transforms The results of the interpolation for each instance.
+  /// \param count The number of instances.
+  void interpolate(const animation_clip& animation_clip, const float* times, mat4* const* final_transforms, uint32_t count);
 }
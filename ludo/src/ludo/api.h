@@ -17,6 +17,7 @@
 #include "meshes/clean.h"
 #include "meshes/edit.h"
 #include "meshes/shapes.h"
+#include "meshes/simplify.h"
 #include "meshes/util.h"
 #include "importing.h"
 #include "input.h"
@@ -28,11 +29,13 @@
 #include "math/util.h"
 #include "math/vec.h"
 #include "physics.h"
+#include "profiling.h"
 #include "rendering.h"
 #include "scripts.h"
 #include "spatial/bounds.h"
 #include "spatial/grid2.h"
 #include "spatial/grid3.h"
+#include "spatial/loose_octree.h"
 #include "spatial/octree.h"
 #include "spatial/quadtree.h"
 #include "timer.h"
@@ -0,0 +1,25 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <iomanip>
+#include <iostream>
+
+#include "benchmarking.h"
+
+namespace ludo
+{
+  std::string benchmark_group_name;
+  const void* volatile benchmark_sink = nullptr;
+
+  void benchmark_group(const std::string& name)
+  {
+    benchmark_group_name = name;
+    std::cout << name << std::endl;
+  }
+
+  void benchmark_report(const std::string& name, double value, const std::string& unit)
+  {
+    std::cout << "  " << std::left << std::setw(64) << name << std::right << std::fixed << std::setprecision(3) << std::setw(16) << value << " " << unit << std::endl;
+  }
+}
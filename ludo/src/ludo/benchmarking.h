@@ -0,0 +1,39 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#pragma once
+
+#include <string>
+
+namespace ludo
+{
+  extern std::string benchmark_group_name;
+  extern const void* volatile benchmark_sink;
+
+  void benchmark_group(const std::string& name);
+
+  ///
+  /// Executes a function repeatedly and reports the average time taken per iteration.
+  /// \param name The name of the benchmark.
+  /// \param iterations The number of times to execute the function.
+  /// \param func The function to execute.
+  /// \return The average time (in seconds) taken per iteration.
+  template<typename F>
+  float benchmark(const std::string& name, uint64_t iterations, F func);
+
+  ///
+  /// Reports a value measured during a benchmark.
+  /// \param name The name of the value.
+  /// \param value The value.
+  /// \param unit The unit of the value.
+  void benchmark_report(const std::string& name, double value, const std::string& unit);
+
+  ///
+  /// Prevents the compiler from optimizing away the computation of a value.
+  /// \param value The value to keep.
+  template<typename T>
+  void benchmark_keep(const T& value);
+}
+
+#include "benchmarking.hpp"
@@ -0,0 +1,31 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include "benchmarking.h"
+#include "timer.h"
+
+namespace ludo
+{
+  template<typename F>
+  float benchmark(const std::string& name, uint64_t iterations, F func)
+  {
+    auto timer = ludo::timer();
+
+    for (auto iteration = uint64_t(0); iteration < iterations; iteration++)
+    {
+      func();
+    }
+
+    auto time = elapsed(timer) / static_cast<float>(iterations);
+    benchmark_report(name, time * 1000000000.0, "ns/op");
+
+    return time;
+  }
+
+  template<typename T>
+  void benchmark_keep(const T& value)
+  {
+    benchmark_sink = &value;
+  }
+}
@@ -2,19 +2,24 @@
  * This file is part of ludo. See the LICENSE file for the full license governing this code.
  */
 
+#include <algorithm>
 #include <vector>
 
 #include "core.h"
 #include "data/data.h"
+#include "profiling.h"
 #include "scripts.h"
+#include "thread_pool.h"
 #include "timer.h"
 
 namespace ludo
 {
-  uint64_t next_id = 1;
+  std::atomic<uint64_t> next_id = 1;
 
-  // TODO arghhh! global!
-  std::vector<float> total_script_times;
+  script_schedule& schedule_of(instance& instance);
+  void build_schedule(script_schedule& schedule, const array<script>& scripts);
+  void apply_deferred_changes(instance& instance, script_schedule& schedule);
+  bool declares_access(const script& script);
 
   void play(instance& instance)
   {
@@ -23,7 +28,12 @@ namespace ludo
     instance.playing = true;
     while (instance.playing)
     {
-      frame(instance);
+      {
+        auto zone = profile_zone("ludo::frame");
+        frame(instance);
+      }
+
+      profile_frame();
 
       instance.total_time = elapsed(total_timer);
     }
@@ -40,31 +50,219 @@ namespace ludo
 
     assert(exists<ludo::script>(instance) && "scripts not found");
     auto& scripts = data<ludo::script>(instance, "default");
+    auto script_count = scripts.length;
 
-    // Make a copy of the scripts array to allow for insert/removal of scripts from within a script.
-    auto scripts_copy = std::vector<ludo::script>(scripts.begin(), scripts.end());
+    auto& schedule = schedule_of(instance);
+    if (schedule.stale || schedule.dependencies.size() != script_count)
+    {
+      build_schedule(schedule, scripts);
+    }
+
+    // Scripts added/removed from within a script only take effect from the next frame, so the scripts stay in place while they are executing.
+    schedule.executing = true;
 
-    for (auto index = 0; index < scripts_copy.size(); index++)
+    auto concurrent = thread_pool_running();
+    auto handles = std::vector<job_handle>(script_count);
+    for (auto index = uint32_t(0); index < script_count; index++)
     {
-      auto timer = ludo::timer();
+      auto execute = [&instance, &scripts, index]()
+      {
+        auto zone = profile_zone(scripts[index].name);
 
-      scripts[index](instance);
+        scripts[index].function(instance);
+      };
 
-      if (total_script_times.size() < index)
+      if (!concurrent || schedule.exclusive[index])
       {
-        // Don't record the time. We're in no-man's land now...
+        for (auto& handle : handles)
+        {
+          thread_pool_wait(handle);
+        }
+
+        execute();
+        continue;
+      }
+
+      auto dependencies = std::vector<job_handle>();
+      for (auto dependency_index : schedule.dependencies[index])
+      {
+        if (!thread_pool_complete(handles[dependency_index]))
+        {
+          dependencies.emplace_back(handles[dependency_index]);
+        }
+      }
+
+      handles[index] = thread_pool_enqueue(execute, dependencies);
+    }
+
+    for (auto& handle : handles)
+    {
+      thread_pool_wait(handle);
+    }
+
+    schedule.executing = false;
+    apply_deferred_changes(instance, schedule);
+
+    instance.delta_time = elapsed(delta_timer);
+  }
+
+  script* add(instance& instance, const script& init, const std::string& partition)
+  {
+    auto& schedule = schedule_of(instance);
+    if (schedule.executing)
+    {
+      return &schedule.deferred_additions.emplace_back(init, partition).first;
+    }
+
+    schedule.stale = true;
+
+    return add(data<script>(instance), init, partition);
+  }
+
+  void remove(instance& instance, script* element, const std::string& partition)
+  {
+    auto& schedule = schedule_of(instance);
+    if (schedule.executing)
+    {
+      // Scripts added during the same frame are still pending.
+      auto addition_iter = std::find_if(schedule.deferred_additions.begin(), schedule.deferred_additions.end(), [element](const std::pair<script, std::string>& addition)
+      {
+        return &addition.first == element;
+      });
+
+      if (addition_iter != schedule.deferred_additions.end())
+      {
+        schedule.deferred_additions.erase(addition_iter);
       }
       else
       {
-        if (total_script_times.size() < index + 1)
+        schedule.deferred_removals.emplace_back(element, partition);
+      }
+
+      return;
+    }
+
+    if (!exists<script>(instance))
+    {
+      return;
+    }
+
+    schedule.stale = true;
+
+    remove(data<script>(instance), element, partition);
+  }
+
+  bool conflicts(const script& a, const script& b)
+  {
+    if (!declares_access(a) || !declares_access(b))
+    {
+      return true;
+    }
+
+    auto intersects = [](const std::vector<uint32_t>& a, const std::vector<uint32_t>& b)
+    {
+      return std::find_first_of(a.begin(), a.end(), b.begin(), b.end()) != a.end();
+    };
+
+    if (intersects(a.writes, b.writes) || intersects(a.writes, b.reads) || intersects(a.reads, b.writes))
+    {
+      return true;
+    }
+
+    // An access of a whole type covers the type within every partition.
+    auto covers = [](const std::vector<uint32_t>& type_indices, const std::vector<partition_access>& accesses)
+    {
+      return std::any_of(accesses.begin(), accesses.end(), [&type_indices](const partition_access& access)
+      {
+        return std::find(type_indices.begin(), type_indices.end(), access.type_index) != type_indices.end();
+      });
+    };
+
+    if (covers(a.writes, b.partition_reads) || covers(a.writes, b.partition_writes) || covers(a.reads, b.partition_writes) ||
+        covers(b.writes, a.partition_reads) || covers(b.writes, a.partition_writes) || covers(b.reads, a.partition_writes))
+    {
+      return true;
+    }
+
+    auto overlaps = [](const std::vector<partition_access>& a, const std::vector<partition_access>& b)
+    {
+      return std::find_first_of(a.begin(), a.end(), b.begin(), b.end(), [](const partition_access& a, const partition_access& b)
+      {
+        return a.type_index == b.type_index && a.partition == b.partition;
+      }) != a.end();
+    };
+
+    return overlaps(a.partition_writes, b.partition_writes) || overlaps(a.partition_writes, b.partition_reads) || overlaps(a.partition_reads, b.partition_writes);
+  }
+
+  bool declares_access(const script& script)
+  {
+    return !script.reads.empty() || !script.writes.empty() || !script.partition_reads.empty() || !script.partition_writes.empty();
+  }
+
+  script_schedule& schedule_of(instance& instance)
+  {
+    if (!instance.schedule)
+    {
+      instance.schedule = std::make_shared<script_schedule>();
+    }
+
+    return *instance.schedule;
+  }
+
+  void build_schedule(script_schedule& schedule, const array<script>& scripts)
+  {
+    schedule.exclusive.assign(scripts.length, false);
+    schedule.dependencies.assign(scripts.length, {});
+
+    // Exclusive scripts wait for every earlier script, so later scripts only need to wait for the conflicting scripts since the last of them.
+    auto first_index = uint32_t(0);
+    for (auto index = uint32_t(0); index < scripts.length; index++)
+    {
+      if (!declares_access(scripts[index]))
+      {
+        schedule.exclusive[index] = true;
+        first_index = index + 1;
+        continue;
+      }
+
+      // Conflicting scripts are executed in the order they were added.
+      for (auto other_index = first_index; other_index < index; other_index++)
+      {
+        if (conflicts(scripts[other_index], scripts[index]))
         {
-          total_script_times.emplace_back();
+          schedule.dependencies[index].emplace_back(other_index);
         }
+      }
+    }
+
+    schedule.stale = false;
+  }
+
+  void apply_deferred_changes(instance& instance, script_schedule& schedule)
+  {
+    // Removing the scripts furthest into the array first leaves the positions of the other scripts to be removed unchanged.
+    std::sort(schedule.deferred_removals.begin(), schedule.deferred_removals.end(), [](const std::pair<script*, std::string>& a, const std::pair<script*, std::string>& b)
+    {
+      return a.first > b.first;
+    });
 
-        total_script_times[index] += elapsed(timer);
+    auto last_element = static_cast<script*>(nullptr);
+    for (auto& [element, partition] : schedule.deferred_removals)
+    {
+      if (element != last_element)
+      {
+        remove(instance, element, partition);
+        last_element = element;
       }
     }
 
-    instance.delta_time = elapsed(delta_timer);
+    for (auto& [init, partition] : schedule.deferred_additions)
+    {
+      add(instance, init, partition);
+    }
+
+    schedule.deferred_removals.clear();
+    schedule.deferred_additions.clear();
   }
 }
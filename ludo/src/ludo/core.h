@@ -4,14 +4,18 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
 #include <string>
-#include <unordered_map>
+#include <vector>
 
 namespace ludo
 {
   ///
   /// A counter used to provide unique IDs.
-  extern uint64_t next_id;
+  extern std::atomic<uint64_t> next_id;
+
+  struct script_schedule;
 
   ///
   /// An instance of ludo.
@@ -22,7 +26,10 @@ namespace ludo
     float delta_time = 0.0f; ///< The elapsed time since the last frame.
     float total_time = 0.0f; ///< The elapsed time since ludo started playing.
 
-    std::unordered_map<std::string, void*> data; ///< The data of the instance.
+    std::vector<void*> data; ///< The data of the instance (indexed by type index, see ludo::type_index).
+    std::vector<std::pair<std::string, void*>> heaps; ///< The named heaps of the instance.
+
+    std::shared_ptr<script_schedule> schedule; ///< The cached order in which the scripts of the instance are executed (see ludo::frame).
   };
 
   ///
@@ -40,6 +47,8 @@ namespace ludo
 
   ///
   /// Executes a single frame.
+  /// Scripts that don't conflict (see ludo::script) are executed concurrently if the thread pool is running.
+  /// Scripts added or removed during the frame take effect from the next frame.
   /// @param instance The instance to execute a frame of.
   void frame(instance& instance);
 }
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <unordered_map>
 #include <vector>
 
 #include "buffers.h"
@@ -32,12 +34,44 @@ namespace ludo
     const T* cend() const;
   };
 
+  ///
+  /// A handle to an element within a partitioned array that remains valid across additions/removals (see use_swapping()).
+  struct handle
+  {
+    uint32_t index = 0; ///< The index of the handle slot.
+    uint32_t generation = 0; ///< The generation of the handle slot at the time the handle was created.
+  };
+
+  ///
+  /// A slot referred to by handles.
+  struct handle_slot
+  {
+    uint32_t position = 0; ///< The position of the element within the partitioned array.
+    uint32_t generation = 1; ///< The current generation, incremented each time the slot is released.
+  };
+
+  ///
+  /// The location of an element within a partitioned array.
+  struct partitioned_location
+  {
+    uint32_t partition_index = 0; ///< The index of the partition containing the element.
+    uint32_t index = 0; ///< The index of the element within the partition.
+  };
+
   ///
   /// A array that maintains named "partitions". Partitions are just named sections of the array.
   template<typename T>
   struct partitioned_array : public array<T>
   {
     std::vector<std::pair<std::string, array<T>>> partitions; ///< The partitions within the array.
+
+    bool id_indexed = false; ///< Determines if the IDs of the elements are indexed, see index_ids().
+    std::unordered_map<uint64_t, partitioned_location> id_index; ///< The locations of the elements by ID.
+
+    bool swapping = false; ///< Determines if elements are added/removed by swapping rather than shifting, see use_swapping().
+    std::vector<handle_slot> handle_slots; ///< The slots referred to by handles.
+    std::vector<uint32_t> free_handle_slots; ///< The indices of slots available for reuse.
+    std::vector<uint32_t> element_handle_slots; ///< The slot index of the element at each position.
   };
 
   ///
@@ -81,6 +115,14 @@ namespace ludo
   template<typename T>
   void remove(array<T>& array, T* element);
 
+  ///
+  /// Removes an element from an array by moving the last element into its place.
+  /// This is constant time but does not preserve the order of the elements.
+  /// \param array The array to remove the element from.
+  /// \param element The element to be removed.
+  template<typename T>
+  void swap_remove(array<T>& array, T* element);
+
   ///
   /// Removes all elements from an array.
   /// \param array The array to remove all elements from.
@@ -145,6 +187,61 @@ namespace ludo
   template<typename T>
   typename std::vector<std::pair<std::string, array<T>>>::const_iterator find(const partitioned_array<T>& array, const std::string& partition);
 
+  ///
+  /// Switches a partitioned array to swapping storage.
+  /// Additions and removals move at most one element per partition instead of shifting all subsequent elements,
+  /// and elements can be referred to by handles that remain valid across additions/removals.
+  /// Elements remain contiguous within their partitions but their order is not preserved.
+  /// Pointers to elements are still invalidated by additions/removals, use handles to refer to elements over time.
+  /// \param array The partitioned array to switch to swapping storage.
+  template<typename T>
+  void use_swapping(partitioned_array<T>& array);
+
+  ///
+  /// Retrieves a handle to an element within a partitioned array using swapping storage.
+  /// \param array The partitioned array containing the element.
+  /// \param element The element.
+  /// \return The handle.
+  template<typename T>
+  handle handle_of(const partitioned_array<T>& array, const T* element);
+
+  ///
+  /// Retrieves the element referred to by a handle.
+  /// \param array The partitioned array containing the element.
+  /// \param handle The handle.
+  /// \return The element or nullptr if it has been removed.
+  template<typename T>
+  T* get(partitioned_array<T>& array, handle handle);
+  template<typename T>
+  const T* get(const partitioned_array<T>& array, handle handle);
+
+  ///
+  /// Indexes the IDs of the elements within a partitioned array to provide constant time lookup by ID.
+  /// The index is maintained through subsequent additions/removals, so lookups never modify the array (and can be made concurrently).
+  /// The IDs of elements must be assigned (non-zero and unique) before they are added and must not change while they are in the array.
+  /// Changing the ID of an element in place leaves the index stale (asserted in debug builds), remove it and add it again instead.
+  /// Cannot be combined with swapping storage (see use_swapping()).
+  /// \param array The partitioned array to index.
+  template<typename T>
+  void index_ids(partitioned_array<T>& array);
+
+  ///
+  /// Finds an element with the given ID within a partitioned array.
+  /// Uses the ID index if the array has one (IDs missing from the index are not found), otherwise searches linearly.
+  /// When a partition is given, only the elements within that partition are searched.
+  /// \param array The partitioned array to search.
+  /// \param partition The name of the partition.
+  /// \param id The ID to search for.
+  /// \return The element or nullptr if it is not found.
+  template<typename T>
+  T* find_by_id(partitioned_array<T>& array, uint64_t id);
+  template<typename T>
+  const T* find_by_id(const partitioned_array<T>& array, uint64_t id);
+  template<typename T>
+  T* find_by_id(partitioned_array<T>& array, const std::string& partition, uint64_t id);
+  template<typename T>
+  const T* find_by_id(const partitioned_array<T>& array, const std::string& partition, uint64_t id);
+
   ///
   /// Finds a partition within a partitioned array. If the partition does not exist, it creates it.
   /// \param array The partitioned array containing the partition.
@@ -4,11 +4,25 @@
 
 #include <cassert>
 #include <cstring>
+#include <memory>
+#include <type_traits>
 
 #include "arrays.h"
 
 namespace ludo
 {
+  template<typename T>
+  void relocate(T* from, T* to, std::size_t count);
+
+  template<typename T>
+  void move_element(partitioned_array<T>& array, T* from, T* to);
+
+  template<typename T>
+  void acquire_handle_slot(partitioned_array<T>& array, uint32_t position);
+
+  template<typename T>
+  void release_handle_slot(partitioned_array<T>& array, uint32_t position);
+
   template<typename T>
   T& array<T>::operator[](uint32_t index)
   {
@@ -141,7 +155,25 @@ namespace ludo
     assert(array.capacity && "array not allocated (partitions of partitioned arrays cannot be modified directly)");
     assert(element >= array.data && element < array.data + array.length && "element out of range");
 
-    std::memmove(element, element + 1, (array.data + array.length - (element + 1)) * sizeof(T));
+    std::destroy_at(element);
+    relocate(element + 1, element, array.data + array.length - (element + 1));
+
+    array.length--;
+  }
+
+  template<typename T>
+  void swap_remove(array<T>& array, T* element)
+  {
+    assert(array.capacity && "array not allocated (partitions of partitioned arrays cannot be modified directly)");
+    assert(element >= array.data && element < array.data + array.length && "element out of range");
+
+    std::destroy_at(element);
+
+    auto last = array.data + array.length - 1;
+    if (element != last)
+    {
+      relocate(last, element, 1);
+    }
 
     array.length--;
   }
@@ -196,6 +228,10 @@ namespace ludo
     array.capacity = 0;
     array.length = 0;
     array.partitions.clear();
+    array.id_index.clear();
+    array.handle_slots.clear();
+    array.free_handle_slots.clear();
+    array.element_handle_slots.clear();
   }
 
   template<typename T>
@@ -214,6 +250,10 @@ namespace ludo
     array.capacity = 0;
     array.length = 0;
     array.partitions.clear();
+    array.id_index.clear();
+    array.handle_slots.clear();
+    array.free_handle_slots.clear();
+    array.element_handle_slots.clear();
   }
 
   template<typename T>
@@ -221,21 +261,65 @@ namespace ludo
   {
     assert(array.length < array.capacity && "array is full");
 
+    if constexpr (requires { init.id; })
+    {
+      if (array.id_indexed)
+      {
+        assert(init.id && "indexed elements must be initialized (given an ID) before they are added");
+        assert(!array.id_index.contains(init.id) && "indexed elements must have unique IDs");
+      }
+    }
+
     auto partition_iter = find_or_create(array, partition);
 
-    std::memmove(partition_iter->second.end() + 1, partition_iter->second.end(), (array.end() - partition_iter->second.end()) * sizeof(T));
+    if (array.swapping)
+    {
+      // Make room at the end of the partition by moving the first element of each subsequent partition to its end.
+      for (auto later_partition_iter = array.partitions.end() - 1; later_partition_iter > partition_iter; later_partition_iter--)
+      {
+        auto& later_partition = later_partition_iter->second;
+        if (later_partition.length)
+        {
+          move_element(array, later_partition.begin(), later_partition.end());
+        }
+
+        later_partition.data++;
+      }
+    }
+    else
+    {
+      relocate(partition_iter->second.end(), partition_iter->second.end() + 1, array.end() - partition_iter->second.end());
+
+      std::for_each(partition_iter + 1, array.partitions.end(), [](std::pair<std::string, ludo::array<T>>& element)
+      {
+        element.second.data++;
+      });
+    }
 
     auto element = partition_iter->second.end();
     std::uninitialized_copy(&init, &init + 1, element);
 
     partition_iter->second.length++;
 
-    std::for_each(partition_iter + 1, array.partitions.end(), [](std::pair<std::string, ludo::array<T>>& element)
+    array.length++;
+
+    if (array.swapping)
     {
-      element.second.data++;
-    });
+      acquire_handle_slot(array, static_cast<uint32_t>(element - array.data));
+    }
 
-    array.length++;
+    if constexpr (requires { element->id; })
+    {
+      if (array.id_indexed)
+      {
+        // Locations are relative to partitions, so the elements of later partitions shifted above keep theirs.
+        array.id_index[element->id] =
+        {
+          .partition_index = static_cast<uint32_t>(partition_iter - array.partitions.begin()),
+          .index = partition_iter->second.length - 1
+        };
+      }
+    }
 
     return element;
   }
@@ -251,7 +335,47 @@ namespace ludo
 
     assert(element >= partition_iter->second.begin() && element < partition_iter->second.end() && "element out of range");
 
-    std::memmove(element, element + 1, (array.data + array.length - (element + 1)) * sizeof(T));
+    if (array.swapping)
+    {
+      release_handle_slot(array, static_cast<uint32_t>(element - array.data));
+      std::destroy_at(element);
+
+      auto& partition_array = partition_iter->second;
+      auto last = partition_array.end() - 1;
+      if (element != last)
+      {
+        move_element(array, last, element);
+      }
+
+      partition_array.length--;
+
+      // Close the gap at the end of the partition by moving the last element of each subsequent partition to its start.
+      for (auto later_partition_iter = partition_iter + 1; later_partition_iter < array.partitions.end(); later_partition_iter++)
+      {
+        auto& later_partition = later_partition_iter->second;
+        if (later_partition.length)
+        {
+          move_element(array, later_partition.end() - 1, later_partition.begin() - 1);
+        }
+
+        later_partition.data--;
+      }
+
+      array.length--;
+
+      return;
+    }
+
+    if constexpr (requires { element->id; })
+    {
+      if (array.id_indexed)
+      {
+        array.id_index.erase(element->id);
+      }
+    }
+
+    std::destroy_at(element);
+    relocate(element + 1, element, array.data + array.length - (element + 1));
 
     partition_iter->second.length--;
 
@@ -261,13 +385,196 @@ namespace ludo
     });
 
     array.length--;
+
+    if constexpr (requires { element->id; })
+    {
+      if (array.id_indexed)
+      {
+        // Only the elements after the removed element within the same partition have moved relative to their partition.
+        auto partition_index = static_cast<uint32_t>(partition_iter - array.partitions.begin());
+        auto& partition_array = partition_iter->second;
+        for (auto index = static_cast<uint32_t>(element - partition_array.data); index < partition_array.length; index++)
+        {
+          array.id_index[partition_array.data[index].id] = { .partition_index = partition_index, .index = index };
+        }
+      }
+    }
   }
 
   template<typename T>
   void clear(partitioned_array<T>& array)
   {
+    if (array.swapping)
+    {
+      for (auto position = uint32_t(0); position < array.length; position++)
+      {
+        release_handle_slot(array, position);
+      }
+    }
+
     array.length = 0;
     array.partitions.clear();
+    array.id_index.clear();
+  }
+
+  template<typename T>
+  void use_swapping(partitioned_array<T>& array)
+  {
+    assert(!array.id_indexed && "swapping storage cannot be combined with an ID index");
+
+    array.swapping = true;
+    array.handle_slots.clear();
+    array.free_handle_slots.clear();
+    array.element_handle_slots.assign(array.capacity, 0);
+
+    for (auto position = uint32_t(0); position < array.length; position++)
+    {
+      acquire_handle_slot(array, position);
+    }
+  }
+
+  template<typename T>
+  handle handle_of(const partitioned_array<T>& array, const T* element)
+  {
+    assert(array.swapping && "handles require swapping storage");
+    assert(element >= array.data && element < array.data + array.length && "element out of range");
+
+    auto slot_index = array.element_handle_slots[element - array.data];
+    return { .index = slot_index, .generation = array.handle_slots[slot_index].generation };
+  }
+
+  template<typename T>
+  T* get(partitioned_array<T>& array, handle handle)
+  {
+    return const_cast<T*>(get(const_cast<const partitioned_array<T>&>(array), handle));
+  }
+
+  template<typename T>
+  const T* get(const partitioned_array<T>& array, handle handle)
+  {
+    if (handle.index >= array.handle_slots.size())
+    {
+      return nullptr;
+    }
+
+    auto& slot = array.handle_slots[handle.index];
+    if (slot.generation != handle.generation)
+    {
+      return nullptr;
+    }
+
+    return array.data + slot.position;
+  }
+
+  template<typename T>
+  void index_ids(partitioned_array<T>& array)
+  {
+    assert(!array.swapping && "an ID index cannot be combined with swapping storage");
+
+    array.id_indexed = true;
+    array.id_index.clear();
+
+    for (auto partition_index = uint32_t(0); partition_index < array.partitions.size(); partition_index++)
+    {
+      auto& partition_array = array.partitions[partition_index].second;
+      for (auto index = uint32_t(0); index < partition_array.length; index++)
+      {
+        array.id_index[partition_array.data[index].id] = { .partition_index = partition_index, .index = index };
+      }
+    }
+  }
+
+  template<typename T>
+  T* find_by_id(partitioned_array<T>& array, uint64_t id)
+  {
+    return const_cast<T*>(find_by_id(const_cast<const partitioned_array<T>&>(array), id));
+  }
+
+  template<typename T>
+  const T* find_by_id(const partitioned_array<T>& array, uint64_t id)
+  {
+    if (array.id_indexed)
+    {
+      auto location_iter = array.id_index.find(id);
+      if (location_iter == array.id_index.end())
+      {
+        return nullptr;
+      }
+
+      auto& location = location_iter->second;
+      auto& partition_array = array.partitions[location.partition_index].second;
+      assert(location.index < partition_array.length && partition_array.data[location.index].id == id && "the IDs of indexed elements must not change");
+      if (location.index >= partition_array.length || partition_array.data[location.index].id != id)
+      {
+        return nullptr;
+      }
+
+      return partition_array.data + location.index;
+    }
+
+    for (auto partition_index = uint32_t(0); partition_index < array.partitions.size(); partition_index++)
+    {
+      auto& partition_array = array.partitions[partition_index].second;
+      for (auto index = uint32_t(0); index < partition_array.length; index++)
+      {
+        if (partition_array.data[index].id == id)
+        {
+          return partition_array.data + index;
+        }
+      }
+    }
+
+    return nullptr;
+  }
+
+  template<typename T>
+  T* find_by_id(partitioned_array<T>& array, const std::string& partition, uint64_t id)
+  {
+    return const_cast<T*>(find_by_id(const_cast<const partitioned_array<T>&>(array), partition, id));
+  }
+
+  template<typename T>
+  const T* find_by_id(const partitioned_array<T>& array, const std::string& partition, uint64_t id)
+  {
+    auto partition_iter = find(array, partition);
+    if (partition_iter == array.partitions.end())
+    {
+      return nullptr;
+    }
+
+    auto& partition_array = partition_iter->second;
+    if (array.id_indexed)
+    {
+      auto location_iter = array.id_index.find(id);
+      if (location_iter == array.id_index.end())
+      {
+        return nullptr;
+      }
+
+      auto& location = location_iter->second;
+      if (location.partition_index != uint32_t(partition_iter - array.partitions.begin()))
+      {
+        return nullptr;
+      }
+
+      assert(location.index < partition_array.length && partition_array.data[location.index].id == id && "the IDs of indexed elements must not change");
+      if (location.index >= partition_array.length || partition_array.data[location.index].id != id)
+      {
+        return nullptr;
+      }
+
+      return partition_array.data + location.index;
+    }
+
+    for (auto index = uint32_t(0); index < partition_array.length; index++)
+    {
+      if (partition_array.data[index].id == id)
+      {
+        return partition_array.data + index;
+      }
+    }
+
+    return nullptr;
   }
 
   template<typename T>
@@ -304,4 +611,60 @@ namespace ludo
 
     return partition_iter;
   }
+
+  template<typename T>
+  void relocate(T* from, T* to, std::size_t count)
+  {
+    if constexpr (std::is_trivially_copyable_v<T>)
+    {
+      std::memmove(to, from, count * sizeof(T));
+    }
+    else
+    {
+      // Elements that refer to their own storage (e.g. strings holding short names inline) cannot be moved as raw bytes.
+      // Relocating one element at a time in the direction of the move means each destination is vacant when it is constructed.
+      for (auto offset = std::size_t(0); offset < count; offset++)
+      {
+        auto index = to < from ? offset : count - 1 - offset;
+        std::construct_at(to + index, std::move(from[index]));
+        std::destroy_at(from + index);
+      }
+    }
+  }
+
+  template<typename T>
+  void move_element(partitioned_array<T>& array, T* from, T* to)
+  {
+    relocate(from, to, 1);
+
+    auto slot_index = array.element_handle_slots[from - array.data];
+    array.element_handle_slots[to - array.data] = slot_index;
+    array.handle_slots[slot_index].position = static_cast<uint32_t>(to - array.data);
+  }
+
+  template<typename T>
+  void acquire_handle_slot(partitioned_array<T>& array, uint32_t position)
+  {
+    auto slot_index = static_cast<uint32_t>(array.handle_slots.size());
+    if (array.free_handle_slots.empty())
+    {
+      array.handle_slots.emplace_back();
+    }
+    else
+    {
+      slot_index = array.free_handle_slots.back();
+      array.free_handle_slots.pop_back();
+    }
+
+    array.handle_slots[slot_index].position = position;
+    array.element_handle_slots[position] = slot_index;
+  }
+
+  template<typename T>
+  void release_handle_slot(partitioned_array<T>& array, uint32_t position)
+  {
+    auto slot_index = array.element_handle_slots[position];
+    array.handle_slots[slot_index].generation++;
+    array.free_handle_slots.push_back(slot_index);
+  }
 }
@@ -8,20 +8,28 @@
 
 namespace ludo
 {
+  std::atomic<uint32_t> next_type_index = 0;
+
+  std::vector<std::pair<std::string, void*>>::const_iterator find_heap(const instance& instance, std::string_view name);
+
   heap& allocate_heap(instance& instance, const std::string& name, uint64_t size)
   {
-    auto key = heap_key(name);
-    instance.data[key] = new heap(allocate_heap(size));
+    assert(find_heap(instance, name) == instance.heaps.end() && "heap already exists");
+
+    auto heap = new ludo::heap(allocate_heap(size));
+    instance.heaps.emplace_back(name, heap);
 
-    return *static_cast<heap*>(instance.data[key]);
+    return *heap;
   }
 
   heap& allocate_heap_vram(instance& instance, const std::string& name, uint64_t size, vram_buffer_access_hint access_hint)
   {
-    auto key = heap_key(name);
-    instance.data[key] = new heap(allocate_heap_vram(size, access_hint));
+    assert(find_heap(instance, name) == instance.heaps.end() && "heap already exists");
 
-    return *static_cast<heap*>(instance.data[key]);
+    auto heap = new ludo::heap(allocate_heap_vram(size, access_hint));
+    instance.heaps.emplace_back(name, heap);
+
+    return *heap;
   }
 
   void deallocate_heap(instance& instance, const std::string& name)
@@ -29,7 +37,7 @@ namespace ludo
     auto& heap = data_heap(instance, name);
     deallocate(heap);
 
-    instance.data.erase(heap_key(name));
+    instance.heaps.erase(find_heap(instance, name));
     delete &heap;
   }
 
@@ -38,26 +46,29 @@ namespace ludo
     auto& heap = data_heap(instance, name);
     deallocate_vram(heap);
 
-    instance.data.erase(heap_key(name));
+    instance.heaps.erase(find_heap(instance, name));
     delete &heap;
   }
 
-  heap& data_heap(instance& instance, const std::string& name)
+  heap& data_heap(instance& instance, std::string_view name)
   {
-    assert(instance.data.find(heap_key(name)) != instance.data.end() && "heap not found");
-
-    return *static_cast<heap*>(instance.data.at(heap_key(name)));
+    return const_cast<heap&>(data_heap(const_cast<const ludo::instance&>(instance), name));
   }
 
-  const heap& data_heap(const instance& instance, const std::string& name)
+  const heap& data_heap(const instance& instance, std::string_view name)
   {
-    assert(instance.data.find(heap_key(name)) != instance.data.end() && "heap not found");
+    auto heap_iter = find_heap(instance, name);
+    assert(heap_iter != instance.heaps.end() && "heap not found");
 
-    return *static_cast<const heap*>(instance.data.at(heap_key(name)));
+    return *static_cast<const heap*>(heap_iter->second);
   }
 
-  std::string heap_key(const std::string& name)
+  std::vector<std::pair<std::string, void*>>::const_iterator find_heap(const instance& instance, std::string_view name)
   {
-    return std::string("ludo::heap::") + name;
+    // There are only ever a handful of heaps so a linear search beats hashing the name.
+    return std::find_if(instance.heaps.begin(), instance.heaps.end(), [&name](const std::pair<std::string, void*>& element)
+    {
+      return element.first == name;
+    });
   }
 }
@@ -4,10 +4,17 @@
 
 #pragma once
 
+#include <atomic>
+#include <string_view>
+
 #include "heaps.h"
 
 namespace ludo
 {
+  ///
+  /// A counter used to provide unique type indices.
+  extern std::atomic<uint32_t> next_type_index;
+
   ///
   /// Allocates capacity for a particular type of data within an instance.
   /// \param instance The instance to allocate capacity within.
@@ -77,6 +84,7 @@ namespace ludo
 
   ///
   /// Retrieves an element of a particular type of data within an instance.
+  /// This is a constant time lookup if the IDs of the data are indexed (see index_ids()), otherwise it is a linear search.
   /// \param instance The instance containing the data.
   /// \param partition The name of the partition.
   /// \param id The ID of the element.
@@ -90,6 +98,17 @@ namespace ludo
   template<typename T>
   const T* get(const instance& instance, const std::string& partition, uint64_t id);
 
+  ///
+  /// Retrieves an element of a particular type of data within an instance by handle.
+  /// The data must be using swapping storage (see use_swapping()).
+  /// \param instance The instance containing the data.
+  /// \param handle The handle of the element.
+  /// \return The element or nullptr if it has been removed.
+  template<typename T>
+  T* get(instance& instance, handle handle);
+  template<typename T>
+  const T* get(const instance& instance, handle handle);
+
   ///
   /// Adds an element to the data of an instance.
   /// \param instance The instance to add the element to.
@@ -141,13 +160,20 @@ namespace ludo
   /// \param instance The instance containing the heap.
   /// \param name The name of the heap.
   /// \return The heap buffer.
-  heap& data_heap(instance& instance, const std::string& name);
-  const heap& data_heap(const instance& instance, const std::string& name);
+  heap& data_heap(instance& instance, std::string_view name);
+  const heap& data_heap(const instance& instance, std::string_view name);
 
+  ///
+  /// Retrieves the index of a particular type of data. Indices are dense and are assigned on first use.
+  /// \return The index of the type.
   template<typename T>
-  std::string partitioned_array_key();
+  uint32_t type_index();
 
-  std::string heap_key(const std::string& name);
+  ///
+  /// Retrieves the indices of several types of data.
+  /// \return The indices of the types.
+  template<typename... T>
+  std::vector<uint32_t> type_indices();
 }
 
 #include "data.hpp"
@@ -3,29 +3,41 @@
  */
 
 #include <cassert>
-#include <typeinfo>
 
 #include "../algorithm.h"
 #include "data.h"
 
 namespace ludo
 {
+  template<typename T>
+  partitioned_array<T>* find_data(const instance& instance);
+
   template<typename T>
   partitioned_array<T>& allocate(instance& instance, uint64_t capacity)
   {
-    auto key = partitioned_array_key<T>();
-    instance.data[key] = new partitioned_array<T>(allocate_partitioned_array<T>(capacity));
+    auto index = type_index<T>();
+    if (index >= instance.data.size())
+    {
+      instance.data.resize(index + 1);
+    }
+
+    instance.data[index] = new partitioned_array<T>(allocate_partitioned_array<T>(capacity));
 
-    return *static_cast<partitioned_array<T>*>(instance.data[key]);
+    return *static_cast<partitioned_array<T>*>(instance.data[index]);
   }
 
   template<typename T>
   partitioned_array<T>& allocate_vram(instance& instance, uint64_t capacity, vram_buffer_access_hint access_hint)
   {
-    auto key = partitioned_array_key<T>();
-    instance.data[key] = new partitioned_array<T>(allocate_partitioned_vram<T>(capacity, access_hint));
+    auto index = type_index<T>();
+    if (index >= instance.data.size())
+    {
+      instance.data.resize(index + 1);
+    }
 
-    return *static_cast<partitioned_array<T>*>(instance.data[key]);
+    instance.data[index] = new partitioned_array<T>(allocate_partitioned_array_vram<T>(capacity, access_hint));
+
+    return *static_cast<partitioned_array<T>*>(instance.data[index]);
   }
 
   template<typename T>
@@ -34,7 +46,7 @@ namespace ludo
     auto& array = data<T>(instance);
     deallocate(array);
 
-    instance.data.erase(partitioned_array_key<T>());
+    instance.data[type_index<T>()] = nullptr;
     delete &array;
   }
 
@@ -44,7 +56,7 @@ namespace ludo
     auto& array = data<T>(instance);
     deallocate_vram(array);
 
-    instance.data.erase(partitioned_array_key<T>());
+    instance.data[type_index<T>()] = nullptr;
     delete &array;
   }
 
@@ -57,9 +69,10 @@ namespace ludo
   template<typename T>
   const partitioned_array<T>& data(const instance& instance)
   {
-    assert(instance.data.find(partitioned_array_key<T>()) != instance.data.end() && "array not found");
+    auto array = find_data<T>(instance);
+    assert(array && "array not found");
 
-    return *static_cast<partitioned_array<T>*>(instance.data.at(partitioned_array_key<T>()));
+    return *array;
   }
 
   template<typename T>
@@ -81,7 +94,7 @@ namespace ludo
   template<typename T>
   bool exists(const instance& instance)
   {
-    return instance.data.contains(partitioned_array_key<T>());
+    return find_data<T>(instance) != nullptr;
   }
 
   template<typename T>
@@ -106,8 +119,7 @@ namespace ludo
   template<typename T>
   const T* first(const instance& instance)
   {
-    auto array_iter = instance.data.find(partitioned_array_key<T>());
-    auto array = array_iter == instance.data.end() ? nullptr : static_cast<partitioned_array<T>*>(array_iter->second);
+    auto array = find_data<T>(instance);
     if (array && array->length)
     {
       return array->begin();
@@ -125,8 +137,7 @@ namespace ludo
   template<typename T>
   const T* first(const instance& instance, const std::string& partition)
   {
-    auto array_iter = instance.data.find(partitioned_array_key<T>());
-    auto array = array_iter == instance.data.end() ? nullptr : static_cast<partitioned_array<T>*>(array_iter->second);
+    auto array = find_data<T>(instance);
     if (array && array->length)
     {
       auto partition_iter = find(*array, partition);
@@ -148,15 +159,7 @@ namespace ludo
   template<typename T>
   const T* get(const instance& instance, uint64_t id)
   {
-    auto& array = data<T>(instance);
-
-    auto element = find_by_id(array.begin(), array.end(), id);
-    if (element == array.end())
-    {
-      return nullptr;
-    }
-
-    return element;
+    return find_by_id(data<T>(instance), id);
   }
 
   template<typename T>
@@ -168,15 +171,21 @@ namespace ludo
   template<typename T>
   const T* get(const instance& instance, const std::string& partition, uint64_t id)
   {
-    auto& array = data<T>(instance, partition);
+    assert(exists<T>(instance, partition) && "partition not found");
 
-    auto element = find_by_id(array.begin(), array.end(), id);
-    if (element == array.end())
-    {
-      return nullptr;
-    }
+    return find_by_id(data<T>(instance), partition, id);
+  }
 
-    return element;
+  template<typename T>
+  T* get(instance& instance, handle handle)
+  {
+    return const_cast<T*>(get<T>(const_cast<const ludo::instance&>(instance), handle));
+  }
+
+  template<typename T>
+  const T* get(const instance& instance, handle handle)
+  {
+    return get(data<T>(instance), handle);
   }
 
   template<typename T>
@@ -188,18 +197,38 @@ namespace ludo
   template<typename T>
   void remove(instance& instance, T* element, const std::string& partition)
   {
-    auto array_iter = instance.data.find(partitioned_array_key<T>());
-    if (array_iter == instance.data.end())
+    auto array = find_data<T>(instance);
+    if (!array)
     {
       return;
     }
 
-    remove(*static_cast<partitioned_array<T>*>(array_iter->second), element, partition);
+    remove(*array, element, partition);
+  }
+
+  template<typename T>
+  uint32_t type_index()
+  {
+    static const auto index = next_type_index++;
+
+    return index;
+  }
+
+  template<typename... T>
+  std::vector<uint32_t> type_indices()
+  {
+    return { type_index<T>()... };
   }
 
   template<typename T>
-  std::string partitioned_array_key()
+  partitioned_array<T>* find_data(const instance& instance)
   {
-    return std::string("ludo::partitioned_array::") + typeid(T).name();
+    auto index = type_index<T>();
+    if (index >= instance.data.size())
+    {
+      return nullptr;
+    }
+
+    return static_cast<partitioned_array<T>*>(instance.data[index]);
   }
 }
@@ -2,11 +2,24 @@
  * This file is part of ludo. See the LICENSE file for the full license governing this code.
  */
 
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <utility>
+
 #include "heaps.h"
 
 namespace ludo
 {
-  void sort_free(heap& heap);
+  void reset_blocks(heap& heap);
+  uint32_t add_block(heap& heap, const heap_block& block);
+  void remove_block(heap& heap, uint32_t index);
+  void insert_free_block(heap& heap, uint32_t index);
+  void remove_free_block(heap& heap, uint32_t index);
+  uint32_t find_free_block(const heap& heap, uint64_t size);
+  uint32_t find_free_block_exhaustive(const heap& heap, uint64_t size, uint8_t alignment);
+  uint64_t alignment_offset(uint64_t offset, uint8_t alignment);
+  std::pair<uint32_t, uint32_t> size_class(uint64_t size);
 
   heap allocate_heap(uint64_t size)
   {
@@ -16,7 +29,7 @@ namespace ludo
     heap.id = buffer.id;
     heap.data = buffer.data;
     heap.size = buffer.size;
-    heap.free = { { .data = heap.data, .size = heap.size } };
+    reset_blocks(heap);
 
     return heap;
   }
@@ -29,7 +42,7 @@ namespace ludo
     heap.id = buffer.id;
     heap.data = buffer.data;
     heap.size = buffer.size;
-    heap.free = { { .data = heap.data, .size = heap.size } };
+    reset_blocks(heap);
 
     return heap;
   }
@@ -47,7 +60,7 @@ namespace ludo
 
     heap.data = nullptr;
     heap.size = 0;
-    heap.free.clear();
+    reset_blocks(heap);
   }
 
   void deallocate_vram(heap& heap)
@@ -63,7 +76,7 @@ namespace ludo
 
     heap.data = nullptr;
     heap.size = 0;
-    heap.free.clear();
+    reset_blocks(heap);
   }
 
   buffer allocate(heap& heap, uint64_t size, uint8_t alignment)
@@ -73,114 +86,346 @@ namespace ludo
       return {};
     }
 
-    for (auto free_iter = heap.free.begin(); free_iter < heap.free.end(); free_iter++)
+    // Blocks are usually aligned already (e.g. all allocations from a vertex heap are a multiple of the vertex size), so try without padding first.
+    // Failing that, searching for a block that fits the size plus the worst case alignment padding means any block found will fit.
+    auto index = find_free_block(heap, size);
+    if (index != heap_block_none && alignment_offset(heap.blocks[index].offset, alignment))
+    {
+      index = find_free_block(heap, size + alignment - 1);
+    }
+
+    if (index == heap_block_none)
+    {
+      // Rounding up to the next size class can skip blocks that would have fit (e.g. heaps sized exactly for their contents).
+      index = find_free_block_exhaustive(heap, size, alignment);
+    }
+
+    assert(index != heap_block_none && "could not fit buffer");
+    if (index == heap_block_none)
+    {
+      return {};
+    }
+
+    remove_free_block(heap, index);
+
+    // Blocks adjacent to a free block are never free (they are always coalesced) so splits can be made without merging.
+    auto padding = alignment_offset(heap.blocks[index].offset, alignment);
+    if (padding)
     {
-      auto start = free_iter->data;
-      auto start_offset = free_iter->data - heap.data;
-      auto start_misalignment = start_offset % static_cast<uint64_t>(alignment);
-      auto alignment_offset = start_misalignment && alignment > 1 ? alignment - start_misalignment : 0;
-      auto aligned_data = free_iter->data + alignment_offset;
-      auto aligned_size = free_iter->size > alignment_offset ? free_iter->size - alignment_offset : 0;
+      auto padding_index = add_block(heap, heap_block
+      {
+        .offset = heap.blocks[index].offset,
+        .size = padding,
+        .previous = heap.blocks[index].previous,
+        .next = index
+      });
 
-      if (aligned_size < size)
+      if (heap.blocks[padding_index].previous != heap_block_none)
       {
-        continue;
+        heap.blocks[heap.blocks[padding_index].previous].next = padding_index;
       }
 
-      auto buffer = ludo::buffer
+      heap.blocks[index].offset += padding;
+      heap.blocks[index].size -= padding;
+      heap.blocks[index].previous = padding_index;
+      insert_free_block(heap, padding_index);
+    }
+
+    if (heap.blocks[index].size > size)
+    {
+      auto remainder_index = add_block(heap, heap_block
       {
-        .data = aligned_data,
-        .size = size
-      };
+        .offset = heap.blocks[index].offset + size,
+        .size = heap.blocks[index].size - size,
+        .previous = index,
+        .next = heap.blocks[index].next
+      });
 
-      if (aligned_size == size)
+      if (heap.blocks[remainder_index].next != heap_block_none)
       {
-        heap.free.erase(free_iter);
+        heap.blocks[heap.blocks[remainder_index].next].previous = remainder_index;
       }
-      else
+
+      heap.blocks[index].size = size;
+      heap.blocks[index].next = remainder_index;
+      insert_free_block(heap, remainder_index);
+    }
+
+    return ludo::buffer
+    {
+      .id = index + 1, // Identifies the block so that deallocation doesn't need to search for it.
+      .data = heap.data + heap.blocks[index].offset,
+      .size = size
+    };
+  }
+
+  void deallocate(heap& heap, ludo::buffer& buffer)
+  {
+    if (!buffer.data)
+    {
+      return;
+    }
+
+    auto offset = static_cast<uint64_t>(buffer.data - heap.data);
+
+    auto index = static_cast<uint32_t>(buffer.id - 1);
+    if (buffer.id == 0 || index >= heap.blocks.size() || heap.blocks[index].free || heap.blocks[index].offset != offset)
+    {
+      auto block_iter = std::find_if(heap.blocks.begin(), heap.blocks.end(), [&offset](const heap_block& block)
       {
-        free_iter->data += size + alignment_offset;
-        free_iter->size -= size + alignment_offset;
-      }
+        return !block.free && block.size && block.offset == offset;
+      });
 
-      if (alignment_offset)
+      assert(block_iter != heap.blocks.end() && "buffer not allocated from heap");
+      if (block_iter == heap.blocks.end())
       {
-        heap.free.push_back(ludo::buffer
-        {
-          .data = start,
-          .size = alignment_offset
-        });
+        return;
       }
 
-      sort_free(heap);
+      index = static_cast<uint32_t>(block_iter - heap.blocks.begin());
+    }
+
+    auto previous = heap.blocks[index].previous;
+    if (previous != heap_block_none && heap.blocks[previous].free)
+    {
+      remove_free_block(heap, previous);
+      heap.blocks[previous].size += heap.blocks[index].size;
+      remove_block(heap, index);
+      index = previous;
+    }
 
-      return buffer;
+    auto next = heap.blocks[index].next;
+    if (next != heap_block_none && heap.blocks[next].free)
+    {
+      remove_free_block(heap, next);
+      heap.blocks[index].size += heap.blocks[next].size;
+      remove_block(heap, next);
     }
 
-    assert(false && "could not fit buffer");
-    return {};
+    insert_free_block(heap, index);
+
+    buffer.id = 0;
+    buffer.data = nullptr;
+    buffer.size = 0;
+  }
+
+  void clear(heap& heap)
+  {
+    reset_blocks(heap);
   }
 
-  void deallocate(heap& heap, ludo::buffer& buffer)
+  uint64_t free_size(const heap& heap)
   {
-    auto free_before_iter = std::find_if(
-      heap.free.begin(),
-      heap.free.end(),
-      [&buffer](const ludo::buffer& free)
+    auto size = uint64_t(0);
+    for (auto& block : heap.blocks)
+    {
+      if (block.free)
       {
-        return free.data + free.size == buffer.data;
+        size += block.size;
       }
-    );
+    }
 
-    auto free_after_iter = std::find_if(
-      heap.free.begin(),
-      heap.free.end(),
-      [&buffer](const ludo::buffer& free)
+    return size;
+  }
+
+  uint64_t largest_free_size(const heap& heap)
+  {
+    auto size = uint64_t(0);
+    for (auto& block : heap.blocks)
+    {
+      if (block.free)
       {
-        return free.data == buffer.data + buffer.size;
+        size = std::max(size, block.size);
       }
-    );
+    }
+
+    return size;
+  }
+
+  void reset_blocks(heap& heap)
+  {
+    heap.blocks.clear();
+    heap.unused_blocks.clear();
+    heap.first_level_bitmap = 0;
+    heap.second_level_bitmaps.fill(0);
+    heap.free_blocks.fill(heap_block_none);
+
+    if (heap.size)
+    {
+      insert_free_block(heap, add_block(heap, heap_block
+      {
+        .size = heap.size,
+        .previous = heap_block_none,
+        .next = heap_block_none
+      }));
+    }
+  }
+
+  uint32_t add_block(heap& heap, const heap_block& block)
+  {
+    if (heap.unused_blocks.empty())
+    {
+      heap.blocks.emplace_back(block);
+      return static_cast<uint32_t>(heap.blocks.size() - 1);
+    }
+
+    auto index = heap.unused_blocks.back();
+    heap.unused_blocks.pop_back();
+    heap.blocks[index] = block;
+
+    return index;
+  }
+
+  void remove_block(heap& heap, uint32_t index)
+  {
+    auto& block = heap.blocks[index];
+
+    if (block.previous != heap_block_none)
+    {
+      heap.blocks[block.previous].next = block.next;
+    }
 
-    if (free_before_iter != heap.free.end() && free_after_iter != heap.free.end())
+    if (block.next != heap_block_none)
     {
-      free_before_iter->size += buffer.size + free_after_iter->size;
-      heap.free.erase(free_after_iter);
+      heap.blocks[block.next].previous = block.previous;
     }
-    else if (free_before_iter != heap.free.end())
+
+    block = heap_block();
+    heap.unused_blocks.push_back(index);
+  }
+
+  void insert_free_block(heap& heap, uint32_t index)
+  {
+    auto& block = heap.blocks[index];
+    auto [first_level, second_level] = size_class(block.size);
+    auto& head = heap.free_blocks[first_level * heap_second_level_count + second_level];
+
+    block.free = true;
+    block.previous_free = heap_block_none;
+    block.next_free = head;
+    if (head != heap_block_none)
     {
-      free_before_iter->size += buffer.size;
+      heap.blocks[head].previous_free = index;
     }
-    else if (free_after_iter != heap.free.end())
+
+    head = index;
+    heap.first_level_bitmap |= uint64_t(1) << first_level;
+    heap.second_level_bitmaps[first_level] |= uint32_t(1) << second_level;
+  }
+
+  void remove_free_block(heap& heap, uint32_t index)
+  {
+    auto& block = heap.blocks[index];
+    auto [first_level, second_level] = size_class(block.size);
+    auto& head = heap.free_blocks[first_level * heap_second_level_count + second_level];
+
+    if (block.previous_free != heap_block_none)
     {
-      free_after_iter->data = buffer.data;
-      free_after_iter->size += buffer.size;
+      heap.blocks[block.previous_free].next_free = block.next_free;
     }
-    else
+
+    if (block.next_free != heap_block_none)
     {
-      heap.free.emplace_back(buffer);
+      heap.blocks[block.next_free].previous_free = block.previous_free;
     }
 
-    buffer.data = nullptr;
-    buffer.size = 0;
+    if (head == index)
+    {
+      head = block.next_free;
+      if (head == heap_block_none)
+      {
+        heap.second_level_bitmaps[first_level] &= ~(uint32_t(1) << second_level);
+        if (!heap.second_level_bitmaps[first_level])
+        {
+          heap.first_level_bitmap &= ~(uint64_t(1) << first_level);
+        }
+      }
+    }
 
-    sort_free(heap);
+    block.free = false;
+    block.previous_free = heap_block_none;
+    block.next_free = heap_block_none;
   }
 
-  void clear(heap& heap)
+  uint32_t find_free_block(const heap& heap, uint64_t size)
   {
-    heap.free = { { .data = heap.data, .size = heap.size } };
+    // Round up to the next size class so that every block within the class found is large enough.
+    if (size >= heap_second_level_count)
+    {
+      auto rounding = (uint64_t(1) << (std::bit_width(size) - 1 - heap_second_level_count_log2)) - 1;
+      if (size > UINT64_MAX - rounding)
+      {
+        return heap_block_none;
+      }
+
+      size += rounding;
+    }
+
+    auto [first_level, second_level] = size_class(size);
+
+    auto second_level_bitmap = heap.second_level_bitmaps[first_level] & (~uint32_t(0) << second_level);
+    if (!second_level_bitmap)
+    {
+      auto first_level_bitmap = first_level + 1 < 64 ? heap.first_level_bitmap & (~uint64_t(0) << (first_level + 1)) : 0;
+      if (!first_level_bitmap)
+      {
+        return heap_block_none;
+      }
+
+      first_level = std::countr_zero(first_level_bitmap);
+      second_level_bitmap = heap.second_level_bitmaps[first_level];
+    }
+
+    second_level = std::countr_zero(second_level_bitmap);
+
+    return heap.free_blocks[first_level * heap_second_level_count + second_level];
   }
 
-  void sort_free(heap& heap)
+  uint32_t find_free_block_exhaustive(const heap& heap, uint64_t size, uint8_t alignment)
   {
-    // Smallest free sections first so that allocations are within the smallest free section that will fit.
-    std::sort(
-      heap.free.begin(),
-      heap.free.end(),
-      [](const ludo::buffer& a, const ludo::buffer& b)
+    auto [first_level, second_level] = size_class(size);
+
+    for (auto class_index = first_level * heap_second_level_count + second_level; class_index < heap.free_blocks.size(); class_index++)
+    {
+      for (auto index = heap.free_blocks[class_index]; index != heap_block_none; index = heap.blocks[index].next_free)
       {
-        return a.size < b.size;
+        auto& block = heap.blocks[index];
+        auto padding = alignment_offset(block.offset, alignment);
+        if (block.size >= padding && block.size - padding >= size)
+        {
+          return index;
+        }
       }
-    );
+    }
+
+    return heap_block_none;
+  }
+
+  uint64_t alignment_offset(uint64_t offset, uint8_t alignment)
+  {
+    if (alignment <= 1)
+    {
+      return 0;
+    }
+
+    auto misalignment = offset % static_cast<uint64_t>(alignment);
+
+    return misalignment ? alignment - misalignment : 0;
+  }
+
+  std::pair<uint32_t, uint32_t> size_class(uint64_t size)
+  {
+    // Sizes below the second level count map linearly, above that each power of two is split evenly into second level classes.
+    if (size < heap_second_level_count)
+    {
+      return { 0, static_cast<uint32_t>(size) };
+    }
+
+    auto most_significant_bit = static_cast<uint32_t>(std::bit_width(size) - 1);
+
+    return {
+      most_significant_bit - heap_second_level_count_log2 + 1,
+      static_cast<uint32_t>(size >> (most_significant_bit - heap_second_level_count_log2)) - heap_second_level_count
+    };
   }
 }
@@ -4,20 +4,48 @@
 
 #pragma once
 
+#include <array>
 #include <vector>
 
 #include "arrays.h"
 
 namespace ludo
 {
+  const auto heap_second_level_count_log2 = uint32_t(4); ///< The log2 of the number of second level size classes per first level size class.
+  const auto heap_second_level_count = uint32_t(1) << heap_second_level_count_log2; ///< The number of second level size classes per first level size class.
+  const auto heap_first_level_count = uint32_t(64) - heap_second_level_count_log2 + 1; ///< The number of first level size classes.
+
   ///
-  /// A (very basically managed) heap from which buffers can be allocated.
+  /// A contiguous section of a heap, either allocated or free.
+  /// Blocks are tracked outside of the heap data since heaps may be allocated in VRAM.
+  struct heap_block
+  {
+    uint64_t offset = 0; ///< The offset (in bytes) from the start of the heap.
+    uint64_t size = 0; ///< The size (in bytes).
+    bool free = false; ///< Determines if this block is available for allocation.
+
+    uint32_t previous = 0; ///< The index of the adjacent block preceding this one, or heap_block_none.
+    uint32_t next = 0; ///< The index of the adjacent block following this one, or heap_block_none.
+    uint32_t previous_free = 0; ///< The index of the previous free block of the same size class, or heap_block_none.
+    uint32_t next_free = 0; ///< The index of the next free block of the same size class, or heap_block_none.
+  };
+
+  const auto heap_block_none = uint32_t(0xFFFFFFFF); ///< Represents the absence of a block.
+
+  ///
+  /// A heap from which buffers can be allocated.
+  /// Uses a two-level segregated fit (TLSF) allocator so allocation and deallocation are constant time.
   struct heap
   {
     uint64_t id = 0; ///< The ID of the heap (heaps allocated in VRAM may have overlapping IDs with heaps allocated in RAM).
     std::byte* data = nullptr; ///< The data.
     uint64_t size = 0; ///< The size (in bytes).
-    std::vector<ludo::buffer> free; ///< The data available for allocation.
+
+    std::vector<heap_block> blocks; ///< The blocks the heap is divided into (in no particular order).
+    std::vector<uint32_t> unused_blocks; ///< The indices of block records available for reuse.
+    uint64_t first_level_bitmap = 0; ///< The first level size classes that contain free blocks.
+    std::array<uint32_t, heap_first_level_count> second_level_bitmaps = {}; ///< The second level size classes that contain free blocks, per first level size class.
+    std::array<uint32_t, heap_first_level_count * heap_second_level_count> free_blocks = {}; ///< The first free block of each size class, or heap_block_none.
   };
 
   ///
@@ -47,16 +75,28 @@ namespace ludo
   /// Allocates a buffer from a heap.
   /// \param heap The heap to allocate from.
   /// \param size The size (in bytes) to allocate.
-  /// \param alignment The alignment (in bytes) of the allocation.
-  /// \return The buffer.
+  /// \param alignment The alignment (in bytes) of the allocation relative to the start of the heap (need not be a power of two).
+  /// \return The buffer. Its ID identifies the allocation within the heap.
   buffer allocate(heap& heap, uint64_t size, uint8_t alignment = 1);
 
   ///
   /// Deallocates a buffer from a heap.
   /// \param heap The heap to deallocate from.
-  /// \param buffer The buffer to deallocate.
+  /// \param buffer The buffer to deallocate. This should be the buffer returned by allocate(), deallocation is not constant time otherwise.
   void deallocate(heap& heap, ludo::buffer& buffer);
 
+  ///
+  /// Determines the total free space within a heap.
+  /// \param heap The heap.
+  /// \return The total free space (in bytes).
+  uint64_t free_size(const heap& heap);
+
+  ///
+  /// Determines the largest contiguous free space within a heap.
+  /// \param heap The heap.
+  /// \return The largest contiguous free space (in bytes).
+  uint64_t largest_free_size(const heap& heap);
+
   ///
   /// Deallocates an array from a heap.
   /// \param heap The heap to deallocate from.
@@ -12,6 +12,7 @@ namespace ludo
     auto buffer = allocate(heap, capacity * sizeof(T));
 
     auto array = ludo::array<T>();
+    array.id = buffer.id;
     array.data = buffer.data;
     array.capacity = capacity;
 
@@ -24,6 +25,7 @@ namespace ludo
     auto buffer = allocate(heap, capacity * sizeof(T));
 
     auto array = partitioned_array<T>();
+    array.id = buffer.id;
     array.data = buffer.data;
     array.capacity = capacity;
 
@@ -2,10 +2,114 @@
  * This file is part of ludo. See the LICENSE file for the full license governing this code.
  */
 
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstdlib>
+#include <filesystem>
+
 #include "files.h"
 
 namespace ludo
 {
   std::string asset_folder = "./assets";
   std::string user_folder = "~/.ludo";
+
+  std::string user_file_name(const std::string& relative_file_name)
+  {
+    auto folder = user_folder;
+    if (folder.starts_with('~'))
+    {
+#if defined(_WIN32)
+      auto home = std::getenv("USERPROFILE");
+#else
+      auto home = std::getenv("HOME");
+#endif
+      if (!home)
+      {
+        return {};
+      }
+
+      folder = home + folder.substr(1);
+    }
+
+    auto path = std::filesystem::path(folder) / relative_file_name;
+
+    auto error = std::error_code();
+    std::filesystem::create_directories(path.parent_path(), error);
+    if (error)
+    {
+      return {};
+    }
+
+    return path.string();
+  }
+
+  buffer map_file(const std::string& file_name)
+  {
+    auto buffer = ludo::buffer();
+
+#if defined(_WIN32)
+    auto file = CreateFileA(file_name.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+      return buffer;
+    }
+
+    auto size = LARGE_INTEGER();
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+    {
+      // The view keeps the mapping alive, so neither handle needs to outlive this function.
+      auto mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if (mapping)
+      {
+        buffer.data = static_cast<std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        buffer.size = buffer.data ? static_cast<uint64_t>(size.QuadPart) : 0;
+        CloseHandle(mapping);
+      }
+    }
+
+    CloseHandle(file);
+#else
+    auto file = open(file_name.c_str(), O_RDONLY);
+    if (file == -1)
+    {
+      return buffer;
+    }
+
+    struct stat status;
+    if (fstat(file, &status) == 0 && status.st_size > 0)
+    {
+      // The mapping keeps the file open, so the descriptor does not need to outlive this function.
+      auto data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+      if (data != MAP_FAILED)
+      {
+        buffer.data = static_cast<std::byte*>(data);
+        buffer.size = static_cast<uint64_t>(status.st_size);
+      }
+    }
+
+    close(file);
+#endif
+
+    return buffer;
+  }
+
+  void unmap_file(buffer& buffer)
+  {
+#if defined(_WIN32)
+    UnmapViewOfFile(buffer.data);
+#else
+    munmap(buffer.data, buffer.size);
+#endif
+
+    buffer.data = nullptr;
+    buffer.size = 0;
+  }
 }
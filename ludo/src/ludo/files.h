@@ -6,8 +6,28 @@
 
 #include <string>
 
+#include "data/buffers.h"
+
 namespace ludo
 {
   extern std::string asset_folder; ///< Read-only files packaged with the application
   extern std::string user_folder; ///< Read-write files specific to the current user
+
+  ///
+  /// Builds the name of a file within the user folder, creating the folders leading to it if they don't exist.
+  /// A leading ~ in the user folder is expanded to the home folder of the current user.
+  /// \param relative_file_name The name of the file relative to the user folder.
+  /// \return The name of the file (or an empty string if its folder could not be created).
+  std::string user_file_name(const std::string& relative_file_name);
+
+  ///
+  /// Maps a file into (read-only) memory. The contents of the file are only read as they are accessed.
+  /// \param file_name The name of the file.
+  /// \return A buffer aliasing the contents of the file. Its data is nullptr if the file could not be mapped.
+  buffer map_file(const std::string& file_name);
+
+  ///
+  /// Unmaps a file that was mapped into memory.
+  /// \param buffer The buffer aliasing the contents of the file.
+  void unmap_file(buffer& buffer);
 }
@@ -25,6 +25,7 @@ namespace ludo
   struct import_options
   {
     bool merge_meshes = false; ///< Determines if the meshes being imported should be merged into a single mesh.
+    bool cache = true; ///< Determines if the results should be read from (and written to) a cache in the user folder (keyed by the path of the file), so that it is only parsed once.
   };
 
   ///
@@ -38,7 +39,9 @@ namespace ludo
 
   ///
   /// Determines the total and unique vertex counts in a file.
+  /// If the file has a valid import cache, only its header is read.
   /// \param file_name The name of the file to count the vertices in.
+  /// \param options The options used to modify the import behavior.
   /// \return The total and unique vertex counts of a file. Of the form { total, unique }.
-  std::pair<uint32_t, uint32_t> import_counts(const std::string& file_name);
+  std::pair<uint32_t, uint32_t> import_counts(const std::string& file_name, const import_options& options = {});
 }
@@ -158,6 +158,14 @@ namespace ludo
   vec3 operator*(const mat3& matrix, const vec3& vector);
   vec4 operator*(const mat4& matrix, const vec4& vector);
 
+  ///
+  /// Multiplies a matrix with many vectors.
+  /// \param matrix The matrix.
+  /// \param vectors The vectors.
+  /// \param products The products, this can be the same array as the vectors.
+  /// \param count The number of vectors.
+  void multiply(const mat4& matrix, const vec4* vectors, vec4* products, uint64_t count);
+
   ///
   /// Multiplies a vector with a matrix.
   /// \param vector The vector.
@@ -304,3 +312,5 @@ namespace ludo
   /// \return A matrix representing a perspective projection.
   mat4 perspective(float y_axis_field_of_view, float aspect_ratio, float near_clipping_distance, float far_clipping_distance);
 }
+
+#include "mat.hpp"
@@ -0,0 +1,787 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include "mat.h"
+#include "simd.h"
+
+namespace ludo
+{
+  inline mat3::mat3() : std::array<float, 9>()
+  {}
+
+  inline mat3::mat3(float m00, float m01, float m02,
+             float m10, float m11, float m12,
+             float m20, float m21, float m22) : std::array<float, 9>
+    // The matrix is column-major so this is visually transposed as shown here
+    {
+      m00, m01, m02,
+      m10, m11, m12,
+      m20, m21, m22
+    }
+  {}
+
+  inline mat3::mat3(std::array<float, 16> transformation) : std::array<float, 9>
+    // The matrix is column-major so this is visually transposed as shown here
+    {
+      transformation[0], transformation[1], transformation[2], // transformation[3]
+      transformation[4], transformation[5], transformation[6], // transformation[7]
+      transformation[8], transformation[9], transformation[10] // transformation[11]
+      // transformation[12], transformation[13], transformation[14], transformation[15]
+    }
+  {}
+
+  inline mat4::mat4() : std::array<float, 16>()
+  {}
+
+  inline mat4::mat4(float m00, float m01, float m02, float m03,
+             float m10, float m11, float m12, float m13,
+             float m20, float m21, float m22, float m23,
+             float m30, float m31, float m32, float m33) : std::array<float, 16>
+    // The matrix is column-major so this is visually transposed as shown here
+    {
+      m00, m01, m02, m03,
+      m10, m11, m12, m13,
+      m20, m21, m22, m23,
+      m30, m31, m32, m33
+    }
+  {}
+
+  inline mat4::mat4(std::array<float, 3> position, std::array<float, 9> rotation) : std::array<float, 16>
+    // The matrix is column-major so this is visually transposed as shown here
+  {
+    rotation[0], rotation[1], rotation[2], 0.0f,
+    rotation[3], rotation[4], rotation[5], 0.0f,
+    rotation[6], rotation[7], rotation[8], 0.0f,
+    position[0], position[1], position[2], 1.0f
+  }
+  {}
+
+  inline mat3 operator+(const mat3& lhs, const mat3& rhs)
+  {
+    auto sum = lhs;
+    sum += rhs;
+    return sum;
+  }
+
+  inline mat4 operator+(const mat4& lhs, const mat4& rhs)
+  {
+    auto sum = lhs;
+    sum += rhs;
+    return sum;
+  }
+
+  inline mat3& operator+=(mat3& lhs, const mat3& rhs)
+  {
+    lhs[0] += rhs[0];
+    lhs[1] += rhs[1];
+    lhs[2] += rhs[2];
+
+    lhs[3] += rhs[3];
+    lhs[4] += rhs[4];
+    lhs[5] += rhs[5];
+
+    lhs[6] += rhs[6];
+    lhs[7] += rhs[7];
+    lhs[8] += rhs[8];
+
+    return lhs;
+  }
+
+  inline mat4& operator+=(mat4& lhs, const mat4& rhs)
+  {
+    lhs[0] += rhs[0];
+    lhs[1] += rhs[1];
+    lhs[2] += rhs[2];
+    lhs[3] += rhs[3];
+
+    lhs[4] += rhs[4];
+    lhs[5] += rhs[5];
+    lhs[6] += rhs[6];
+    lhs[7] += rhs[7];
+
+    lhs[8] += rhs[8];
+    lhs[9] += rhs[9];
+    lhs[10] += rhs[10];
+    lhs[11] += rhs[11];
+
+    lhs[12] += rhs[12];
+    lhs[13] += rhs[13];
+    lhs[14] += rhs[14];
+    lhs[15] += rhs[15];
+
+    return lhs;
+  }
+
+  inline mat3 operator-(const mat3& lhs, const mat3& rhs)
+  {
+    auto sum = lhs;
+    sum -= rhs;
+    return sum;
+  }
+
+  inline mat4 operator-(const mat4& lhs, const mat4& rhs)
+  {
+    auto sum = lhs;
+    sum -= rhs;
+    return sum;
+  }
+
+  inline mat3& operator-=(mat3& lhs, const mat3& rhs)
+  {
+    lhs[0] -= rhs[0];
+    lhs[1] -= rhs[1];
+    lhs[2] -= rhs[2];
+
+    lhs[3] -= rhs[3];
+    lhs[4] -= rhs[4];
+    lhs[5] -= rhs[5];
+
+    lhs[6] -= rhs[6];
+    lhs[7] -= rhs[7];
+    lhs[8] -= rhs[8];
+
+    return lhs;
+  }
+
+  inline mat4& operator-=(mat4& lhs, const mat4& rhs)
+  {
+    lhs[0] -= rhs[0];
+    lhs[1] -= rhs[1];
+    lhs[2] -= rhs[2];
+    lhs[3] -= rhs[3];
+
+    lhs[4] -= rhs[4];
+    lhs[5] -= rhs[5];
+    lhs[6] -= rhs[6];
+    lhs[7] -= rhs[7];
+
+    lhs[8] -= rhs[8];
+    lhs[9] -= rhs[9];
+    lhs[10] -= rhs[10];
+    lhs[11] -= rhs[11];
+
+    lhs[12] -= rhs[12];
+    lhs[13] -= rhs[13];
+    lhs[14] -= rhs[14];
+    lhs[15] -= rhs[15];
+
+    return lhs;
+  }
+
+  inline mat3 operator*(const mat3& lhs, const mat3& rhs)
+  {
+    auto product = lhs;
+    product *= rhs;
+    return product;
+  }
+
+  inline mat4 operator*(const mat4& lhs, const mat4& rhs)
+  {
+    auto product = lhs;
+    product *= rhs;
+    return product;
+  }
+
+  inline mat3& operator*=(mat3& lhs, const mat3& rhs)
+  {
+    lhs =
+    {
+      lhs[0] * rhs[0] + lhs[3] * rhs[1] + lhs[6] * rhs[2],
+      lhs[1] * rhs[0] + lhs[4] * rhs[1] + lhs[7] * rhs[2],
+      lhs[2] * rhs[0] + lhs[5] * rhs[1] + lhs[8] * rhs[2],
+
+      lhs[0] * rhs[3] + lhs[3] * rhs[4] + lhs[6] * rhs[5],
+      lhs[1] * rhs[3] + lhs[4] * rhs[4] + lhs[7] * rhs[5],
+      lhs[2] * rhs[3] + lhs[5] * rhs[4] + lhs[8] * rhs[5],
+
+      lhs[0] * rhs[6] + lhs[3] * rhs[7] + lhs[6] * rhs[8],
+      lhs[1] * rhs[6] + lhs[4] * rhs[7] + lhs[7] * rhs[8],
+      lhs[2] * rhs[6] + lhs[5] * rhs[7] + lhs[8] * rhs[8]
+    };
+
+    return lhs;
+  }
+
+  inline mat4& operator*=(mat4& lhs, const mat4& rhs)
+  {
+    // Each column of the product is a sum of the columns of lhs, weighted by a column of rhs.
+    // The sums are performed in the same order as the scalar version so the results are identical.
+#if defined(LUDO_AVX)
+    auto column_0 = _mm_loadu_ps(&lhs[0]);
+    auto column_1 = _mm_loadu_ps(&lhs[4]);
+    auto column_2 = _mm_loadu_ps(&lhs[8]);
+    auto column_3 = _mm_loadu_ps(&lhs[12]);
+    auto columns_0 = _mm256_insertf128_ps(_mm256_castps128_ps256(column_0), column_0, 1);
+    auto columns_1 = _mm256_insertf128_ps(_mm256_castps128_ps256(column_1), column_1, 1);
+    auto columns_2 = _mm256_insertf128_ps(_mm256_castps128_ps256(column_2), column_2, 1);
+    auto columns_3 = _mm256_insertf128_ps(_mm256_castps128_ps256(column_3), column_3, 1);
+
+    auto weights_01 = _mm256_loadu_ps(&rhs[0]);
+    auto weights_23 = _mm256_loadu_ps(&rhs[8]);
+
+    auto product_01 = _mm256_mul_ps(columns_0, _mm256_permute_ps(weights_01, 0x00));
+    product_01 = _mm256_add_ps(product_01, _mm256_mul_ps(columns_1, _mm256_permute_ps(weights_01, 0x55)));
+    product_01 = _mm256_add_ps(product_01, _mm256_mul_ps(columns_2, _mm256_permute_ps(weights_01, 0xAA)));
+    product_01 = _mm256_add_ps(product_01, _mm256_mul_ps(columns_3, _mm256_permute_ps(weights_01, 0xFF)));
+
+    auto product_23 = _mm256_mul_ps(columns_0, _mm256_permute_ps(weights_23, 0x00));
+    product_23 = _mm256_add_ps(product_23, _mm256_mul_ps(columns_1, _mm256_permute_ps(weights_23, 0x55)));
+    product_23 = _mm256_add_ps(product_23, _mm256_mul_ps(columns_2, _mm256_permute_ps(weights_23, 0xAA)));
+    product_23 = _mm256_add_ps(product_23, _mm256_mul_ps(columns_3, _mm256_permute_ps(weights_23, 0xFF)));
+
+    _mm256_storeu_ps(&lhs[0], product_01);
+    _mm256_storeu_ps(&lhs[8], product_23);
+#elif defined(LUDO_SSE)
+    auto column_0 = _mm_loadu_ps(&lhs[0]);
+    auto column_1 = _mm_loadu_ps(&lhs[4]);
+    auto column_2 = _mm_loadu_ps(&lhs[8]);
+    auto column_3 = _mm_loadu_ps(&lhs[12]);
+
+    // lhs and rhs may be the same matrix, so every product is calculated before any are stored.
+    __m128 products[4];
+    for (auto index = 0; index < 4; index++)
+    {
+      products[index] = _mm_mul_ps(column_0, _mm_set1_ps(rhs[index * 4]));
+      products[index] = _mm_add_ps(products[index], _mm_mul_ps(column_1, _mm_set1_ps(rhs[index * 4 + 1])));
+      products[index] = _mm_add_ps(products[index], _mm_mul_ps(column_2, _mm_set1_ps(rhs[index * 4 + 2])));
+      products[index] = _mm_add_ps(products[index], _mm_mul_ps(column_3, _mm_set1_ps(rhs[index * 4 + 3])));
+    }
+
+    _mm_storeu_ps(&lhs[0], products[0]);
+    _mm_storeu_ps(&lhs[4], products[1]);
+    _mm_storeu_ps(&lhs[8], products[2]);
+    _mm_storeu_ps(&lhs[12], products[3]);
+#else
+    lhs =
+    {
+      lhs[0] * rhs[0] + lhs[4] * rhs[1] + lhs[8] * rhs[2] + lhs[12] * rhs[3],
+      lhs[1] * rhs[0] + lhs[5] * rhs[1] + lhs[9] * rhs[2] + lhs[13] * rhs[3],
+      lhs[2] * rhs[0] + lhs[6] * rhs[1] + lhs[10] * rhs[2] + lhs[14] * rhs[3],
+      lhs[3] * rhs[0] + lhs[7] * rhs[1] + lhs[11] * rhs[2] + lhs[15] * rhs[3],
+
+      lhs[0] * rhs[4] + lhs[4] * rhs[5] + lhs[8] * rhs[6] + lhs[12] * rhs[7],
+      lhs[1] * rhs[4] + lhs[5] * rhs[5] + lhs[9] * rhs[6] + lhs[13] * rhs[7],
+      lhs[2] * rhs[4] + lhs[6] * rhs[5] + lhs[10] * rhs[6] + lhs[14] * rhs[7],
+      lhs[3] * rhs[4] + lhs[7] * rhs[5] + lhs[11] * rhs[6] + lhs[15] * rhs[7],
+
+      lhs[0] * rhs[8] + lhs[4] * rhs[9] + lhs[8] * rhs[10] + lhs[12] * rhs[11],
+      lhs[1] * rhs[8] + lhs[5] * rhs[9] + lhs[9] * rhs[10] + lhs[13] * rhs[11],
+      lhs[2] * rhs[8] + lhs[6] * rhs[9] + lhs[10] * rhs[10] + lhs[14] * rhs[11],
+      lhs[3] * rhs[8] + lhs[7] * rhs[9] + lhs[11] * rhs[10] + lhs[15] * rhs[11],
+
+      lhs[0] * rhs[12] + lhs[4] * rhs[13] + lhs[8] * rhs[14] + lhs[12] * rhs[15],
+      lhs[1] * rhs[12] + lhs[5] * rhs[13] + lhs[9] * rhs[14] + lhs[13] * rhs[15],
+      lhs[2] * rhs[12] + lhs[6] * rhs[13] + lhs[10] * rhs[14] + lhs[14] * rhs[15],
+      lhs[3] * rhs[12] + lhs[7] * rhs[13] + lhs[11] * rhs[14] + lhs[15] * rhs[15]
+    };
+
+#endif
+
+    return lhs;
+  }
+
+  inline vec3 operator*(const mat3& matrix, const vec3& vector)
+  {
+    return
+    {
+      matrix[0] * vector[0] + matrix[3] * vector[1] + matrix[6] * vector[2],
+      matrix[1] * vector[0] + matrix[4] * vector[1] + matrix[7] * vector[2],
+      matrix[2] * vector[0] + matrix[5] * vector[1] + matrix[8] * vector[2]
+    };
+  }
+
+  inline vec4 operator*(const mat4& matrix, const vec4& vector)
+  {
+#if defined(LUDO_SSE)
+    auto product = _mm_mul_ps(_mm_loadu_ps(&matrix[0]), _mm_set1_ps(vector[0]));
+    product = _mm_add_ps(product, _mm_mul_ps(_mm_loadu_ps(&matrix[4]), _mm_set1_ps(vector[1])));
+    product = _mm_add_ps(product, _mm_mul_ps(_mm_loadu_ps(&matrix[8]), _mm_set1_ps(vector[2])));
+    product = _mm_add_ps(product, _mm_mul_ps(_mm_loadu_ps(&matrix[12]), _mm_set1_ps(vector[3])));
+
+    auto result = vec4();
+    _mm_storeu_ps(&result[0], product);
+
+    return result;
+#else
+    return
+    {
+      matrix[0] * vector[0] + matrix[4] * vector[1] + matrix[8] * vector[2] + matrix[12] * vector[3],
+      matrix[1] * vector[0] + matrix[5] * vector[1] + matrix[9] * vector[2] + matrix[13] * vector[3],
+      matrix[2] * vector[0] + matrix[6] * vector[1] + matrix[10] * vector[2] + matrix[14] * vector[3],
+      matrix[3] * vector[0] + matrix[7] * vector[1] + matrix[11] * vector[2] + matrix[15] * vector[3]
+    };
+#endif
+  }
+
+  inline void multiply(const mat4& matrix, const vec4* vectors, vec4* products, uint64_t count)
+  {
+    auto index = uint64_t(0);
+
+#if defined(LUDO_AVX)
+    auto column_0 = _mm_loadu_ps(&matrix[0]);
+    auto column_1 = _mm_loadu_ps(&matrix[4]);
+    auto column_2 = _mm_loadu_ps(&matrix[8]);
+    auto column_3 = _mm_loadu_ps(&matrix[12]);
+    auto columns_0 = _mm256_insertf128_ps(_mm256_castps128_ps256(column_0), column_0, 1);
+    auto columns_1 = _mm256_insertf128_ps(_mm256_castps128_ps256(column_1), column_1, 1);
+    auto columns_2 = _mm256_insertf128_ps(_mm256_castps128_ps256(column_2), column_2, 1);
+    auto columns_3 = _mm256_insertf128_ps(_mm256_castps128_ps256(column_3), column_3, 1);
+
+    // Two vectors per iteration, one in each 128-bit lane
+    for (; index + 1 < count; index += 2)
+    {
+      auto vector_pair = _mm256_loadu_ps(&vectors[index][0]);
+
+      auto product_pair = _mm256_mul_ps(columns_0, _mm256_permute_ps(vector_pair, 0x00));
+      product_pair = _mm256_add_ps(product_pair, _mm256_mul_ps(columns_1, _mm256_permute_ps(vector_pair, 0x55)));
+      product_pair = _mm256_add_ps(product_pair, _mm256_mul_ps(columns_2, _mm256_permute_ps(vector_pair, 0xAA)));
+      product_pair = _mm256_add_ps(product_pair, _mm256_mul_ps(columns_3, _mm256_permute_ps(vector_pair, 0xFF)));
+
+      _mm256_storeu_ps(&products[index][0], product_pair);
+    }
+#elif defined(LUDO_SSE)
+    auto column_0 = _mm_loadu_ps(&matrix[0]);
+    auto column_1 = _mm_loadu_ps(&matrix[4]);
+    auto column_2 = _mm_loadu_ps(&matrix[8]);
+    auto column_3 = _mm_loadu_ps(&matrix[12]);
+
+    for (; index < count; index++)
+    {
+      auto vector = _mm_loadu_ps(&vectors[index][0]);
+
+      auto product = _mm_mul_ps(column_0, _mm_shuffle_ps(vector, vector, 0x00));
+      product = _mm_add_ps(product, _mm_mul_ps(column_1, _mm_shuffle_ps(vector, vector, 0x55)));
+      product = _mm_add_ps(product, _mm_mul_ps(column_2, _mm_shuffle_ps(vector, vector, 0xAA)));
+      product = _mm_add_ps(product, _mm_mul_ps(column_3, _mm_shuffle_ps(vector, vector, 0xFF)));
+
+      _mm_storeu_ps(&products[index][0], product);
+    }
+#endif
+
+    for (; index < count; index++)
+    {
+      products[index] = matrix * vectors[index];
+    }
+  }
+
+  inline vec3 operator*(const vec3& vector, const mat3& matrix)
+  {
+    return
+    {
+      vector[0] * matrix[0] + vector[1] * matrix[1] + vector[2] * matrix[2],
+      vector[0] * matrix[3] + vector[1] * matrix[4] + vector[2] * matrix[5],
+      vector[0] * matrix[6] + vector[1] * matrix[7] + vector[2] * matrix[8]
+    };
+  }
+
+  inline vec4 operator*(const vec4& vector, const mat4& matrix)
+  {
+    return
+    {
+      vector[0] * matrix[0] + vector[1] * matrix[1] + vector[2] * matrix[2] + vector[3] * matrix[3],
+      vector[0] * matrix[4] + vector[1] * matrix[5] + vector[2] * matrix[6] + vector[3] * matrix[7],
+      vector[0] * matrix[8] + vector[1] * matrix[9] + vector[2] * matrix[10] + vector[3] * matrix[11],
+      vector[0] * matrix[12] + vector[1] * matrix[13] + vector[2] * matrix[14] + vector[3] * matrix[15]
+    };
+  }
+
+  inline mat3 operator*(const mat3& matrix, float scalar)
+  {
+    auto product = matrix;
+    product *= scalar;
+    return product;
+  }
+
+  inline mat4 operator*(const mat4& matrix, float scalar)
+  {
+    auto product = matrix;
+    product *= scalar;
+    return product;
+  }
+
+  inline mat3& operator*=(mat3& matrix, float scalar)
+  {
+    matrix[0] *= scalar;
+    matrix[1] *= scalar;
+    matrix[2] *= scalar;
+
+    matrix[3] *= scalar;
+    matrix[4] *= scalar;
+    matrix[5] *= scalar;
+
+    matrix[6] *= scalar;
+    matrix[7] *= scalar;
+    matrix[8] *= scalar;
+
+    return matrix;
+  }
+
+  inline mat4& operator*=(mat4& matrix, float scalar)
+  {
+    matrix[0] *= scalar;
+    matrix[1] *= scalar;
+    matrix[2] *= scalar;
+    matrix[3] *= scalar;
+
+    matrix[4] *= scalar;
+    matrix[5] *= scalar;
+    matrix[6] *= scalar;
+    matrix[7] *= scalar;
+
+    matrix[8] *= scalar;
+    matrix[9] *= scalar;
+    matrix[10] *= scalar;
+    matrix[11] *= scalar;
+
+    matrix[12] *= scalar;
+    matrix[13] *= scalar;
+    matrix[14] *= scalar;
+    matrix[15] *= scalar;
+
+    return matrix;
+  }
+
+  inline mat3 operator*(float scalar, const mat3& matrix)
+  {
+    return matrix * scalar;
+  }
+
+  inline mat4 operator*(float scalar, const mat4& matrix)
+  {
+    return matrix * scalar;
+  }
+
+  inline vec3 position(const mat4& matrix)
+  {
+    return { matrix[12], matrix[13], matrix[14] };
+  }
+
+  inline vec4 position4(const mat4& matrix)
+  {
+    return { matrix[12], matrix[13], matrix[14], matrix[15] };
+  }
+
+  inline void position(mat4& matrix, const vec3& position)
+  {
+    matrix[12] = position[0];
+    matrix[13] = position[1];
+    matrix[14] = position[2];
+    matrix[15] = 1.0f;
+  }
+
+  inline void position(mat4& matrix, const vec4& position)
+  {
+    matrix[12] = position[0];
+    matrix[13] = position[1];
+    matrix[14] = position[2];
+    matrix[15] = position[3];
+  }
+
+  inline vec3 right(const mat3& matrix)
+  {
+    return { matrix[0], matrix[1], matrix[2] };
+  }
+
+  inline vec3 right(const mat4& matrix)
+  {
+    return { matrix[0], matrix[1], matrix[2] };
+  }
+
+  inline vec4 right4(const mat4& matrix)
+  {
+    return { matrix[0], matrix[1], matrix[2], matrix[3] };
+  }
+
+  inline vec3 up(const mat3& matrix)
+  {
+    return { matrix[3], matrix[4], matrix[5] };
+  }
+
+  inline vec3 up(const mat4& matrix)
+  {
+    return { matrix[4], matrix[5], matrix[6] };
+  }
+
+  inline vec4 up4(const mat4& matrix)
+  {
+    return { matrix[4], matrix[5], matrix[6], matrix[7] };
+  }
+
+  inline vec3 out(const mat3& matrix)
+  {
+    return { matrix[6], matrix[7], matrix[8] };
+  }
+
+  inline vec3 out(const mat4& matrix)
+  {
+    return { matrix[8], matrix[9], matrix[10] };
+  }
+
+  inline vec4 out4(const mat4& matrix)
+  {
+    return { matrix[8], matrix[9], matrix[10], matrix[11] };
+  }
+
+  inline float determinant(const mat3& matrix)
+  {
+    return matrix[0] * (matrix[4] * matrix[8] - matrix[7] * matrix[5]) - matrix[1] * (matrix[3] * matrix[8] - matrix[6] * matrix[5]) + matrix[2] * (matrix[3] * matrix[7] - matrix[6] * matrix[4]);
+  }
+
+  inline float determinant(const mat4& matrix)
+  {
+    auto determinant = matrix[0] *
+    (
+      (matrix[5] * matrix[10] * matrix[15] + matrix[6] * matrix[11] * matrix[13] + matrix[7] * matrix[9] * matrix[14]) -
+      matrix[7] * matrix[10] * matrix[13] - matrix[5] * matrix[11] * matrix[14] - matrix[6] * matrix[9] * matrix[15]
+    );
+
+    determinant -= matrix[1] *
+    (
+      (matrix[4] * matrix[10] * matrix[15] + matrix[6] * matrix[11] * matrix[12] + matrix[7] * matrix[8] * matrix[14]) -
+      matrix[7] * matrix[10] * matrix[12] - matrix[4] * matrix[11] * matrix[14] - matrix[6] * matrix[8] * matrix[15]
+    );
+
+    determinant += matrix[2] *
+    (
+      (matrix[4] * matrix[9] * matrix[15] + matrix[5] * matrix[11] * matrix[12] + matrix[7] * matrix[8] * matrix[13]) -
+      matrix[7] * matrix[9] * matrix[12] - matrix[4] * matrix[11] * matrix[13] - matrix[5] * matrix[8] * matrix[15]
+    );
+
+    determinant -= matrix[3] *
+    (
+      (matrix[4] * matrix[9] * matrix[14] + matrix[5] * matrix[10] * matrix[12] + matrix[6] * matrix[8] * matrix[13]) -
+      matrix[6] * matrix[9] * matrix[12] - matrix[4] * matrix[10] * matrix[13] - matrix[5] * matrix[8] * matrix[14]
+    );
+
+    return determinant;
+  }
+
+  inline void invert(mat3& matrix)
+  {
+    auto determinant = ludo::determinant(matrix);
+    auto determinant_inverse = 1.0f / determinant; // TODO what if the determinant is zero?
+
+    matrix =
+    {
+      -(matrix[4] * matrix[8] - matrix[7] * matrix[5]),
+      (matrix[3] * matrix[8] - matrix[5] * matrix[6]),
+      -(matrix[3] * matrix[7] - matrix[6] * matrix[4]),
+
+      (matrix[1] * matrix[8] - matrix[2] * matrix[7]),
+      -(matrix[0] * matrix[8] - matrix[2] * matrix[6]),
+      (matrix[0] * matrix[7] - matrix[6] * matrix[1]),
+
+      -(matrix[1] * matrix[5] - matrix[2] * matrix[4]),
+      (matrix[0] * matrix[5] - matrix[3] * matrix[2]),
+      -(matrix[0] * matrix[4] - matrix[3] * matrix[1])
+    };
+
+    transpose(matrix);
+    matrix *= determinant_inverse;
+  }
+
+  inline void invert(mat4& matrix)
+  {
+#if defined(LUDO_SSE)
+    // Block-wise inversion using 2x2 sub-matrices (and their adjugates), see https://lxjk.github.io/2017/09/03/Fast-4x4-Matrix-Inverse-with-SSE-SIMD-Explained.html
+    // This is written in terms of rows, but since the inverse of the transpose is the transpose of the inverse it works on columns just the same.
+    // TODO what if the determinant is zero?
+    auto row_0 = _mm_loadu_ps(&matrix[0]);
+    auto row_1 = _mm_loadu_ps(&matrix[4]);
+    auto row_2 = _mm_loadu_ps(&matrix[8]);
+    auto row_3 = _mm_loadu_ps(&matrix[12]);
+
+    // 2x2 matrix multiplication
+    auto multiply_2x2 = [](__m128 lhs, __m128 rhs)
+    {
+      return _mm_add_ps(
+        _mm_mul_ps(lhs, _mm_shuffle_ps(rhs, rhs, _MM_SHUFFLE(3, 0, 3, 0))),
+        _mm_mul_ps(_mm_shuffle_ps(lhs, lhs, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(rhs, rhs, _MM_SHUFFLE(1, 2, 1, 2)))
+      );
+    };
+
+    // 2x2 matrix multiplication where the left-hand matrix is replaced by its adjugate
+    auto adjugate_multiply_2x2 = [](__m128 lhs, __m128 rhs)
+    {
+      return _mm_sub_ps(
+        _mm_mul_ps(_mm_shuffle_ps(lhs, lhs, _MM_SHUFFLE(0, 0, 3, 3)), rhs),
+        _mm_mul_ps(_mm_shuffle_ps(lhs, lhs, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(rhs, rhs, _MM_SHUFFLE(1, 0, 3, 2)))
+      );
+    };
+
+    // 2x2 matrix multiplication where the right-hand matrix is replaced by its adjugate
+    auto multiply_adjugate_2x2 = [](__m128 lhs, __m128 rhs)
+    {
+      return _mm_sub_ps(
+        _mm_mul_ps(lhs, _mm_shuffle_ps(rhs, rhs, _MM_SHUFFLE(0, 3, 0, 3))),
+        _mm_mul_ps(_mm_shuffle_ps(lhs, lhs, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(rhs, rhs, _MM_SHUFFLE(1, 2, 1, 2)))
+      );
+    };
+
+    // The sub-matrices of | a b |
+    //                     | c d |
+    auto a = _mm_movelh_ps(row_0, row_1);
+    auto b = _mm_movehl_ps(row_1, row_0);
+    auto c = _mm_movelh_ps(row_2, row_3);
+    auto d = _mm_movehl_ps(row_3, row_2);
+
+    auto sub_determinants = _mm_sub_ps(
+      _mm_mul_ps(_mm_shuffle_ps(row_0, row_2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(row_1, row_3, _MM_SHUFFLE(3, 1, 3, 1))),
+      _mm_mul_ps(_mm_shuffle_ps(row_0, row_2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(row_1, row_3, _MM_SHUFFLE(2, 0, 2, 0)))
+    );
+    auto determinant_a = _mm_shuffle_ps(sub_determinants, sub_determinants, 0x00);
+    auto determinant_b = _mm_shuffle_ps(sub_determinants, sub_determinants, 0x55);
+    auto determinant_c = _mm_shuffle_ps(sub_determinants, sub_determinants, 0xAA);
+    auto determinant_d = _mm_shuffle_ps(sub_determinants, sub_determinants, 0xFF);
+
+    auto adjugate_d_c = adjugate_multiply_2x2(d, c);
+    auto adjugate_a_b = adjugate_multiply_2x2(a, b);
+
+    // The adjugates of the sub-matrices of the inverse (before being divided by the determinant)
+    auto x = _mm_sub_ps(_mm_mul_ps(determinant_d, a), multiply_2x2(b, adjugate_d_c));
+    auto w = _mm_sub_ps(_mm_mul_ps(determinant_a, d), multiply_2x2(c, adjugate_a_b));
+    auto y = _mm_sub_ps(_mm_mul_ps(determinant_b, c), multiply_adjugate_2x2(d, adjugate_a_b));
+    auto z = _mm_sub_ps(_mm_mul_ps(determinant_c, b), multiply_adjugate_2x2(a, adjugate_d_c));
+
+    auto trace = _mm_mul_ps(adjugate_a_b, _mm_shuffle_ps(adjugate_d_c, adjugate_d_c, _MM_SHUFFLE(3, 1, 2, 0)));
+    trace = _mm_add_ps(trace, _mm_shuffle_ps(trace, trace, _MM_SHUFFLE(2, 3, 0, 1)));
+    trace = _mm_add_ps(trace, _mm_shuffle_ps(trace, trace, _MM_SHUFFLE(1, 0, 3, 2)));
+
+    auto determinant = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(determinant_a, determinant_d), _mm_mul_ps(determinant_b, determinant_c)), trace);
+    auto determinant_inverse = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), determinant);
+
+    x = _mm_mul_ps(x, determinant_inverse);
+    y = _mm_mul_ps(y, determinant_inverse);
+    z = _mm_mul_ps(z, determinant_inverse);
+    w = _mm_mul_ps(w, determinant_inverse);
+
+    // Convert the adjugates back to the sub-matrices while re-assembling the rows
+    _mm_storeu_ps(&matrix[0], _mm_shuffle_ps(x, y, _MM_SHUFFLE(1, 3, 1, 3)));
+    _mm_storeu_ps(&matrix[4], _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 2, 0, 2)));
+    _mm_storeu_ps(&matrix[8], _mm_shuffle_ps(z, w, _MM_SHUFFLE(1, 3, 1, 3)));
+    _mm_storeu_ps(&matrix[12], _mm_shuffle_ps(z, w, _MM_SHUFFLE(0, 2, 0, 2)));
+#else
+    auto determinant = ludo::determinant(matrix);
+    auto determinant_inverse = 1.0f / determinant; // TODO what if the determinant is zero?
+
+    matrix =
+    {
+      ludo::determinant({ matrix[5], matrix[6], matrix[7], matrix[9], matrix[10], matrix[11], matrix[13], matrix[14], matrix[15] }),
+      -ludo::determinant({ matrix[4], matrix[6], matrix[7], matrix[8], matrix[10], matrix[11], matrix[12], matrix[14], matrix[15] }),
+      ludo::determinant({ matrix[4], matrix[5], matrix[7], matrix[8], matrix[9], matrix[11], matrix[12], matrix[13], matrix[15] }),
+      -ludo::determinant({ matrix[4], matrix[5], matrix[6], matrix[8], matrix[9], matrix[10], matrix[12], matrix[13], matrix[14] }),
+
+      -ludo::determinant({ matrix[1], matrix[2], matrix[3], matrix[9], matrix[10], matrix[11], matrix[13], matrix[14], matrix[15] }),
+      ludo::determinant({ matrix[0], matrix[2], matrix[3], matrix[8], matrix[10], matrix[11], matrix[12], matrix[14], matrix[15] }),
+      -ludo::determinant({ matrix[0], matrix[1], matrix[3], matrix[8], matrix[9], matrix[11], matrix[12], matrix[13], matrix[15] }),
+      ludo::determinant({ matrix[0], matrix[1], matrix[2], matrix[8], matrix[9], matrix[10], matrix[12], matrix[13], matrix[14] }),
+
+      ludo::determinant({ matrix[1], matrix[2], matrix[3], matrix[5], matrix[6], matrix[7], matrix[13], matrix[14], matrix[15] }),
+      -ludo::determinant({ matrix[0], matrix[2], matrix[3], matrix[4], matrix[6], matrix[7], matrix[12], matrix[14], matrix[15] }),
+      ludo::determinant({ matrix[0], matrix[1], matrix[3], matrix[4], matrix[5], matrix[7], matrix[12], matrix[13], matrix[15] }),
+      -ludo::determinant({ matrix[0], matrix[1], matrix[2], matrix[4], matrix[5], matrix[6], matrix[12], matrix[13], matrix[14] }),
+
+      -ludo::determinant({ matrix[1], matrix[2], matrix[3], matrix[5], matrix[6], matrix[7], matrix[9], matrix[10], matrix[11] }),
+      ludo::determinant({ matrix[0], matrix[2], matrix[3], matrix[4], matrix[6], matrix[7], matrix[8], matrix[10], matrix[11] }),
+      -ludo::determinant({ matrix[0], matrix[1], matrix[3], matrix[4], matrix[5], matrix[7], matrix[8], matrix[9], matrix[11] }),
+      ludo::determinant({ matrix[0], matrix[1], matrix[2], matrix[4], matrix[5], matrix[6], matrix[8], matrix[9], matrix[10] })
+    };
+
+    transpose(matrix);
+    matrix *= determinant_inverse;
+#endif
+  }
+
+  inline void transpose(mat3& matrix)
+  {
+    float temp;
+
+    temp = matrix[1];
+    matrix[1] = matrix[3];
+    matrix[3] = temp;
+
+    temp = matrix[2];
+    matrix[2] = matrix[6];
+    matrix[6] = temp;
+
+    temp = matrix[5];
+    matrix[5] = matrix[7];
+    matrix[7] = temp;
+  }
+
+  inline void transpose(mat4& matrix)
+  {
+    float temp;
+
+    temp = matrix[1];
+    matrix[1] = matrix[4];
+    matrix[4] = temp;
+
+    temp = matrix[2];
+    matrix[2] = matrix[8];
+    matrix[8] = temp;
+
+    temp = matrix[3];
+    matrix[3] = matrix[12];
+    matrix[12] = temp;
+
+    temp = matrix[6];
+    matrix[6] = matrix[9];
+    matrix[9] = temp;
+
+    temp = matrix[7];
+    matrix[7] = matrix[13];
+    matrix[13] = temp;
+
+    temp = matrix[11];
+    matrix[11] = matrix[14];
+    matrix[14] = temp;
+  }
+
+  inline void scale_abs(mat4& matrix, const vec3& scale)
+  {
+    matrix[0] = scale[0];
+    matrix[5] = scale[1];
+    matrix[10] = scale[2];
+  }
+
+  inline void scale(mat4& matrix, const vec3& scale)
+  {
+    matrix[0] *= scale[0];
+    matrix[5] *= scale[1];
+    matrix[10] *= scale[2];
+  }
+
+  inline void translate(mat4& matrix, const vec3& translation)
+  {
+    matrix[12] += matrix[0] * translation[0] + matrix[4] * translation[1] + matrix[8] * translation[2];
+    matrix[13] += matrix[1] * translation[0] + matrix[5] * translation[1] + matrix[9] * translation[2];
+    matrix[14] += matrix[2] * translation[0] + matrix[6] * translation[1] + matrix[10] * translation[2];
+  }
+
+  inline void translate(mat4& matrix, const vec4& translation)
+  {
+    matrix[12] += matrix[0] * translation[0] + matrix[4] * translation[1] + matrix[8] * translation[2];
+    matrix[13] += matrix[1] * translation[0] + matrix[5] * translation[1] + matrix[9] * translation[2];
+    matrix[14] += matrix[2] * translation[0] + matrix[6] * translation[1] + matrix[10] * translation[2];
+    matrix[15] += matrix[3] * translation[0] + matrix[7] * translation[1] + matrix[11] * translation[2];
+  }
+
+  inline bool near(const mat3& a, const mat3& b, float epsilon)
+  {
+    return
+      near(a[0], b[0], epsilon) && near(a[1], b[1], epsilon) && near(a[2], b[2], epsilon) &&
+      near(a[3], b[3], epsilon) && near(a[4], b[4], epsilon) && near(a[5], b[5], epsilon) &&
+      near(a[6], b[6], epsilon) && near(a[7], b[7], epsilon) && near(a[8], b[8], epsilon);
+  }
+
+  inline bool near(const mat4& a, const mat4& b, float epsilon)
+  {
+    return
+      near(a[0], b[0], epsilon) && near(a[1], b[1], epsilon) && near(a[2], b[2], epsilon) && near(a[3], b[3], epsilon) &&
+      near(a[4], b[4], epsilon) && near(a[5], b[5], epsilon) && near(a[6], b[6], epsilon) && near(a[7], b[7], epsilon) &&
+      near(a[8], b[8], epsilon) && near(a[9], b[9], epsilon) && near(a[10], b[10], epsilon) && near(a[11], b[11], epsilon) &&
+      near(a[12], b[12], epsilon) && near(a[13], b[13], epsilon) && near(a[14], b[14], epsilon) && near(a[15], b[15], epsilon);
+  }
+}
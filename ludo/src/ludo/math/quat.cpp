@@ -9,16 +9,6 @@
 
 namespace ludo
 {
-  quat exp(const quat& quaternion);
-  quat log(const quat& quaternion);
-  quat pow(const quat& quaternion, float exponent);
-
-  quat::quat() : std::array<float, 4>()
-  {}
-
-  quat::quat(float x, float y, float z, float w) : std::array<float, 4> { x, y, z, w }
-  {}
-
   quat::quat(float x, float y, float z) : std::array<float, 4>()
   {
     auto cosines = vec3
@@ -157,65 +147,6 @@ namespace ludo
     *this = from_inverse * to;
   }
 
-  quat operator*(const quat& lhs, const quat& rhs)
-  {
-    auto product = lhs;
-    product *= rhs;
-    return product;
-  }
-
-  quat& operator*=(quat& lhs, const quat& rhs)
-  {
-    lhs =
-    {
-      lhs[3] * rhs[0] + lhs[0] * rhs[3] + lhs[1] * rhs[2] - lhs[2] * rhs[1],
-      lhs[3] * rhs[1] - lhs[0] * rhs[2] + lhs[1] * rhs[3] + lhs[2] * rhs[0],
-      lhs[3] * rhs[2] + lhs[0] * rhs[1] - lhs[1] * rhs[0] + lhs[2] * rhs[3],
-      lhs[3] * rhs[3] - lhs[0] * rhs[0] - lhs[1] * rhs[1] - lhs[2] * rhs[2]
-    };
-
-    return lhs;
-  }
-
-  quat operator*(const quat& quaternion, float scalar)
-  {
-    auto product = quaternion;
-    product *= scalar;
-    return product;
-  }
-
-  quat& operator*=(quat& quaternion, float scalar)
-  {
-    quaternion[0] *= scalar;
-    quaternion[1] *= scalar;
-    quaternion[2] *= scalar;
-    quaternion[3] *= scalar;
-
-    return quaternion;
-  }
-
-  quat operator*(float scalar, const quat& quaternion)
-  {
-    return quaternion * scalar;
-  }
-
-  quat operator/(const quat& quaternion, float scalar)
-  {
-    auto product = quaternion;
-    product /= scalar;
-    return product;
-  }
-
-  quat& operator/=(quat& quaternion, float scalar)
-  {
-    quaternion[0] /= scalar;
-    quaternion[1] /= scalar;
-    quaternion[2] /= scalar;
-    quaternion[3] /= scalar;
-
-    return quaternion;
-  }
-
   std::ostream& operator<<(std::ostream& stream, const quat& quaternion)
   {
     stream << "[" << quaternion[0] << "," << quaternion[1] << "," << quaternion[2] << "," << quaternion[3] << "]";
@@ -223,11 +154,6 @@ namespace ludo
     return stream;
   }
 
-  float length(const quat& quaternion)
-  {
-    return std::sqrt(powf(quaternion[0], 2) + powf(quaternion[1], 2) + powf(quaternion[2], 2) + powf(quaternion[3], 2));
-  }
-
   vec3 angles(const quat& quaternion)
   {
     auto test = quaternion[0] * quaternion[1] + quaternion[2] * quaternion[3];
@@ -288,96 +214,4 @@ namespace ludo
 
     return { axis, angle };
   }
-
-  void normalize(quat& quaternion)
-  {
-    auto length = ludo::length(quaternion);
-    if (length == 0.0f)
-    {
-      return;
-    }
-
-    quaternion /= length;
-  }
-
-  void invert(quat& quaternion)
-  {
-    auto length = ludo::length(quaternion);
-    if (length == 0)
-    {
-      quaternion = { 0.0f, 0.0f, 0.0f, 0.0f };
-      return;
-    }
-
-    length *= length;
-
-    quaternion = { -quaternion[0] / length, -quaternion[1] / length, -quaternion[2] / length, quaternion[3] / length };
-  }
-
-  bool near(const quat& a, const quat& b, float epsilon)
-  {
-    return near(a[0], b[0], epsilon) && near(a[1], b[1], epsilon) && near(a[2], b[2], epsilon) && near(a[3], b[3], epsilon);
-  }
-
-  float dot(const quat& lhs, const quat& rhs)
-  {
-    return lhs[0] * rhs[0] + lhs[1] * rhs[1] + lhs[2] * rhs[2] + lhs[3] * rhs[3];
-  }
-
-  quat slerp(const quat& from, const quat& to, float time)
-  {
-    // Clamp to the range [0,1]
-    time = std::max(std::min(time, 1.0f), 0.0f);
-
-    auto from_inverse = from;
-    invert(from_inverse);
-
-    auto to_final = to;
-    if (dot(from, to) < 0.0f)
-    {
-      to_final *= -1.0f;
-    }
-
-    return from * pow(from_inverse * to_final, time);
-  }
-
-  quat exp(const quat& quaternion)
-  {
-    auto vector = vec3 { quaternion[0], quaternion[1], quaternion[2] };
-    auto vector_length = length(vector);
-    normalize(vector);
-
-    auto sin_vector_length = std::sin(vector_length);
-    auto exp_w = std::exp(quaternion[3]);
-
-    return
-    {
-      vector[0] * sin_vector_length * exp_w,
-      vector[1] * sin_vector_length * exp_w,
-      vector[2] * sin_vector_length * exp_w,
-      std::cos(vector_length) * exp_w
-    };
-  }
-
-  quat log(const quat& quaternion)
-  {
-    auto vector = vec3 { quaternion[0], quaternion[1], quaternion[2] };
-    normalize(vector);
-
-    auto length = ludo::length(quaternion);
-    auto scalar = std::acos(quaternion[3] / length);
-
-    return
-    {
-      vector[0] * scalar,
-      vector[1] * scalar,
-      vector[2] * scalar,
-      std::log(length)
-    };
-  }
-
-  quat pow(const quat& quaternion, float exponent)
-  {
-    return exp(log(quaternion) * exponent);
-  }
 }
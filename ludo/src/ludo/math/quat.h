@@ -151,3 +151,5 @@ namespace ludo
   /// \return The spherical linear interpolation between two quaternions.
   quat slerp(const quat& from, const quat& to, float time);
 }
+
+#include "quat.hpp"
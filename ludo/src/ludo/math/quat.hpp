@@ -0,0 +1,167 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "quat.h"
+#include "simd.h"
+
+namespace ludo
+{
+  inline quat::quat() : std::array<float, 4>()
+  {}
+
+  inline quat::quat(float x, float y, float z, float w) : std::array<float, 4> { x, y, z, w }
+  {}
+
+  inline quat operator*(const quat& lhs, const quat& rhs)
+  {
+    auto product = lhs;
+    product *= rhs;
+    return product;
+  }
+
+  inline quat& operator*=(quat& lhs, const quat& rhs)
+  {
+    lhs =
+    {
+      lhs[3] * rhs[0] + lhs[0] * rhs[3] + lhs[1] * rhs[2] - lhs[2] * rhs[1],
+      lhs[3] * rhs[1] - lhs[0] * rhs[2] + lhs[1] * rhs[3] + lhs[2] * rhs[0],
+      lhs[3] * rhs[2] + lhs[0] * rhs[1] - lhs[1] * rhs[0] + lhs[2] * rhs[3],
+      lhs[3] * rhs[3] - lhs[0] * rhs[0] - lhs[1] * rhs[1] - lhs[2] * rhs[2]
+    };
+
+    return lhs;
+  }
+
+  inline quat operator*(const quat& quaternion, float scalar)
+  {
+    auto product = quaternion;
+    product *= scalar;
+    return product;
+  }
+
+  inline quat& operator*=(quat& quaternion, float scalar)
+  {
+    quaternion[0] *= scalar;
+    quaternion[1] *= scalar;
+    quaternion[2] *= scalar;
+    quaternion[3] *= scalar;
+
+    return quaternion;
+  }
+
+  inline quat operator*(float scalar, const quat& quaternion)
+  {
+    return quaternion * scalar;
+  }
+
+  inline quat operator/(const quat& quaternion, float scalar)
+  {
+    auto product = quaternion;
+    product /= scalar;
+    return product;
+  }
+
+  inline quat& operator/=(quat& quaternion, float scalar)
+  {
+    quaternion[0] /= scalar;
+    quaternion[1] /= scalar;
+    quaternion[2] /= scalar;
+    quaternion[3] /= scalar;
+
+    return quaternion;
+  }
+
+  inline float length(const quat& quaternion)
+  {
+    return std::sqrt(powf(quaternion[0], 2) + powf(quaternion[1], 2) + powf(quaternion[2], 2) + powf(quaternion[3], 2));
+  }
+
+  inline void normalize(quat& quaternion)
+  {
+    auto length = ludo::length(quaternion);
+    if (length == 0.0f)
+    {
+      return;
+    }
+
+    quaternion /= length;
+  }
+
+  inline void invert(quat& quaternion)
+  {
+    auto length = ludo::length(quaternion);
+    if (length == 0)
+    {
+      quaternion = { 0.0f, 0.0f, 0.0f, 0.0f };
+      return;
+    }
+
+    length *= length;
+
+    quaternion = { -quaternion[0] / length, -quaternion[1] / length, -quaternion[2] / length, quaternion[3] / length };
+  }
+
+  inline bool near(const quat& a, const quat& b, float epsilon)
+  {
+    return near(a[0], b[0], epsilon) && near(a[1], b[1], epsilon) && near(a[2], b[2], epsilon) && near(a[3], b[3], epsilon);
+  }
+
+  inline float dot(const quat& lhs, const quat& rhs)
+  {
+    return lhs[0] * rhs[0] + lhs[1] * rhs[1] + lhs[2] * rhs[2] + lhs[3] * rhs[3];
+  }
+
+  inline quat slerp(const quat& from, const quat& to, float time)
+  {
+    // Clamp to the range [0,1]
+    time = std::max(std::min(time, 1.0f), 0.0f);
+
+    // Take the shortest path
+    auto cosine = dot(from, to);
+    auto to_sign = 1.0f;
+    if (cosine < 0.0f)
+    {
+      cosine = -cosine;
+      to_sign = -1.0f;
+    }
+
+    // When the quaternions are very close the angle is too small to divide by, but a linear interpolation is indistinguishable.
+    auto from_weight = 1.0f - time;
+    auto to_weight = time;
+    auto linear = cosine > 0.9995f;
+    if (!linear)
+    {
+      auto angle = std::acos(cosine);
+      auto sine_inverse = 1.0f / std::sin(angle);
+      from_weight = std::sin(from_weight * angle) * sine_inverse;
+      to_weight = std::sin(to_weight * angle) * sine_inverse;
+    }
+
+    to_weight *= to_sign;
+
+    auto result = quat();
+#if defined(LUDO_SSE)
+    _mm_storeu_ps(&result[0], _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&from[0]), _mm_set1_ps(from_weight)), _mm_mul_ps(_mm_loadu_ps(&to[0]), _mm_set1_ps(to_weight))));
+#else
+    result =
+    {
+      from[0] * from_weight + to[0] * to_weight,
+      from[1] * from_weight + to[1] * to_weight,
+      from[2] * from_weight + to[2] * to_weight,
+      from[3] * from_weight + to[3] * to_weight
+    };
+#endif
+
+    if (linear)
+    {
+      normalize(result);
+    }
+
+    return result;
+  }
+
+}
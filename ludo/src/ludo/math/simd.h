@@ -0,0 +1,21 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#pragma once
+
+// Selects the SIMD kernels used by the math library from the instruction sets the compiler is targeting.
+// SSE2 is part of every x86-64 target, AVX is only used when it is enabled explicitly (i.e. -mavx or /arch:AVX).
+// Define LUDO_NO_SIMD to fall back to the scalar implementations.
+
+#if !defined(LUDO_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define LUDO_SSE
+#endif
+
+#if defined(LUDO_SSE) && defined(__AVX__)
+#define LUDO_AVX
+#endif
+
+#if defined(LUDO_SSE)
+#include <immintrin.h>
+#endif
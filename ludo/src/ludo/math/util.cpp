@@ -2,12 +2,16 @@
  * This file is part of ludo. See the LICENSE file for the full license governing this code.
  */
 
+#include <cassert>
 #include <cmath>
 
 #include "util.h"
 
 namespace ludo
 {
+  uint32_t spread_bits(uint32_t value);
+  uint32_t compact_bits(uint32_t value);
+
   bool near(float a, float b, float epsilon)
   {
     return std::abs(a - b) < epsilon;
@@ -31,4 +35,40 @@ namespace ludo
 
     return angle;
   }
+
+  uint32_t morton_encode(const std::array<uint32_t, 3>& coordinates)
+  {
+    assert(coordinates[0] < 1024 && coordinates[1] < 1024 && coordinates[2] < 1024 && "coordinates out of range");
+
+    return (spread_bits(coordinates[0]) << 2) | (spread_bits(coordinates[1]) << 1) | spread_bits(coordinates[2]);
+  }
+
+  std::array<uint32_t, 3> morton_decode(uint32_t code)
+  {
+    return { compact_bits(code >> 2), compact_bits(code >> 1), compact_bits(code) };
+  }
+
+  // Spreads the lower 10 bits of a value out so that there are 2 zero bits between each of them.
+  uint32_t spread_bits(uint32_t value)
+  {
+    value &= 0x000003ff;
+    value = (value | (value << 16)) & 0x030000ff;
+    value = (value | (value << 8)) & 0x0300f00f;
+    value = (value | (value << 4)) & 0x030c30c3;
+    value = (value | (value << 2)) & 0x09249249;
+
+    return value;
+  }
+
+  // The inverse of spread_bits.
+  uint32_t compact_bits(uint32_t value)
+  {
+    value &= 0x09249249;
+    value = (value | (value >> 2)) & 0x030c30c3;
+    value = (value | (value >> 4)) & 0x0300f00f;
+    value = (value | (value >> 8)) & 0x030000ff;
+    value = (value | (value >> 16)) & 0x000003ff;
+
+    return value;
+  }
 }
@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
+
 namespace ludo
 {
   const float pi = 3.14159265358979323f; ///< The ratio of a circle's circumference to its diameter
@@ -30,4 +33,17 @@ namespace ludo
   /// \param angle The angle to reduce.
   /// \return The shortest equivalent angle.
   float shortest_angle(float angle);
+
+  ///
+  /// Interleaves the bits of 3D coordinates into a Morton code (i.e. an index along a Z-order curve).
+  /// Coordinates that are near to each-other produce codes that are near to each-other, and the cells of any aligned power-of-two block have contiguous codes.
+  /// \param coordinates The coordinates. Each coordinate must be less than 1024.
+  /// \return The Morton code, with the bits of each coordinate ordered x, y then z from most to least significant (so that a 2x2x2 block matches row-major order).
+  uint32_t morton_encode(const std::array<uint32_t, 3>& coordinates);
+
+  ///
+  /// De-interleaves a Morton code into 3D coordinates.
+  /// \param code The Morton code.
+  /// \return The coordinates.
+  std::array<uint32_t, 3> morton_decode(uint32_t code);
 }
@@ -269,3 +269,5 @@ namespace ludo
   float angle_between(const vec2& a, const vec2& b);
   float angle_between(const vec3& a, const vec3& b);
 }
+
+#include "vec.hpp"
@@ -2,13 +2,48 @@
  * This file is part of ludo. See the LICENSE file for the full license governing this code.
  */
 
+#include <cstring>
 #include <fstream>
+#include <limits>
+#include <sstream>
 
 #include "animation.h"
+#include "files.h"
 #include "meshes.h"
+#include "spatial/bounds.h"
 
 namespace ludo
 {
+  // The fixed size header at the start of a ludo mesh file. It is followed by the section table.
+  struct mesh_file_header
+  {
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint32_t section_count = 0;
+    uint32_t vertex_size = 0;
+    std::array<char, 32> format = {}; // The vertex format components e.g. p3n3c4 (empty if unknown).
+  };
+
+  // The header at the start of a legacy (unsectioned) ludo mesh file, the index data sits between the index buffer size and the vertex size.
+  struct legacy_mesh_file_header
+  {
+    uint64_t index_buffer_size = 0;
+    uint32_t vertex_size = 0;
+    uint64_t vertex_buffer_size = 0;
+  };
+
+  const auto mesh_file_magic = uint32_t(0x48534d4c); // "LMSH"
+  const auto mesh_file_version = uint32_t(1);
+
+  static_assert(sizeof(mesh_file_header) == 48 && sizeof(mesh_section) == 48, "mesh file layout changed");
+
+  std::vector<mesh> load_mapped(const std::string& file_name, heap& indices, heap& vertices, uint32_t section_limit);
+  bool read_mesh_file_header(std::istream& stream, mesh_file_header& header, std::vector<mesh_section>& sections);
+  mesh load_legacy(std::istream& stream, heap& indices, heap& vertices);
+  std::pair<uint32_t, uint32_t> mesh_counts_legacy(std::istream& stream);
+  legacy_mesh_file_header read_legacy_mesh_file_header(std::istream& stream);
+  uint64_t align_section(uint64_t position);
+
   vertex_format format(bool normal, bool color, bool texture_coordinate, bool bone_weights)
   {
     auto format = vertex_format();
@@ -81,66 +116,283 @@ namespace ludo
 
   mesh load(const std::string& file_name, heap& indices, heap& vertices)
   {
-    auto stream = std::ifstream(file_name, std::ios::binary);
+    auto meshes = load_mapped(file_name, indices, vertices, 1);
+    assert(!meshes.empty() && "mesh file has no sections");
 
-    return load(stream, indices, vertices);
+    return meshes[0];
   }
 
   mesh load(std::istream& stream, heap& indices, heap& vertices)
   {
+    auto start = stream.tellg();
+
+    auto header = mesh_file_header();
+    auto sections = std::vector<mesh_section>();
+    if (!read_mesh_file_header(stream, header, sections))
+    {
+      return load_legacy(stream, indices, vertices);
+    }
+
+    assert(!sections.empty() && "mesh file has no sections");
+    auto& section = sections[0];
+
     auto mesh = ludo::mesh();
     mesh.id = next_id++;
+    mesh.vertex_size = header.vertex_size;
 
-    stream.read(reinterpret_cast<char*>(&mesh.index_buffer.size), sizeof(uint64_t));
-    mesh.index_buffer = allocate(indices, mesh.index_buffer.size);
+    mesh.index_buffer = allocate(indices, section.index_count * sizeof(uint32_t));
+    stream.seekg(start + static_cast<std::streamoff>(section.index_offset));
     stream.read(reinterpret_cast<char*>(mesh.index_buffer.data), static_cast<int64_t>(mesh.index_buffer.size));
 
-    stream.read(reinterpret_cast<char*>(&mesh.vertex_size), sizeof(uint32_t));
-
-    stream.read(reinterpret_cast<char*>(&mesh.vertex_buffer.size), sizeof(uint64_t));
-    mesh.vertex_buffer = allocate(vertices, mesh.vertex_buffer.size, mesh.vertex_size);
+    mesh.vertex_buffer = allocate(vertices, section.vertex_count * mesh.vertex_size, mesh.vertex_size);
+    stream.seekg(start + static_cast<std::streamoff>(section.vertex_offset));
     stream.read(reinterpret_cast<char*>(mesh.vertex_buffer.data), static_cast<int64_t>(mesh.vertex_buffer.size));
 
     return mesh;
   }
 
+  std::vector<mesh> load_sections(const std::string& file_name, heap& indices, heap& vertices)
+  {
+    return load_mapped(file_name, indices, vertices, std::numeric_limits<uint32_t>::max());
+  }
+
   void save(const mesh& mesh, const std::string& file_name)
+  {
+    save(std::span(&mesh, 1), vertex_format(), file_name);
+  }
+
+  void save(const mesh& mesh, std::ostream& stream)
+  {
+    save(std::span(&mesh, 1), vertex_format(), stream);
+  }
+
+  void save(std::span<const mesh> meshes, const vertex_format& format, const std::string& file_name)
   {
     auto stream = std::ofstream(file_name, std::ios::binary);
 
-    save(mesh, stream);
+    save(meshes, format, stream);
   }
 
-  void save(const mesh& mesh, std::ostream& stream)
+  void save(std::span<const mesh> meshes, const vertex_format& format, std::ostream& stream)
   {
-    stream.write(reinterpret_cast<const char*>(&mesh.index_buffer.size), sizeof(uint64_t));
-    stream.write(reinterpret_cast<const char*>(mesh.index_buffer.data), static_cast<int64_t>(mesh.index_buffer.size));
+    auto header = mesh_file_header
+    {
+      .magic = mesh_file_magic,
+      .version = mesh_file_version,
+      .section_count = static_cast<uint32_t>(meshes.size()),
+      .vertex_size = meshes.empty() ? format.size : meshes[0].vertex_size
+    };
+
+    auto format_stream = std::ostringstream();
+    for (auto& component : format.components)
+    {
+      format_stream << component.first << component.second;
+    }
+
+    auto format_string = format_stream.str();
+    assert(format_string.size() < header.format.size() && "vertex format too long");
+    std::copy(format_string.begin(), format_string.end(), header.format.begin());
 
-    stream.write(reinterpret_cast<const char*>(&mesh.vertex_size), sizeof(uint32_t));
+    // Without a format, the positions are assumed to be at the start of each vertex (as they are in every format ludo builds).
+    auto bounds_format = format.components.empty() ? vertex_format { .size = header.vertex_size } : format;
 
-    stream.write(reinterpret_cast<const char*>(&mesh.vertex_buffer.size), sizeof(uint64_t));
-    stream.write(reinterpret_cast<const char*>(mesh.vertex_buffer.data), static_cast<int64_t>(mesh.vertex_buffer.size));
+    // The data of each section is 16 byte aligned so that it can be used in place.
+    auto position = align_section(sizeof(mesh_file_header) + meshes.size() * sizeof(mesh_section));
+    auto sections = std::vector<mesh_section>();
+    for (auto& mesh : meshes)
+    {
+      assert(mesh.vertex_size == header.vertex_size && "meshes have different vertex sizes");
+      assert((format.components.empty() || format.size == mesh.vertex_size) && "vertex format does not match the meshes");
+
+      auto mesh_bounds = bounds(mesh, bounds_format);
+      auto& section = sections.emplace_back(mesh_section
+      {
+        .index_offset = position,
+        .vertex_offset = align_section(position + mesh.index_buffer.size),
+        .index_count = static_cast<uint32_t>(mesh.index_buffer.size / sizeof(uint32_t)),
+        .vertex_count = header.vertex_size ? static_cast<uint32_t>(mesh.vertex_buffer.size / header.vertex_size) : 0,
+        .min = mesh_bounds.min,
+        .max = mesh_bounds.max
+      });
+
+      position = align_section(section.vertex_offset + mesh.vertex_buffer.size);
+    }
+
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(mesh_file_header));
+    stream.write(reinterpret_cast<const char*>(sections.data()), static_cast<int64_t>(sections.size() * sizeof(mesh_section)));
+
+    position = sizeof(mesh_file_header) + sections.size() * sizeof(mesh_section);
+    auto padding = std::array<char, 16>();
+    for (auto index = std::size_t(0); index < meshes.size(); index++)
+    {
+      stream.write(padding.data(), static_cast<int64_t>(sections[index].index_offset - position));
+      stream.write(reinterpret_cast<const char*>(meshes[index].index_buffer.data), static_cast<int64_t>(meshes[index].index_buffer.size));
+      position = sections[index].index_offset + meshes[index].index_buffer.size;
+
+      stream.write(padding.data(), static_cast<int64_t>(sections[index].vertex_offset - position));
+      stream.write(reinterpret_cast<const char*>(meshes[index].vertex_buffer.data), static_cast<int64_t>(meshes[index].vertex_buffer.size));
+      position = sections[index].vertex_offset + meshes[index].vertex_buffer.size;
+    }
   }
 
   std::pair<uint32_t, uint32_t> mesh_counts(const std::string& file_name)
   {
-    auto stream = std::ifstream(file_name);
+    auto stream = std::ifstream(file_name, std::ios::binary);
 
     return mesh_counts(stream);
   }
 
   std::pair<uint32_t, uint32_t> mesh_counts(std::istream& stream)
   {
-    auto index_buffer_size = uint64_t(0);
-    stream.read(reinterpret_cast<char*>(&index_buffer_size), sizeof(uint64_t));
-    stream.seekg(static_cast<int64_t>(index_buffer_size), std::ios_base::cur);
+    auto header = mesh_file_header();
+    auto sections = std::vector<mesh_section>();
+    if (!read_mesh_file_header(stream, header, sections))
+    {
+      return mesh_counts_legacy(stream);
+    }
+
+    auto counts = std::pair<uint32_t, uint32_t>();
+    for (auto& section : sections)
+    {
+      counts.first += section.index_count;
+      counts.second += section.vertex_count;
+    }
+
+    return counts;
+  }
+
+  std::vector<mesh_section> mesh_sections(const std::string& file_name)
+  {
+    auto stream = std::ifstream(file_name, std::ios::binary);
+
+    auto header = mesh_file_header();
+    auto sections = std::vector<mesh_section>();
+    if (!read_mesh_file_header(stream, header, sections))
+    {
+      // Legacy files hold a single mesh without bounds.
+      auto legacy_header = read_legacy_mesh_file_header(stream);
+      sections.emplace_back(mesh_section
+      {
+        .index_offset = sizeof(uint64_t),
+        .vertex_offset = sizeof(uint64_t) + legacy_header.index_buffer_size + sizeof(uint32_t) + sizeof(uint64_t),
+        .index_count = static_cast<uint32_t>(legacy_header.index_buffer_size / sizeof(uint32_t)),
+        .vertex_count = legacy_header.vertex_size ? static_cast<uint32_t>(legacy_header.vertex_buffer_size / legacy_header.vertex_size) : 0
+      });
+    }
+
+    return sections;
+  }
+
+  std::vector<mesh> load_mapped(const std::string& file_name, heap& indices, heap& vertices, uint32_t section_limit)
+  {
+    // Legacy files are read straight from the stream, only sectioned files are worth mapping.
+    {
+      auto stream = std::ifstream(file_name, std::ios::binary);
+      assert(stream && "failed to open mesh file");
+
+      auto magic = uint32_t(0);
+      stream.read(reinterpret_cast<char*>(&magic), sizeof(uint32_t));
+      if (!stream || magic != mesh_file_magic)
+      {
+        stream.clear();
+        stream.seekg(0);
+        return { load_legacy(stream, indices, vertices) };
+      }
+    }
 
-    auto vertex_size = uint32_t(0);
-    stream.read(reinterpret_cast<char*>(&vertex_size), sizeof(uint32_t));
+    auto file = map_file(file_name);
+    assert(file.data && "failed to map mesh file");
 
-    auto vertex_buffer_size = uint64_t(0);
-    stream.read(reinterpret_cast<char*>(&vertex_buffer_size), sizeof(uint64_t));
+    auto header = mesh_file_header();
+    assert(file.size >= sizeof(mesh_file_header) && "truncated mesh file");
+    std::memcpy(&header, file.data, sizeof(mesh_file_header));
+
+    assert(header.version <= mesh_file_version && "unsupported mesh file version");
+    assert(sizeof(mesh_file_header) + header.section_count * sizeof(mesh_section) <= file.size && "truncated mesh file");
+
+    auto meshes = std::vector<mesh>();
+    for (auto section_index = uint32_t(0); section_index < std::min(header.section_count, section_limit); section_index++)
+    {
+      auto& section = cast<mesh_section>(file, sizeof(mesh_file_header) + section_index * sizeof(mesh_section));
+      assert(section.index_offset + section.index_count * sizeof(uint32_t) <= file.size && "truncated mesh file");
+      assert(section.vertex_offset + section.vertex_count * header.vertex_size <= file.size && "truncated mesh file");
+
+      auto& mesh = meshes.emplace_back();
+      mesh.id = next_id++;
+      mesh.vertex_size = header.vertex_size;
+
+      // Only the pages of this section are faulted in by the copies.
+      mesh.index_buffer = allocate(indices, section.index_count * sizeof(uint32_t));
+      std::memcpy(mesh.index_buffer.data, file.data + section.index_offset, mesh.index_buffer.size);
+
+      mesh.vertex_buffer = allocate(vertices, section.vertex_count * mesh.vertex_size, mesh.vertex_size);
+      std::memcpy(mesh.vertex_buffer.data, file.data + section.vertex_offset, mesh.vertex_buffer.size);
+    }
 
-    return { index_buffer_size / sizeof(uint32_t), vertex_buffer_size / vertex_size };
+    unmap_file(file);
+
+    return meshes;
+  }
+
+  bool read_mesh_file_header(std::istream& stream, mesh_file_header& header, std::vector<mesh_section>& sections)
+  {
+    auto start = stream.tellg();
+
+    stream.read(reinterpret_cast<char*>(&header), sizeof(mesh_file_header));
+    if (!stream || header.magic != mesh_file_magic)
+    {
+      stream.clear();
+      stream.seekg(start);
+      return false;
+    }
+
+    assert(header.version <= mesh_file_version && "unsupported mesh file version");
+
+    sections.resize(header.section_count);
+    stream.read(reinterpret_cast<char*>(sections.data()), static_cast<int64_t>(sections.size() * sizeof(mesh_section)));
+
+    return true;
+  }
+
+  mesh load_legacy(std::istream& stream, heap& indices, heap& vertices)
+  {
+    auto mesh = ludo::mesh();
+    mesh.id = next_id++;
+
+    stream.read(reinterpret_cast<char*>(&mesh.index_buffer.size), sizeof(uint64_t));
+    mesh.index_buffer = allocate(indices, mesh.index_buffer.size);
+    stream.read(reinterpret_cast<char*>(mesh.index_buffer.data), static_cast<int64_t>(mesh.index_buffer.size));
+
+    stream.read(reinterpret_cast<char*>(&mesh.vertex_size), sizeof(uint32_t));
+
+    stream.read(reinterpret_cast<char*>(&mesh.vertex_buffer.size), sizeof(uint64_t));
+    mesh.vertex_buffer = allocate(vertices, mesh.vertex_buffer.size, mesh.vertex_size);
+    stream.read(reinterpret_cast<char*>(mesh.vertex_buffer.data), static_cast<int64_t>(mesh.vertex_buffer.size));
+
+    return mesh;
+  }
+
+  std::pair<uint32_t, uint32_t> mesh_counts_legacy(std::istream& stream)
+  {
+    auto header = read_legacy_mesh_file_header(stream);
+
+    return { header.index_buffer_size / sizeof(uint32_t), header.vertex_buffer_size / header.vertex_size };
+  }
+
+  legacy_mesh_file_header read_legacy_mesh_file_header(std::istream& stream)
+  {
+    auto header = legacy_mesh_file_header();
+
+    stream.read(reinterpret_cast<char*>(&header.index_buffer_size), sizeof(uint64_t));
+    stream.seekg(static_cast<int64_t>(header.index_buffer_size), std::ios_base::cur);
+    stream.read(reinterpret_cast<char*>(&header.vertex_size), sizeof(uint32_t));
+    stream.read(reinterpret_cast<char*>(&header.vertex_buffer_size), sizeof(uint64_t));
+
+    return header;
+  }
+
+  uint64_t align_section(uint64_t position)
+  {
+    return (position + 15) & ~uint64_t(15);
   }
 }
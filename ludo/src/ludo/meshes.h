@@ -6,6 +6,7 @@
 
 #include <istream>
 #include <ostream>
+#include <span>
 
 #include "data/buffers.h"
 #include "data/data.h"
@@ -70,6 +71,20 @@ namespace ludo
     uint32_t vertex_size = 0; ///< The size in bytes of a vertex within this mesh.
   };
 
+  ///
+  /// A section of a ludo mesh file e.g. a level of detail.
+  /// Ludo mesh files begin with a fixed size header (holding the vertex size and format) followed by a table of sections.
+  /// The indices and vertices of each section are stored as they are laid out in memory, so they can be copied straight out of a mapped file.
+  struct mesh_section
+  {
+    uint64_t index_offset = 0; ///< The offset (in bytes, from the start of the file) to the indices.
+    uint64_t vertex_offset = 0; ///< The offset (in bytes, from the start of the file) to the vertices.
+    uint32_t index_count = 0; ///< The number of indices.
+    uint32_t vertex_count = 0; ///< The number of vertices.
+    vec3 min = vec3_zero; ///< The corner of the bounds of the vertex positions with the minimum values in all dimensions.
+    vec3 max = vec3_zero; ///< The corner of the bounds of the vertex positions with the maximum values in all dimensions.
+  };
+
   const auto vertex_format_p = vertex_format ///< A vertex format containing only position information
   {
     .components = { { 'p', 3 } },
@@ -148,7 +163,7 @@ namespace ludo
   void de_init(mesh& mesh, heap& indices, heap& vertices);
 
   ///
-  /// Loads a mesh from a ludo mesh file.
+  /// Loads the first section of a ludo mesh file. The file is memory mapped and copied straight into the index and vertex heaps.
   /// \param file_name The name of the file containing the mesh data.
   /// \param indices The indices to allocate from.
   /// \param vertices The vertices to allocate from.
@@ -156,7 +171,7 @@ namespace ludo
   mesh load(const std::string& file_name, heap& indices, heap& vertices);
 
   ///
-  /// Loads a mesh from a stream.
+  /// Loads the first section of a ludo mesh from a stream.
   /// \param stream The mesh data.
   /// \param indices The indices to allocate from.
   /// \param vertices The vertices to allocate from.
@@ -164,30 +179,54 @@ namespace ludo
   mesh load(std::istream& stream, heap& indices, heap& vertices);
 
   ///
-  /// Saves a mesh to a ludo mesh file.
+  /// Loads every section of a ludo mesh file. The file is memory mapped and copied straight into the index and vertex heaps.
+  /// \param file_name The name of the file containing the mesh data.
+  /// \param indices The indices to allocate from.
+  /// \param vertices The vertices to allocate from.
+  /// \return The meshes, one per section.
+  std::vector<mesh> load_sections(const std::string& file_name, heap& indices, heap& vertices);
+
+  ///
+  /// Saves a mesh to a ludo mesh file (as a single section with an unknown vertex format).
   /// \param mesh The mesh.
   /// \param file_name The name of the file to save to.
   void save(const mesh& mesh, const std::string& file_name);
 
   ///
-  /// Saves a mesh to a stream.
+  /// Saves a mesh to a stream (as a single section with an unknown vertex format).
   /// \param mesh The mesh.
   /// \param stream The mesh data.
   void save(const mesh& mesh, std::ostream& stream);
 
   ///
-  /// Reads mesh counts from a ludo mesh file.
+  /// Saves meshes to a ludo mesh file, one section per mesh.
+  /// \param meshes The meshes. They must share the same vertex format.
+  /// \param format The vertex format of the meshes.
+  /// \param file_name The name of the file to save to.
+  void save(std::span<const mesh> meshes, const vertex_format& format, const std::string& file_name);
+
+  ///
+  /// Saves meshes to a stream, one section per mesh.
+  /// \param meshes The meshes. They must share the same vertex format.
+  /// \param format The vertex format of the meshes.
+  /// \param stream The mesh data.
+  void save(std::span<const mesh> meshes, const vertex_format& format, std::ostream& stream);
+
+  ///
+  /// Reads mesh counts from a ludo mesh file. Only the header and section table are read.
   /// \param file_name The name of the file containing the mesh data.
-  /// \param indices The indices to allocate from.
-  /// \param vertices The vertices to allocate from.
-  /// \return The mesh counts.
+  /// \return The mesh counts, summed across all the sections.
   std::pair<uint32_t, uint32_t> mesh_counts(const std::string& file_name);
 
   ///
-  /// Reads mesh counts mesh from a stream.
+  /// Reads mesh counts from a stream. Only the header and section table are read.
   /// \param stream The mesh data.
-  /// \param indices The indices to allocate from.
-  /// \param vertices The vertices to allocate from.
-  /// \return The mesh counts.
+  /// \return The mesh counts, summed across all the sections.
   std::pair<uint32_t, uint32_t> mesh_counts(std::istream& stream);
+
+  ///
+  /// Reads the section table of a ludo mesh file. Only the header and section table are read.
+  /// \param file_name The name of the file containing the mesh data.
+  /// \return The sections.
+  std::vector<mesh_section> mesh_sections(const std::string& file_name);
 }
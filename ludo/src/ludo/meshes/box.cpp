@@ -12,10 +12,13 @@ namespace ludo
     auto index_index = start_index;
     auto vertex_index = start_vertex;
 
-    box(mesh, format, index_index, vertex_index, options, true, false);
+    auto welder = vertex_welder();
+    init(welder, mesh, format, start_vertex);
+
+    box(mesh, format, index_index, vertex_index, options, &welder);
   }
 
-  void box(mesh& mesh, const vertex_format& format, uint32_t& index_index, uint32_t& vertex_index, const shape_options& options, bool unique_only, bool no_normal_check)
+  void box(mesh& mesh, const vertex_format& format, uint32_t& index_index, uint32_t& vertex_index, const shape_options& options, vertex_welder* welder)
   {
     assert(options.divisions >= 1 && "must have at-least 1 division");
     assert(options.outward_faces || options.inward_faces && "outward and/or inward faces must be specified");
@@ -35,8 +38,7 @@ namespace ludo
         vec3 { 0.0f, options.dimensions[1], 0.0f },
         vec2 { 1.0f / 4.0f, 1.0f / 3.0f },
         tex_coord_delta,
-        unique_only,
-        no_normal_check,
+        welder,
         options.color,
         options.divisions
       );
@@ -52,8 +54,7 @@ namespace ludo
         vec3 { 0.0f, options.dimensions[1], 0.0f },
         vec2 { 3.0f / 4.0f, 1.0f / 3.0f },
         tex_coord_delta,
-        unique_only,
-        no_normal_check,
+        welder,
         options.color,
         options.divisions
       );
@@ -69,8 +70,7 @@ namespace ludo
         vec3 { 0.0f, options.dimensions[1], 0.0f },
         vec2 { 0.0f, 1.0f / 3.0f },
         tex_coord_delta,
-        unique_only,
-        no_normal_check,
+        welder,
         options.color,
         options.divisions
       );
@@ -86,8 +86,7 @@ namespace ludo
         vec3 { 0.0f, options.dimensions[1], 0.0f },
         vec2 { 2.0f / 4.0f, 1.0f / 3.0f },
         tex_coord_delta,
-        unique_only,
-        no_normal_check,
+        welder,
         options.color,
         options.divisions
       );
@@ -103,8 +102,7 @@ namespace ludo
         vec3 { 0.0f, 0.0f, -options.dimensions[2] },
         vec2 { 1.0f / 4.0f, 2.0f / 3.0f },
         tex_coord_delta,
-        unique_only,
-        no_normal_check,
+        welder,
         options.color,
         options.divisions
       );
@@ -120,8 +118,7 @@ namespace ludo
         vec3 { 0.0f, 0.0f, options.dimensions[2] },
         vec2 { 1.0f / 4.0f, 0.0f },
         tex_coord_delta,
-        unique_only,
-        no_normal_check,
+        welder,
         options.color,
         options.divisions
       );
@@ -140,8 +137,7 @@ namespace ludo
         vec3 { 0.0f, options.dimensions[1], 0.0f },
         vec2 { 1.0f / 4.0f, 1.0f / 3.0f },
         tex_coord_delta,
-        unique_only,
-        no_normal_check,
+        welder,
         options.color,
         options.divisions
       );
@@ -157,8 +153,7 @@ namespace ludo
         vec3 { 0.0f, options.dimensions[1], 0.0f },
         vec2 { 3.0f / 4.0f, 1.0f / 3.0f },
         tex_coord_delta,
-        unique_only,
-        no_normal_check,
+        welder,
         options.color,
         options.divisions
       );
@@ -174,8 +169,7 @@ namespace ludo
         vec3 { 0.0f, options.dimensions[1], 0.0f },
         vec2 { 2.0f / 4.0f, 1.0f / 3.0f },
         tex_coord_delta,
-        unique_only,
-        no_normal_check,
+        welder,
         options.color,
         options.divisions
       );
@@ -191,8 +185,7 @@ namespace ludo
         vec3 { 0.0f, options.dimensions[1], 0.0f },
         vec2 { 0.0f, 1.0f / 3.0f },
         tex_coord_delta,
-        unique_only,
-        no_normal_check,
+        welder,
         options.color,
         options.divisions
       );
@@ -208,8 +201,7 @@ namespace ludo
         vec3 { 0.0f, 0.0f, -options.dimensions[1] },
         vec2 { 1.0f / 4.0f, 2.0f / 3.0f },
         tex_coord_delta,
-        unique_only,
-        no_normal_check,
+        welder,
         options.color,
         options.divisions
       );
@@ -225,8 +217,7 @@ namespace ludo
         vec3 { 0.0f, 0.0f, options.dimensions[1] },
         vec2 { 1.0f / 4.0f, 0.0f },
         tex_coord_delta,
-        unique_only,
-        no_normal_check,
+        welder,
         options.color,
         options.divisions
       );
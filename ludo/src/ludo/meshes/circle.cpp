@@ -18,16 +18,19 @@ namespace ludo
     auto index_index = start_index;
     auto vertex_index = start_vertex;
 
+    auto welder = vertex_welder();
+    init(welder, mesh, format, start_vertex);
+
     auto radius = options.dimensions[0] / 2.0f;
 
     if (options.outward_faces)
     {
-      circle(mesh, format, index_index, vertex_index, options.center, radius, options.divisions, options.color, false);
+      circle(mesh, format, welder, index_index, vertex_index, options.center, radius, options.divisions, options.color, false);
     }
 
     if (options.inward_faces)
     {
-      circle(mesh, format, index_index, vertex_index, options.center, radius, options.divisions, options.color, true);
+      circle(mesh, format, welder, index_index, vertex_index, options.center, radius, options.divisions, options.color, true);
     }
   }
 
@@ -47,7 +50,7 @@ namespace ludo
     return { total, unique };
   }
 
-  void circle(mesh& mesh, const vertex_format& format, uint32_t& index_index, uint32_t& vertex_index, const vec3& center, float radius, uint32_t divisions, const vec4& color, bool invert)
+  void circle(mesh& mesh, const vertex_format& format, vertex_welder& welder, uint32_t& index_index, uint32_t& vertex_index, const vec3& center, float radius, uint32_t divisions, const vec4& color, bool invert)
   {
     auto normal = vec3 { 0.0f, 0.0f, 1.0f };
     if (invert)
@@ -60,17 +63,17 @@ namespace ludo
       auto angle_0 = -two_pi * static_cast<float>(division) / static_cast<float>(divisions);
       auto angle_1 = -two_pi * static_cast<float>(division + 1) / static_cast<float>(divisions);
 
-      write_vertex(mesh, format, index_index, vertex_index, center, normal, color, { 0.0f, 0.0f });
+      write_vertex(mesh, format, welder, index_index, vertex_index, center, normal, color, { 0.0f, 0.0f });
 
       if (invert)
       {
-        write_vertex(mesh, format, index_index, vertex_index, center + vec3 { std::sin(angle_1), std::cos(angle_1), 0.0f } * radius, normal, color, { 0.0f, 0.0f });
-        write_vertex(mesh, format, index_index, vertex_index, center + vec3 { std::sin(angle_0), std::cos(angle_0), 0.0f } * radius, normal, color, { 0.0f, 0.0f });
+        write_vertex(mesh, format, welder, index_index, vertex_index, center + vec3 { std::sin(angle_1), std::cos(angle_1), 0.0f } * radius, normal, color, { 0.0f, 0.0f });
+        write_vertex(mesh, format, welder, index_index, vertex_index, center + vec3 { std::sin(angle_0), std::cos(angle_0), 0.0f } * radius, normal, color, { 0.0f, 0.0f });
       }
       else
       {
-        write_vertex(mesh, format, index_index, vertex_index, center + vec3 { std::sin(angle_0), std::cos(angle_0), 0.0f } * radius, normal, color, { 0.0f, 0.0f });
-        write_vertex(mesh, format, index_index, vertex_index, center + vec3 { std::sin(angle_1), std::cos(angle_1), 0.0f } * radius, normal, color, { 0.0f, 0.0f });
+        write_vertex(mesh, format, welder, index_index, vertex_index, center + vec3 { std::sin(angle_0), std::cos(angle_0), 0.0f } * radius, normal, color, { 0.0f, 0.0f });
+        write_vertex(mesh, format, welder, index_index, vertex_index, center + vec3 { std::sin(angle_1), std::cos(angle_1), 0.0f } * radius, normal, color, { 0.0f, 0.0f });
       }
     }
   }
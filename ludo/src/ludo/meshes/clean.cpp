@@ -22,6 +22,8 @@ namespace ludo
       to_mesh.vertex_buffer = allocate(destination.vertex_buffer.size);
     }
 
+    auto welder = vertex_welder();
+
     auto index_stream = stream(source.index_buffer);
     while (!ended(index_stream))
     {
@@ -50,7 +52,7 @@ namespace ludo
           auto color = source_format.has_color ? cast<vec4>(source.vertex_buffer, index * source_format.size + source_format.color_offset) : vec4();
           auto texture_coordinate = source_format.has_texture_coordinate ? cast<vec2>(source.vertex_buffer, index * source_format.size + source_format.texture_coordinate_offset): vec2();
 
-          write_vertex(to_mesh, destination_format, counts.first, counts.second, position, normal, color, texture_coordinate);
+          write_vertex(to_mesh, destination_format, welder, counts.first, counts.second, position, normal, color, texture_coordinate);
         }
       }
     }
@@ -10,7 +10,7 @@
 
 namespace ludo
 {
-  void pipe(mesh& mesh, const vertex_format& format, uint32_t& index_index, uint32_t& vertex_index, const vec3& center_front, const vec3& center_back, float radius, uint32_t divisions, bool smooth, const vec4& color, bool invert);
+  void pipe(mesh& mesh, const vertex_format& format, vertex_welder& welder, uint32_t& index_index, uint32_t& vertex_index, const vec3& center_front, const vec3& center_back, float radius, uint32_t divisions, bool smooth, const vec4& color, bool invert);
 
   void cylinder(mesh& mesh, const vertex_format& format, uint32_t start_index, uint32_t start_vertex, const shape_options& options)
   {
@@ -20,22 +20,25 @@ namespace ludo
     auto index_index = start_index;
     auto vertex_index = start_vertex;
 
+    auto welder = vertex_welder();
+    init(welder, mesh, format, start_vertex);
+
     auto radius = options.dimensions[0] / 2.0f;
     auto center_front = options.center + vec3 { 0.0f, 0.0f, options.dimensions[0] * 0.5f };
     auto center_back = options.center + vec3 { 0.0f, 0.0f, options.dimensions[0] * -0.5f };
 
     if (options.outward_faces)
     {
-      circle(mesh, format, index_index, vertex_index, center_front, radius, options.divisions, options.color, false);
-      pipe(mesh, format, index_index, vertex_index, center_front, center_back, radius, options.divisions, options.smooth, options.color, false);
-      circle(mesh, format, index_index, vertex_index, center_back, radius, options.divisions, options.color, true);
+      circle(mesh, format, welder, index_index, vertex_index, center_front, radius, options.divisions, options.color, false);
+      pipe(mesh, format, welder, index_index, vertex_index, center_front, center_back, radius, options.divisions, options.smooth, options.color, false);
+      circle(mesh, format, welder, index_index, vertex_index, center_back, radius, options.divisions, options.color, true);
     }
 
     if (options.inward_faces)
     {
-      circle(mesh, format, index_index, vertex_index, center_front, radius, options.divisions, options.color, true);
-      pipe(mesh, format, index_index, vertex_index, center_front, center_back, radius, options.divisions, options.smooth, options.color, true);
-      circle(mesh, format, index_index, vertex_index, center_back, radius, options.divisions, options.color, false);
+      circle(mesh, format, welder, index_index, vertex_index, center_front, radius, options.divisions, options.color, true);
+      pipe(mesh, format, welder, index_index, vertex_index, center_front, center_back, radius, options.divisions, options.smooth, options.color, true);
+      circle(mesh, format, welder, index_index, vertex_index, center_back, radius, options.divisions, options.color, false);
     }
   }
 
@@ -58,7 +61,7 @@ namespace ludo
     return { total, unique };
   }
 
-  void pipe(mesh& mesh, const vertex_format& format, uint32_t& index_index, uint32_t& vertex_index, const vec3& center_front, const vec3& center_back, float radius, uint32_t divisions, bool smooth, const vec4& color, bool invert)
+  void pipe(mesh& mesh, const vertex_format& format, vertex_welder& welder, uint32_t& index_index, uint32_t& vertex_index, const vec3& center_front, const vec3& center_back, float radius, uint32_t divisions, bool smooth, const vec4& color, bool invert)
   {
     for (auto division = 0; division < divisions; division++)
     {
@@ -90,13 +93,13 @@ namespace ludo
         normal_1 *= -1.0f;
       }
 
-      write_vertex(mesh, format, index_index, vertex_index, position_bottom_left, normal_0, color, { 0.0f, 0.0f });
-      write_vertex(mesh, format, index_index, vertex_index, position_bottom_right, normal_0, color, { 0.0f, 0.0f });
-      write_vertex(mesh, format, index_index, vertex_index, position_top_left, normal_1, color, { 0.0f, 0.0f });
+      write_vertex(mesh, format, welder, index_index, vertex_index, position_bottom_left, normal_0, color, { 0.0f, 0.0f });
+      write_vertex(mesh, format, welder, index_index, vertex_index, position_bottom_right, normal_0, color, { 0.0f, 0.0f });
+      write_vertex(mesh, format, welder, index_index, vertex_index, position_top_left, normal_1, color, { 0.0f, 0.0f });
 
-      write_vertex(mesh, format, index_index, vertex_index, position_bottom_right, normal_0, color, { 0.0f, 0.0f });
-      write_vertex(mesh, format, index_index, vertex_index, position_top_right, normal_1, color, { 0.0f, 0.0f });
-      write_vertex(mesh, format, index_index, vertex_index, position_top_left, normal_1, color, { 0.0f, 0.0f });
+      write_vertex(mesh, format, welder, index_index, vertex_index, position_bottom_right, normal_0, color, { 0.0f, 0.0f });
+      write_vertex(mesh, format, welder, index_index, vertex_index, position_top_right, normal_1, color, { 0.0f, 0.0f });
+      write_vertex(mesh, format, welder, index_index, vertex_index, position_top_left, normal_1, color, { 0.0f, 0.0f });
     }
   }
 }
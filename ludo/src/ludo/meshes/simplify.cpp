@@ -0,0 +1,628 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+
+#include "simplify.h"
+
+namespace ludo
+{
+  // A symmetric 4x4 matrix (the upper triangle) accumulating the squared distance to a set of planes
+  using simplify_quadric = std::array<double, 10>;
+
+  struct simplify_state
+  {
+    std::vector<vec3> positions; // The position of each node (a set of mesh vertices sharing a position)
+    std::vector<uint32_t> node_vertex_offsets;
+    std::vector<uint32_t> node_vertices; // The mesh vertices of each node (CSR)
+    std::vector<std::array<uint32_t, 3>> faces; // The nodes of each triangle
+    std::vector<uint32_t> node_face_offsets;
+    std::vector<uint32_t> node_faces; // The triangles of each node (CSR)
+
+    std::vector<uint32_t> parents; // The node each node has been collapsed into (or itself)
+    std::vector<uint32_t> next_members; // The next node in the same cluster of collapsed nodes
+    std::vector<uint32_t> last_members; // The last node in the cluster of each root node
+
+    std::vector<simplify_quadric> quadrics;
+
+    std::vector<float> costs; // The cost of collapsing each node into its target
+    std::vector<uint32_t> targets;
+    std::vector<uint32_t> heap; // An indexed min-heap of nodes ordered by cost
+    std::vector<uint32_t> heap_positions;
+
+    std::vector<std::pair<uint32_t, std::array<uint32_t, 3>>> scratch_faces;
+    std::vector<uint32_t> scratch_neighbours;
+    std::vector<uint32_t> scratch_other_neighbours;
+    std::vector<uint32_t> scratch_opposite_nodes;
+  };
+
+  const auto simplify_none = std::numeric_limits<uint32_t>::max();
+  const auto simplify_boundary_weight = 3.0f; // Boundaries are weighted above the surface so that open surfaces (like leaves) keep their outline
+
+  void simplify_init(simplify_state& state, const mesh& mesh, const vertex_format& format, bool quadrics);
+  void simplify_add(simplify_quadric& quadric, const vec3& normal, float distance, float weight);
+  double simplify_error(const simplify_quadric& quadric, const vec3& position);
+  uint32_t simplify_root(simplify_state& state, uint32_t node);
+  void simplify_live_faces(simplify_state& state, uint32_t root, std::vector<std::pair<uint32_t, std::array<uint32_t, 3>>>& faces);
+  void simplify_neighbours(simplify_state& state, uint32_t root, std::vector<uint32_t>& neighbours);
+  float simplify_cost(simplify_state& state, const simplify_options& options, uint32_t collapse_node, uint32_t collapse_to_node);
+  void simplify_update(simplify_state& state, const simplify_options& options, uint32_t node);
+  bool simplify_valid(simplify_state& state, uint32_t collapse_node, uint32_t collapse_to_node);
+  uint32_t simplify_collapse(mesh& mesh, const vertex_format& format, simplify_state& state, const simplify_options& options, uint32_t collapse_node, uint32_t collapse_to_node);
+  bool simplify_heap_less(const simplify_state& state, uint32_t a, uint32_t b);
+  void simplify_heap_set(simplify_state& state, uint32_t position, uint32_t node);
+  void simplify_heap_sift(simplify_state& state, uint32_t position);
+  void simplify_heap_remove(simplify_state& state, uint32_t node);
+
+  uint32_t simplify(mesh& mesh, const vertex_format& format, const simplify_options& options)
+  {
+    auto state = simplify_state();
+    simplify_init(state, mesh, format, options.quadrics);
+
+    auto triangle_count = uint32_t(0);
+    for (auto& face : state.faces)
+    {
+      if (face[0] != face[1] && face[1] != face[2] && face[2] != face[0])
+      {
+        triangle_count++;
+      }
+    }
+
+    for (auto node = uint32_t(0); node < state.positions.size(); node++)
+    {
+      simplify_update(state, options, node);
+    }
+
+    while (triangle_count > options.target_triangle_count && !state.heap.empty())
+    {
+      auto collapse_node = state.heap[0];
+      if (state.costs[collapse_node] > options.max_error)
+      {
+        break;
+      }
+
+      // Only the neighbours of the node collapsed to are updated after a collapse, so a target may have been collapsed into another node since it was chosen
+      auto collapse_to_node = state.targets[collapse_node];
+      if (simplify_root(state, collapse_to_node) != collapse_to_node)
+      {
+        simplify_update(state, options, collapse_node);
+        continue;
+      }
+
+      // Validity is only checked for the cheapest collapse, nodes that can't be collapsed are left out of the heap until their neighbourhood changes
+      if (!simplify_valid(state, collapse_node, collapse_to_node))
+      {
+        simplify_heap_remove(state, collapse_node);
+        continue;
+      }
+
+      triangle_count -= simplify_collapse(mesh, format, state, options, collapse_node, collapse_to_node);
+    }
+
+    return triangle_count;
+  }
+
+  void simplify_init(simplify_state& state, const mesh& mesh, const vertex_format& format, bool quadrics)
+  {
+    auto vertex_count = static_cast<uint32_t>(mesh.vertex_buffer.size / format.size);
+    auto index_count = static_cast<uint32_t>(mesh.index_buffer.size / sizeof(uint32_t));
+
+    // Group the mesh vertices sharing a position into nodes (ignoring any vertices that aren't used by a triangle)
+    auto vertex_nodes = std::vector<uint32_t>(vertex_count, simplify_none);
+    for (auto index_index = uint32_t(0); index_index < index_count; index_index++)
+    {
+      vertex_nodes[cast<uint32_t>(mesh.index_buffer, index_index * sizeof(uint32_t))] = 0;
+    }
+
+    auto sorted_vertices = std::vector<uint32_t>();
+    for (auto vertex_index = uint32_t(0); vertex_index < vertex_count; vertex_index++)
+    {
+      if (vertex_nodes[vertex_index] != simplify_none)
+      {
+        sorted_vertices.push_back(vertex_index);
+      }
+    }
+
+    auto position = [&](uint32_t vertex_index) -> const vec3&
+    {
+      return cast<vec3>(mesh.vertex_buffer, vertex_index * format.size + format.position_offset);
+    };
+    std::stable_sort(sorted_vertices.begin(), sorted_vertices.end(), [&](uint32_t a, uint32_t b)
+    {
+      auto& position_a = position(a);
+      auto& position_b = position(b);
+      return std::tie(position_a[0], position_a[1], position_a[2]) < std::tie(position_b[0], position_b[1], position_b[2]);
+    });
+
+    for (auto sorted_index = uint32_t(0); sorted_index < sorted_vertices.size(); sorted_index++)
+    {
+      auto vertex_index = sorted_vertices[sorted_index];
+      if (sorted_index == 0 || position(vertex_index) != position(sorted_vertices[sorted_index - 1]))
+      {
+        state.positions.push_back(position(vertex_index));
+        state.node_vertex_offsets.push_back(sorted_index);
+      }
+
+      vertex_nodes[vertex_index] = static_cast<uint32_t>(state.positions.size() - 1);
+    }
+    state.node_vertex_offsets.push_back(static_cast<uint32_t>(sorted_vertices.size()));
+    state.node_vertices = std::move(sorted_vertices);
+
+    auto node_count = static_cast<uint32_t>(state.positions.size());
+
+    state.faces.resize(index_count / 3);
+    state.node_face_offsets.assign(node_count + 1, 0);
+    for (auto face_index = uint32_t(0); face_index < state.faces.size(); face_index++)
+    {
+      for (auto corner = 0; corner < 3; corner++)
+      {
+        auto node = vertex_nodes[cast<uint32_t>(mesh.index_buffer, (face_index * 3 + corner) * sizeof(uint32_t))];
+        state.faces[face_index][corner] = node;
+        state.node_face_offsets[node + 1]++;
+      }
+    }
+
+    std::partial_sum(state.node_face_offsets.begin(), state.node_face_offsets.end(), state.node_face_offsets.begin());
+    state.node_faces.resize(state.node_face_offsets[node_count]);
+    auto node_face_counts = std::vector<uint32_t>(node_count, 0);
+    for (auto face_index = uint32_t(0); face_index < state.faces.size(); face_index++)
+    {
+      for (auto node : state.faces[face_index])
+      {
+        state.node_faces[state.node_face_offsets[node] + node_face_counts[node]++] = face_index;
+      }
+    }
+
+    state.parents.resize(node_count);
+    std::iota(state.parents.begin(), state.parents.end(), 0);
+    state.next_members.assign(node_count, simplify_none);
+    state.last_members.resize(node_count);
+    std::iota(state.last_members.begin(), state.last_members.end(), 0);
+
+    state.costs.assign(node_count, std::numeric_limits<float>::max());
+    state.targets.assign(node_count, simplify_none);
+    state.heap_positions.assign(node_count, simplify_none);
+
+    if (!quadrics)
+    {
+      return;
+    }
+
+    // Each node starts with the (area weighted) planes of its triangles
+    state.quadrics.assign(node_count, simplify_quadric());
+    auto edges = std::vector<std::tuple<uint32_t, uint32_t, uint32_t, uint32_t>>();
+    for (auto face_index = uint32_t(0); face_index < state.faces.size(); face_index++)
+    {
+      auto& face = state.faces[face_index];
+      if (face[0] == face[1] || face[1] == face[2] || face[2] == face[0])
+      {
+        continue;
+      }
+
+      auto normal = cross(state.positions[face[1]] - state.positions[face[0]], state.positions[face[2]] - state.positions[face[0]]);
+      auto area = length(normal) / 2.0f;
+      if (area == 0.0f)
+      {
+        continue;
+      }
+
+      normal /= area * 2.0f;
+      for (auto node : face)
+      {
+        simplify_add(state.quadrics[node], normal, -dot(normal, state.positions[face[0]]), area);
+      }
+
+      for (auto corner = 0; corner < 3; corner++)
+      {
+        auto node_0 = face[corner];
+        auto node_1 = face[(corner + 1) % 3];
+        edges.emplace_back(std::min(node_0, node_1), std::max(node_0, node_1), face[(corner + 2) % 3], face_index);
+      }
+    }
+
+    // Edges with only one triangle (or two back to back on a double-sided surface) are on the boundary of the mesh, a plane perpendicular to the triangle through them keeps the boundary in place
+    std::sort(edges.begin(), edges.end());
+    for (auto edge_index = size_t(0); edge_index < edges.size();)
+    {
+      auto [ node_0, node_1, opposite_node, face_index ] = edges[edge_index];
+
+      auto boundary = true;
+      for (edge_index++; edge_index < edges.size() && std::get<0>(edges[edge_index]) == node_0 && std::get<1>(edges[edge_index]) == node_1; edge_index++)
+      {
+        boundary = boundary && std::get<2>(edges[edge_index]) == opposite_node;
+      }
+
+      if (!boundary)
+      {
+        continue;
+      }
+
+      auto& face = state.faces[face_index];
+      auto face_normal = cross(state.positions[face[1]] - state.positions[face[0]], state.positions[face[2]] - state.positions[face[0]]);
+      auto edge = state.positions[node_1] - state.positions[node_0];
+
+      auto normal = cross(edge, face_normal);
+      normalize(normal);
+      auto distance = -dot(normal, state.positions[node_0]);
+      auto weight = length2(edge) * simplify_boundary_weight;
+
+      simplify_add(state.quadrics[node_0], normal, distance, weight);
+      simplify_add(state.quadrics[node_1], normal, distance, weight);
+    }
+  }
+
+  void simplify_add(simplify_quadric& quadric, const vec3& normal, float distance, float weight)
+  {
+    auto a = static_cast<double>(normal[0]);
+    auto b = static_cast<double>(normal[1]);
+    auto c = static_cast<double>(normal[2]);
+    auto d = static_cast<double>(distance);
+    auto w = static_cast<double>(weight);
+
+    quadric[0] += w * a * a;
+    quadric[1] += w * a * b;
+    quadric[2] += w * a * c;
+    quadric[3] += w * a * d;
+    quadric[4] += w * b * b;
+    quadric[5] += w * b * c;
+    quadric[6] += w * b * d;
+    quadric[7] += w * c * c;
+    quadric[8] += w * c * d;
+    quadric[9] += w * d * d;
+  }
+
+  double simplify_error(const simplify_quadric& quadric, const vec3& position)
+  {
+    auto x = static_cast<double>(position[0]);
+    auto y = static_cast<double>(position[1]);
+    auto z = static_cast<double>(position[2]);
+
+    return quadric[0] * x * x + 2.0 * quadric[1] * x * y + 2.0 * quadric[2] * x * z + 2.0 * quadric[3] * x +
+      quadric[4] * y * y + 2.0 * quadric[5] * y * z + 2.0 * quadric[6] * y +
+      quadric[7] * z * z + 2.0 * quadric[8] * z +
+      quadric[9];
+  }
+
+  uint32_t simplify_root(simplify_state& state, uint32_t node)
+  {
+    while (state.parents[node] != node)
+    {
+      state.parents[node] = state.parents[state.parents[node]];
+      node = state.parents[node];
+    }
+
+    return node;
+  }
+
+  void simplify_live_faces(simplify_state& state, uint32_t root, std::vector<std::pair<uint32_t, std::array<uint32_t, 3>>>& faces)
+  {
+    faces.clear();
+    for (auto member = root; member != simplify_none; member = state.next_members[member])
+    {
+      for (auto offset = state.node_face_offsets[member]; offset < state.node_face_offsets[member + 1]; offset++)
+      {
+        auto face_index = state.node_faces[offset];
+        auto& face = state.faces[face_index];
+        auto roots = std::array<uint32_t, 3>
+        {
+          simplify_root(state, face[0]),
+          simplify_root(state, face[1]),
+          simplify_root(state, face[2])
+        };
+
+        // Each live triangle has exactly one corner in the cluster, the others have collapsed
+        if (roots[0] != roots[1] && roots[1] != roots[2] && roots[2] != roots[0])
+        {
+          faces.emplace_back(face_index, roots);
+        }
+      }
+    }
+  }
+
+  void simplify_neighbours(simplify_state& state, uint32_t root, std::vector<uint32_t>& neighbours)
+  {
+    simplify_live_faces(state, root, state.scratch_faces);
+
+    neighbours.clear();
+    for (auto& [ face_index, roots ] : state.scratch_faces)
+    {
+      for (auto node : roots)
+      {
+        if (node != root)
+        {
+          neighbours.push_back(node);
+        }
+      }
+    }
+
+    std::sort(neighbours.begin(), neighbours.end());
+    neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+  }
+
+  float simplify_cost(simplify_state& state, const simplify_options& options, uint32_t collapse_node, uint32_t collapse_to_node)
+  {
+    auto& collapse_to_position = state.positions[collapse_to_node];
+
+    if (options.quadrics)
+    {
+      auto quadric = state.quadrics[collapse_node];
+      for (auto index = 0; index < 10; index++)
+      {
+        quadric[index] += state.quadrics[collapse_to_node][index];
+      }
+
+      return static_cast<float>(std::max(simplify_error(quadric, collapse_to_position), 0.0));
+    }
+
+    // Use the collapse-adjacent face facing most away from the shared-adjacent faces to determine our curvature term (see collapse)
+    auto curvature = 0.0f;
+    for (auto& [ face_index, roots ] : state.scratch_faces)
+    {
+      if (std::find(roots.begin(), roots.end(), collapse_to_node) == roots.end())
+      {
+        continue;
+      }
+
+      auto shared_normal = cross(state.positions[roots[1]] - state.positions[roots[0]], state.positions[roots[2]] - state.positions[roots[0]]);
+      normalize(shared_normal);
+
+      for (auto& [ other_face_index, other_roots ] : state.scratch_faces)
+      {
+        if (std::find(other_roots.begin(), other_roots.end(), collapse_to_node) != other_roots.end())
+        {
+          continue;
+        }
+
+        auto normal = cross(state.positions[other_roots[1]] - state.positions[other_roots[0]], state.positions[other_roots[2]] - state.positions[other_roots[0]]);
+        normalize(normal);
+
+        curvature = std::max(curvature, dot(normal, shared_normal) * -0.5f + 0.5f);
+      }
+    }
+
+    return length2(collapse_to_position - state.positions[collapse_node]) * curvature;
+  }
+
+  void simplify_update(simplify_state& state, const simplify_options& options, uint32_t node)
+  {
+    simplify_neighbours(state, node, state.scratch_neighbours);
+
+    // The curvature cost relies on the live faces of the node left in the scratch faces by simplify_neighbours
+    state.costs[node] = std::numeric_limits<float>::max();
+    state.targets[node] = simplify_none;
+    for (auto neighbour : state.scratch_neighbours)
+    {
+      auto cost = simplify_cost(state, options, node, neighbour);
+      if (cost < state.costs[node])
+      {
+        state.costs[node] = cost;
+        state.targets[node] = neighbour;
+      }
+    }
+
+    if (state.targets[node] == simplify_none)
+    {
+      simplify_heap_remove(state, node);
+      return;
+    }
+
+    auto position = state.heap_positions[node];
+    if (position == simplify_none)
+    {
+      position = static_cast<uint32_t>(state.heap.size());
+      state.heap.push_back(node);
+      state.heap_positions[node] = position;
+    }
+
+    simplify_heap_sift(state, position);
+  }
+
+  bool simplify_valid(simplify_state& state, uint32_t collapse_node, uint32_t collapse_to_node)
+  {
+    simplify_neighbours(state, collapse_to_node, state.scratch_other_neighbours);
+    simplify_neighbours(state, collapse_node, state.scratch_neighbours);
+
+    // The only neighbours shared by the nodes of the edge must be the opposite corners of its triangles, otherwise the collapse would pinch the surface
+    // Double-sided surfaces have two triangles with the same opposite corner so the opposite corners are counted rather than the triangles
+    auto& opposite_nodes = state.scratch_opposite_nodes;
+    opposite_nodes.clear();
+    for (auto& [ face_index, roots ] : state.scratch_faces)
+    {
+      if (std::find(roots.begin(), roots.end(), collapse_to_node) == roots.end())
+      {
+        continue;
+      }
+
+      for (auto node : roots)
+      {
+        if (node != collapse_node && node != collapse_to_node)
+        {
+          opposite_nodes.push_back(node);
+        }
+      }
+    }
+
+    std::sort(opposite_nodes.begin(), opposite_nodes.end());
+    opposite_nodes.erase(std::unique(opposite_nodes.begin(), opposite_nodes.end()), opposite_nodes.end());
+
+    auto shared_neighbour_count = uint32_t(0);
+    auto other_iter = state.scratch_other_neighbours.begin();
+    for (auto neighbour : state.scratch_neighbours)
+    {
+      other_iter = std::lower_bound(other_iter, state.scratch_other_neighbours.end(), neighbour);
+      if (other_iter != state.scratch_other_neighbours.end() && *other_iter == neighbour)
+      {
+        shared_neighbour_count++;
+      }
+    }
+
+    if (shared_neighbour_count != opposite_nodes.size())
+    {
+      return false;
+    }
+
+    // The remaining triangles must not flip
+    for (auto& [ face_index, roots ] : state.scratch_faces)
+    {
+      if (std::find(roots.begin(), roots.end(), collapse_to_node) != roots.end())
+      {
+        continue;
+      }
+
+      auto positions = std::array<vec3, 3> { state.positions[roots[0]], state.positions[roots[1]], state.positions[roots[2]] };
+      auto normal = cross(positions[1] - positions[0], positions[2] - positions[0]);
+
+      for (auto corner = 0; corner < 3; corner++)
+      {
+        if (roots[corner] == collapse_node)
+        {
+          positions[corner] = state.positions[collapse_to_node];
+        }
+      }
+
+      if (dot(cross(positions[1] - positions[0], positions[2] - positions[0]), normal) <= 0.0f)
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  uint32_t simplify_collapse(mesh& mesh, const vertex_format& format, simplify_state& state, const simplify_options& options, uint32_t collapse_node, uint32_t collapse_to_node)
+  {
+    simplify_live_faces(state, collapse_node, state.scratch_faces);
+
+    auto collapsed_face_count = uint32_t(0);
+    for (auto& [ face_index, roots ] : state.scratch_faces)
+    {
+      if (std::find(roots.begin(), roots.end(), collapse_to_node) != roots.end())
+      {
+        collapsed_face_count++;
+      }
+    }
+
+    // Move the mesh vertices of the collapsed cluster onto the vertex being collapsed to
+    auto collapse_to_vertex_index = state.node_vertices[state.node_vertex_offsets[collapse_to_node]];
+    auto& collapse_to_position = state.positions[collapse_to_node];
+    auto collapse_to_color = format.has_color ? cast<vec4>(mesh.vertex_buffer, collapse_to_vertex_index * format.size + format.color_offset) : vec4();
+    auto collapse_to_texture_coordinate = format.has_texture_coordinate ? cast<vec2>(mesh.vertex_buffer, collapse_to_vertex_index * format.size + format.texture_coordinate_offset) : vec2();
+    for (auto member = collapse_node; member != simplify_none; member = state.next_members[member])
+    {
+      for (auto offset = state.node_vertex_offsets[member]; offset < state.node_vertex_offsets[member + 1]; offset++)
+      {
+        auto vertex_index = state.node_vertices[offset];
+
+        cast<vec3>(mesh.vertex_buffer, vertex_index * format.size + format.position_offset) = collapse_to_position;
+        // Normals are not updated, the same as collapse
+        if (format.has_color)
+        {
+          cast<vec4>(mesh.vertex_buffer, vertex_index * format.size + format.color_offset) = collapse_to_color;
+        }
+        if (format.has_texture_coordinate)
+        {
+          cast<vec2>(mesh.vertex_buffer, vertex_index * format.size + format.texture_coordinate_offset) = collapse_to_texture_coordinate;
+        }
+      }
+    }
+
+    state.parents[collapse_node] = collapse_to_node;
+    state.next_members[state.last_members[collapse_to_node]] = collapse_node;
+    state.last_members[collapse_to_node] = state.last_members[collapse_node];
+
+    if (options.quadrics)
+    {
+      for (auto index = 0; index < 10; index++)
+      {
+        state.quadrics[collapse_to_node][index] += state.quadrics[collapse_node][index];
+      }
+    }
+
+    simplify_heap_remove(state, collapse_node);
+
+    // Only the costs of the node collapsed to and its neighbours can have changed
+    simplify_neighbours(state, collapse_to_node, state.scratch_other_neighbours);
+    simplify_update(state, options, collapse_to_node);
+    for (auto neighbour : state.scratch_other_neighbours)
+    {
+      simplify_update(state, options, neighbour);
+    }
+
+    return collapsed_face_count;
+  }
+
+  bool simplify_heap_less(const simplify_state& state, uint32_t a, uint32_t b)
+  {
+    return state.costs[a] < state.costs[b] || (state.costs[a] == state.costs[b] && a < b);
+  }
+
+  void simplify_heap_set(simplify_state& state, uint32_t position, uint32_t node)
+  {
+    state.heap[position] = node;
+    state.heap_positions[node] = position;
+  }
+
+  void simplify_heap_sift(simplify_state& state, uint32_t position)
+  {
+    auto node = state.heap[position];
+
+    while (position > 0)
+    {
+      auto parent_position = (position - 1) / 2;
+      if (!simplify_heap_less(state, node, state.heap[parent_position]))
+      {
+        break;
+      }
+
+      simplify_heap_set(state, position, state.heap[parent_position]);
+      position = parent_position;
+    }
+
+    auto size = static_cast<uint32_t>(state.heap.size());
+    while (true)
+    {
+      auto child_position = position * 2 + 1;
+      if (child_position >= size)
+      {
+        break;
+      }
+
+      if (child_position + 1 < size && simplify_heap_less(state, state.heap[child_position + 1], state.heap[child_position]))
+      {
+        child_position++;
+      }
+
+      if (!simplify_heap_less(state, state.heap[child_position], node))
+      {
+        break;
+      }
+
+      simplify_heap_set(state, position, state.heap[child_position]);
+      position = child_position;
+    }
+
+    simplify_heap_set(state, position, node);
+  }
+
+  void simplify_heap_remove(simplify_state& state, uint32_t node)
+  {
+    auto position = state.heap_positions[node];
+    if (position == simplify_none)
+    {
+      return;
+    }
+
+    auto last = state.heap.back();
+    state.heap.pop_back();
+    state.heap_positions[node] = simplify_none;
+
+    if (last != node)
+    {
+      simplify_heap_set(state, position, last);
+      simplify_heap_sift(state, position);
+    }
+  }
+}
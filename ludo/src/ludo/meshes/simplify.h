@@ -0,0 +1,31 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#pragma once
+
+#include <limits>
+
+#include "../meshes.h"
+
+namespace ludo
+{
+  ///
+  /// A set of options for simplifying a mesh.
+  struct simplify_options
+  {
+    uint32_t target_triangle_count = 0; ///< The number of triangles to simplify down to.
+    float max_error = std::numeric_limits<float>::max(); ///< The maximum error a single collapse may introduce, simplification stops early if the next collapse would exceed it.
+    bool quadrics = true; ///< Determines if the error of a collapse is measured with quadric error metrics, otherwise it is measured with the curvature cost used by collapse.
+  };
+
+  ///
+  /// Simplifies a mesh by repeatedly collapsing the edge that introduces the least error.
+  /// Like collapse, vertices are collapsed by moving them onto the vertex they are collapsed to so the collapsed triangles become degenerate (and can be removed with clean).
+  /// Vertices at the same position are collapsed together.
+  /// \param mesh The mesh to simplify.
+  /// \param format The vertex format of the mesh.
+  /// \param options The options to simplify the mesh with.
+  /// \return The number of (non-degenerate) triangles remaining.
+  uint32_t simplify(mesh& mesh, const vertex_format& format, const simplify_options& options);
+}
@@ -25,7 +25,13 @@ namespace ludo
     auto box_vertex_index = vertex_index;
     auto box_options = options;
     box_options.dimensions = vec3 { 2.0f, 2.0f, 2.0f };
-    box(mesh, format, box_index_index, box_vertex_index, box_options, options.smooth, options.smooth);
+    // Smooth spheres share vertices between the faces of the box regardless of their normals (which are recalculated below)
+    auto welder = vertex_welder { .no_normal_check = true };
+    if (options.smooth)
+    {
+      init(welder, mesh, format, vertex_index);
+    }
+    box(mesh, format, box_index_index, box_vertex_index, box_options, options.smooth ? &welder : nullptr);
 
     auto byte_index = vertex_index * format.size;
     for (auto existing_vertex_index = vertex_index; existing_vertex_index < vertex_index + vertex_count; existing_vertex_index++)
@@ -2,10 +2,96 @@
  * This file is part of ludo. See the LICENSE file for the full license governing this code.
  */
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 #include "util.h"
 
 namespace ludo
 {
+  // The cells are four times the epsilon so that any matching vertex lies within the cell containing the position or the neighbouring cell on the nearest side, in each axis.
+  const auto welder_cell_epsilons = 4.0;
+
+  std::array<int64_t, 3> welder_cell(const vertex_welder& welder, const vec3& position, std::array<int64_t, 3>& nearest_neighbours);
+  uint64_t welder_cell_key(int64_t x, int64_t y, int64_t z);
+  bool welder_match(const vertex_welder& welder, const mesh& mesh, const vertex_format& format, uint32_t vertex_index, const vec3& position, const vec3& normal, const vec4& color, const vec2& texture_coordinate);
+
+  void init(vertex_welder& welder, const mesh& mesh, const vertex_format& format, uint32_t vertex_count)
+  {
+    welder.buckets.clear();
+    welder.next.clear();
+    welder.keys.clear();
+
+    welder.next.reserve(vertex_count);
+    welder.keys.reserve(vertex_count);
+
+    for (auto vertex_index = uint32_t(0); vertex_index < vertex_count; vertex_index++)
+    {
+      add(welder, cast<vec3>(mesh.vertex_buffer, vertex_index * format.size + format.position_offset), vertex_index);
+    }
+  }
+
+  void add(vertex_welder& welder, const vec3& position, uint32_t vertex_index)
+  {
+    assert(vertex_index == welder.next.size() && "vertices must be added in order");
+
+    auto nearest_neighbours = std::array<int64_t, 3>();
+    auto cell = welder_cell(welder, position, nearest_neighbours);
+
+    welder.keys.push_back(welder_cell_key(cell[0], cell[1], cell[2]));
+    welder.next.push_back(std::numeric_limits<uint32_t>::max());
+
+    // Keep the buckets at-most half full, re-chaining every vertex (in order) when they grow
+    if (welder.buckets.size() < welder.keys.size() * 2)
+    {
+      welder.buckets.assign(std::max(std::size_t(64), welder.buckets.size() * 2), std::numeric_limits<uint32_t>::max());
+      for (auto existing_vertex_index = uint32_t(0); existing_vertex_index < vertex_index; existing_vertex_index++)
+      {
+        auto& bucket = welder.buckets[welder.keys[existing_vertex_index] & (welder.buckets.size() - 1)];
+        welder.next[existing_vertex_index] = bucket;
+        bucket = existing_vertex_index;
+      }
+    }
+
+    auto& bucket = welder.buckets[welder.keys[vertex_index] & (welder.buckets.size() - 1)];
+    welder.next[vertex_index] = bucket;
+    bucket = vertex_index;
+  }
+
+  uint32_t find(const vertex_welder& welder, const mesh& mesh, const vertex_format& format, const vec3& position, const vec3& normal, const vec4& color, const vec2& texture_coordinate)
+  {
+    if (welder.buckets.empty())
+    {
+      return std::numeric_limits<uint32_t>::max();
+    }
+
+    auto nearest_neighbours = std::array<int64_t, 3>();
+    auto cell = welder_cell(welder, position, nearest_neighbours);
+
+    // Every match is checked (rather than the first one found) so that the lowest index wins, as it would with a linear search.
+    auto match = std::numeric_limits<uint32_t>::max();
+    for (auto x : { cell[0], nearest_neighbours[0] })
+    {
+      for (auto y : { cell[1], nearest_neighbours[1] })
+      {
+        for (auto z : { cell[2], nearest_neighbours[2] })
+        {
+          auto key = welder_cell_key(x, y, z);
+          for (auto vertex_index = welder.buckets[key & (welder.buckets.size() - 1)]; vertex_index != std::numeric_limits<uint32_t>::max(); vertex_index = welder.next[vertex_index])
+          {
+            if (vertex_index < match && welder.keys[vertex_index] == key && welder_match(welder, mesh, format, vertex_index, position, normal, color, texture_coordinate))
+            {
+              match = vertex_index;
+            }
+          }
+        }
+      }
+    }
+
+    return match;
+  }
+
   void write_vertex(mesh& mesh, const vertex_format& format, uint32_t& index_index, uint32_t& vertex_index, const vec3& position, const vec3& normal, const vec4& color, const vec2& texture_coordinate, bool unique_only, bool no_normal_check)
   {
     if (unique_only)
@@ -40,4 +126,56 @@ namespace ludo
     vertex_index++;
     index_index++;
   }
+
+  void write_vertex(mesh& mesh, const vertex_format& format, vertex_welder& welder, uint32_t& index_index, uint32_t& vertex_index, const vec3& position, const vec3& normal, const vec4& color, const vec2& texture_coordinate)
+  {
+    auto existing_vertex_index = find(welder, mesh, format, position, normal, color, texture_coordinate);
+    if (existing_vertex_index != std::numeric_limits<uint32_t>::max())
+    {
+      cast<uint32_t>(mesh.index_buffer, index_index * sizeof(uint32_t)) = existing_vertex_index;
+
+      index_index++;
+
+      return;
+    }
+
+    add(welder, position, vertex_index);
+    write_vertex(mesh, format, index_index, vertex_index, position, normal, color, texture_coordinate, false);
+  }
+
+  std::array<int64_t, 3> welder_cell(const vertex_welder& welder, const vec3& position, std::array<int64_t, 3>& nearest_neighbours)
+  {
+    auto inverse_cell_size = 1.0 / (static_cast<double>(welder.epsilon) * welder_cell_epsilons);
+
+    auto cell = std::array<int64_t, 3>();
+    for (auto axis = 0; axis < 3; axis++)
+    {
+      auto scaled = static_cast<double>(position[axis]) * inverse_cell_size;
+      auto floored = std::floor(scaled);
+
+      cell[axis] = static_cast<int64_t>(floored);
+      nearest_neighbours[axis] = scaled - floored < 0.5 ? cell[axis] - 1 : cell[axis] + 1;
+    }
+
+    return cell;
+  }
+
+  uint64_t welder_cell_key(int64_t x, int64_t y, int64_t z)
+  {
+    // Cells with colliding keys are compared as though they were the same cell, which costs some extra comparisons but does not change the result.
+    auto key = static_cast<uint64_t>(x) * 0x9E3779B97F4A7C15 ^ static_cast<uint64_t>(y) * 0xC2B2AE3D27D4EB4F ^ static_cast<uint64_t>(z) * 0x165667B19E3779F9;
+
+    // Fold the high bits in since the buckets are selected with the low bits
+    return key ^ (key >> 32);
+  }
+
+  bool welder_match(const vertex_welder& welder, const mesh& mesh, const vertex_format& format, uint32_t vertex_index, const vec3& position, const vec3& normal, const vec4& color, const vec2& texture_coordinate)
+  {
+    auto byte_index = vertex_index * format.size;
+
+    return near(cast<vec3>(mesh.vertex_buffer, byte_index + format.position_offset), position, welder.epsilon) &&
+      (welder.no_normal_check || !format.has_normal || near(cast<vec3>(mesh.vertex_buffer, byte_index + format.normal_offset), normal, welder.epsilon)) &&
+      (!format.has_color || near(cast<vec4>(mesh.vertex_buffer, byte_index + format.color_offset), color, welder.epsilon)) &&
+      (!format.has_texture_coordinate || near(cast<vec2>(mesh.vertex_buffer, byte_index + format.texture_coordinate_offset), texture_coordinate, welder.epsilon));
+  }
 }
@@ -4,14 +4,58 @@
 
 #pragma once
 
+#include <vector>
+
 #include "../meshes.h"
 
 namespace ludo
 {
+  ///
+  /// Finds matching vertices within a mesh so that they can be welded together.
+  /// Vertices match according to the same rules used by write_vertex, i.e. their positions, normals, colors and texture coordinates are 'near' to each-other.
+  /// Vertices are bucketed by position into a spatial hash so that only the vertices in neighbouring cells need to be compared, which keeps welding linear in the number of vertices.
+  struct vertex_welder
+  {
+    float epsilon = 0.0001f; ///< The maximum acceptable difference between the components of matching vertices.
+    bool no_normal_check = false; ///< Determines if normals should be taken into account when searching for matching vertices.
+
+    std::vector<uint32_t> buckets; ///< The most recently added vertex in each bucket of cells (a power of two in size).
+    std::vector<uint32_t> next; ///< The previously added vertex in the same bucket as each vertex.
+    std::vector<uint64_t> keys; ///< The key of the cell containing each vertex.
+  };
+
+  ///
+  /// Initializes a vertex welder with the existing vertices of a mesh.
+  /// \param welder The vertex welder.
+  /// \param mesh The mesh containing the existing vertices.
+  /// \param format The vertex format of the mesh.
+  /// \param vertex_count The number of existing vertices.
+  void init(vertex_welder& welder, const mesh& mesh, const vertex_format& format, uint32_t vertex_count);
+
+  ///
+  /// Adds a vertex to a vertex welder.
+  /// Vertices must be added in order of their indices.
+  /// \param welder The vertex welder.
+  /// \param position The position of the vertex.
+  /// \param vertex_index The index of the vertex.
+  void add(vertex_welder& welder, const vec3& position, uint32_t vertex_index);
+
+  ///
+  /// Finds the lowest index vertex that matches the given vertex.
+  /// \param welder The vertex welder.
+  /// \param mesh The mesh containing the vertices that have been added to the welder.
+  /// \param format The vertex format of the mesh.
+  /// \param position The position of the vertex to match.
+  /// \param normal The normal of the vertex to match.
+  /// \param color The color of the vertex to match.
+  /// \param texture_coordinate The texture coordinate of the vertex to match.
+  /// \return The index of the matching vertex or UINT32_MAX if there is no matching vertex.
+  uint32_t find(const vertex_welder& welder, const mesh& mesh, const vertex_format& format, const vec3& position, const vec3& normal, const vec4& color, const vec2& texture_coordinate);
+
   ///
   /// Writes an index and vertex at the given indices within the given mesh.
   /// If it is writing unique vertices only it may only write an index and not a vertex (if the vertex already exists).
-  /// It will only search the vertices before the given vertex index for matching vertices.
+  /// It will only search the vertices before the given vertex index for matching vertices, which makes writing many unique vertices quadratic (see the vertex_welder overload).
   /// Vertex format information is passed individually (instead of being calculated in this function) to improve performance where this function is called many times.
   /// \param mesh The mesh to write the index and vertex to.
   /// \param format The vertex format of the mesh.
@@ -24,4 +68,18 @@ namespace ludo
   /// \param unique_only Determines if only unique vertices should be written.
   /// \param no_normal_check Determines if normals should be taken into account when searching for matching vertices.
   void write_vertex(mesh& mesh, const vertex_format& format, uint32_t& index_index, uint32_t& vertex_index, const vec3& position, const vec3& normal, const vec4& color, const vec2& texture_coordinate, bool unique_only = true, bool no_normal_check = false);
+
+  ///
+  /// Writes an index and vertex at the given indices within the given mesh, only writing the vertex if a matching vertex has not been written already.
+  /// This gives the same result as writing unique vertices only with the other overload, but uses a vertex welder to find matching vertices.
+  /// \param mesh The mesh to write the index and vertex to.
+  /// \param format The vertex format of the mesh.
+  /// \param welder The vertex welder containing the vertices before the given vertex index.
+  /// \param index_index The index at which to write the index. NOTE: The value passed will be incremented if an index was written.
+  /// \param vertex_index The index at which to write the vertex. NOTE: The value passed will be incremented if a vertex was written.
+  /// \param position The position to write to the vertex.
+  /// \param normal The normal to write to the vertex.
+  /// \param color The color to write to the vertex.
+  /// \param texture_coordinate The texture coordinate to write to the vertex.
+  void write_vertex(mesh& mesh, const vertex_format& format, vertex_welder& welder, uint32_t& index_index, uint32_t& vertex_index, const vec3& position, const vec3& normal, const vec4& color, const vec2& texture_coordinate);
 }
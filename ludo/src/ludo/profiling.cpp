@@ -0,0 +1,281 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "profiling.h"
+
+namespace ludo
+{
+  struct profile_event
+  {
+    std::array<char, profile_name_capacity> name = {};
+    uint64_t start = 0;
+    uint64_t end = 0;
+    uint32_t thread = 0;
+  };
+
+  // Events are written by the owning thread and read by profile_frame() (a single producer, single consumer ring).
+  // Once its thread has exited, it is handed to the next thread to record a zone (along with any events not yet read).
+  struct profile_thread
+  {
+    uint32_t index = 0;
+    bool owned = false; // Guarded by threads_mutex
+    std::array<profile_event, profile_event_capacity> events;
+    std::atomic<uint64_t> write_index = 0;
+    std::atomic<uint64_t> read_index = 0;
+  };
+
+  // Releases the profile thread of a thread when it exits.
+  struct profile_thread_owner
+  {
+    profile_thread* thread = nullptr;
+
+    ~profile_thread_owner();
+  };
+
+  struct profile_zone_frames
+  {
+    std::string name;
+    std::array<float, profile_frame_capacity> times = {};
+    std::array<uint32_t, profile_frame_capacity> calls = {};
+  };
+
+  // Allows zones to be looked up by name without constructing a string.
+  struct profile_name_hash
+  {
+    using is_transparent = void;
+
+    std::size_t operator()(std::string_view name) const
+    {
+      return std::hash<std::string_view>()(name);
+    }
+  };
+
+  uint64_t profile_now();
+  profile_thread& current_profile_thread();
+
+  static const auto profile_epoch = std::chrono::steady_clock::now();
+
+  static auto threads_mutex = std::mutex();
+  static auto threads = std::vector<std::unique_ptr<profile_thread>>();
+
+  static auto frames_mutex = std::mutex();
+  static auto frame_count = uint64_t(0);
+  static auto zones = std::vector<profile_zone_frames>();
+  static auto zone_indices = std::unordered_map<std::string, uint32_t, profile_name_hash, std::equal_to<>>();
+  static auto trace = std::vector<profile_event>();
+  static auto trace_start = uint64_t(0);
+
+  profile_zone::profile_zone(std::string_view name) : name(name), start(profile_now())
+  {
+  }
+
+  profile_zone::~profile_zone()
+  {
+    auto end = profile_now();
+    auto& thread = current_profile_thread();
+
+    auto write_index = thread.write_index.load(std::memory_order_relaxed);
+    if (write_index - thread.read_index.load(std::memory_order_acquire) >= profile_event_capacity)
+    {
+      return; // Full, profile_frame() isn't being called often enough.
+    }
+
+    // The name is copied so that it only needs to remain valid for the lifetime of the zone.
+    auto& event = thread.events[write_index % profile_event_capacity];
+    auto name_size = std::min(name.size(), static_cast<std::size_t>(profile_name_capacity - 1));
+    std::memcpy(event.name.data(), name.data(), name_size);
+    event.name[name_size] = '\0';
+    event.start = start;
+    event.end = end;
+    event.thread = thread.index;
+
+    thread.write_index.store(write_index + 1, std::memory_order_release);
+  }
+
+  void profile_frame()
+  {
+    auto frames_lock = std::lock_guard(frames_mutex);
+
+    auto frame_index = frame_count % profile_frame_capacity;
+    for (auto& zone : zones)
+    {
+      zone.times[frame_index] = 0.0f;
+      zone.calls[frame_index] = 0;
+    }
+
+    auto threads_lock = std::unique_lock(threads_mutex);
+    for (auto& thread : threads)
+    {
+      auto read_index = thread->read_index.load(std::memory_order_relaxed);
+      auto write_index = thread->write_index.load(std::memory_order_acquire);
+
+      for (; read_index < write_index; read_index++)
+      {
+        auto& event = thread->events[read_index % profile_event_capacity];
+
+        auto name = std::string_view(event.name.data());
+        auto zone_iter = zone_indices.find(name);
+        if (zone_iter == zone_indices.end())
+        {
+          zone_iter = zone_indices.emplace(name, static_cast<uint32_t>(zones.size())).first;
+          zones.emplace_back(profile_zone_frames { .name = std::string(name) });
+        }
+
+        auto& zone = zones[zone_iter->second];
+        zone.times[frame_index] += static_cast<float>(event.end - event.start) / 1000000000.0f;
+        zone.calls[frame_index]++;
+
+        if (trace.size() < profile_trace_capacity)
+        {
+          trace.emplace_back(event);
+        }
+        else
+        {
+          trace[trace_start++ % profile_trace_capacity] = event;
+        }
+      }
+
+      thread->read_index.store(read_index, std::memory_order_release);
+    }
+
+    frame_count++;
+  }
+
+  std::vector<profile_summary> profile_summaries()
+  {
+    auto lock = std::lock_guard(frames_mutex);
+
+    auto frames = static_cast<uint32_t>(std::min(frame_count, static_cast<uint64_t>(profile_frame_capacity)));
+
+    auto summaries = std::vector<profile_summary>();
+    auto sorted_times = std::vector<float>(frames);
+    for (auto& zone : zones)
+    {
+      auto summary = profile_summary { .name = zone.name, .frames = frames };
+      if (!frames)
+      {
+        summaries.emplace_back(summary);
+        continue;
+      }
+
+      auto total_calls = uint64_t(0);
+      for (auto frame = uint32_t(0); frame < frames; frame++)
+      {
+        sorted_times[frame] = zone.times[frame];
+        total_calls += zone.calls[frame];
+      }
+
+      std::sort(sorted_times.begin(), sorted_times.end());
+
+      auto total_time = 0.0f;
+      for (auto time : sorted_times)
+      {
+        total_time += time;
+      }
+
+      summary.calls = static_cast<float>(total_calls) / static_cast<float>(frames);
+      summary.min = sorted_times.front();
+      summary.average = total_time / static_cast<float>(frames);
+      summary.p99 = sorted_times[static_cast<uint32_t>(std::ceil(0.99f * static_cast<float>(frames))) - 1];
+      summary.max = sorted_times.back();
+
+      summaries.emplace_back(summary);
+    }
+
+    return summaries;
+  }
+
+  void clear_profile()
+  {
+    auto lock = std::lock_guard(frames_mutex);
+
+    frame_count = 0;
+    zones.clear();
+    zone_indices.clear();
+    trace.clear();
+    trace_start = 0;
+  }
+
+  void write_profile_trace(std::ostream& stream)
+  {
+    auto lock = std::lock_guard(frames_mutex);
+
+    stream << "{\"traceEvents\":[";
+
+    for (auto offset = uint64_t(0); offset < trace.size(); offset++)
+    {
+      // Oldest first
+      auto index = (trace_start + offset) % trace.size();
+      auto& event = trace[index];
+
+      auto name = std::string();
+      for (auto character = event.name.data(); *character; character++)
+      {
+        if (*character == '"' || *character == '\\')
+        {
+          name += '\\';
+        }
+
+        name += *character;
+      }
+
+      stream << (offset ? "," : "") << "\n{\"name\":\"" << name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.thread
+             << ",\"ts\":" << static_cast<double>(event.start) / 1000.0 << ",\"dur\":" << static_cast<double>(event.end - event.start) / 1000.0 << "}";
+    }
+
+    stream << "\n]}\n";
+  }
+
+  uint64_t profile_now()
+  {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - profile_epoch).count());
+  }
+
+  profile_thread_owner::~profile_thread_owner()
+  {
+    if (thread)
+    {
+      auto lock = std::lock_guard(threads_mutex);
+      thread->owned = false;
+    }
+  }
+
+  profile_thread& current_profile_thread()
+  {
+    static thread_local auto owner = profile_thread_owner();
+    if (!owner.thread)
+    {
+      // Registration only happens once per thread, so the lock doesn't affect recording.
+      // Threads that have exited are reused, so that repeatedly starting threads (e.g. the thread pool) doesn't keep adding more.
+      auto lock = std::lock_guard(threads_mutex);
+      auto thread_iter = std::find_if(threads.begin(), threads.end(), [](const std::unique_ptr<profile_thread>& thread)
+      {
+        return !thread->owned;
+      });
+
+      if (thread_iter == threads.end())
+      {
+        threads.emplace_back(std::make_unique<profile_thread>());
+        threads.back()->index = static_cast<uint32_t>(threads.size() - 1);
+        thread_iter = threads.end() - 1;
+      }
+
+      owner.thread = thread_iter->get();
+      owner.thread->owned = true;
+    }
+
+    return *owner.thread;
+  }
+}
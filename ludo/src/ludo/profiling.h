@@ -0,0 +1,69 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ludo
+{
+  const auto profile_frame_capacity = uint32_t(256); ///< The number of frames of timings kept for each zone.
+  const auto profile_event_capacity = uint32_t(16384); ///< The number of zone events each thread can record between frames (further events are dropped).
+  const auto profile_trace_capacity = uint32_t(65536); ///< The number of zone events kept for exporting traces.
+  const auto profile_name_capacity = uint32_t(64); ///< The maximum length of a zone name (including the null terminator).
+
+  ///
+  /// Times a section of code on the current thread from construction to destruction.
+  /// Zones can be nested and used on any thread. Recording is lock-free.
+  struct profile_zone
+  {
+    ///
+    /// Begins a zone.
+    /// \param name The name of the zone (truncated to profile_name_capacity - 1 characters).
+    explicit profile_zone(std::string_view name);
+    ~profile_zone();
+
+    profile_zone(const profile_zone&) = delete;
+    profile_zone& operator=(const profile_zone&) = delete;
+
+    std::string_view name; ///< The name of the zone.
+    uint64_t start; ///< The time the zone began (in nanoseconds since profiling started).
+  };
+
+  ///
+  /// Timing statistics of a zone over the frames recorded.
+  struct profile_summary
+  {
+    std::string name; ///< The name of the zone.
+    uint32_t frames = 0; ///< The number of frames the statistics cover.
+    float calls = 0.0f; ///< The average number of times the zone was entered per frame.
+    float min = 0.0f; ///< The minimum time (in seconds) spent in the zone per frame.
+    float average = 0.0f; ///< The average time (in seconds) spent in the zone per frame.
+    float p99 = 0.0f; ///< The 99th percentile time (in seconds) spent in the zone per frame.
+    float max = 0.0f; ///< The maximum time (in seconds) spent in the zone per frame.
+  };
+
+  ///
+  /// Collects the zones recorded by all threads since the previous call into a frame.
+  /// Called by play() after each frame so this is only needed when calling frame() directly.
+  void profile_frame();
+
+  ///
+  /// Summarizes the timings of each zone over the frames recorded.
+  /// \return The summaries of each zone, in the order the zones were first recorded.
+  std::vector<profile_summary> profile_summaries();
+
+  ///
+  /// Discards all recorded frames and trace events.
+  void clear_profile();
+
+  ///
+  /// Writes the most recent zone events in the Chrome trace event format (viewable in chrome://tracing or Perfetto).
+  /// \param stream The stream to write to.
+  void write_profile_trace(std::ostream& stream);
+}
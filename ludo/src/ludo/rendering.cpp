@@ -47,6 +47,32 @@ namespace ludo
     return 3;
   }
 
+  // Based on http://www.cs.otago.ac.nz/postgrads/alexis/planeExtraction.pdf
+  std::array<vec4, 6> frustum_planes(const camera& camera)
+  {
+    auto view_inverse = camera.view;
+    invert(view_inverse);
+    auto view_projection = camera.projection * view_inverse;
+
+    auto rows = std::array<vec4, 4>
+    {
+      vec4 { view_projection[0], view_projection[4], view_projection[8], view_projection[12] },
+      vec4 { view_projection[1], view_projection[5], view_projection[9], view_projection[13] },
+      vec4 { view_projection[2], view_projection[6], view_projection[10], view_projection[14] },
+      vec4 { view_projection[3], view_projection[7], view_projection[11], view_projection[15] },
+    };
+
+    return std::array<vec4, 6>
+    {
+      rows[3] + rows[0], // Left
+      rows[3] - rows[0], // Right
+      rows[3] + rows[1], // Bottom
+      rows[3] - rows[1], // Top
+      rows[3] + rows[2], // Near
+      rows[3] - rows[2] // Far
+    };
+  }
+
   void init(render_mesh& render_mesh)
   {
     render_mesh.id = next_id++;
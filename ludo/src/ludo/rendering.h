@@ -59,6 +59,17 @@ namespace ludo
     float range = 1000; ///< The distance that the light will reach.
   };
 
+  ///
+  /// A command to draw the instances of a mesh (laid out as an indirect draw command).
+  struct render_command
+  {
+    uint32_t index_count = 0; ///< The number of indices.
+    uint32_t instance_count = 1; ///< The number of instances.
+    uint32_t index_start = 0; ///< The first index.
+    uint32_t vertex_start = 0; ///< The offset added to each index.
+    uint32_t instance_start = 0; ///< The first instance.
+  };
+
   ///
   /// A program that executes a render pipeline.
   struct render_program
@@ -304,6 +315,49 @@ namespace ludo
   /// \return The fragment shader code.
   std::stringstream default_fragment_shader_code(const vertex_format& format);
 
+  ///
+  /// Writes the header (version and extensions) of the default shaders.
+  /// These allow custom shader code to be built from the sections of the default shaders.
+  /// \param stream The stream to write to.
+  /// \param format The vertex format.
+  void write_header(std::ostream& stream, const vertex_format& format);
+
+  ///
+  /// Writes the types used by the default shaders.
+  /// \param stream The stream to write to.
+  /// \param format The vertex format.
+  void write_types(std::ostream& stream, const vertex_format& format);
+
+  ///
+  /// Writes the inputs of the default shaders.
+  /// \param stream The stream to write to.
+  /// \param format The vertex format.
+  void write_inputs(std::ostream& stream, const vertex_format& format);
+
+  ///
+  /// Writes the buffers used by the default shaders.
+  /// \param stream The stream to write to.
+  /// \param format The vertex format.
+  void write_buffers(std::ostream& stream, const vertex_format& format);
+
+  ///
+  /// Writes the main function of the default vertex shader.
+  /// \param stream The stream to write to.
+  /// \param format The vertex format.
+  void write_vertex_main(std::ostream& stream, const vertex_format& format);
+
+  ///
+  /// Writes the lighting functions of the default fragment shader.
+  /// \param stream The stream to write to.
+  /// \param format The vertex format.
+  void write_lighting_functions(std::ostream& stream, const vertex_format& format);
+
+  ///
+  /// Writes the main function of the default fragment shader.
+  /// \param stream The stream to write to.
+  /// \param format The vertex format.
+  void write_fragment_main(std::ostream& stream, const vertex_format& format);
+
   ///
   /// Initializes a render mesh.
   /// \param render_mesh The render mesh.
@@ -439,6 +493,12 @@ namespace ludo
   /// \param data The texture data.
   void write(texture& texture, const std::byte* data);
 
+  ///
+  /// Retrieves the handle used to access a texture from within shaders.
+  /// \param texture The texture.
+  /// \return The handle of the texture.
+  uint64_t handle(const texture& texture);
+
   ///
   /// Determines the size (in bytes) of a pixel in a texture.
   /// \param texture The texture.
@@ -5,15 +5,80 @@
 #pragma once
 
 #include <functional>
+#include <list>
+#include <string>
+#include <vector>
 
 #include "core.h"
 
 namespace ludo
 {
-  using script = std::function<void(instance& instance)>; ///< A function that can be executed during various points in the lifecycle of an instance.
+  ///
+  /// Access to the data of a type within a single partition.
+  /// Only covers accessing the existing elements of the partition in place. Adding or removing elements shifts the other partitions, so it is an access to the whole type.
+  struct partition_access
+  {
+    uint32_t type_index = 0; ///< The index of the type of data (see ludo::type_index).
+    std::string partition; ///< The name of the partition.
+  };
 
-  // TODO something much better than this *global* hack
-  extern std::vector<float> total_script_times;
+  ///
+  /// A function that can be executed during various points in the lifecycle of an instance.
+  /// Scripts that declare the data they read and write may be executed concurrently with other scripts they don't conflict with.
+  /// Scripts that declare nothing are assumed to access anything, they are executed on the thread calling frame() with no other script executing.
+  struct script
+  {
+    std::string name = "ludo::script"; ///< The name of the script (used when profiling).
+    std::function<void(instance& instance)> function; ///< The function to execute.
+    std::vector<uint32_t> reads; ///< The indices of the types of data read by the function (see ludo::type_indices).
+    std::vector<uint32_t> writes; ///< The indices of the types of data written by the function (see ludo::type_indices).
+    std::vector<partition_access> partition_reads; ///< The data read by the function within single partitions (see ludo::partition_accesses).
+    std::vector<partition_access> partition_writes; ///< The data written by the function within single partitions (see ludo::partition_accesses).
+  };
+
+  ///
+  /// The order in which the scripts of an instance are executed, built when they are first executed after being added/removed.
+  struct script_schedule
+  {
+    bool stale = true; ///< Determines if scripts have been added/removed since the schedule was built.
+    bool executing = false; ///< Determines if a frame is executing the scripts, additions/removals are deferred until the end of the frame while it is.
+    std::vector<bool> exclusive; ///< Determines, for each script, if it must be executed with no other script executing.
+    std::vector<std::vector<uint32_t>> dependencies; ///< The indices of the earlier scripts each script must wait for.
+    std::list<std::pair<script, std::string>> deferred_additions; ///< The scripts (and their partitions) added during the current frame.
+    std::vector<std::pair<script*, std::string>> deferred_removals; ///< The scripts (and their partitions) removed during the current frame.
+  };
+
+  ///
+  /// Retrieves the accesses of several types of data within a single partition.
+  /// \param partition The name of the partition.
+  /// \return The accesses of the types within the partition.
+  template<typename... T>
+  std::vector<partition_access> partition_accesses(const std::string& partition);
+
+  ///
+  /// Determines if two scripts conflict i.e. must not be executed concurrently.
+  /// Accesses of a whole type conflict with accesses of the type within any partition, accesses within partitions only conflict with accesses within the same partition.
+  /// \param a The first script.
+  /// \param b The second script.
+  /// \return True if the scripts conflict, false otherwise.
+  bool conflicts(const script& a, const script& b);
+
+  ///
+  /// Adds a script to an instance.
+  /// Scripts added during a frame are only added at the end of it.
+  /// \param instance The instance to add the script to.
+  /// \param init The initial state of the new script.
+  /// \param partition The name of the partition.
+  /// \return A pointer to the new script. When added during a frame, this points to the pending script until the end of the frame.
+  script* add(instance& instance, const script& init, const std::string& partition = "default");
+
+  ///
+  /// Removes a script from an instance.
+  /// Scripts removed during a frame are only removed at the end of it.
+  /// \param instance The instance to remove the script from.
+  /// \param element The script to be removed (within the partition).
+  /// \param partition The name of the partition.
+  void remove(instance& instance, script* element, const std::string& partition);
 
   template<typename T>
   T* add(instance& instance, const std::function<void(ludo::instance& instance)>& init, const std::string& partition = "default");
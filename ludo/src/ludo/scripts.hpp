@@ -7,10 +7,16 @@
 
 namespace ludo
 {
+  template<typename... T>
+  std::vector<partition_access> partition_accesses(const std::string& partition)
+  {
+    return { partition_access { .type_index = type_index<T>(), .partition = partition }... };
+  }
+
   template<typename T>
   T* add(instance& instance, const std::function<void(ludo::instance& instance)>& init, const std::string& partition)
   {
-    return add(data<T>(instance), init, partition);
+    return add(instance, T { .function = init }, partition);
   }
 
   template<typename T, typename Arg1>
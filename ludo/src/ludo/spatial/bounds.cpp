@@ -95,4 +95,36 @@ namespace ludo
       std::abs(center_a[1] - center_b[1]) < (half_dimensions_a[1] + half_dimensions_b[1]) &&
       std::abs(center_a[2] - center_b[2]) < (half_dimensions_a[2] + half_dimensions_b[2]);
   }
+
+  // Based on https://old.cescg.org/CESCG-2002/DSykoraJJelinek/index.html
+  int32_t frustum_test(const std::array<vec4, 6>& planes, const aabb3& bounds)
+  {
+    auto result = 1;
+    for (auto& plane : planes)
+    {
+      // The vertex furthest along the plane's normal (the p-vertex). If it is in the negative halfspace, the whole AABB is.
+      auto p_distance =
+        plane[0] * (plane[0] > 0.0f ? bounds.max[0] : bounds.min[0]) +
+        plane[1] * (plane[1] > 0.0f ? bounds.max[1] : bounds.min[1]) +
+        plane[2] * (plane[2] > 0.0f ? bounds.max[2] : bounds.min[2]) +
+        plane[3];
+      if (p_distance < 0.0f)
+      {
+        return -1;
+      }
+
+      // The vertex furthest against the plane's normal (the n-vertex). If it is in the negative halfspace, the AABB straddles the plane.
+      auto n_distance =
+        plane[0] * (plane[0] > 0.0f ? bounds.min[0] : bounds.max[0]) +
+        plane[1] * (plane[1] > 0.0f ? bounds.min[1] : bounds.max[1]) +
+        plane[2] * (plane[2] > 0.0f ? bounds.min[2] : bounds.max[2]) +
+        plane[3];
+      if (n_distance < 0.0f)
+      {
+        result = 0;
+      }
+    }
+
+    return result;
+  }
 }
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <array>
+
 #include "../meshes.h"
 
 namespace ludo
@@ -54,4 +56,11 @@ namespace ludo
   /// \return True if the AABBs intersect, false otherwise.
   bool intersect(const aabb2& a, const aabb2& b);
   bool intersect(const aabb3& a, const aabb3& b);
+
+  ///
+  /// Tests an AABB against the planes of a view frustum (see frustum_planes(...)).
+  /// \param planes The planes of the view frustum, with their normals pointing into the view frustum.
+  /// \param bounds The AABB to test.
+  /// \return -1 if the AABB is outside the view frustum, 1 if it is wholly inside, 0 if it intersects the view frustum's planes.
+  int32_t frustum_test(const std::array<vec4, 6>& planes, const aabb3& bounds);
 }
@@ -2,7 +2,9 @@
  * This file is part of ludo. See the LICENSE file for the full license governing this code.
  */
 
+#include <algorithm>
 #include <cmath>
+#include <numeric>
 
 #include "grid2.h"
 
@@ -12,6 +14,7 @@ namespace ludo
   std::vector<uint64_t> cell_render_mesh_ids(const grid2& grid, uint32_t cell_index);
   uint32_t cell_render_mesh_index(const grid2& grid, uint32_t cell_index, uint64_t render_mesh_id);
   uint64_t cell_offset(const grid2& grid, uint32_t cell_index);
+  void mark_dirty(grid2& grid, uint32_t cell_index);
   uint32_t to_index(const grid2& grid, const std::array<uint32_t, 2>& cell_coordinates);
   std::array<uint32_t, 2> to_cell_coordinates(const grid2& grid, const vec2& position);
 
@@ -41,6 +44,11 @@ namespace ludo
       cast<uint32_t>(grid.buffer.back, offset) = 0;
       offset += cell_size;
     }
+
+    // The front buffer starts out uninitialized, so every cell needs to be committed.
+    grid.dirty_cells.assign(cell_count, true);
+    grid.dirty_cell_indices.resize(cell_count);
+    std::iota(grid.dirty_cell_indices.begin(), grid.dirty_cell_indices.end(), 0);
   }
 
   void de_init(grid2& grid)
@@ -48,13 +56,31 @@ namespace ludo
     grid.id = 0;
 
     deallocate_dual(grid.buffer);
+
+    grid.dirty_cell_indices.clear();
+    grid.dirty_cells.clear();
   }
 
   void commit(grid2& grid)
   {
     commit_header(grid);
 
-    std::memcpy(grid.buffer.front.data + front_buffer_header_size, grid.buffer.back.data, grid.buffer.back.size);
+    grid.commit_size = front_buffer_header_size;
+
+    // Copy in the order of the buffer, and only the render meshes actually in each cell.
+    std::sort(grid.dirty_cell_indices.begin(), grid.dirty_cell_indices.end());
+    for (auto cell_index : grid.dirty_cell_indices)
+    {
+      auto offset = cell_offset(grid, cell_index);
+      auto size = cell_header_size + cast<uint32_t>(grid.buffer.back, offset) * render_mesh_size;
+
+      std::memcpy(grid.buffer.front.data + front_buffer_header_size + offset, grid.buffer.back.data + offset, size);
+      grid.commit_size += size;
+
+      grid.dirty_cells[cell_index] = false;
+    }
+
+    grid.dirty_cell_indices.clear();
   }
 
   void commit_header(grid2& grid)
@@ -75,6 +101,8 @@ namespace ludo
 
     assert(render_mesh_count < grid.cell_capacity && "cell is full");
 
+    mark_dirty(grid, index);
+
     write(stream, render_mesh_count + 1);
     stream.position += 4; // align 8
     stream.position += render_mesh_count * render_mesh_size;
@@ -135,6 +163,8 @@ namespace ludo
 
     assert(render_mesh_index < grid.cell_capacity && "render mesh not found");
 
+    mark_dirty(grid, cell_index);
+
     auto offset = cell_offset(grid, cell_index);
     auto stream = ludo::stream(grid.buffer.back, offset);
 
@@ -152,30 +182,10 @@ namespace ludo
   std::vector<uint64_t> find(const grid2& grid, const std::function<int32_t(const aabb2& bounds)>& test)
   {
     auto render_mesh_ids = std::vector<uint64_t>();
-    auto cell_count = static_cast<uint32_t>(std::pow(grid.cell_count_1d, 2));
-    auto cell_dimensions = ludo::cell_dimensions(grid);
-
-    for (auto index = uint32_t(0); index < cell_count; index++)
+    find_each(grid, test, [&](uint64_t render_mesh_id)
     {
-      auto x = index / (grid.cell_count_1d * grid.cell_count_1d);
-      auto y = (index / grid.cell_count_1d) % grid.cell_count_1d;
-      auto z = index % grid.cell_count_1d;
-
-      auto xy = vec2 { static_cast<float>(x), static_cast<float>(y) };
-      auto min = grid.bounds.min + xy * cell_dimensions;
-
-      auto bounds = aabb2
-      {
-        .min = min,
-        .max = min + cell_dimensions
-      };
-
-      if (test(bounds) != -1)
-      {
-        auto ids = cell_render_mesh_ids(grid, index);
-        render_mesh_ids.insert(render_mesh_ids.end(), ids.begin(), ids.end());
-      }
-    }
+      render_mesh_ids.push_back(render_mesh_id);
+    });
 
     return render_mesh_ids;
   }
@@ -230,6 +240,15 @@ namespace ludo
     return cell_index * (cell_header_size + grid.cell_capacity * render_mesh_size);
   }
 
+  void mark_dirty(grid2& grid, uint32_t cell_index)
+  {
+    if (!grid.dirty_cells[cell_index])
+    {
+      grid.dirty_cells[cell_index] = true;
+      grid.dirty_cell_indices.push_back(cell_index);
+    }
+  }
+
   uint32_t to_index(const grid2& grid, const std::array<uint32_t, 2>& cell_coordinates)
   {
     return cell_coordinates[0] * grid.cell_count_1d + cell_coordinates[1];
@@ -5,6 +5,9 @@
 #ifndef LUDO_SPATIAL_GRID2_H
 #define LUDO_SPATIAL_GRID2_H
 
+#include <functional>
+#include <span>
+
 #include "../compute.h"
 #include "../rendering.h"
 #include "bounds.h"
@@ -22,6 +25,10 @@ namespace ludo
     uint32_t cell_capacity = 16; ///< The maximum number of render meshes that can be added to a cell.
 
     double_buffer buffer; ///< The cell data (the front buffer also contains a header).
+
+    std::vector<uint32_t> dirty_cell_indices; ///< The cells that have changed since the last commit.
+    std::vector<bool> dirty_cells; ///< Determines which cells have changed since the last commit.
+    uint64_t commit_size = 0; ///< The number of bytes copied to the front buffer by the last commit.
   };
 
   ///
@@ -35,9 +42,9 @@ namespace ludo
   void de_init(grid2& grid);
 
   ///
-  /// Commits to the front buffer.
+  /// Commits the header state and the cells that have changed since the last commit to the front buffer.
+  /// Changes made by any number of calls to add(...) and remove(...) are copied by a single commit.
   /// \param grid The grid.
-  /// \param header_only Determines if only the header state should be pushed (i.e. not the cell data).
   void commit(grid2& grid);
 
   ///
@@ -65,6 +72,25 @@ namespace ludo
   /// \param test The test to perform against the bounds of the cells.
   /// \return The matching render mesh IDs.
   std::vector<uint64_t> find(const grid2& grid, const std::function<int32_t(const aabb2& bounds)>& test);
+
+  ///
+  /// Finds render meshes within a grid without allocating.
+  /// \param grid The grid to search.
+  /// \param test The test to perform against the bounds of the cells, of the form int32_t(const aabb2& bounds).
+  /// \param visit The function to call with each matching render mesh ID, of the form void(uint64_t render_mesh_id).
+  template<typename T, typename V>
+  void find_each(const grid2& grid, T&& test, V&& visit);
+
+  ///
+  /// Finds render meshes within a grid without allocating.
+  /// \param grid The grid to search.
+  /// \param test The test to perform against the bounds of the cells, of the form int32_t(const aabb2& bounds).
+  /// \param results The matching render mesh IDs. Only the first results.size() IDs are written.
+  /// \return The number of matching render meshes (which can be greater than results.size()).
+  template<typename T>
+  uint32_t find(const grid2& grid, T&& test, std::span<uint64_t> results);
 }
 
+#include "grid2.hpp"
+
 #endif // LUDO_SPATIAL_GRID2_H
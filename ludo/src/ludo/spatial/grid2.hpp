@@ -0,0 +1,61 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include "grid2.h"
+
+namespace ludo
+{
+  vec2 cell_dimensions(const grid2& grid);
+  uint64_t cell_offset(const grid2& grid, uint32_t cell_index);
+
+  template<typename T, typename V>
+  void find_each(const grid2& grid, T&& test, V&& visit)
+  {
+    auto cell_dimensions = ludo::cell_dimensions(grid);
+
+    auto index = uint32_t(0);
+    for (auto x = uint32_t(0); x < grid.cell_count_1d; x++)
+    {
+      for (auto y = uint32_t(0); y < grid.cell_count_1d; y++, index++)
+      {
+        auto xy = vec2 { static_cast<float>(x), static_cast<float>(y) };
+        auto min = grid.bounds.min + xy * cell_dimensions;
+
+        if (test(aabb2 { .min = min, .max = min + cell_dimensions }) == -1)
+        {
+          continue;
+        }
+
+        auto offset = cell_offset(grid, index);
+
+        auto render_mesh_count = cast<uint32_t>(grid.buffer.back, offset);
+        offset += 4;
+        offset += 4; // align 8
+
+        for (auto render_mesh_index = uint32_t(0); render_mesh_index < render_mesh_count; render_mesh_index++)
+        {
+          visit(cast<uint64_t>(grid.buffer.back, offset));
+          offset += 2 * sizeof(uint64_t) + 6 * sizeof(uint32_t);
+        }
+      }
+    }
+  }
+
+  template<typename T>
+  uint32_t find(const grid2& grid, T&& test, std::span<uint64_t> results)
+  {
+    auto count = uint32_t(0);
+    find_each(grid, test, [&](uint64_t render_mesh_id)
+    {
+      if (count < results.size())
+      {
+        results[count] = render_mesh_id;
+      }
+
+      count++;
+    });
+
+    return count;
+  }
+}
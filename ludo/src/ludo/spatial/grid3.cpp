@@ -2,16 +2,28 @@
  * This file is part of ludo. See the LICENSE file for the full license governing this code.
  */
 
+#include <algorithm>
 #include <cmath>
+#include <numeric>
 
+#include "../math/simd.h"
+#include "../profiling.h"
+#include "../thread_pool.h"
 #include "grid3.h"
 
 namespace ludo
 {
+  struct cell_render_mesh;
+
+  void add_render_commands(const grid3& grid, array<render_program>& render_programs, const std::array<vec4, 6>& planes);
+  void cull_row(const grid3& grid, const std::array<vec4, 6>& planes, uint32_t row_index, uint8_t* visible);
+  void for_each_batch(uint32_t count, uint32_t batch_size, const std::function<void(uint32_t, uint32_t)>& task);
+  uint32_t render_program_index(const array<render_program>& render_programs, uint64_t render_program_id);
   vec3 cell_dimensions(const grid3& grid);
   std::vector<uint64_t> cell_render_mesh_ids(const grid3& grid, uint32_t cell_index);
   uint32_t cell_render_mesh_index(const grid3& grid, uint32_t cell_index, uint64_t render_mesh_id);
   uint64_t cell_offset(const grid3& grid, uint32_t cell_index);
+  void mark_dirty(grid3& grid, uint32_t cell_index);
   uint32_t to_index(const grid3& grid, const std::array<uint32_t, 3>& cell_coordinates);
   std::array<uint32_t, 3> to_cell_coordinates(const grid3& grid, const vec3& position);
 
@@ -24,8 +36,25 @@ namespace ludo
   // 2 IDs and 6 start/count values
   const auto render_mesh_size = 2 * sizeof(uint64_t) + 6 * sizeof(uint32_t);
 
+  // The layout of a render mesh within a cell
+  struct cell_render_mesh
+  {
+    uint64_t id;
+    uint64_t render_program_id;
+    range instances;
+    range indices;
+    range vertices;
+  };
+
+  static_assert(sizeof(cell_render_mesh) == render_mesh_size);
+
+  // The number of rows of cells culled by each batch
+  const auto cull_batch_size = uint32_t(16);
+
   void init(grid3& grid)
   {
+    assert((!grid.morton || (grid.cell_count_1d & (grid.cell_count_1d - 1)) == 0) && "cell count must be a power of two for a morton layout");
+
     grid.id = next_id++;
 
     auto cell_count = static_cast<uint32_t>(std::pow(grid.cell_count_1d, 3));
@@ -41,6 +70,11 @@ namespace ludo
       cast<uint32_t>(grid.buffer.back, offset) = 0;
       offset += cell_size;
     }
+
+    // The front buffer starts out uninitialized, so every cell needs to be committed.
+    grid.dirty_cells.assign(cell_count, true);
+    grid.dirty_cell_indices.resize(cell_count);
+    std::iota(grid.dirty_cell_indices.begin(), grid.dirty_cell_indices.end(), 0);
   }
 
   void de_init(grid3& grid)
@@ -48,13 +82,33 @@ namespace ludo
     grid.id = 0;
 
     deallocate_dual(grid.buffer);
+
+    grid.dirty_cell_indices.clear();
+    grid.dirty_cells.clear();
   }
 
   void commit(grid3& grid)
   {
+    auto zone = profile_zone("ludo::commit(grid3)");
+
     commit_header(grid);
 
-    std::memcpy(grid.buffer.front.data + front_buffer_header_size, grid.buffer.back.data, grid.buffer.back.size);
+    grid.commit_size = front_buffer_header_size;
+
+    // Copy in the order of the buffer, and only the render meshes actually in each cell.
+    std::sort(grid.dirty_cell_indices.begin(), grid.dirty_cell_indices.end());
+    for (auto cell_index : grid.dirty_cell_indices)
+    {
+      auto offset = cell_offset(grid, cell_index);
+      auto size = cell_header_size + cast<uint32_t>(grid.buffer.back, offset) * render_mesh_size;
+
+      std::memcpy(grid.buffer.front.data + front_buffer_header_size + offset, grid.buffer.back.data + offset, size);
+      grid.commit_size += size;
+
+      grid.dirty_cells[cell_index] = false;
+    }
+
+    grid.dirty_cell_indices.clear();
   }
 
   void commit_header(grid3& grid)
@@ -77,6 +131,8 @@ namespace ludo
 
     assert(render_mesh_count < grid.cell_capacity && "cell is full");
 
+    mark_dirty(grid, index);
+
     write(stream, render_mesh_count + 1);
     stream.position += 4; // align 8
     stream.position += render_mesh_count * render_mesh_size;
@@ -90,6 +146,68 @@ namespace ludo
     write(stream, render_mesh.vertices.count);
   }
 
+  void add(grid3& grid, std::span<const render_mesh> render_meshes, std::span<const vec3> positions)
+  {
+    assert(render_meshes.size() == positions.size() && "render mesh and position counts differ");
+
+    auto cell_indices = std::vector<uint32_t>(render_meshes.size());
+    for (auto index = uint32_t(0); index < render_meshes.size(); index++)
+    {
+      cell_indices[index] = to_index(grid, to_cell_coordinates(grid, positions[index]));
+    }
+
+    // Counting sort the render meshes by cell (keeping the order they were given in within each cell), so that the cells are filled in the order of the buffer.
+    auto cell_count = static_cast<uint32_t>(std::pow(grid.cell_count_1d, 3));
+    auto cell_starts = std::vector<uint32_t>(cell_count + 1);
+    for (auto cell_index : cell_indices)
+    {
+      cell_starts[cell_index + 1]++;
+    }
+
+    std::partial_sum(cell_starts.begin(), cell_starts.end(), cell_starts.begin());
+
+    auto order = std::vector<uint32_t>(render_meshes.size());
+    auto next_order_positions = cell_starts;
+    for (auto index = uint32_t(0); index < render_meshes.size(); index++)
+    {
+      order[next_order_positions[cell_indices[index]]++] = index;
+    }
+
+    for (auto cell_index = uint32_t(0); cell_index < cell_count; cell_index++)
+    {
+      auto start = cell_starts[cell_index];
+      auto end = cell_starts[cell_index + 1];
+      if (start == end)
+      {
+        continue;
+      }
+
+      auto offset = cell_offset(grid, cell_index);
+      auto& render_mesh_count = cast<uint32_t>(grid.buffer.back, offset);
+
+      assert(render_mesh_count + (end - start) <= grid.cell_capacity && "cell is full");
+
+      mark_dirty(grid, cell_index);
+
+      offset += cell_header_size + render_mesh_count * render_mesh_size;
+      for (auto index = start; index < end; index++)
+      {
+        auto& render_mesh = render_meshes[order[index]];
+        cast<cell_render_mesh>(grid.buffer.back, offset) =
+        {
+          .id = render_mesh.id,
+          .render_program_id = render_mesh.render_program_id,
+          .instances = render_mesh.instances,
+          .indices = render_mesh.indices,
+          .vertices = render_mesh.vertices
+        };
+        offset += render_mesh_size;
+      }
+
+      render_mesh_count += end - start;
+    }
+  }
+
   void remove(grid3& grid, const render_mesh& render_mesh, const vec3& position)
   {
     auto cell_coordinates = to_cell_coordinates(grid, position);
@@ -150,6 +268,8 @@ namespace ludo
 
     assert(render_mesh_index < grid.cell_capacity && "render mesh not found");
 
+    mark_dirty(grid, cell_index);
+
     auto offset = cell_offset(grid, cell_index);
     auto stream = ludo::stream(grid.buffer.back, offset);
 
@@ -167,32 +287,203 @@ namespace ludo
   std::vector<uint64_t> find(const grid3& grid, const std::function<int32_t(const aabb3& bounds)>& test)
   {
     auto render_mesh_ids = std::vector<uint64_t>();
-    auto cell_count = static_cast<uint32_t>(std::pow(grid.cell_count_1d, 3));
+    find_each(grid, test, [&](uint64_t render_mesh_id)
+    {
+      render_mesh_ids.push_back(render_mesh_id);
+    });
+
+    return render_mesh_ids;
+  }
+
+  void add_render_commands(const array<grid3>& grids, array<render_program>& render_programs, const camera& camera)
+  {
+    auto zone = profile_zone("ludo::add_render_commands(grid3)");
+
+    auto planes = frustum_planes(camera);
+    for (auto& grid : grids)
+    {
+      add_render_commands(grid, render_programs, planes);
+    }
+  }
+
+  void add_render_commands(const grid3& grid, array<render_program>& render_programs, const std::array<vec4, 6>& planes)
+  {
+    auto row_count = uint32_t(grid.cell_count_1d) * grid.cell_count_1d;
+    auto batch_count = (row_count + cull_batch_size - 1) / cull_batch_size;
+    auto render_program_count = static_cast<uint32_t>(render_programs.length);
+
+    auto visible = std::vector<uint8_t>(row_count * grid.cell_count_1d);
+
+    // Each batch counts its render commands so that it knows where to write them without synchronizing with the other batches.
+    auto command_positions = std::vector<uint32_t>(batch_count * render_program_count);
+
+    auto for_each_visible_render_mesh = [&](uint32_t start, uint32_t end, auto&& function)
+    {
+      for (auto cell_index = start * grid.cell_count_1d; cell_index < end * grid.cell_count_1d; cell_index++)
+      {
+        if (!visible[cell_index])
+        {
+          continue;
+        }
+
+        // The visibility of the cells is determined row by row, regardless of the layout of the cells.
+        auto offset = cell_offset(grid, grid.morton ? morton_encode({ cell_index / row_count, (cell_index / grid.cell_count_1d) % grid.cell_count_1d, cell_index % grid.cell_count_1d }) : cell_index);
+        auto render_mesh_count = cast<uint32_t>(grid.buffer.back, offset);
+        offset += cell_header_size;
+
+        for (auto render_mesh_index = uint32_t(0); render_mesh_index < render_mesh_count; render_mesh_index++)
+        {
+          auto& render_mesh = cast<cell_render_mesh>(grid.buffer.back, offset);
+          offset += render_mesh_size;
+
+          auto index = render_program_index(render_programs, render_mesh.render_program_id);
+          if (index != render_program_count)
+          {
+            function(render_mesh, index);
+          }
+        }
+      }
+    };
+
+    for_each_batch(row_count, cull_batch_size, [&](uint32_t start, uint32_t end)
+    {
+      auto counts = &command_positions[(start / cull_batch_size) * render_program_count];
+      for (auto row_index = start; row_index < end; row_index++)
+      {
+        cull_row(grid, planes, row_index, &visible[row_index * grid.cell_count_1d]);
+      }
+
+      for_each_visible_render_mesh(start, end, [&](const cell_render_mesh&, uint32_t index)
+      {
+        counts[index]++;
+      });
+    });
+
+    for (auto index = uint32_t(0); index < render_program_count; index++)
+    {
+      auto& render_program = render_programs[index];
+
+      auto position = render_program.active_commands.start + render_program.active_commands.count;
+      for (auto batch_index = uint32_t(0); batch_index < batch_count; batch_index++)
+      {
+        auto count = command_positions[batch_index * render_program_count + index];
+        command_positions[batch_index * render_program_count + index] = position;
+        position += count;
+      }
+
+      assert(position * sizeof(render_command) <= render_program.command_buffer.size && "command buffer is full");
+
+      render_program.active_commands.count = position - render_program.active_commands.start;
+    }
+
+    for_each_batch(row_count, cull_batch_size, [&](uint32_t start, uint32_t end)
+    {
+      auto positions = &command_positions[(start / cull_batch_size) * render_program_count];
+      for_each_visible_render_mesh(start, end, [&](const cell_render_mesh& render_mesh, uint32_t index)
+      {
+        cast<render_command>(render_programs[index].command_buffer, positions[index]++ * sizeof(render_command)) =
+        {
+          .index_count = render_mesh.indices.count,
+          .instance_count = render_mesh.instances.count,
+          .index_start = render_mesh.indices.start,
+          .vertex_start = render_mesh.vertices.start,
+          .instance_start = render_mesh.instances.start
+        };
+      });
+    });
+  }
+
+  // Based on https://old.cescg.org/CESCG-2002/DSykoraJJelinek/index.html (see the compute program of the OpenGL implementation)
+  void cull_row(const grid3& grid, const std::array<vec4, 6>& planes, uint32_t row_index, uint8_t* visible)
+  {
     auto cell_dimensions = ludo::cell_dimensions(grid);
+    auto x = static_cast<float>(row_index / grid.cell_count_1d);
+    auto y = static_cast<float>(row_index % grid.cell_count_1d);
+
+    // Include neighbouring cells to ensure the render meshes that overlap from them into this cell are included.
+    // The x and y bounds are the same along the row, so their contribution to the distance of the p-vertex (the vertex furthest along the plane's normal) is only calculated once.
+    auto min_x = grid.bounds.min[0] + (x - 1.0f) * cell_dimensions[0];
+    auto min_y = grid.bounds.min[1] + (y - 1.0f) * cell_dimensions[1];
+    auto max_x = min_x + 3.0f * cell_dimensions[0];
+    auto max_y = min_y + 3.0f * cell_dimensions[1];
+
+    auto distances = std::array<float, 6>();
+    for (auto index = 0; index < 6; index++)
+    {
+      auto& plane = planes[index];
+      distances[index] = plane[3] + std::max(plane[0] * min_x, plane[0] * max_x) + std::max(plane[1] * min_y, plane[1] * max_y);
+    }
+
+    auto z = uint32_t(0);
 
-    for (auto index = uint32_t(0); index < cell_count; index++)
+#if defined(LUDO_SSE)
+    // Test 4 cells at a time, outside if the p-vertex of any plane is within the negative halfspace.
+    auto lanes = _mm_setr_ps(-1.0f, 0.0f, 1.0f, 2.0f);
+    auto cell_dimension_z = _mm_set1_ps(cell_dimensions[2]);
+    auto extent_z = _mm_set1_ps(3.0f * cell_dimensions[2]);
+    for (; z + 4 <= grid.cell_count_1d; z += 4)
     {
-      auto x = index / (grid.cell_count_1d * grid.cell_count_1d);
-      auto y = (index / grid.cell_count_1d) % grid.cell_count_1d;
-      auto z = index % grid.cell_count_1d;
+      auto min_z = _mm_add_ps(_mm_set1_ps(grid.bounds.min[2]), _mm_mul_ps(_mm_add_ps(_mm_set1_ps(static_cast<float>(z)), lanes), cell_dimension_z));
+      auto max_z = _mm_add_ps(min_z, extent_z);
 
-      auto xyz = vec3 { static_cast<float>(x), static_cast<float>(y), static_cast<float>(z) };
-      auto min = grid.bounds.min + xyz * cell_dimensions;
+      auto outside = _mm_setzero_ps();
+      for (auto index = 0; index < 6; index++)
+      {
+        auto plane_z = _mm_set1_ps(planes[index][2]);
+        auto distance = _mm_add_ps(_mm_set1_ps(distances[index]), _mm_max_ps(_mm_mul_ps(plane_z, min_z), _mm_mul_ps(plane_z, max_z)));
+        outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_setzero_ps()));
+      }
+
+      auto mask = _mm_movemask_ps(outside);
+      visible[z] = !(mask & 1);
+      visible[z + 1] = !(mask & 2);
+      visible[z + 2] = !(mask & 4);
+      visible[z + 3] = !(mask & 8);
+    }
+#endif
 
-      auto bounds = aabb3
+    for (; z < grid.cell_count_1d; z++)
+    {
+      auto min_z = grid.bounds.min[2] + (static_cast<float>(z) - 1.0f) * cell_dimensions[2];
+      auto max_z = min_z + 3.0f * cell_dimensions[2];
+
+      visible[z] = true;
+      for (auto index = 0; index < 6; index++)
       {
-        .min = min,
-        .max = min + cell_dimensions
-      };
+        if (distances[index] + std::max(planes[index][2] * min_z, planes[index][2] * max_z) < 0.0f)
+        {
+          visible[z] = false;
+          break;
+        }
+      }
+    }
+  }
+
+  void for_each_batch(uint32_t count, uint32_t batch_size, const std::function<void(uint32_t, uint32_t)>& task)
+  {
+    if (thread_pool_running())
+    {
+      thread_pool_wait(thread_pool_parallel_for(count, batch_size, task));
+      return;
+    }
 
-      if (test(bounds) != -1)
+    for (auto start = uint32_t(0); start < count; start += batch_size)
+    {
+      task(start, start + std::min(batch_size, count - start));
+    }
+  }
+
+  uint32_t render_program_index(const array<render_program>& render_programs, uint64_t render_program_id)
+  {
+    for (auto index = uint32_t(0); index < render_programs.length; index++)
+    {
+      if (render_programs[index].id == render_program_id)
       {
-        auto ids = cell_render_mesh_ids(grid, index);
-        render_mesh_ids.insert(render_mesh_ids.end(), ids.begin(), ids.end());
+        return index;
       }
     }
 
-    return render_mesh_ids;
+    return static_cast<uint32_t>(render_programs.length);
   }
 
   vec3 cell_dimensions(const grid3& grid)
@@ -245,8 +536,22 @@ namespace ludo
     return cell_index * (cell_header_size + grid.cell_capacity * render_mesh_size);
   }
 
+  void mark_dirty(grid3& grid, uint32_t cell_index)
+  {
+    if (!grid.dirty_cells[cell_index])
+    {
+      grid.dirty_cells[cell_index] = true;
+      grid.dirty_cell_indices.push_back(cell_index);
+    }
+  }
+
   uint32_t to_index(const grid3& grid, const std::array<uint32_t, 3>& cell_coordinates)
   {
+    if (grid.morton)
+    {
+      return morton_encode(cell_coordinates);
+    }
+
     return cell_coordinates[0] * grid.cell_count_1d * grid.cell_count_1d + cell_coordinates[1] * grid.cell_count_1d + cell_coordinates[2];
   }
 
@@ -261,6 +566,13 @@ namespace ludo
     cell_coordinates[1] = std::floor(cell_coordinates[1]);
     cell_coordinates[2] = std::floor(cell_coordinates[2]);
 
-    return { static_cast<uint32_t>(cell_coordinates[0]), static_cast<uint32_t>(cell_coordinates[1]), static_cast<uint32_t>(cell_coordinates[2]) };
+    // Positions on the max bounds belong to the last cell.
+    auto max_cell_coordinate = static_cast<uint32_t>(grid.cell_count_1d - 1);
+    return
+    {
+      std::min(static_cast<uint32_t>(cell_coordinates[0]), max_cell_coordinate),
+      std::min(static_cast<uint32_t>(cell_coordinates[1]), max_cell_coordinate),
+      std::min(static_cast<uint32_t>(cell_coordinates[2]), max_cell_coordinate)
+    };
   }
 }
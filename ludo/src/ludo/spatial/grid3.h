@@ -5,7 +5,11 @@
 #ifndef LUDO_SPATIAL_GRID3_H
 #define LUDO_SPATIAL_GRID3_H
 
+#include <functional>
+#include <span>
+
 #include "../compute.h"
+#include "../math/util.h"
 #include "../rendering.h"
 #include "bounds.h"
 
@@ -21,8 +25,13 @@ namespace ludo
     aabb3 bounds; ///< The outer bounds.
     uint8_t cell_count_1d = 1; ///< The number of cells in each dimension.
     uint32_t cell_capacity = 16; ///< The maximum number of render meshes that can be added to a cell.
+    bool morton = false; ///< Determines if the cells are laid out in Morton (Z-order) rather than row-major order, so that nearby cells are near in memory. Requires a power-of-two cell count.
 
     double_buffer buffer; ///< The cell data (the front buffer also contains a header).
+
+    std::vector<uint32_t> dirty_cell_indices; ///< The cells that have changed since the last commit.
+    std::vector<bool> dirty_cells; ///< Determines which cells have changed since the last commit.
+    uint64_t commit_size = 0; ///< The number of bytes copied to the front buffer by the last commit.
   };
 
   ///
@@ -36,9 +45,9 @@ namespace ludo
   void de_init(grid3& grid);
 
   ///
-  /// Commits to the front buffer.
+  /// Commits the header state and the cells that have changed since the last commit to the front buffer.
+  /// Changes made by any number of calls to add(...) and remove(...) are copied by a single commit.
   /// \param grid The grid.
-  /// \param header_only Determines if only the header state should be pushed (i.e. not the cell data).
   void commit(grid3& grid);
 
   ///
@@ -53,6 +62,14 @@ namespace ludo
   /// \param position The position of the render mesh.
   void add(grid3& grid3, const render_mesh& render_mesh, const vec3& position);
 
+  ///
+  /// Adds render meshes to a grid.
+  /// The render meshes are sorted by cell once and then each cell is filled in a single pass.
+  /// \param grid The grid to add the render meshes to.
+  /// \param render_meshes The render meshes to add.
+  /// \param positions The positions of the render meshes.
+  void add(grid3& grid, std::span<const render_mesh> render_meshes, std::span<const vec3> positions);
+
   ///
   /// Removes a render mesh from a grid.
   /// \param grid The grid to remove the render mesh from.
@@ -67,6 +84,23 @@ namespace ludo
   /// \return The matching render mesh IDs.
   std::vector<uint64_t> find(const grid3& grid, const std::function<int32_t(const aabb3& bounds)>& test);
 
+  ///
+  /// Finds render meshes within a grid without allocating.
+  /// \param grid The grid to search.
+  /// \param test The test to perform against the bounds of the cells, of the form int32_t(const aabb3& bounds).
+  /// \param visit The function to call with each matching render mesh ID, of the form void(uint64_t render_mesh_id).
+  template<typename T, typename V>
+  void find_each(const grid3& grid, T&& test, V&& visit);
+
+  ///
+  /// Finds render meshes within a grid without allocating.
+  /// \param grid The grid to search.
+  /// \param test The test to perform against the bounds of the cells, of the form int32_t(const aabb3& bounds).
+  /// \param results The matching render mesh IDs. Only the first results.size() IDs are written.
+  /// \return The number of matching render meshes (which can be greater than results.size()).
+  template<typename T>
+  uint32_t find(const grid3& grid, T&& test, std::span<uint64_t> results);
+
   ///
   /// Builds a compute program used to build render commands from a grid.
   /// \param grid The grid.
@@ -75,12 +109,23 @@ namespace ludo
 
   ///
   /// Adds render commands to the render programs' command buffers and updates the active command count.
-  /// \param grids The render program.
+  /// \param grids The grids.
   /// \param compute_programs The compute programs to execute.
   /// \param render_programs The render programs that can have render commands added.
   /// \param render_commands The render commands to sample from.
   /// \param camera The camera the render meshes are being viewed through.
   void add_render_commands(array<grid3>& grids, array<compute_program>& compute_programs, array<render_program>& render_programs, const heap& render_commands, const camera& camera);
+
+  ///
+  /// Adds render commands to the render programs' command buffers and updates the active command count.
+  /// Culls the cells of the back buffer on the CPU (across the thread pool if it is running), so it does not require a GPU.
+  /// Commands are added in cell order, so the results are the same regardless of how the work is split.
+  /// \param grids The grids.
+  /// \param render_programs The render programs that can have render commands added.
+  /// \param camera The camera the render meshes are being viewed through.
+  void add_render_commands(const array<grid3>& grids, array<render_program>& render_programs, const camera& camera);
 }
 
+#include "grid3.hpp"
+
 #endif // LUDO_SPATIAL_GRID3_H
@@ -0,0 +1,82 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include "grid3.h"
+
+namespace ludo
+{
+  vec3 cell_dimensions(const grid3& grid);
+  uint64_t cell_offset(const grid3& grid, uint32_t cell_index);
+
+  template<typename T, typename V>
+  void find_each(const grid3& grid, T&& test, V&& visit)
+  {
+    auto cell_dimensions = ludo::cell_dimensions(grid);
+
+    auto visit_cell = [&](uint32_t index, uint32_t x, uint32_t y, uint32_t z)
+    {
+      auto xyz = vec3 { static_cast<float>(x), static_cast<float>(y), static_cast<float>(z) };
+      auto min = grid.bounds.min + xyz * cell_dimensions;
+
+      if (test(aabb3 { .min = min, .max = min + cell_dimensions }) == -1)
+      {
+        return;
+      }
+
+      auto offset = cell_offset(grid, index);
+
+      auto render_mesh_count = cast<uint32_t>(grid.buffer.back, offset);
+      offset += 4;
+      offset += 4; // align 8
+
+      for (auto render_mesh_index = uint32_t(0); render_mesh_index < render_mesh_count; render_mesh_index++)
+      {
+        visit(cast<uint64_t>(grid.buffer.back, offset));
+        offset += 2 * sizeof(uint64_t) + 6 * sizeof(uint32_t);
+      }
+    };
+
+    if (grid.morton)
+    {
+      // Walk the cells in the order of the buffer.
+      auto cell_count = uint32_t(grid.cell_count_1d) * grid.cell_count_1d * grid.cell_count_1d;
+      for (auto index = uint32_t(0); index < cell_count; index++)
+      {
+        auto cell_coordinates = morton_decode(index);
+        visit_cell(index, cell_coordinates[0], cell_coordinates[1], cell_coordinates[2]);
+      }
+
+      return;
+    }
+
+    auto index = uint32_t(0);
+    for (auto x = uint32_t(0); x < grid.cell_count_1d; x++)
+    {
+      for (auto y = uint32_t(0); y < grid.cell_count_1d; y++)
+      {
+        for (auto z = uint32_t(0); z < grid.cell_count_1d; z++, index++)
+        {
+          visit_cell(index, x, y, z);
+        }
+      }
+    }
+  }
+
+  template<typename T>
+  uint32_t find(const grid3& grid, T&& test, std::span<uint64_t> results)
+  {
+    auto count = uint32_t(0);
+    find_each(grid, test, [&](uint64_t render_mesh_id)
+    {
+      if (count < results.size())
+      {
+        results[count] = render_mesh_id;
+      }
+
+      count++;
+    });
+
+    return count;
+  }
+}
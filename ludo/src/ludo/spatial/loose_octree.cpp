@@ -0,0 +1,411 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <algorithm>
+
+#include "../profiling.h"
+#include "loose_octree.h"
+
+namespace ludo
+{
+  uint32_t allocate_children(loose_octree& octree, uint32_t node_index);
+  template<typename V>
+  void cull(const loose_octree& octree, uint32_t node_index, const std::array<vec4, 6>& planes, uint8_t plane_mask, V&& visit);
+  template<typename V>
+  void find_all(const loose_octree& octree, uint32_t node_index, V&& visit);
+  bool fits(const loose_octree& octree, uint32_t node_index, float radius);
+  void insert(loose_octree& octree, uint32_t node_index, const loose_octree_render_mesh& render_mesh);
+  aabb3 loose_bounds(const loose_octree& octree, const loose_octree_node& node);
+  void merge(loose_octree& octree, uint32_t node_index);
+  std::array<aabb3, 8> octant_bounds(const aabb3& bounds);
+  uint32_t octant_index(const loose_octree_node& node, const vec3& position);
+  uint32_t render_program_index(const array<render_program>& render_programs, uint64_t render_program_id);
+  void split(loose_octree& octree, uint32_t node_index);
+
+  void init(loose_octree& octree)
+  {
+    octree.id = next_id++;
+
+    octree.nodes = { { .bounds = octree.bounds } };
+    octree.free_node_indices.clear();
+  }
+
+  void de_init(loose_octree& octree)
+  {
+    octree.id = 0;
+
+    octree.nodes.clear();
+    octree.free_node_indices.clear();
+  }
+
+  void add(loose_octree& octree, const render_mesh& render_mesh, const vec3& position, float radius)
+  {
+    assert(contains(octree.bounds, position) && "position out of bounds");
+
+    insert(octree, 0,
+    {
+      .id = render_mesh.id,
+      .render_program_id = render_mesh.render_program_id,
+      .instances = render_mesh.instances,
+      .indices = render_mesh.indices,
+      .vertices = render_mesh.vertices,
+      .position = position,
+      .radius = radius
+    });
+  }
+
+  void remove(loose_octree& octree, const render_mesh& render_mesh, const vec3& position, float radius)
+  {
+    auto is_render_mesh = [&](const loose_octree_render_mesh& candidate)
+    {
+      return candidate.id == render_mesh.id;
+    };
+
+    // Follow the path taken by add(...), a render mesh can be held by any node along it (depending on when the nodes were split).
+    auto node_index = uint32_t(0);
+    auto found = false;
+    while (true)
+    {
+      auto& node = octree.nodes[node_index];
+      if (std::any_of(node.render_meshes.begin(), node.render_meshes.end(), is_render_mesh))
+      {
+        found = true;
+        break;
+      }
+
+      if (!node.child_index)
+      {
+        break;
+      }
+
+      auto child_index = node.child_index + octant_index(node, position);
+      if (!fits(octree, child_index, radius))
+      {
+        break;
+      }
+
+      node_index = child_index;
+    }
+
+    if (!found)
+    {
+      // Search every node in case of floating point precision errors
+      for (node_index = 0; node_index < octree.nodes.size(); node_index++)
+      {
+        auto& node = octree.nodes[node_index];
+        if (std::any_of(node.render_meshes.begin(), node.render_meshes.end(), is_render_mesh))
+        {
+          found = true;
+          break;
+        }
+      }
+    }
+
+    assert(found && "render mesh not found");
+
+    auto& render_meshes = octree.nodes[node_index].render_meshes;
+    render_meshes.erase(std::find_if(render_meshes.begin(), render_meshes.end(), is_render_mesh));
+
+    // Merge the highest ancestor that has become small enough (halfway to the split threshold, so that nodes do not flip-flop).
+    auto merge_index = uint32_t(0);
+    auto merge_required = false;
+    while (true)
+    {
+      auto& node = octree.nodes[node_index];
+      node.count--;
+      if (node.child_index && node.count <= octree.split_threshold / 2)
+      {
+        merge_index = node_index;
+        merge_required = true;
+      }
+
+      if (node_index == 0)
+      {
+        break;
+      }
+
+      node_index = node.parent_index;
+    }
+
+    if (merge_required)
+    {
+      merge(octree, merge_index);
+    }
+  }
+
+  std::vector<uint64_t> find(const loose_octree& octree, const std::function<int32_t(const aabb3& bounds)>& test)
+  {
+    auto render_mesh_ids = std::vector<uint64_t>();
+    find_each(octree, test, [&](uint64_t render_mesh_id)
+    {
+      render_mesh_ids.push_back(render_mesh_id);
+    });
+
+    return render_mesh_ids;
+  }
+
+  void add_render_commands(const array<loose_octree>& octrees, array<render_program>& render_programs, const camera& camera)
+  {
+    auto zone = profile_zone("ludo::add_render_commands(loose_octree)");
+
+    // Normalize the planes so that distances to them can be compared against the radii of render meshes.
+    auto planes = frustum_planes(camera);
+    for (auto& plane : planes)
+    {
+      plane = plane / length(vec3 { plane[0], plane[1], plane[2] });
+    }
+
+    // Render meshes of the same render program tend to be found together.
+    auto render_program_id = uint64_t(0);
+    auto index = static_cast<uint32_t>(render_programs.length);
+
+    for (auto& octree : octrees)
+    {
+      cull(octree, 0, planes, 0b111111, [&](const loose_octree_render_mesh& render_mesh)
+      {
+        if (render_mesh.render_program_id != render_program_id)
+        {
+          render_program_id = render_mesh.render_program_id;
+          index = render_program_index(render_programs, render_program_id);
+        }
+
+        if (index == render_programs.length)
+        {
+          return;
+        }
+
+        auto& render_program = render_programs[index];
+        auto position = (render_program.active_commands.start + render_program.active_commands.count++) * sizeof(render_command);
+
+        assert(position + sizeof(render_command) <= render_program.command_buffer.size && "command buffer is full");
+
+        cast<render_command>(render_program.command_buffer, position) =
+        {
+          .index_count = render_mesh.indices.count,
+          .instance_count = render_mesh.instances.count,
+          .index_start = render_mesh.indices.start,
+          .vertex_start = render_mesh.vertices.start,
+          .instance_start = render_mesh.instances.start
+        };
+      });
+    }
+  }
+
+  uint32_t allocate_children(loose_octree& octree, uint32_t node_index)
+  {
+    auto child_index = static_cast<uint32_t>(octree.nodes.size());
+    if (!octree.free_node_indices.empty())
+    {
+      child_index = octree.free_node_indices.back();
+      octree.free_node_indices.pop_back();
+    }
+    else
+    {
+      octree.nodes.resize(octree.nodes.size() + 8);
+    }
+
+    auto& node = octree.nodes[node_index];
+    auto octant_bounds = ludo::octant_bounds(node.bounds);
+    for (auto octant_index = uint32_t(0); octant_index < 8; octant_index++)
+    {
+      octree.nodes[child_index + octant_index] = { .bounds = octant_bounds[octant_index], .parent_index = node_index, .depth = node.depth + 1 };
+    }
+
+    node.child_index = child_index;
+
+    return child_index;
+  }
+
+  // Based on https://old.cescg.org/CESCG-2002/DSykoraJJelinek/index.html (with the addition of plane masking)
+  // The planes must be normalized.
+  template<typename V>
+  void cull(const loose_octree& octree, uint32_t node_index, const std::array<vec4, 6>& planes, uint8_t plane_mask, V&& visit)
+  {
+    auto& node = octree.nodes[node_index];
+    if (!node.count)
+    {
+      return;
+    }
+
+    // Only the planes the parent straddled need to be tested, the node is wholly inside the others.
+    auto bounds = loose_bounds(octree, node);
+    for (auto plane_index = 0; plane_index < 6; plane_index++)
+    {
+      if (!(plane_mask & (1 << plane_index)))
+      {
+        continue;
+      }
+
+      auto& plane = planes[plane_index];
+      auto p_distance =
+        plane[0] * (plane[0] > 0.0f ? bounds.max[0] : bounds.min[0]) +
+        plane[1] * (plane[1] > 0.0f ? bounds.max[1] : bounds.min[1]) +
+        plane[2] * (plane[2] > 0.0f ? bounds.max[2] : bounds.min[2]) +
+        plane[3];
+      if (p_distance < 0.0f)
+      {
+        return;
+      }
+
+      auto n_distance =
+        plane[0] * (plane[0] > 0.0f ? bounds.min[0] : bounds.max[0]) +
+        plane[1] * (plane[1] > 0.0f ? bounds.min[1] : bounds.max[1]) +
+        plane[2] * (plane[2] > 0.0f ? bounds.min[2] : bounds.max[2]) +
+        plane[3];
+      if (n_distance >= 0.0f)
+      {
+        plane_mask &= ~(1 << plane_index);
+      }
+    }
+
+    if (!plane_mask)
+    {
+      find_all(octree, node_index, visit);
+      return;
+    }
+
+    for (auto& render_mesh : node.render_meshes)
+    {
+      // Render meshes without a radius are only known to be within the node's (loosened) bounds.
+      auto inside = true;
+      for (auto plane_index = 0; plane_index < 6 && inside && render_mesh.radius > 0.0f; plane_index++)
+      {
+        auto& plane = planes[plane_index];
+        inside = !(plane_mask & (1 << plane_index)) || plane[0] * render_mesh.position[0] + plane[1] * render_mesh.position[1] + plane[2] * render_mesh.position[2] + plane[3] >= -render_mesh.radius;
+      }
+
+      if (inside)
+      {
+        visit(render_mesh);
+      }
+    }
+
+    if (node.child_index)
+    {
+      for (auto octant_index = uint32_t(0); octant_index < 8; octant_index++)
+      {
+        cull(octree, node.child_index + octant_index, planes, plane_mask, visit);
+      }
+    }
+  }
+
+  template<typename V>
+  void find_all(const loose_octree& octree, uint32_t node_index, V&& visit)
+  {
+    auto& node = octree.nodes[node_index];
+    if (!node.count)
+    {
+      return;
+    }
+
+    for (auto& render_mesh : node.render_meshes)
+    {
+      visit(render_mesh);
+    }
+
+    if (node.child_index)
+    {
+      for (auto octant_index = uint32_t(0); octant_index < 8; octant_index++)
+      {
+        find_all(octree, node.child_index + octant_index, visit);
+      }
+    }
+  }
+
+  bool fits(const loose_octree& octree, uint32_t node_index, float radius)
+  {
+    auto& bounds = octree.nodes[node_index].bounds;
+    auto size = bounds.max - bounds.min;
+
+    return radius <= octree.looseness * std::min(std::min(size[0], size[1]), size[2]);
+  }
+
+  void insert(loose_octree& octree, uint32_t node_index, const loose_octree_render_mesh& render_mesh)
+  {
+    while (true)
+    {
+      auto& node = octree.nodes[node_index];
+      node.count++;
+
+      if (node.child_index)
+      {
+        auto child_index = node.child_index + octant_index(node, render_mesh.position);
+        if (fits(octree, child_index, render_mesh.radius))
+        {
+          node_index = child_index;
+          continue;
+        }
+      }
+
+      node.render_meshes.push_back(render_mesh);
+
+      if (!node.child_index && node.render_meshes.size() > octree.split_threshold && node.depth < octree.max_depth)
+      {
+        split(octree, node_index);
+      }
+
+      return;
+    }
+  }
+
+  aabb3 loose_bounds(const loose_octree& octree, const loose_octree_node& node)
+  {
+    auto margin = (node.bounds.max - node.bounds.min) * octree.looseness;
+
+    return { .min = node.bounds.min - margin, .max = node.bounds.max + margin };
+  }
+
+  void merge(loose_octree& octree, uint32_t node_index)
+  {
+    auto child_index = octree.nodes[node_index].child_index;
+    if (!child_index)
+    {
+      return;
+    }
+
+    for (auto octant_index = uint32_t(0); octant_index < 8; octant_index++)
+    {
+      merge(octree, child_index + octant_index);
+
+      auto& child_render_meshes = octree.nodes[child_index + octant_index].render_meshes;
+      auto& render_meshes = octree.nodes[node_index].render_meshes;
+      render_meshes.insert(render_meshes.end(), child_render_meshes.begin(), child_render_meshes.end());
+
+      octree.nodes[child_index + octant_index] = {};
+    }
+
+    octree.nodes[node_index].child_index = 0;
+    octree.free_node_indices.push_back(child_index);
+  }
+
+  uint32_t octant_index(const loose_octree_node& node, const vec3& position)
+  {
+    // Matches the order of octant_bounds(...)
+    auto center = (node.bounds.min + node.bounds.max) / 2.0f;
+
+    return (position[0] >= center[0] ? 1 : 0) | (position[1] >= center[1] ? 2 : 0) | (position[2] >= center[2] ? 4 : 0);
+  }
+
+  void split(loose_octree& octree, uint32_t node_index)
+  {
+    auto child_index = allocate_children(octree, node_index);
+
+    // Move the render meshes that fit into the children down to them (the node's count already includes them).
+    auto render_meshes = std::move(octree.nodes[node_index].render_meshes);
+    octree.nodes[node_index].render_meshes.clear();
+
+    for (auto& render_mesh : render_meshes)
+    {
+      auto octant_child_index = child_index + octant_index(octree.nodes[node_index], render_mesh.position);
+      if (fits(octree, octant_child_index, render_mesh.radius))
+      {
+        insert(octree, octant_child_index, render_mesh);
+      }
+      else
+      {
+        octree.nodes[node_index].render_meshes.push_back(render_mesh);
+      }
+    }
+  }
+}
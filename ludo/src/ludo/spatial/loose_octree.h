@@ -0,0 +1,122 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#pragma once
+
+#include <functional>
+#include <span>
+
+#include "../rendering.h"
+#include "bounds.h"
+
+namespace ludo
+{
+  ///
+  /// A render mesh within a loose octree.
+  struct loose_octree_render_mesh
+  {
+    uint64_t id = 0; ///< The ID of the render mesh.
+    uint64_t render_program_id = 0; ///< The render program used to draw the render mesh.
+
+    range instances; ///< The instances.
+    range indices; ///< The indices.
+    range vertices; ///< The vertices.
+
+    vec3 position = vec3_zero; ///< The position of the render mesh.
+    float radius = 0.0f; ///< The radius of the render mesh's bounding sphere.
+  };
+
+  ///
+  /// A node within a loose octree.
+  struct loose_octree_node
+  {
+    aabb3 bounds; ///< The bounds of the node's cell (i.e. not loosened).
+
+    uint32_t parent_index = 0; ///< The index of the parent node.
+    uint32_t child_index = 0; ///< The index of the first of the 8 child nodes (or 0 if the node is a leaf).
+    uint32_t depth = 0; ///< The depth of the node (the root has a depth of 0).
+    uint32_t count = 0; ///< The number of render meshes within the node and its descendants.
+
+    std::vector<loose_octree_render_mesh> render_meshes; ///< The render meshes held by the node itself.
+  };
+
+  ///
+  /// An octree of render meshes that only subdivides (and allocates) where render meshes are.
+  /// Nodes are split when they hold too many render meshes and merged when they hold few enough.
+  /// The bounds of each node are loosened so that a render mesh only needs to be contained by its position, not its extent.
+  struct loose_octree
+  {
+    uint64_t id = 0; ///< A unique identifier.
+
+    aabb3 bounds; ///< The outer bounds.
+    float looseness = 0.5f; ///< The fraction of a node's size its bounds are extended by (on each side).
+    uint32_t max_depth = 8; ///< The maximum depth of a node.
+    uint32_t split_threshold = 16; ///< The number of render meshes a leaf can hold before it is split.
+
+    std::vector<loose_octree_node> nodes; ///< The nodes (the root is the first node, siblings are adjacent).
+    std::vector<uint32_t> free_node_indices; ///< The indices of the first of 8 sibling nodes that are no longer used.
+  };
+
+  ///
+  /// Initializes a loose octree.
+  /// \param octree The loose octree.
+  void init(loose_octree& octree);
+
+  ///
+  /// De-initializes a loose octree.
+  /// \param octree The loose octree.
+  void de_init(loose_octree& octree);
+
+  ///
+  /// Adds a render mesh to a loose octree.
+  /// \param octree The loose octree to add the render mesh to.
+  /// \param render_mesh The render mesh to add.
+  /// \param position The position of the render mesh.
+  /// \param radius The radius of the render mesh's bounding sphere. Larger render meshes are held by larger nodes.
+  void add(loose_octree& octree, const render_mesh& render_mesh, const vec3& position, float radius = 0.0f);
+
+  ///
+  /// Removes a render mesh from a loose octree.
+  /// \param octree The loose octree to remove the render mesh from.
+  /// \param render_mesh The render mesh to remove.
+  /// \param position The position of the render mesh.
+  /// \param radius The radius of the render mesh's bounding sphere (as it was added).
+  void remove(loose_octree& octree, const render_mesh& render_mesh, const vec3& position, float radius = 0.0f);
+
+  ///
+  /// Finds render meshes within a loose octree.
+  /// Nodes the test reports as wholly inside have all of their render meshes accepted without testing their descendants.
+  /// \param octree The loose octree to search.
+  /// \param test The test to perform against the (loosened) bounds of the nodes. Returns -1 if outside, 0 if intersecting and 1 if inside.
+  /// \return The matching render mesh IDs.
+  std::vector<uint64_t> find(const loose_octree& octree, const std::function<int32_t(const aabb3& bounds)>& test);
+
+  ///
+  /// Finds render meshes within a loose octree without allocating (or recursing).
+  /// Nodes the test reports as wholly inside have all of their render meshes visited without testing their descendants.
+  /// \param octree The loose octree to search.
+  /// \param test The test to perform against the (loosened) bounds of the nodes, of the form int32_t(const aabb3& bounds). Returns -1 if outside, 0 if intersecting and 1 if inside.
+  /// \param visit The function to call with each matching render mesh ID, of the form void(uint64_t render_mesh_id).
+  template<typename T, typename V>
+  void find_each(const loose_octree& octree, T&& test, V&& visit);
+
+  ///
+  /// Finds render meshes within a loose octree without allocating (or recursing).
+  /// \param octree The loose octree to search.
+  /// \param test The test to perform against the (loosened) bounds of the nodes, of the form int32_t(const aabb3& bounds). Returns -1 if outside, 0 if intersecting and 1 if inside.
+  /// \param results The matching render mesh IDs. Only the first results.size() IDs are written.
+  /// \return The number of matching render meshes (which can be greater than results.size()).
+  template<typename T>
+  uint32_t find(const loose_octree& octree, T&& test, std::span<uint64_t> results);
+
+  ///
+  /// Adds render commands to the render programs' command buffers and updates the active command count.
+  /// Culls the loose octrees hierarchically on the CPU.
+  /// \param octrees The loose octrees.
+  /// \param render_programs The render programs that can have render commands added.
+  /// \param camera The camera the render meshes are being viewed through.
+  void add_render_commands(const array<loose_octree>& octrees, array<render_program>& render_programs, const camera& camera);
+}
+
+#include "loose_octree.hpp"
@@ -0,0 +1,85 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <cassert>
+
+#include "loose_octree.h"
+
+namespace ludo
+{
+  aabb3 loose_bounds(const loose_octree& octree, const loose_octree_node& node);
+
+  template<typename T, typename V>
+  void find_each(const loose_octree& octree, T&& test, V&& visit)
+  {
+    struct node
+    {
+      uint32_t index;
+      bool inside; // Determines if the node is known to be wholly inside (and so doesn't need to be tested)
+    };
+
+    // At most 7 siblings are left waiting per layer.
+    assert(octree.max_depth <= 16 && "max depth too great");
+    auto stack = std::array<node, 7 * 16 + 1>();
+    auto stack_size = uint32_t(0);
+    stack[stack_size++] = { .index = 0, .inside = false };
+
+    while (stack_size)
+    {
+      auto current = stack[--stack_size];
+      auto& octree_node = octree.nodes[current.index];
+      if (!octree_node.count)
+      {
+        continue;
+      }
+
+      auto inside = current.inside;
+      if (!inside)
+      {
+        auto test_result = test(loose_bounds(octree, octree_node));
+        if (test_result == -1)
+        {
+          continue;
+        }
+
+        inside = test_result == 1;
+      }
+
+      for (auto& render_mesh : octree_node.render_meshes)
+      {
+        // Render meshes without a radius are only known to be within the node's (loosened) bounds.
+        auto extent = vec3 { render_mesh.radius, render_mesh.radius, render_mesh.radius };
+        if (inside || render_mesh.radius == 0.0f || test(aabb3 { .min = render_mesh.position - extent, .max = render_mesh.position + extent }) != -1)
+        {
+          visit(render_mesh.id);
+        }
+      }
+
+      if (octree_node.child_index)
+      {
+        for (auto octant_index = 7; octant_index >= 0; octant_index--)
+        {
+          stack[stack_size++] = { .index = octree_node.child_index + octant_index, .inside = inside };
+        }
+      }
+    }
+  }
+
+  template<typename T>
+  uint32_t find(const loose_octree& octree, T&& test, std::span<uint64_t> results)
+  {
+    auto count = uint32_t(0);
+    find_each(octree, test, [&](uint64_t render_mesh_id)
+    {
+      if (count < results.size())
+      {
+        results[count] = render_mesh_id;
+      }
+
+      count++;
+    });
+
+    return count;
+  }
+}
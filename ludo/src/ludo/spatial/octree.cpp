@@ -2,13 +2,14 @@
  * This file is part of ludo. See the LICENSE file for the full license governing this code.
  */
 
+#include <algorithm>
 #include <cmath>
+#include <numeric>
 
 #include "octree.h"
 
 namespace ludo
 {
-  void find(const octree& octree, const std::function<int32_t(const aabb3& bounds)>& test, uint32_t divisions, const aabb3& bounds, uint32_t cumulative_index, std::vector<uint32_t>& results);
   vec3 cell_dimensions(const octree& octree);
   uint32_t cell_element_index(const octree& octree, uint32_t cell_index, uint32_t element);
   std::vector<uint32_t> cell_elements(const octree& octree, uint32_t cell_index);
@@ -19,6 +20,8 @@ namespace ludo
 
   void init(octree& octree)
   {
+    assert((!octree.morton || octree.divisions <= 10) && "too many divisions for a morton layout");
+
     octree.id = next_id++;
 
     auto cell_count = static_cast<uint32_t>(std::pow(8, octree.divisions));
@@ -55,6 +58,56 @@ namespace ludo
     write(stream, element);
   }
 
+  void add(octree& octree, std::span<const uint32_t> elements, std::span<const vec3> positions)
+  {
+    assert(elements.size() == positions.size() && "element and position counts differ");
+
+    auto cell_indices = std::vector<uint32_t>(elements.size());
+    for (auto index = uint32_t(0); index < elements.size(); index++)
+    {
+      cell_indices[index] = to_index(octree, to_cell_coordinates(octree, positions[index]));
+    }
+
+    // Counting sort the elements by cell (keeping the order they were given in within each cell), so that the cells are filled in the order of the buffer.
+    auto cell_count = static_cast<uint32_t>(std::pow(8, octree.divisions));
+    auto cell_starts = std::vector<uint32_t>(cell_count + 1);
+    for (auto cell_index : cell_indices)
+    {
+      cell_starts[cell_index + 1]++;
+    }
+
+    std::partial_sum(cell_starts.begin(), cell_starts.end(), cell_starts.begin());
+
+    auto order = std::vector<uint32_t>(elements.size());
+    auto next_order_positions = cell_starts;
+    for (auto index = uint32_t(0); index < elements.size(); index++)
+    {
+      order[next_order_positions[cell_indices[index]]++] = index;
+    }
+
+    for (auto cell_index = uint32_t(0); cell_index < cell_count; cell_index++)
+    {
+      auto start = cell_starts[cell_index];
+      auto end = cell_starts[cell_index + 1];
+      if (start == end)
+      {
+        continue;
+      }
+
+      auto stream = ludo::stream(octree.buffer, cell_offset(octree, cell_index));
+      auto element_count = peek<uint32_t>(stream);
+
+      assert(element_count + (end - start) <= octree.cell_capacity && "cell is full");
+
+      write(stream, element_count + (end - start));
+      stream.position += element_count * sizeof(uint32_t);
+      for (auto index = start; index < end; index++)
+      {
+        write(stream, elements[order[index]]);
+      }
+    }
+  }
+
   void remove(octree& octree, uint32_t element, const ludo::vec3& position)
   {
     auto cell_coordinates = to_cell_coordinates(octree, position);
@@ -132,32 +185,12 @@ namespace ludo
   std::vector<uint32_t> find(const octree& octree, const std::function<int32_t(const aabb3& bounds)>& test)
   {
     auto results = std::vector<uint32_t>();
-    find(octree, test, octree.divisions, octree.bounds, 0, results);
-
-    return results;
-  }
-
-  void find(const octree& octree, const std::function<int32_t(const aabb3& bounds)>& test, uint32_t divisions, const aabb3& bounds, uint32_t cumulative_index, std::vector<uint32_t>& results)
-  {
-    auto test_result = test(bounds);
-    if (test_result == -1)
-    {
-      return;
-    }
-
-    if (divisions == 0)
+    find_each(octree, test, [&](uint32_t element)
     {
-      auto elements = cell_elements(octree, cumulative_index);
-      results.insert(results.end(), elements.begin(), elements.end());
-
-      return;
-    }
+      results.push_back(element);
+    });
 
-    auto octant_bounds = ludo::octant_bounds(bounds);
-    for (auto octant_index = uint32_t(0); octant_index < octant_bounds.size(); octant_index++)
-    {
-      find(octree, test, divisions - 1, octant_bounds[octant_index], cumulative_index * 8 + octant_index, results);
-    }
+    return results;
   }
 
   vec3 cell_dimensions(const octree& octree)
@@ -238,6 +271,11 @@ namespace ludo
 
   uint32_t to_index(const octree& octree, const std::array<uint32_t, 3>& cell_coordinates)
   {
+    if (octree.morton)
+    {
+      return morton_encode(cell_coordinates);
+    }
+
     auto cell_count_1d = uint32_t(std::pow(2, octree.divisions));
     return cell_coordinates[0] * cell_count_1d * cell_count_1d + cell_coordinates[1] * cell_count_1d + cell_coordinates[2];
   }
@@ -253,6 +291,13 @@ namespace ludo
     cell_coordinates[1] = std::floor(cell_coordinates[1]);
     cell_coordinates[2] = std::floor(cell_coordinates[2]);
 
-    return { static_cast<uint32_t>(cell_coordinates[0]), static_cast<uint32_t>(cell_coordinates[1]), static_cast<uint32_t>(cell_coordinates[2]) };
+    // Positions on the max bounds belong to the last cell.
+    auto max_cell_coordinate = (uint32_t(1) << octree.divisions) - 1;
+    return
+    {
+      std::min(static_cast<uint32_t>(cell_coordinates[0]), max_cell_coordinate),
+      std::min(static_cast<uint32_t>(cell_coordinates[1]), max_cell_coordinate),
+      std::min(static_cast<uint32_t>(cell_coordinates[2]), max_cell_coordinate)
+    };
   }
 }
@@ -4,7 +4,11 @@
 
 #pragma once
 
+#include <functional>
+#include <span>
+
 #include "../data/buffers.h"
+#include "../math/util.h"
 #include "bounds.h"
 
 namespace ludo
@@ -18,6 +22,7 @@ namespace ludo
     aabb3 bounds; ///< The outer bounds.
     uint32_t divisions = 1; ///< The number of divisions (layers).
     uint32_t cell_capacity = 16; ///< The maximum number of elements that can be added to a cell.
+    bool morton = false; ///< Determines if the cells are laid out in Morton (Z-order) rather than row-major order, so that the cells of each node are contiguous.
 
     ludo::buffer buffer; ///< The cell data.
   };
@@ -39,6 +44,14 @@ namespace ludo
   /// \param position The position of the element.
   void add(octree& octree, uint32_t element, const ludo::vec3& position);
 
+  ///
+  /// Adds elements to an octree.
+  /// The elements are sorted by cell once and then each cell is filled in a single pass.
+  /// \param octree The octree to add the elements to.
+  /// \param elements The elements to add to the octree.
+  /// \param positions The positions of the elements.
+  void add(octree& octree, std::span<const uint32_t> elements, std::span<const vec3> positions);
+
   ///
   /// Removes an element from an octree.
   /// \param octree The octree to remove the element from.
@@ -52,4 +65,24 @@ namespace ludo
   /// \param test The test to perform against the bounds of the nodes.
   /// \return The matching elements.
   std::vector<uint32_t> find(const octree& octree, const std::function<int32_t(const aabb3& bounds)>& test);
+
+  ///
+  /// Finds elements within an octree without allocating (or recursing).
+  /// Nodes the test reports as wholly inside have all of their elements visited without testing their descendants.
+  /// \param octree The octree to search.
+  /// \param test The test to perform against the bounds of the nodes, of the form int32_t(const aabb3& bounds). Returns -1 if outside, 0 if intersecting and 1 if inside.
+  /// \param visit The function to call with each matching element, of the form void(uint32_t element).
+  template<typename T, typename V>
+  void find_each(const octree& octree, T&& test, V&& visit);
+
+  ///
+  /// Finds elements within an octree without allocating (or recursing).
+  /// \param octree The octree to search.
+  /// \param test The test to perform against the bounds of the nodes, of the form int32_t(const aabb3& bounds). Returns -1 if outside, 0 if intersecting and 1 if inside.
+  /// \param results The matching elements. Only the first results.size() elements are written.
+  /// \return The number of matching elements (which can be greater than results.size()).
+  template<typename T>
+  uint32_t find(const octree& octree, T&& test, std::span<uint32_t> results);
 }
+
+#include "octree.hpp"
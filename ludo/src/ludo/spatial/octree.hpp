@@ -0,0 +1,124 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <cassert>
+
+#include "octree.h"
+
+namespace ludo
+{
+  template<typename T, typename V>
+  void find_each(const octree& octree, T&& test, V&& visit)
+  {
+    struct node
+    {
+      aabb3 bounds;
+      std::array<uint32_t, 3> cell_coordinates; // The coordinates of the node's first cell, in units of the node's size
+      uint32_t morton_code; // The Morton code of the node's coordinates
+      uint32_t divisions;
+    };
+
+    // Children are pushed in reverse so that they are visited in order. At most 7 siblings are left waiting per layer.
+    assert(octree.divisions <= 10 && "too many divisions");
+    auto stack = std::array<node, 7 * 10 + 1>();
+    auto stack_size = uint32_t(0);
+    stack[stack_size++] = { .bounds = octree.bounds, .cell_coordinates = { 0, 0, 0 }, .morton_code = 0, .divisions = octree.divisions };
+
+    auto cell_count_1d = uint32_t(1) << octree.divisions;
+    auto cells = reinterpret_cast<const uint32_t*>(octree.buffer.data);
+    auto visit_cell = [&](uint32_t cell_index)
+    {
+      auto cell = cells + cell_index * (1 + octree.cell_capacity);
+      for (auto element_index = uint32_t(0); element_index < cell[0]; element_index++)
+      {
+        visit(cell[1 + element_index]);
+      }
+    };
+
+    while (stack_size)
+    {
+      auto current = stack[--stack_size];
+
+      auto test_result = test(current.bounds);
+      if (test_result == -1)
+      {
+        continue;
+      }
+
+      if (current.divisions == 0 || test_result == 1)
+      {
+        // Every cell within a node that is wholly inside is also wholly inside.
+        if (octree.morton)
+        {
+          // The cells of a node are contiguous.
+          auto cell_count = uint32_t(1) << (3 * current.divisions);
+          auto start = current.morton_code * cell_count;
+          for (auto cell_index = start; cell_index < start + cell_count; cell_index++)
+          {
+            visit_cell(cell_index);
+          }
+
+          continue;
+        }
+
+        auto size = uint32_t(1) << current.divisions;
+        auto min = std::array<uint32_t, 3> { current.cell_coordinates[0] * size, current.cell_coordinates[1] * size, current.cell_coordinates[2] * size };
+        for (auto x = min[0]; x < min[0] + size; x++)
+        {
+          for (auto y = min[1]; y < min[1] + size; y++)
+          {
+            for (auto z = min[2]; z < min[2] + size; z++)
+            {
+              visit_cell((x * cell_count_1d + y) * cell_count_1d + z);
+            }
+          }
+        }
+
+        continue;
+      }
+
+      auto half_size = (current.bounds.max - current.bounds.min) / 2.0f;
+      for (auto octant_index = 7; octant_index >= 0; octant_index--)
+      {
+        auto offset = vec3
+        {
+          octant_index & 1 ? half_size[0] : 0.0f,
+          octant_index & 2 ? half_size[1] : 0.0f,
+          octant_index & 4 ? half_size[2] : 0.0f
+        };
+
+        auto min = current.bounds.min + offset;
+        stack[stack_size++] =
+        {
+          .bounds = { .min = min, .max = min + half_size },
+          .cell_coordinates =
+          {
+            current.cell_coordinates[0] * 2 + (octant_index & 1 ? 1 : 0),
+            current.cell_coordinates[1] * 2 + (octant_index & 2 ? 1 : 0),
+            current.cell_coordinates[2] * 2 + (octant_index & 4 ? 1 : 0)
+          },
+          .morton_code = current.morton_code * 8 + static_cast<uint32_t>(((octant_index & 1) << 2) | (octant_index & 2) | ((octant_index & 4) >> 2)),
+          .divisions = current.divisions - 1
+        };
+      }
+    }
+  }
+
+  template<typename T>
+  uint32_t find(const octree& octree, T&& test, std::span<uint32_t> results)
+  {
+    auto count = uint32_t(0);
+    find_each(octree, test, [&](uint32_t element)
+    {
+      if (count < results.size())
+      {
+        results[count] = element;
+      }
+
+      count++;
+    });
+
+    return count;
+  }
+}
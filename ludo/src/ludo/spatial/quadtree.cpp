@@ -8,12 +8,10 @@
 
 namespace ludo
 {
-  void find(const quadtree& quadtree, const std::function<int32_t(const aabb2& bounds)>& test, uint32_t divisions, const aabb2& bounds, uint32_t cumulative_index, std::vector<uint32_t>& results);
   vec2 cell_dimensions(const quadtree& quadtree);
   uint32_t cell_element_index(const quadtree& quadtree, uint32_t cell_index, uint32_t element);
   std::vector<uint32_t> cell_elements(const quadtree& quadtree, uint32_t cell_index);
   uint64_t cell_offset(const quadtree& quadtree, uint32_t cell_index);
-  std::array<aabb2, 4> quadrant_bounds(const aabb2& bounds);
   uint32_t to_index(const quadtree& quadtree, const std::array<uint32_t, 2>& cell_coordinates);
   std::array<uint32_t, 2> to_cell_coordinates(const quadtree& quadtree, const vec2& position);
 
@@ -119,32 +117,12 @@ namespace ludo
   std::vector<uint32_t> find(const quadtree& quadtree, const std::function<int32_t(const aabb2& bounds)>& test)
   {
     auto results = std::vector<uint32_t>();
-    find(quadtree, test, quadtree.divisions, quadtree.bounds, 0, results);
-
-    return results;
-  }
-
-  void find(const quadtree& quadtree, const std::function<int32_t(const aabb2& bounds)>& test, uint32_t divisions, const aabb2& bounds, uint32_t cumulative_index, std::vector<uint32_t>& results)
-  {
-    auto test_result = test(bounds);
-    if (test_result == -1)
-    {
-      return;
-    }
-
-    if (divisions == 0)
+    find_each(quadtree, test, [&](uint32_t element)
     {
-      auto elements = cell_elements(quadtree, cumulative_index);
-      results.insert(results.end(), elements.begin(), elements.end());
+      results.push_back(element);
+    });
 
-      return;
-    }
-
-    auto quadrant_bounds = ludo::quadrant_bounds(bounds);
-    for (auto quadrant_index = uint32_t(0); quadrant_index < quadrant_bounds.size(); quadrant_index++)
-    {
-      find(quadtree, test, divisions - 1, quadrant_bounds[quadrant_index], cumulative_index * 4 + quadrant_index, results);
-    }
+    return results;
   }
 
   vec2 cell_dimensions(const quadtree& quadtree)
@@ -191,29 +169,6 @@ namespace ludo
     return cell_index * (sizeof(uint32_t) + quadtree.cell_capacity * sizeof(uint32_t));
   }
 
-  std::array<aabb2, 4> quadrant_bounds(const aabb2& bounds)
-  {
-    auto center = (bounds.min + bounds.max) / 2.0f;
-
-    auto offset_x = center[0] - bounds.min[0];
-    auto offset_y = center[1] - bounds.min[1];
-    auto offsets = std::array<vec2, 4>
-    {{
-      { 0.0f, 0.0f },
-      { offset_x, 0.0f },
-      { 0.0f, offset_y },
-      { offset_x, offset_y },
-    }};
-
-    return
-    {{
-      { .min = bounds.min + offsets[0], .max = center + offsets[0] },
-      { .min = bounds.min + offsets[1], .max = center + offsets[1] },
-      { .min = bounds.min + offsets[2], .max = center + offsets[2] },
-      { .min = bounds.min + offsets[3], .max = center + offsets[3] }
-    }};
-  }
-
   uint32_t to_index(const quadtree& quadtree, const std::array<uint32_t, 2>& cell_coordinates)
   {
     auto cell_count_1d = uint32_t(std::pow(2, quadtree.divisions));
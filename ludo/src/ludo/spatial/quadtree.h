@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <functional>
+#include <span>
+
 #include "../data/buffers.h"
 #include "bounds.h"
 
@@ -52,4 +55,24 @@ namespace ludo
   /// \param test The test to perform against the bounds of the nodes.
   /// \return The matching elements.
   std::vector<uint32_t> find(const quadtree& quadtree, const std::function<int32_t(const aabb2& bounds)>& test);
+
+  ///
+  /// Finds elements within an quadtree without allocating (or recursing).
+  /// Nodes the test reports as wholly inside have all of their elements visited without testing their descendants.
+  /// \param quadtree The quadtree to search.
+  /// \param test The test to perform against the bounds of the nodes, of the form int32_t(const aabb2& bounds). Returns -1 if outside, 0 if intersecting and 1 if inside.
+  /// \param visit The function to call with each matching element, of the form void(uint32_t element).
+  template<typename T, typename V>
+  void find_each(const quadtree& quadtree, T&& test, V&& visit);
+
+  ///
+  /// Finds elements within an quadtree without allocating (or recursing).
+  /// \param quadtree The quadtree to search.
+  /// \param test The test to perform against the bounds of the nodes, of the form int32_t(const aabb2& bounds). Returns -1 if outside, 0 if intersecting and 1 if inside.
+  /// \param results The matching elements. Only the first results.size() elements are written.
+  /// \return The number of matching elements (which can be greater than results.size()).
+  template<typename T>
+  uint32_t find(const quadtree& quadtree, T&& test, std::span<uint32_t> results);
 }
+
+#include "quadtree.hpp"
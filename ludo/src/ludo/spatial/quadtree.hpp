@@ -0,0 +1,104 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <cassert>
+
+#include "quadtree.h"
+
+namespace ludo
+{
+  template<typename T, typename V>
+  void find_each(const quadtree& quadtree, T&& test, V&& visit)
+  {
+    struct node
+    {
+      aabb2 bounds;
+      std::array<uint32_t, 2> cell_coordinates; // The coordinates of the node's first cell, in units of the node's size
+      uint32_t divisions;
+    };
+
+    // Children are pushed in reverse so that they are visited in order. At most 3 siblings are left waiting per layer.
+    assert(quadtree.divisions <= 16 && "too many divisions");
+    auto stack = std::array<node, 3 * 16 + 1>();
+    auto stack_size = uint32_t(0);
+    stack[stack_size++] = { .bounds = quadtree.bounds, .cell_coordinates = { 0, 0 }, .divisions = quadtree.divisions };
+
+    auto cell_count_1d = uint32_t(1) << quadtree.divisions;
+    auto cells = reinterpret_cast<const uint32_t*>(quadtree.buffer.data);
+    auto visit_cell = [&](uint32_t x, uint32_t y)
+    {
+      auto cell = cells + (x * cell_count_1d + y) * (1 + quadtree.cell_capacity);
+      for (auto element_index = uint32_t(0); element_index < cell[0]; element_index++)
+      {
+        visit(cell[1 + element_index]);
+      }
+    };
+
+    while (stack_size)
+    {
+      auto current = stack[--stack_size];
+
+      auto test_result = test(current.bounds);
+      if (test_result == -1)
+      {
+        continue;
+      }
+
+      if (current.divisions == 0 || test_result == 1)
+      {
+        // Every cell within a node that is wholly inside is also wholly inside.
+        auto size = uint32_t(1) << current.divisions;
+        auto min = std::array<uint32_t, 2> { current.cell_coordinates[0] * size, current.cell_coordinates[1] * size };
+        for (auto x = min[0]; x < min[0] + size; x++)
+        {
+          for (auto y = min[1]; y < min[1] + size; y++)
+          {
+            visit_cell(x, y);
+          }
+        }
+
+        continue;
+      }
+
+      auto half_size = (current.bounds.max - current.bounds.min) / 2.0f;
+      for (auto quadrant_index = 3; quadrant_index >= 0; quadrant_index--)
+      {
+        auto offset = vec2
+        {
+          quadrant_index & 1 ? half_size[0] : 0.0f,
+          quadrant_index & 2 ? half_size[1] : 0.0f
+        };
+
+        auto min = current.bounds.min + offset;
+        stack[stack_size++] =
+        {
+          .bounds = { .min = min, .max = min + half_size },
+          .cell_coordinates =
+          {
+            current.cell_coordinates[0] * 2 + (quadrant_index & 1 ? 1 : 0),
+            current.cell_coordinates[1] * 2 + (quadrant_index & 2 ? 1 : 0)
+          },
+          .divisions = current.divisions - 1
+        };
+      }
+    }
+  }
+
+  template<typename T>
+  uint32_t find(const quadtree& quadtree, T&& test, std::span<uint32_t> results)
+  {
+    auto count = uint32_t(0);
+    find_each(quadtree, test, [&](uint32_t element)
+    {
+      if (count < results.size())
+      {
+        results[count] = element;
+      }
+
+      count++;
+    });
+
+    return count;
+  }
+}
@@ -2,45 +2,493 @@
  * This file is part of ludo. See the LICENSE file for the full license governing this code.
  */
 
-#include <queue>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
 #include <thread>
+#include <utility>
 
 #include "thread_pool.h"
 
 namespace ludo
 {
-  static auto queue = std::queue<std::function<void()>>();
-  static auto mutex = std::mutex();
-  static auto semaphore = std::counting_semaphore(0);
+  struct job
+  {
+    std::function<void()> task;
+    std::shared_ptr<ludo::job> parent;
+    job_priority priority = job_priority::normal;
+
+    std::atomic<uint32_t> unfinished = 1; // The job itself plus its unfinished children.
+    std::atomic<uint32_t> unmet_dependencies = 1; // Held at 1 until the job has been fully enqueued.
+
+    std::mutex continuations_mutex;
+    std::vector<std::shared_ptr<ludo::job>> continuations; // The jobs that depend on this one.
+    bool finished = false;
+
+    std::mutex dependencies_mutex;
+    std::vector<std::weak_ptr<ludo::job>> dependencies; // The jobs this one or its children depended on when they were created, so that waiting threads can help with them.
+  };
+
+  struct job_queue
+  {
+    std::mutex mutex;
+    std::array<std::deque<std::shared_ptr<job>>, 3> jobs; // One deque per priority.
+  };
 
-  void thread_pool_start()
+  std::shared_ptr<job> create_job(const std::function<void()>& task, const std::vector<job_handle>& dependencies, const job_handle& parent, job_priority priority);
+  void schedule(const std::shared_ptr<job>& job);
+  void release(const std::shared_ptr<job>& job);
+  void execute(const std::shared_ptr<job>& job);
+  void finish(const std::shared_ptr<job>& job);
+  void notify_waiters();
+  std::shared_ptr<job> take_job(const std::vector<std::shared_ptr<job>>* contributors = nullptr);
+  std::vector<std::shared_ptr<job>> find_contributors(const std::shared_ptr<job>& awaited);
+  bool contributes(const job& candidate, const std::vector<std::shared_ptr<job>>& contributors);
+
+  static auto threads = std::vector<std::thread>();
+  static auto queues = std::vector<std::unique_ptr<job_queue>>(); // Guarded by the queues mutex since external threads can schedule and take jobs while the thread pool starts or stops.
+  static auto queues_mutex = std::shared_mutex();
+  static auto pending_queue = job_queue(); // Holds the jobs scheduled while the thread pool is not running.
+  static auto queued_count = std::atomic<uint32_t>(0);
+  static auto next_queue_index = std::atomic<uint32_t>(0);
+  static auto stopping = false;
+  static auto sleep_mutex = std::mutex();
+  static auto sleep_condition = std::condition_variable();
+
+  // Waiting threads sleep until the progress count changes i.e. a job is queued or completes.
+  static auto progress_count = std::atomic<uint64_t>(0);
+  static auto waiting_count = std::atomic<uint32_t>(0);
+  static auto wait_mutex = std::mutex();
+  static auto wait_condition = std::condition_variable();
+
+  // Changes whenever a child with dependencies is added, so that waiting threads know to look for the jobs they need again.
+  static auto dependency_generation = std::atomic<uint64_t>(0);
+
+  // The index of the queue owned by the current thread (external threads share the queues round-robin).
+  static thread_local auto worker_index = int32_t(-1);
+  static thread_local auto current_job = std::shared_ptr<job>();
+
+  void thread_pool_start(uint32_t thread_count)
   {
-    static auto threads = std::vector<std::thread>();
-    while (threads.size() < std::thread::hardware_concurrency())
+    assert(threads.empty() && "thread pool already started");
+
+    if (thread_count == 0)
     {
-      threads.emplace_back([]()
+      thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    stopping = false;
+
+    // Hand out the jobs scheduled before the thread pool started (they are already included in the queued count).
+    {
+      auto queues_lock = std::unique_lock(queues_mutex);
+      queues.resize(thread_count);
+      for (auto& queue : queues)
+      {
+        queue = std::make_unique<job_queue>();
+      }
+
+      auto lock = std::lock_guard(pending_queue.mutex);
+      for (auto priority_index = size_t(0); priority_index < pending_queue.jobs.size(); priority_index++)
       {
+        for (auto& job : pending_queue.jobs[priority_index])
+        {
+          queues[next_queue_index++ % thread_count]->jobs[priority_index].emplace_back(std::move(job));
+        }
+
+        pending_queue.jobs[priority_index].clear();
+      }
+    }
+
+    for (auto index = uint32_t(0); index < thread_count; index++)
+    {
+      threads.emplace_back([index]()
+      {
+        worker_index = static_cast<int32_t>(index);
+
         while (true)
         {
-          semaphore.acquire();
+          if (auto job = take_job())
+          {
+            execute(job);
+            continue;
+          }
 
-          mutex.lock();
-          auto task = queue.front();
-          queue.pop();
-          mutex.unlock();
+          auto lock = std::unique_lock(sleep_mutex);
+          sleep_condition.wait(lock, []() { return queued_count > 0 || stopping; });
 
-          task();
+          if (stopping && queued_count == 0)
+          {
+            return;
+          }
         }
       });
     }
   }
 
-  void thread_pool_enqueue(const std::function<void()>& task)
+  void thread_pool_stop()
+  {
+    {
+      auto lock = std::lock_guard(sleep_mutex);
+      stopping = true;
+    }
+
+    sleep_condition.notify_all();
+
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+
+    threads.clear();
+
+    // Keep any jobs external threads scheduled after the workers finished (they are already included in the queued count).
+    auto queues_lock = std::unique_lock(queues_mutex);
+    auto pending_lock = std::lock_guard(pending_queue.mutex);
+    for (auto& queue : queues)
+    {
+      for (auto priority_index = size_t(0); priority_index < queue->jobs.size(); priority_index++)
+      {
+        auto& jobs = queue->jobs[priority_index];
+        pending_queue.jobs[priority_index].insert(pending_queue.jobs[priority_index].end(), std::make_move_iterator(jobs.begin()), std::make_move_iterator(jobs.end()));
+      }
+    }
+
+    queues.clear();
+  }
+
+  bool thread_pool_running()
+  {
+    return !threads.empty();
+  }
+
+  job_handle thread_pool_enqueue(const std::function<void()>& task, const std::vector<job_handle>& dependencies, const job_handle& parent, job_priority priority)
+  {
+    auto job = create_job(task, dependencies, parent, priority);
+    release(job);
+
+    return { job };
+  }
+
+  job_handle thread_pool_parallel_for(uint32_t count, uint32_t batch_size, const std::function<void(uint32_t, uint32_t)>& task, const std::vector<job_handle>& dependencies, job_priority priority)
+  {
+    assert(batch_size > 0 && "batch size must be greater than zero");
+
+    // The batches are added as children of a job that holds the dependencies, so that threads waiting on it find them.
+    // The job cannot complete before its own task has added every batch.
+    auto shared_task = std::make_shared<std::function<void(uint32_t, uint32_t)>>(task);
+    return thread_pool_enqueue([count, batch_size, shared_task, priority]()
+    {
+      auto parent = thread_pool_current();
+      for (auto start = uint32_t(0); start < count; start += batch_size)
+      {
+        auto end = start + std::min(batch_size, count - start);
+        thread_pool_enqueue([shared_task, start, end]() { (*shared_task)(start, end); }, {}, parent, priority);
+      }
+    }, dependencies, {}, priority);
+  }
+
+  job_handle thread_pool_current()
+  {
+    return { current_job };
+  }
+
+  bool thread_pool_complete(const job_handle& handle)
+  {
+    return !handle.job || handle.job->unfinished.load(std::memory_order_acquire) == 0;
+  }
+
+  void thread_pool_wait(const job_handle& handle)
+  {
+    if (thread_pool_complete(handle))
+    {
+      return;
+    }
+
+    // Only jobs the awaited job needs are executed, so that waiting (e.g. for the scripts of a frame) never stalls on unrelated long-running work.
+    // The jobs it needs are found once (their descendants are found through their parents) unless a child with dependencies is added in the meantime.
+    auto seen_dependency_generation = dependency_generation.load();
+    auto contributors = find_contributors(handle.job);
+
+    waiting_count++;
+    while (!thread_pool_complete(handle))
+    {
+      auto seen_progress_count = progress_count.load();
+      if (dependency_generation.load() != seen_dependency_generation)
+      {
+        seen_dependency_generation = dependency_generation.load();
+        contributors = find_contributors(handle.job);
+      }
+
+      if (auto job = take_job(&contributors))
+      {
+        execute(job);
+        continue;
+      }
+
+      auto lock = std::unique_lock(wait_mutex);
+      wait_condition.wait(lock, [&]() { return progress_count.load() != seen_progress_count || thread_pool_complete(handle); });
+    }
+
+    waiting_count--;
+  }
+
+  std::shared_ptr<job> create_job(const std::function<void()>& task, const std::vector<job_handle>& dependencies, const job_handle& parent, job_priority priority)
+  {
+    auto job = std::make_shared<ludo::job>();
+    job->task = task;
+    job->priority = priority;
+
+    if (parent.job)
+    {
+      [[maybe_unused]] auto parent_unfinished = parent.job->unfinished.fetch_add(1);
+      assert(parent_unfinished > 0 && "parent already complete");
+      job->parent = parent.job;
+    }
+
+    for (auto& dependency : dependencies)
+    {
+      if (!dependency.job)
+      {
+        continue;
+      }
+
+      auto lock = std::lock_guard(dependency.job->continuations_mutex);
+      if (!dependency.job->finished)
+      {
+        job->unmet_dependencies++;
+        job->dependencies.emplace_back(dependency.job);
+        dependency.job->continuations.emplace_back(job);
+      }
+    }
+
+    // Waiting threads only follow the dependencies of the jobs they wait on, so the ancestors take on those of their children.
+    // The ancestors are unfinished while this job is, so their parents are still in place.
+    if (job->parent && !job->dependencies.empty())
+    {
+      for (auto ancestor = job->parent.get(); ancestor; ancestor = ancestor->parent.get())
+      {
+        auto lock = std::lock_guard(ancestor->dependencies_mutex);
+        ancestor->dependencies.insert(ancestor->dependencies.end(), job->dependencies.begin(), job->dependencies.end());
+      }
+
+      dependency_generation++;
+      notify_waiters();
+    }
+
+    return job;
+  }
+
+  void schedule(const std::shared_ptr<job>& job)
+  {
+    {
+      auto queues_lock = std::shared_lock(queues_mutex);
+      auto& queue = queues.empty() ? pending_queue : worker_index >= 0 ? *queues[worker_index] : *queues[next_queue_index++ % queues.size()];
+      auto lock = std::lock_guard(queue.mutex);
+      queue.jobs[static_cast<size_t>(job->priority)].emplace_back(job);
+    }
+
+    {
+      auto lock = std::lock_guard(sleep_mutex);
+      queued_count++;
+    }
+
+    sleep_condition.notify_one();
+    notify_waiters();
+  }
+
+  void release(const std::shared_ptr<job>& job)
+  {
+    if (job->unmet_dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+      schedule(job);
+    }
+  }
+
+  void execute(const std::shared_ptr<job>& job)
+  {
+    if (job->task)
+    {
+      // Jobs can be executed within other jobs while they wait, so restore the outer job afterwards.
+      auto outer_job = std::exchange(current_job, job);
+      job->task();
+      current_job = std::move(outer_job);
+    }
+
+    finish(job);
+  }
+
+  void finish(const std::shared_ptr<job>& job)
   {
-    mutex.lock();
-    queue.push(task);
-    mutex.unlock();
+    if (job->unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1)
+    {
+      return;
+    }
+
+    auto continuations = std::vector<std::shared_ptr<ludo::job>>();
+    {
+      auto lock = std::lock_guard(job->continuations_mutex);
+      job->finished = true;
+      std::swap(continuations, job->continuations);
+    }
+
+    // Release anything captured by the task now rather than whenever the last handle goes away.
+    job->task = nullptr;
+
+    for (auto& continuation : continuations)
+    {
+      release(continuation);
+    }
+
+    if (auto parent = std::move(job->parent))
+    {
+      finish(parent);
+    }
+
+    notify_waiters();
+  }
+
+  void notify_waiters()
+  {
+    progress_count++;
+
+    // A waiting thread registers itself before it reads the progress count, so it either sees the new count or is woken here.
+    if (waiting_count > 0)
+    {
+      {
+        auto lock = std::lock_guard(wait_mutex);
+      }
+
+      wait_condition.notify_all();
+    }
+  }
+
+  std::shared_ptr<job> take_job(const std::vector<std::shared_ptr<job>>* contributors)
+  {
+    if (queued_count == 0)
+    {
+      return nullptr;
+    }
+
+    auto takeable = [contributors](const std::shared_ptr<job>& job)
+    {
+      return !contributors || contributes(*job, *contributors);
+    };
+
+    auto take = [&takeable](job_queue& queue, size_t priority_index, bool newest) -> std::shared_ptr<job>
+    {
+      auto lock = std::lock_guard(queue.mutex);
+      auto& jobs = queue.jobs[priority_index];
+      if (newest)
+      {
+        auto iter = std::find_if(jobs.rbegin(), jobs.rend(), takeable);
+        if (iter != jobs.rend())
+        {
+          auto job = std::move(*iter);
+          jobs.erase(std::next(iter).base());
+          queued_count--;
+
+          return job;
+        }
+      }
+      else
+      {
+        auto iter = std::find_if(jobs.begin(), jobs.end(), takeable);
+        if (iter != jobs.end())
+        {
+          auto job = std::move(*iter);
+          jobs.erase(iter);
+          queued_count--;
+
+          return job;
+        }
+      }
+
+      return nullptr;
+    };
+
+    auto queues_lock = std::shared_lock(queues_mutex);
+    for (auto priority_index = size_t(0); priority_index < pending_queue.jobs.size(); priority_index++)
+    {
+      // Jobs scheduled while the thread pool is not running can only be executed by waiting threads.
+      if (queues.empty())
+      {
+        if (auto job = take(pending_queue, priority_index, false))
+        {
+          return job;
+        }
+
+        continue;
+      }
+
+      // Workers take the most recently queued job from their own queue (it is most likely to be in cache)...
+      auto own_index = worker_index >= 0 ? static_cast<uint32_t>(worker_index) : 0;
+      if (worker_index >= 0)
+      {
+        if (auto job = take(*queues[own_index], priority_index, true))
+        {
+          return job;
+        }
+      }
+
+      // ...and steal the oldest job from the other queues (it is most likely to spawn more work).
+      for (auto offset = uint32_t(0); offset < queues.size(); offset++)
+      {
+        if (auto job = take(*queues[(own_index + offset) % queues.size()], priority_index, false))
+        {
+          return job;
+        }
+      }
+    }
+
+    return nullptr;
+  }
+
+  std::vector<std::shared_ptr<job>> find_contributors(const std::shared_ptr<job>& awaited)
+  {
+    // The awaited job and its (unfinished) dependencies, recursively. Holding them keeps their addresses from being reused while waiting.
+    auto contributors = std::vector<std::shared_ptr<job>> { awaited };
+    for (auto index = size_t(0); index < contributors.size(); index++)
+    {
+      auto target = contributors[index].get();
+      auto lock = std::lock_guard(target->dependencies_mutex);
+      for (auto& weak_dependency : target->dependencies)
+      {
+        auto dependency = weak_dependency.lock();
+        if (dependency && dependency->unfinished.load(std::memory_order_acquire) > 0 && std::find(contributors.begin(), contributors.end(), dependency) == contributors.end())
+        {
+          contributors.emplace_back(std::move(dependency));
+        }
+      }
+    }
+
+    std::sort(contributors.begin(), contributors.end());
+
+    return contributors;
+  }
+
+  bool contributes(const job& candidate, const std::vector<std::shared_ptr<job>>& contributors)
+  {
+    // A job contributes if it or one of its ancestors is a contributor.
+    // The ancestors of a queued job are all unfinished, so their parents are still in place.
+    for (auto ancestor = &candidate; ancestor; ancestor = ancestor->parent.get())
+    {
+      auto iter = std::lower_bound(contributors.begin(), contributors.end(), ancestor, [](const std::shared_ptr<job>& contributor, const job* value)
+      {
+        return contributor.get() < value;
+      });
+
+      if (iter != contributors.end() && iter->get() == ancestor)
+      {
+        return true;
+      }
+    }
 
-    semaphore.release();
+    return false;
   }
 }
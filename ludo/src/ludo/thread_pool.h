@@ -5,13 +5,81 @@
 #pragma once
 
 #include <functional>
+#include <memory>
+#include <vector>
 
 namespace ludo
 {
-  void thread_pool_start();
+  struct job;
+
+  ///
+  /// The priority of a job. Queued jobs of a higher priority are always taken before those of a lower priority.
+  enum class job_priority
+  {
+    high, ///< For work that something is about to wait on.
+    normal, ///< For general work e.g. the scripts of a frame.
+    low ///< For background work that can span frames e.g. streaming.
+  };
+
+  ///
+  /// A handle to a job that can be waited upon or depended on by other jobs.
+  /// A job is only complete once its task and the tasks of all of its children are complete.
+  struct job_handle
+  {
+    std::shared_ptr<ludo::job> job; ///< The job (or nullptr if the handle does not refer to a job).
+  };
+
+  ///
+  /// Starts the worker threads of the thread pool.
+  /// Each worker has its own queue of jobs and steals from the queues of other workers when it runs out.
+  /// \param thread_count The number of worker threads to start (defaults to the number of hardware threads).
+  void thread_pool_start(uint32_t thread_count = 0);
+
+  ///
+  /// Stops the worker threads of the thread pool once all queued jobs have been executed.
+  /// Jobs enqueued after the thread pool has stopped are queued until it is started again.
+  void thread_pool_stop();
+
+  ///
+  /// Determines if the worker threads of the thread pool have been started.
+  /// \return True if the worker threads have been started (and not stopped), false otherwise.
+  bool thread_pool_running();
 
   ///
   /// Executes a task in the thread pool.
+  /// Jobs enqueued before the thread pool has started are queued until it starts (or until they are waited on).
   /// \param task The task to execute.
-  void thread_pool_enqueue(const std::function<void()>& task);
+  /// \param dependencies The jobs that must complete before the task is executed.
+  /// \param parent A job that will not complete until this one has. Must not already be complete.
+  /// \param priority The priority of the job.
+  /// \return A handle to the job executing the task.
+  job_handle thread_pool_enqueue(const std::function<void()>& task, const std::vector<job_handle>& dependencies = {}, const job_handle& parent = {}, job_priority priority = job_priority::normal);
+
+  ///
+  /// Executes a task in the thread pool for each batch of a range of indices.
+  /// Batches are always split in the same way for a given count and batch size.
+  /// \param count The number of indices in the range.
+  /// \param batch_size The maximum number of indices per batch.
+  /// \param task The task to execute. Receives the start and end (exclusive) indices of the batch.
+  /// \param dependencies The jobs that must complete before any batch is executed.
+  /// \param priority The priority of the batches.
+  /// \return A handle to a job that completes once all batches have been executed.
+  job_handle thread_pool_parallel_for(uint32_t count, uint32_t batch_size, const std::function<void(uint32_t, uint32_t)>& task, const std::vector<job_handle>& dependencies = {}, job_priority priority = job_priority::normal);
+
+  ///
+  /// Retrieves the job being executed by the calling thread, e.g. to add children to it.
+  /// \return A handle to the job being executed by the calling thread (or an empty handle if it isn't executing one).
+  job_handle thread_pool_current();
+
+  ///
+  /// Determines if a job is complete.
+  /// \param handle The handle of the job.
+  /// \return True if the job (and all of its children) is complete, false otherwise. Empty handles are always complete.
+  bool thread_pool_complete(const job_handle& handle);
+
+  ///
+  /// Waits for a job to complete. While waiting, the calling thread executes queued jobs the job needs to complete (the job itself, its children and the jobs it depends on), but never unrelated jobs.
+  /// When none of those jobs are queued, the calling thread sleeps until more are queued or one completes.
+  /// \param handle The handle of the job to wait for.
+  void thread_pool_wait(const job_handle& handle);
 }
@@ -0,0 +1,77 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <ludo/animation.h>
+#include <ludo/testing.h>
+
+#include "animation.h"
+
+namespace ludo
+{
+  void test_animation()
+  {
+    test_group("animation");
+
+    // A root (that is not a bone) with an animated two bone chain and a bone that is not animated
+    auto armature = ludo::armature { .transform = mat4(vec3 { 0.0f, 1.0f, 0.0f }, mat3_identity) };
+    armature.children.push_back({ .bone_index = 0, .bone_offset = mat4(vec3 { 0.0f, -1.0f, 0.0f }, mat3_identity) });
+    armature.children[0].children.push_back({ .bone_index = 1, .bone_offset = mat4(vec3 { 0.0f, -2.0f, 0.0f }, mat3(vec3_unit_z, 0.1f)) });
+    armature.children.push_back({ .bone_index = 2, .bone_offset = mat4_identity });
+    init(armature);
+
+    auto animation = ludo::animation { .ticks = 4.0f, .ticks_per_second = 2.0f };
+    animation.nodes.push_back(
+    {
+      .bone_index = 1,
+      .position_keyframes = { { 0.0f, vec3 { 0.0f, 1.0f, 0.0f } }, { 1.5f, vec3 { 0.5f, 1.0f, 0.0f } }, { 3.0f, vec3 { 0.0f, 1.5f, 0.0f } }, { 4.0f, vec3 { 0.0f, 1.0f, 0.0f } } },
+      .rotation_keyframes = { { 0.0f, quat(vec3_unit_x, 0.0f) }, { 2.0f, quat(vec3_unit_x, 1.0f) }, { 4.0f, quat(vec3_unit_x, 0.0f) } },
+      .scale_keyframes = { { 0.0f, vec3_one } }
+    });
+    animation.nodes.push_back(
+    {
+      .bone_index = 0,
+      .position_keyframes = { { 0.0f, vec3_zero } },
+      .rotation_keyframes = { { 0.0f, quat(vec3_unit_y, 0.0f) }, { 1.0f, quat(vec3_unit_y, 0.5f) }, { 4.0f, quat(vec3_unit_y, 0.0f) } },
+      .scale_keyframes = { { 0.0f, vec3_one }, { 4.0f, vec3 { 2.0f, 1.0f, 0.5f } } }
+    });
+    init(animation);
+
+    auto animation_clip = compile(animation, armature);
+
+    test_not_equal("compile: id", animation_clip.id, uint64_t(0));
+    test_equal("compile: node count", animation_clip.parent_indices.size(), size_t(4));
+    test_equal("compile: channel count", animation_clip.channels.size(), size_t(2));
+    test_equal("compile: parent of the chain end", animation_clip.parent_indices[2], 1);
+    test_equal("compile: channel of the bone that is not animated", animation_clip.channel_indices[3], -1);
+
+    auto times = std::vector<float> { 0.0f, 0.3f, 0.5f, 0.75f, 1.2f, 1.9f, 2.1f };
+    auto expected_transforms = std::vector<std::array<mat4, 3>>(times.size());
+    auto clip_transforms = std::vector<std::array<mat4, 3>>(times.size());
+    auto batch_transforms = std::vector<std::array<mat4, 3>>(times.size());
+    auto batch_pointers = std::vector<mat4*>(times.size());
+    for (auto index = uint32_t(0); index < times.size(); index++)
+    {
+      expected_transforms[index].fill(mat4_identity);
+      clip_transforms[index].fill(mat4_identity);
+      batch_transforms[index].fill(mat4_identity);
+      batch_pointers[index] = batch_transforms[index].data();
+
+      interpolate(animation, armature, times[index], expected_transforms[index].data());
+      interpolate(animation_clip, times[index], clip_transforms[index].data());
+    }
+
+    interpolate(animation_clip, times.data(), batch_pointers.data(), static_cast<uint32_t>(times.size()));
+
+    for (auto index = uint32_t(0); index < times.size(); index++)
+    {
+      for (auto bone_index = 0; bone_index < 3; bone_index++)
+      {
+        auto name = "interpolate: time " + std::to_string(times[index]) + ", bone " + std::to_string(bone_index);
+
+        test_near(name, clip_transforms[index][bone_index], expected_transforms[index][bone_index]);
+        test_equal(name + " (batch)", batch_transforms[index][bone_index], clip_transforms[index][bone_index]);
+      }
+    }
+  }
+}
@@ -2,6 +2,8 @@
  * This file is part of ludo. See the LICENSE file for the full license governing this code.
  */
 
+#include <string>
+
 #include <ludo/data/arrays.h>
 #include <ludo/testing.h>
 
@@ -9,6 +11,11 @@
 
 namespace ludo
 {
+  struct test_array_element
+  {
+    uint64_t id = 0;
+  };
+
   void test_arrays()
   {
     test_group("arrays");
@@ -58,6 +65,19 @@ namespace ludo
     test_equal("array: remove end (remaining element 0)", array_2[0], 1);
     test_equal("array: remove end (remaining element 1)", array_2[1], 3);
 
+    add(array_2, 5);
+    add(array_2, 6);
+    swap_remove(array_2, array_2.begin());
+    test_equal("array: swap remove front (length)", array_2.length, 3u);
+    test_equal("array: swap remove front (element 0)", array_2[0], 6);
+    test_equal("array: swap remove front (element 1)", array_2[1], 3);
+    test_equal("array: swap remove front (element 2)", array_2[2], 5);
+
+    swap_remove(array_2, array_2.begin() + 2);
+    test_equal("array: swap remove end (length)", array_2.length, 2u);
+    test_equal("array: swap remove end (element 0)", array_2[0], 6);
+    test_equal("array: swap remove end (element 1)", array_2[1], 3);
+
     auto partitioned_array = allocate_partitioned_array<int32_t>(10);
     test_not_equal<int32_t*>("partitioned_array: allocate (data)", partitioned_array.data, nullptr);
     test_equal("partitioned_array: allocate (length)", partitioned_array.length, 0u);
@@ -269,5 +289,101 @@ namespace ludo
     test_equal("partitioned_array: find or create new (name)", new_partition_iter->first, std::string("new-partition"));
     test_equal<void*>("partitioned_array: find or create new (data)", new_partition_iter->second.data, partitioned_array_4.data + 1);
     test_equal("partitioned_array: find or create new (array length)", new_partition_iter->second.length, 0u);
+
+    auto partitioned_array_5 = allocate_partitioned_array<test_array_element>(10);
+    add(partitioned_array_5, { .id = 1 }, "partition-0");
+    index_ids(partitioned_array_5);
+    add(partitioned_array_5, { .id = 2 }, "partition-1");
+    add(partitioned_array_5, { .id = 3 }, "partition-0");
+    add(partitioned_array_5, { .id = 4 }, "partition-1");
+    test_equal("partitioned_array: find by id (indexed before)", find_by_id(partitioned_array_5, 1)->id, uint64_t(1));
+    test_equal("partitioned_array: find by id (indexed after)", find_by_id(partitioned_array_5, 2)->id, uint64_t(2));
+    test_equal("partitioned_array: find by id (shifted partition)", find_by_id(partitioned_array_5, 3)->id, uint64_t(3));
+    test_equal("partitioned_array: find by id (added to shifted partition)", find_by_id(partitioned_array_5, 4)->id, uint64_t(4));
+    test_equal("partitioned_array: find by id (index size)", partitioned_array_5.id_index.size(), std::size_t(4));
+    test_equal<test_array_element*>("partitioned_array: find by id (missing)", find_by_id(partitioned_array_5, 5), nullptr);
+    test_equal("partitioned_array: find by id (partition)", find_by_id(partitioned_array_5, "partition-1", 2)->id, uint64_t(2));
+    test_equal<test_array_element*>("partitioned_array: find by id (other partition)", find_by_id(partitioned_array_5, "partition-0", 2), nullptr);
+
+    remove(partitioned_array_5, find_by_id(partitioned_array_5, 1), "partition-0");
+    test_equal<test_array_element*>("partitioned_array: find by id (removed)", find_by_id(partitioned_array_5, 1), nullptr);
+    test_equal("partitioned_array: find by id (after removal, same partition)", find_by_id(partitioned_array_5, 3), partitioned_array_5.partitions[0].second.begin());
+    test_equal("partitioned_array: find by id (after removal, later partition)", find_by_id(partitioned_array_5, 4), partitioned_array_5.partitions[1].second.begin() + 1);
+    test_equal("partitioned_array: find by id (after removal, index size)", partitioned_array_5.id_index.size(), std::size_t(3));
+
+    const auto& const_partitioned_array_5 = partitioned_array_5;
+    test_equal("partitioned_array: find by id (const)", find_by_id(const_partitioned_array_5, 2)->id, uint64_t(2));
+    test_equal<const test_array_element*>("partitioned_array: find by id (const, missing)", find_by_id(const_partitioned_array_5, 5), nullptr);
+    test_equal("partitioned_array: find by id (const, index size)", partitioned_array_5.id_index.size(), std::size_t(3));
+
+    clear(partitioned_array_5);
+    test_equal<test_array_element*>("partitioned_array: find by id (cleared)", find_by_id(partitioned_array_5, 3), nullptr);
+    test_equal("partitioned_array: find by id (cleared index size)", partitioned_array_5.id_index.size(), std::size_t(0));
+
+    auto partitioned_array_7 = allocate_partitioned_array<test_array_element>(10);
+    add(partitioned_array_7, { .id = 1 }, "partition-0");
+    add(partitioned_array_7, { .id = 1 }, "partition-1");
+    add(partitioned_array_7, { .id = 2 }, "partition-1");
+    test_equal("partitioned_array: find by id unindexed (partition)", find_by_id(partitioned_array_7, "partition-1", 2)->id, uint64_t(2));
+    test_equal("partitioned_array: find by id unindexed (duplicate in earlier partition)", find_by_id(partitioned_array_7, "partition-1", 1), partitioned_array_7.partitions[1].second.begin());
+    test_equal<test_array_element*>("partitioned_array: find by id unindexed (other partition)", find_by_id(partitioned_array_7, "partition-0", 2), nullptr);
+
+    auto partitioned_array_6 = allocate_partitioned_array<int32_t>(10);
+    use_swapping(partitioned_array_6);
+    auto handle_0 = handle_of(partitioned_array_6, add(partitioned_array_6, 0, "partition-0"));
+    auto handle_1 = handle_of(partitioned_array_6, add(partitioned_array_6, 1, "partition-1"));
+    auto handle_2 = handle_of(partitioned_array_6, add(partitioned_array_6, 2, "partition-1"));
+    auto handle_3 = handle_of(partitioned_array_6, add(partitioned_array_6, 3, "partition-2"));
+    auto handle_4 = handle_of(partitioned_array_6, add(partitioned_array_6, 4, "partition-0"));
+    test_equal("partitioned_array: swapping add (length)", partitioned_array_6.length, 5u);
+    test_equal("partitioned_array: swapping add (partition 0 data)", partitioned_array_6.partitions[0].second.data, partitioned_array_6.data);
+    test_equal("partitioned_array: swapping add (partition 0 array length)", partitioned_array_6.partitions[0].second.length, 2u);
+    test_equal<int32_t*>("partitioned_array: swapping add (partition 1 data)", partitioned_array_6.partitions[1].second.data, partitioned_array_6.data + 2);
+    test_equal("partitioned_array: swapping add (partition 1 array length)", partitioned_array_6.partitions[1].second.length, 2u);
+    test_equal<int32_t*>("partitioned_array: swapping add (partition 2 data)", partitioned_array_6.partitions[2].second.data, partitioned_array_6.data + 4);
+    test_equal("partitioned_array: swapping add (partition 2 array length)", partitioned_array_6.partitions[2].second.length, 1u);
+    test_equal("partitioned_array: swapping add (handle 0)", *get(partitioned_array_6, handle_0), 0);
+    test_equal("partitioned_array: swapping add (handle 1)", *get(partitioned_array_6, handle_1), 1);
+    test_equal("partitioned_array: swapping add (handle 2)", *get(partitioned_array_6, handle_2), 2);
+    test_equal("partitioned_array: swapping add (handle 3)", *get(partitioned_array_6, handle_3), 3);
+    test_equal("partitioned_array: swapping add (handle 4)", *get(partitioned_array_6, handle_4), 4);
+    test_equal("partitioned_array: swapping add (handle 4 partition)", find(partitioned_array_6, "partition-0")->second[1], 4);
+
+    remove(partitioned_array_6, get(partitioned_array_6, handle_0), "partition-0");
+    test_equal("partitioned_array: swapping remove (length)", partitioned_array_6.length, 4u);
+    test_equal("partitioned_array: swapping remove (partition 0 array length)", partitioned_array_6.partitions[0].second.length, 1u);
+    test_equal("partitioned_array: swapping remove (partition 0 element 0)", partitioned_array_6.partitions[0].second[0], 4);
+    test_equal<int32_t*>("partitioned_array: swapping remove (partition 1 data)", partitioned_array_6.partitions[1].second.data, partitioned_array_6.data + 1);
+    test_equal<int32_t*>("partitioned_array: swapping remove (partition 2 data)", partitioned_array_6.partitions[2].second.data, partitioned_array_6.data + 3);
+    test_equal<int32_t*>("partitioned_array: swapping remove (removed handle)", get(partitioned_array_6, handle_0), nullptr);
+    test_equal("partitioned_array: swapping remove (handle 1)", *get(partitioned_array_6, handle_1), 1);
+    test_equal("partitioned_array: swapping remove (handle 2)", *get(partitioned_array_6, handle_2), 2);
+    test_equal("partitioned_array: swapping remove (handle 3)", *get(partitioned_array_6, handle_3), 3);
+    test_equal("partitioned_array: swapping remove (handle 4)", *get(partitioned_array_6, handle_4), 4);
+
+    auto handle_5 = handle_of(partitioned_array_6, add(partitioned_array_6, 5, "partition-1"));
+    test_equal("partitioned_array: swapping reuse (slot)", handle_5.index, handle_0.index);
+    test_not_equal("partitioned_array: swapping reuse (generation)", handle_5.generation, handle_0.generation);
+    test_equal<int32_t*>("partitioned_array: swapping reuse (old handle)", get(partitioned_array_6, handle_0), nullptr);
+    test_equal("partitioned_array: swapping reuse (new handle)", *get(partitioned_array_6, handle_5), 5);
+    test_equal("partitioned_array: swapping reuse (handle 3)", *get(partitioned_array_6, handle_3), 3);
+
+    clear(partitioned_array_6);
+    test_equal<int32_t*>("partitioned_array: swapping clear (handle)", get(partitioned_array_6, handle_1), nullptr);
+
+    auto partitioned_array_8 = allocate_partitioned_array<std::string>(10);
+    add(partitioned_array_8, std::string("first"), "partition-0");
+    add(partitioned_array_8, std::string("short"), "partition-1");
+    add(partitioned_array_8, std::string("a name too long to be stored inline"), "partition-1");
+    add(partitioned_array_8, std::string("second"), "partition-0");
+    test_equal("partitioned_array: shift strings (element 0)", partitioned_array_8[0], std::string("first"));
+    test_equal("partitioned_array: shift strings (element 1)", partitioned_array_8[1], std::string("second"));
+    test_equal("partitioned_array: shift strings (element 2)", partitioned_array_8[2], std::string("short"));
+    test_equal("partitioned_array: shift strings (element 3)", partitioned_array_8[3], std::string("a name too long to be stored inline"));
+
+    remove(partitioned_array_8, partitioned_array_8.begin(), "partition-0");
+    test_equal("partitioned_array: remove shifted strings (element 0)", partitioned_array_8[0], std::string("second"));
+    test_equal("partitioned_array: remove shifted strings (element 1)", partitioned_array_8[1], std::string("short"));
+    test_equal("partitioned_array: remove shifted strings (element 2)", partitioned_array_8[2], std::string("a name too long to be stored inline"));
   }
 }
@@ -0,0 +1,60 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <ludo/data/data.h>
+#include <ludo/testing.h>
+
+#include "data.h"
+
+namespace ludo
+{
+  struct test_element_a
+  {
+    uint64_t id = 0;
+  };
+
+  struct test_element_b
+  {
+    uint64_t id = 0;
+  };
+
+  void test_data()
+  {
+    test_group("data");
+
+    test_equal("type_index: stable", type_index<test_element_a>(), type_index<test_element_a>());
+    test_not_equal("type_index: unique", type_index<test_element_a>(), type_index<test_element_b>());
+
+    auto instance = ludo::instance();
+    test_equal("exists: before allocate", exists<test_element_a>(instance), false);
+    test_equal<test_element_a*>("first: before allocate", first<test_element_a>(instance), nullptr);
+
+    allocate<test_element_a>(instance, 4);
+    test_equal("exists: after allocate", exists<test_element_a>(instance), true);
+    test_equal("exists: other type", exists<test_element_b>(instance), false);
+    test_equal<test_element_a*>("first: empty", first<test_element_a>(instance), nullptr);
+
+    add(instance, test_element_a { .id = 1 });
+    add(instance, test_element_a { .id = 2 }, "other");
+    test_equal("first: element", first<test_element_a>(instance)->id, uint64_t(1));
+    test_equal("first: partition element", first<test_element_a>(instance, "other")->id, uint64_t(2));
+    test_equal("exists: partition", exists<test_element_a>(instance, "other"), true);
+    test_equal("exists: missing partition", exists<test_element_a>(instance, "missing"), false);
+    test_equal("get: element", get<test_element_a>(instance, 2)->id, uint64_t(2));
+    test_equal("data: length", data<test_element_a>(instance).length, 2u);
+
+    deallocate<test_element_a>(instance);
+    test_equal("exists: after deallocate", exists<test_element_a>(instance), false);
+
+    auto& heap_a = allocate_heap(instance, "heap-a", 16);
+    auto& heap_b = allocate_heap(instance, "heap-b", 32);
+    test_equal("data_heap: heap a", &data_heap(instance, "heap-a"), &heap_a);
+    test_equal("data_heap: heap b", &data_heap(instance, "heap-b"), &heap_b);
+    test_equal("data_heap: heap b size", data_heap(instance, "heap-b").size, uint64_t(32));
+
+    deallocate_heap(instance, "heap-a");
+    test_equal("data_heap: after deallocate", &data_heap(instance, "heap-b"), &heap_b);
+    test_equal("deallocate_heap: heap count", instance.heaps.size(), std::size_t(1));
+  }
+}
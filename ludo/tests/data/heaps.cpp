@@ -0,0 +1,115 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <random>
+#include <vector>
+
+#include <ludo/data/heaps.h>
+#include <ludo/testing.h>
+
+#include "heaps.h"
+
+namespace ludo
+{
+  void test_heaps()
+  {
+    test_group("heaps");
+
+    auto heap = allocate_heap(1024);
+    test_not_equal<std::byte*>("heap: allocate (data)", heap.data, nullptr);
+    test_equal("heap: allocate (size)", heap.size, 1024ul);
+    test_equal("heap: allocate (free size)", free_size(heap), 1024ul);
+    test_equal("heap: allocate (largest free size)", largest_free_size(heap), 1024ul);
+
+    auto buffer_1 = allocate(heap, 100);
+    test_equal("heap: allocate buffer (data)", buffer_1.data, heap.data);
+    test_equal("heap: allocate buffer (size)", buffer_1.size, 100ul);
+    test_equal("heap: allocate buffer (free size)", free_size(heap), 924ul);
+
+    auto buffer_2 = allocate(heap, 100, 40);
+    test_equal("heap: allocate aligned buffer (offset)", static_cast<uint64_t>(buffer_2.data - heap.data), 120ul);
+    test_equal("heap: allocate aligned buffer (size)", buffer_2.size, 100ul);
+    test_equal("heap: allocate aligned buffer (free size)", free_size(heap), 824ul);
+
+    auto buffer_3 = allocate(heap, 20);
+    test_equal("heap: allocate into padding (offset)", static_cast<uint64_t>(buffer_3.data - heap.data), 100ul);
+
+    deallocate(heap, buffer_1);
+    test_equal<std::byte*>("heap: deallocate buffer (data)", buffer_1.data, nullptr);
+    test_equal("heap: deallocate buffer (size)", buffer_1.size, 0ul);
+    test_equal("heap: deallocate buffer (free size)", free_size(heap), 904ul);
+    test_equal("heap: deallocate buffer (largest free size)", largest_free_size(heap), 804ul);
+
+    deallocate(heap, buffer_3);
+    deallocate(heap, buffer_2);
+    test_equal("heap: deallocate coalesce (free size)", free_size(heap), 1024ul);
+    test_equal("heap: deallocate coalesce (largest free size)", largest_free_size(heap), 1024ul);
+
+    auto buffer_4 = allocate(heap, 1024);
+    test_equal("heap: allocate exact fit (data)", buffer_4.data, heap.data);
+    test_equal("heap: allocate exact fit (free size)", free_size(heap), 0ul);
+
+    // Deallocating a buffer that wasn't returned by allocate (and so has no ID) should still work.
+    auto buffer_5 = buffer { .data = buffer_4.data, .size = buffer_4.size };
+    deallocate(heap, buffer_5);
+    test_equal("heap: deallocate without ID (free size)", free_size(heap), 1024ul);
+
+    auto buffer_6 = allocate(heap, 512);
+    auto buffer_7 = allocate(heap, 512);
+    test_equal("heap: allocate exact fill (free size)", free_size(heap), 0ul);
+    clear(heap);
+    test_equal("heap: clear (free size)", free_size(heap), 1024ul);
+    test_equal("heap: clear (largest free size)", largest_free_size(heap), 1024ul);
+    static_cast<void>(buffer_6);
+    static_cast<void>(buffer_7);
+
+    auto random = std::mt19937(42);
+    auto buffers = std::vector<buffer>();
+    auto overlapping = false;
+    auto misaligned = false;
+    for (auto iteration = 0; iteration < 10000; iteration++)
+    {
+      if (!buffers.empty() && (random() % 2 || free_size(heap) < 64))
+      {
+        auto index = random() % buffers.size();
+        deallocate(heap, buffers[index]);
+        buffers[index] = buffers.back();
+        buffers.pop_back();
+        continue;
+      }
+
+      auto size = 1 + random() % 32;
+      auto alignment = static_cast<uint8_t>(1 + random() % 8);
+      if (largest_free_size(heap) < size + alignment)
+      {
+        continue;
+      }
+
+      auto buffer = allocate(heap, size, alignment);
+      misaligned |= (buffer.data - heap.data) % alignment != 0;
+      for (auto& other : buffers)
+      {
+        overlapping |= buffer.data < other.data + other.size && other.data < buffer.data + buffer.size;
+      }
+
+      buffers.emplace_back(buffer);
+    }
+
+    test_equal("heap: random (overlapping)", overlapping, false);
+    test_equal("heap: random (misaligned)", misaligned, false);
+
+    for (auto& buffer : buffers)
+    {
+      deallocate(heap, buffer);
+    }
+
+    test_equal("heap: random (free size)", free_size(heap), 1024ul);
+    test_equal("heap: random (largest free size)", largest_free_size(heap), 1024ul);
+
+    deallocate(heap);
+    test_equal<std::byte*>("heap: deallocate (data)", heap.data, nullptr);
+    test_equal("heap: deallocate (size)", heap.size, 0ul);
+    test_equal("heap: deallocate (free size)", free_size(heap), 0ul);
+  }
+}
@@ -228,6 +228,17 @@ namespace ludo
     test_equal("mat4 multiply vector", mat4_test * vec4_test, vec4 { 56.0f, 62.0f, 68.0f, 74.0f });
     test_equal("mat4 multiply vector (vector on left)", vec4_test * mat4_test, vec4 { 14.0f, 38.0f, 62.0f, 86.0f });
 
+    auto mat4_multiply_vectors = std::array<vec4, 3> { vec4_test, vec4_test * 2.0f, vec4_test * 3.0f };
+    auto mat4_multiply_vectors_products = std::array<vec4, 3>();
+    multiply(mat4_test, mat4_multiply_vectors.data(), mat4_multiply_vectors_products.data(), 3);
+    test_equal("mat4 multiply vectors (0)", mat4_multiply_vectors_products[0], vec4 { 56.0f, 62.0f, 68.0f, 74.0f });
+    test_equal("mat4 multiply vectors (1)", mat4_multiply_vectors_products[1], vec4 { 112.0f, 124.0f, 136.0f, 148.0f });
+    test_equal("mat4 multiply vectors (2)", mat4_multiply_vectors_products[2], vec4 { 168.0f, 186.0f, 204.0f, 222.0f });
+
+    multiply(mat4_test, mat4_multiply_vectors.data(), mat4_multiply_vectors.data(), 3);
+    test_equal("mat4 multiply vectors inplace (0)", mat4_multiply_vectors[0], mat4_multiply_vectors_products[0]);
+    test_equal("mat4 multiply vectors inplace (2)", mat4_multiply_vectors[2], mat4_multiply_vectors_products[2]);
+
     test_equal("mat3 multiply scalar", mat3_test * 10.0f, mat3
     {
       0.0f, 10.0f, 20.0f,
@@ -358,6 +369,11 @@ namespace ludo
       }
     );
 
+    auto mat4_general = mat4 { 2.0f, 1.0f, 0.0f, 0.0f, 0.0f, 3.0f, 1.0f, 0.0f, 1.0f, 0.0f, 4.0f, 0.0f, 5.0f, 6.0f, 7.0f, 1.0f };
+    auto mat4_general_inverse = mat4_general;
+    invert(mat4_general_inverse);
+    test_near("mat4 invert (multiplied by the original)", mat4_general * mat4_general_inverse, mat4_identity);
+
     auto mat3_transpose = mat3_test;
     transpose(mat3_transpose);
     test_equal("mat3 transpose", mat3_transpose, mat3
@@ -133,9 +133,10 @@ namespace ludo
 
     test_near("dot", dot(quat_identity, quat_x20deg), 0.9848f);
 
-    // TODO test negative dot path in code
     test_near("slerp (0)", slerp(quat_identity, quat_x20deg, 0.0f), quat_identity);
     test_near("slerp (0.5)", slerp(quat_identity, quat_x20deg, 0.5f), quat_x10deg);
     test_near("slerp (1)", slerp(quat_identity, quat_x20deg, 1.0f), quat_x20deg);
+    test_near("slerp (negative dot)", slerp(quat_identity, quat_x20deg * -1.0f, 0.5f), quat_x10deg);
+    test_near("slerp (near)", slerp(quat_x10deg, quat_x10deg, 0.5f), quat_x10deg);
   }
 }
@@ -0,0 +1,126 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include <ludo/meshes.h>
+#include <ludo/testing.h>
+
+#include "meshes.h"
+
+namespace ludo
+{
+  mesh test_mesh(heap& indices, heap& vertices, uint32_t index_count, uint32_t vertex_count, float offset);
+  bool test_equal_data(const mesh& a, const mesh& b);
+
+  void test_meshes()
+  {
+    test_group("meshes");
+
+    auto indices = allocate_heap(1024);
+    auto vertices = allocate_heap(1024);
+
+    auto meshes = std::array<mesh, 2>
+    {
+      test_mesh(indices, vertices, 3, 3, 0.0f),
+      test_mesh(indices, vertices, 6, 4, 10.0f)
+    };
+
+    auto stream = std::stringstream();
+    save(meshes, vertex_format_p, stream);
+
+    auto counts = mesh_counts(stream);
+    test_equal("meshes: mesh_counts (all sections, indices)", counts.first, uint32_t(9));
+    test_equal("meshes: mesh_counts (all sections, vertices)", counts.second, uint32_t(7));
+
+    stream.seekg(0);
+    auto loaded_mesh = load(stream, indices, vertices);
+    test_equal("meshes: load (stream, first section)", test_equal_data(loaded_mesh, meshes[0]), true);
+    de_init(loaded_mesh, indices, vertices);
+
+    auto file_name = (std::filesystem::temp_directory_path() / "ludo-test-meshes.lmesh").string();
+    save(meshes, vertex_format_p, file_name);
+
+    auto sections = mesh_sections(file_name);
+    test_equal("meshes: mesh_sections (count)", sections.size(), std::size_t(2));
+    test_equal("meshes: mesh_sections (index count)", sections[1].index_count, uint32_t(6));
+    test_equal("meshes: mesh_sections (vertex count)", sections[1].vertex_count, uint32_t(4));
+    test_equal("meshes: mesh_sections (alignment)", (sections[0].index_offset | sections[0].vertex_offset | sections[1].index_offset | sections[1].vertex_offset) % 16, uint64_t(0));
+    test_equal("meshes: mesh_sections (bounds min)", sections[1].min, vec3 { 10.0f, 10.0f, 10.0f });
+    test_equal("meshes: mesh_sections (bounds max)", sections[1].max, vec3 { 13.0f, 13.0f, 13.0f });
+
+    auto loaded_meshes = load_sections(file_name, indices, vertices);
+    test_equal("meshes: load_sections (count)", loaded_meshes.size(), std::size_t(2));
+    test_equal("meshes: load_sections (first section)", test_equal_data(loaded_meshes[0], meshes[0]), true);
+    test_equal("meshes: load_sections (second section)", test_equal_data(loaded_meshes[1], meshes[1]), true);
+    de_init(loaded_meshes[0], indices, vertices);
+    de_init(loaded_meshes[1], indices, vertices);
+
+    loaded_mesh = load(file_name, indices, vertices);
+    test_equal("meshes: load (file, first section)", test_equal_data(loaded_mesh, meshes[0]), true);
+    de_init(loaded_mesh, indices, vertices);
+
+    // Files written before the header was introduced.
+    {
+      auto legacy_stream = std::ofstream(file_name, std::ios::binary);
+      legacy_stream.write(reinterpret_cast<const char*>(&meshes[1].index_buffer.size), sizeof(uint64_t));
+      legacy_stream.write(reinterpret_cast<const char*>(meshes[1].index_buffer.data), static_cast<int64_t>(meshes[1].index_buffer.size));
+      legacy_stream.write(reinterpret_cast<const char*>(&meshes[1].vertex_size), sizeof(uint32_t));
+      legacy_stream.write(reinterpret_cast<const char*>(&meshes[1].vertex_buffer.size), sizeof(uint64_t));
+      legacy_stream.write(reinterpret_cast<const char*>(meshes[1].vertex_buffer.data), static_cast<int64_t>(meshes[1].vertex_buffer.size));
+    }
+
+    counts = mesh_counts(file_name);
+    test_equal("meshes: mesh_counts (legacy, indices)", counts.first, uint32_t(6));
+    test_equal("meshes: mesh_counts (legacy, vertices)", counts.second, uint32_t(4));
+
+    auto legacy_sections = mesh_sections(file_name);
+    test_equal("meshes: mesh_sections (legacy, count)", legacy_sections.size(), std::size_t(1));
+    test_equal("meshes: mesh_sections (legacy, index count)", legacy_sections[0].index_count, uint32_t(6));
+    test_equal("meshes: mesh_sections (legacy, vertex count)", legacy_sections[0].vertex_count, uint32_t(4));
+    test_equal("meshes: mesh_sections (legacy, vertex offset)", legacy_sections[0].vertex_offset, uint64_t(8 + 24 + 4 + 8));
+
+    loaded_mesh = load(file_name, indices, vertices);
+    test_equal("meshes: load (legacy)", test_equal_data(loaded_mesh, meshes[1]), true);
+    de_init(loaded_mesh, indices, vertices);
+
+    std::filesystem::remove(file_name);
+
+    de_init(meshes[0], indices, vertices);
+    de_init(meshes[1], indices, vertices);
+    deallocate(indices);
+    deallocate(vertices);
+  }
+
+  mesh test_mesh(heap& indices, heap& vertices, uint32_t index_count, uint32_t vertex_count, float offset)
+  {
+    auto mesh = ludo::mesh();
+    init(mesh, indices, vertices, index_count, vertex_count, vertex_format_p.size);
+
+    for (auto index = uint32_t(0); index < index_count; index++)
+    {
+      cast<uint32_t>(mesh.index_buffer, index * sizeof(uint32_t)) = index % vertex_count;
+    }
+
+    for (auto index = uint32_t(0); index < vertex_count; index++)
+    {
+      auto value = offset + static_cast<float>(index);
+      cast<vec3>(mesh.vertex_buffer, index * vertex_format_p.size) = { value, value, value };
+    }
+
+    return mesh;
+  }
+
+  bool test_equal_data(const mesh& a, const mesh& b)
+  {
+    return a.vertex_size == b.vertex_size &&
+      a.index_buffer.size == b.index_buffer.size &&
+      a.vertex_buffer.size == b.vertex_buffer.size &&
+      std::memcmp(a.index_buffer.data, b.index_buffer.data, a.index_buffer.size) == 0 &&
+      std::memcmp(a.vertex_buffer.data, b.vertex_buffer.data, a.vertex_buffer.size) == 0;
+  }
+}
@@ -0,0 +1,13 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#ifndef LUDO_TESTS_MESHES_H_
+#define LUDO_TESTS_MESHES_H_
+
+namespace ludo
+{
+  void test_meshes();
+}
+
+#endif /* LUDO_TESTS_MESHES_H_ */
@@ -0,0 +1,123 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <cstring>
+#include <random>
+
+#include <ludo/meshes/shapes.h>
+#include <ludo/meshes/simplify.h>
+#include <ludo/testing.h>
+
+#include "simplify.h"
+
+namespace ludo
+{
+  void test_meshes_simplify_triangles(const mesh& mesh, const vertex_format& format, uint32_t& count, float& area);
+
+  void test_meshes_simplify()
+  {
+    test_group("meshes/simplify");
+
+    auto grid_options = shape_options { .divisions = 8 };
+    auto [ grid_index_count, grid_vertex_count ] = rectangle_counts(vertex_format_p, grid_options);
+
+    for (auto quadrics : { true, false })
+    {
+      auto name = std::string("meshes/simplify: ") + (quadrics ? "quadrics" : "curvature");
+
+      auto grid = mesh();
+      grid.index_buffer = allocate(grid_index_count * sizeof(uint32_t));
+      grid.vertex_buffer = allocate(grid_vertex_count * vertex_format_p.size);
+      rectangle(grid, vertex_format_p, 0, 0, grid_options);
+
+      // A flat grid can be simplified to very few triangles without changing its shape
+      auto remaining = simplify(grid, vertex_format_p, { .max_error = 0.000001f, .quadrics = quadrics });
+
+      auto count = uint32_t(0);
+      auto area = 0.0f;
+      test_meshes_simplify_triangles(grid, vertex_format_p, count, area);
+      test_equal(name + " (flat grid remaining)", remaining, count);
+      test_equal(name + " (flat grid simplified)", remaining < grid_index_count / 3, true);
+      if (quadrics)
+      {
+        test_near(name + " (flat grid area)", area, 1.0f);
+      }
+
+      deallocate(grid.index_buffer);
+      deallocate(grid.vertex_buffer);
+    }
+
+    auto sphere_options = shape_options { .divisions = 3 };
+    auto [ sphere_index_count, sphere_vertex_count ] = sphere_ico_counts(vertex_format_pn, sphere_options);
+    auto sphere = mesh();
+    sphere.index_buffer = allocate(sphere_index_count * sizeof(uint32_t));
+    sphere.vertex_buffer = allocate(sphere_vertex_count * vertex_format_pn.size);
+    sphere_ico(sphere, vertex_format_pn, 0, 0, sphere_options);
+
+    // Each collapse on a closed surface removes exactly two triangles
+    auto remaining = simplify(sphere, vertex_format_pn, { .target_triangle_count = sphere_index_count / 12 });
+    auto count = uint32_t(0);
+    auto area = 0.0f;
+    test_meshes_simplify_triangles(sphere, vertex_format_pn, count, area);
+    test_equal("meshes/simplify: target triangle count (remaining)", remaining, sphere_index_count / 12);
+    test_equal("meshes/simplify: target triangle count (triangles)", count, remaining);
+
+    auto unchanged = simplify(sphere, vertex_format_pn, { .max_error = 0.0f });
+    test_equal("meshes/simplify: max error (remaining)", unchanged, remaining);
+
+    deallocate(sphere.index_buffer);
+    deallocate(sphere.vertex_buffer);
+
+    // Non-manifold fans where a node is collapsed into a node that has itself been collapsed since it was chosen as the target
+    auto fan_indices = std::array<uint32_t, 12> { 0, 1, 2, 0, 3, 4, 3, 5, 4, 1, 6, 2 };
+    auto random = std::mt19937(1);
+    auto distribution = std::uniform_real_distribution<float>(-1.0f, 1.0f);
+    auto fan_remaining_matches = true;
+    for (auto trial = 0; trial < 100; trial++)
+    {
+      auto fan = mesh();
+      fan.index_buffer = allocate(fan_indices.size() * sizeof(uint32_t));
+      fan.vertex_buffer = allocate(7 * vertex_format_p.size);
+      std::memcpy(fan.index_buffer.data, fan_indices.data(), fan.index_buffer.size);
+      for (auto vertex_index = uint32_t(0); vertex_index < 7; vertex_index++)
+      {
+        auto x = distribution(random);
+        auto y = distribution(random);
+        auto z = distribution(random) * 0.1f;
+        cast<vec3>(fan.vertex_buffer, vertex_index * vertex_format_p.size) = vec3 { x, y, z };
+      }
+
+      auto fan_remaining = simplify(fan, vertex_format_p, {});
+      auto fan_count = uint32_t(0);
+      auto fan_area = 0.0f;
+      test_meshes_simplify_triangles(fan, vertex_format_p, fan_count, fan_area);
+      fan_remaining_matches = fan_remaining_matches && fan_count == fan_remaining;
+
+      deallocate(fan.index_buffer);
+      deallocate(fan.vertex_buffer);
+    }
+
+    test_equal("meshes/simplify: stale targets (remaining)", fan_remaining_matches, true);
+  }
+
+  void test_meshes_simplify_triangles(const mesh& mesh, const vertex_format& format, uint32_t& count, float& area)
+  {
+    auto index_stream = stream(mesh.index_buffer);
+    while (!ended(index_stream))
+    {
+      auto positions = std::array<vec3, 3>
+      {
+        cast<vec3>(mesh.vertex_buffer, read<uint32_t>(index_stream) * format.size + format.position_offset),
+        cast<vec3>(mesh.vertex_buffer, read<uint32_t>(index_stream) * format.size + format.position_offset),
+        cast<vec3>(mesh.vertex_buffer, read<uint32_t>(index_stream) * format.size + format.position_offset)
+      };
+
+      if (positions[0] != positions[1] && positions[1] != positions[2] && positions[2] != positions[0])
+      {
+        count++;
+        area += length(cross(positions[1] - positions[0], positions[2] - positions[0])) / 2.0f;
+      }
+    }
+  }
+}
@@ -0,0 +1,13 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#ifndef LUDO_TESTS_MESHES_SIMPLIFY_H_
+#define LUDO_TESTS_MESHES_SIMPLIFY_H_
+
+namespace ludo
+{
+  void test_meshes_simplify();
+}
+
+#endif /* LUDO_TESTS_MESHES_SIMPLIFY_H_ */
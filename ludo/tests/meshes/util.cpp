@@ -0,0 +1,98 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <cstring>
+#include <limits>
+#include <random>
+
+#include <ludo/meshes/shapes.h>
+#include <ludo/meshes/util.h>
+#include <ludo/testing.h>
+
+#include "util.h"
+
+namespace ludo
+{
+  void test_meshes_util()
+  {
+    test_group("meshes/util");
+
+    auto format = vertex_format_pnc;
+    auto count = uint32_t(3000);
+
+    auto mesh_1 = mesh();
+    mesh_1.index_buffer = allocate(count * sizeof(uint32_t));
+    mesh_1.vertex_buffer = allocate(count * format.size);
+
+    auto mesh_2 = mesh();
+    mesh_2.index_buffer = allocate(count * sizeof(uint32_t));
+    mesh_2.vertex_buffer = allocate(count * format.size);
+
+    // Points on a coarse lattice jittered by up to almost the epsilon in either direction, so that copies of the same point are sometimes 'near' and sometimes not.
+    auto random = std::mt19937(123456);
+    auto lattice_distribution = std::uniform_int_distribution<int32_t>(-4, 4);
+    auto jitter_distribution = std::uniform_real_distribution<float>(-0.00008f, 0.00008f);
+    auto normal_distribution = std::uniform_int_distribution<int32_t>(0, 1);
+
+    auto welder = vertex_welder();
+    auto index_index_1 = uint32_t(0);
+    auto vertex_index_1 = uint32_t(0);
+    auto index_index_2 = uint32_t(0);
+    auto vertex_index_2 = uint32_t(0);
+    for (auto index = uint32_t(0); index < count; index++)
+    {
+      auto position = vec3
+      {
+        lattice_distribution(random) * 0.001f + jitter_distribution(random),
+        lattice_distribution(random) * 0.001f + jitter_distribution(random),
+        lattice_distribution(random) * 0.001f + jitter_distribution(random)
+      };
+      auto normal = normal_distribution(random) ? vec3_unit_y : vec3_unit_z;
+
+      write_vertex(mesh_1, format, index_index_1, vertex_index_1, position, normal, vec4_one, vec2_zero);
+      write_vertex(mesh_2, format, welder, index_index_2, vertex_index_2, position, normal, vec4_one, vec2_zero);
+    }
+
+    test_equal("meshes/util: write_vertex welder (index count)", index_index_2, index_index_1);
+    test_equal("meshes/util: write_vertex welder (vertex count)", vertex_index_2, vertex_index_1);
+    test_equal("meshes/util: write_vertex welder (indices)", std::memcmp(mesh_2.index_buffer.data, mesh_1.index_buffer.data, index_index_1 * sizeof(uint32_t)), 0);
+    test_equal("meshes/util: write_vertex welder (vertices)", std::memcmp(mesh_2.vertex_buffer.data, mesh_1.vertex_buffer.data, vertex_index_1 * format.size), 0);
+
+    auto existing_position = cast<vec3>(mesh_1.vertex_buffer, format.position_offset);
+    auto existing_normal = cast<vec3>(mesh_1.vertex_buffer, format.normal_offset);
+    test_equal("meshes/util: find (match)", find(welder, mesh_2, format, existing_position + vec3 { 0.00005f, 0.0f, 0.0f }, existing_normal, vec4_one, vec2_zero), uint32_t(0));
+    test_equal("meshes/util: find (different position)", find(welder, mesh_2, format, vec3 { 1.0f, 1.0f, 1.0f }, existing_normal, vec4_one, vec2_zero), std::numeric_limits<uint32_t>::max());
+    test_equal("meshes/util: find (different normal)", find(welder, mesh_2, format, existing_position, vec3_unit_x, vec4_one, vec2_zero), std::numeric_limits<uint32_t>::max());
+
+    welder.no_normal_check = true;
+    test_equal("meshes/util: find (no normal check)", find(welder, mesh_2, format, existing_position, vec3_unit_x, vec4_one, vec2_zero), uint32_t(0));
+
+    auto welder_2 = vertex_welder();
+    init(welder_2, mesh_2, format, vertex_index_2);
+    test_equal("meshes/util: init", welder_2.next.size(), std::size_t(vertex_index_2));
+    test_equal("meshes/util: init (find)", find(welder_2, mesh_2, format, existing_position, existing_normal, vec4_one, vec2_zero), uint32_t(0));
+
+    deallocate(mesh_1.index_buffer);
+    deallocate(mesh_1.vertex_buffer);
+    deallocate(mesh_2.index_buffer);
+    deallocate(mesh_2.vertex_buffer);
+
+    auto box_options = shape_options();
+    auto [ box_index_count, box_vertex_count ] = box_counts(vertex_format_p, box_options);
+    auto box_mesh = mesh();
+    box_mesh.index_buffer = allocate(box_index_count * sizeof(uint32_t));
+    box_mesh.vertex_buffer = allocate(box_vertex_count * vertex_format_p.size);
+    box(box_mesh, vertex_format_p, 0, 0, box_options);
+
+    auto box_max_index = uint32_t(0);
+    for (auto index = uint32_t(0); index < box_index_count; index++)
+    {
+      box_max_index = std::max(box_max_index, cast<uint32_t>(box_mesh.index_buffer, index * sizeof(uint32_t)));
+    }
+    test_equal("meshes/util: box (unique vertex count)", box_max_index + 1, uint32_t(8));
+
+    deallocate(box_mesh.index_buffer);
+    deallocate(box_mesh.vertex_buffer);
+  }
+}
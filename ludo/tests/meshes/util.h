@@ -0,0 +1,13 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#ifndef LUDO_TESTS_MESHES_UTIL_H_
+#define LUDO_TESTS_MESHES_UTIL_H_
+
+namespace ludo
+{
+  void test_meshes_util();
+}
+
+#endif /* LUDO_TESTS_MESHES_UTIL_H_ */
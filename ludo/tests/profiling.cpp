@@ -0,0 +1,108 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <algorithm>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <ludo/profiling.h>
+#include <ludo/testing.h>
+
+#include "profiling.h"
+
+namespace ludo
+{
+  const profile_summary* find_summary(const std::vector<profile_summary>& summaries, const std::string& name);
+
+  void test_profiling()
+  {
+    test_group("profiling");
+
+    clear_profile();
+    test_equal("profiling: clear", profile_summaries().empty(), true);
+
+    for (auto frame = 0; frame < 10; frame++)
+    {
+      {
+        auto outer = profile_zone("test/outer");
+        for (auto call = 0; call < 3; call++)
+        {
+          auto inner = profile_zone("test/inner");
+        }
+      }
+
+      auto thread = std::thread([]()
+      {
+        auto zone = profile_zone("test/\"thread\"");
+      });
+
+      thread.join();
+      profile_frame();
+    }
+
+    auto summaries = profile_summaries();
+    test_equal("profiling: summaries (count)", summaries.size(), std::size_t(3));
+
+    auto outer = find_summary(summaries, "test/outer");
+    auto inner = find_summary(summaries, "test/inner");
+    auto thread = find_summary(summaries, "test/\"thread\"");
+    test_not_equal<const profile_summary*>("profiling: summaries (outer)", outer, nullptr);
+    test_not_equal<const profile_summary*>("profiling: summaries (inner)", inner, nullptr);
+    test_not_equal<const profile_summary*>("profiling: summaries (thread)", thread, nullptr);
+
+    if (outer && inner && thread)
+    {
+      test_equal("profiling: summaries (frames)", outer->frames, 10u);
+      test_equal("profiling: summaries (calls)", inner->calls, 3.0f);
+      test_equal("profiling: summaries (thread calls)", thread->calls, 1.0f);
+      test_equal("profiling: summaries (ordered)", outer->min <= outer->average && outer->average <= outer->max && outer->p99 <= outer->max, true);
+      test_equal("profiling: summaries (nested)", inner->average <= outer->average, true);
+    }
+
+    auto long_name = std::string(100, 'a');
+    {
+      auto zone = profile_zone(long_name);
+    }
+
+    profile_frame();
+    test_not_equal<const profile_summary*>("profiling: truncated name", find_summary(profile_summaries(), long_name.substr(0, profile_name_capacity - 1)), nullptr);
+
+    auto trace = std::stringstream();
+    write_profile_trace(trace);
+    auto trace_string = trace.str();
+    test_equal("profiling: trace (begin)", trace_string.starts_with("{\"traceEvents\":["), true);
+    auto trace_event_count = uint32_t(0);
+    for (auto position = trace_string.find("\"ph\":\"X\""); position != std::string::npos; position = trace_string.find("\"ph\":\"X\"", position + 1))
+    {
+      trace_event_count++;
+    }
+
+    test_equal("profiling: trace (events)", trace_event_count, 51u);
+    test_equal("profiling: trace (escaped)", trace_string.find("\"name\":\"test/\\\"thread\\\"\"") != std::string::npos, true);
+
+    // Each thread exited before the next started, so they all recorded into the same (reused) thread.
+    auto thread_tids = std::vector<std::string>();
+    for (auto position = trace_string.find("\"name\":\"test/\\\"thread\\\"\""); position != std::string::npos; position = trace_string.find("\"name\":\"test/\\\"thread\\\"\"", position + 1))
+    {
+      auto tid_position = trace_string.find("\"tid\":", position) + 6;
+      thread_tids.emplace_back(trace_string.substr(tid_position, trace_string.find(',', tid_position) - tid_position));
+    }
+
+    test_equal("profiling: trace (thread events)", thread_tids.size(), std::size_t(10));
+    test_equal("profiling: trace (reused thread)", std::all_of(thread_tids.begin(), thread_tids.end(), [&thread_tids](const std::string& tid) { return tid == thread_tids[0]; }), true);
+
+    clear_profile();
+  }
+
+  const profile_summary* find_summary(const std::vector<profile_summary>& summaries, const std::string& name)
+  {
+    auto iter = std::find_if(summaries.begin(), summaries.end(), [&name](const profile_summary& summary)
+    {
+      return summary.name == name;
+    });
+
+    return iter != summaries.end() ? &*iter : nullptr;
+  }
+}
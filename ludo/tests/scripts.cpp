@@ -0,0 +1,180 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ludo/data/data.h>
+#include <ludo/scripts.h>
+#include <ludo/testing.h>
+#include <ludo/thread_pool.h>
+
+#include "scripts.h"
+
+namespace ludo
+{
+  struct test_script_data_a {};
+  struct test_script_data_b {};
+
+  void test_scripts()
+  {
+    test_group("scripts");
+
+    auto a = type_indices<test_script_data_a>();
+    auto b = type_indices<test_script_data_b>();
+
+    test_equal("scripts: conflicts (undeclared)", conflicts(script(), script { .reads = a }), true);
+    test_equal("scripts: conflicts (read/read)", conflicts(script { .reads = a }, script { .reads = a }), false);
+    test_equal("scripts: conflicts (read/write)", conflicts(script { .reads = a }, script { .writes = a }), true);
+    test_equal("scripts: conflicts (write/read)", conflicts(script { .writes = a }, script { .reads = a }), true);
+    test_equal("scripts: conflicts (write/write)", conflicts(script { .writes = a }, script { .writes = a }), true);
+    test_equal("scripts: conflicts (mixed)", conflicts(script { .reads = b, .writes = a }, script { .writes = b }), true);
+    test_equal("scripts: conflicts (unrelated)", conflicts(script { .writes = a }, script { .writes = b }), false);
+
+    auto a_0 = partition_accesses<test_script_data_a>("partition-0");
+    auto a_1 = partition_accesses<test_script_data_a>("partition-1");
+
+    test_equal("scripts: conflicts (partition read/read)", conflicts(script { .partition_reads = a_0 }, script { .partition_reads = a_0 }), false);
+    test_equal("scripts: conflicts (partition write/read)", conflicts(script { .partition_writes = a_0 }, script { .partition_reads = a_0 }), true);
+    test_equal("scripts: conflicts (partition write/write)", conflicts(script { .partition_writes = a_0 }, script { .partition_writes = a_0 }), true);
+    test_equal("scripts: conflicts (different partitions)", conflicts(script { .partition_writes = a_0 }, script { .partition_writes = a_1 }), false);
+    test_equal("scripts: conflicts (type write/partition read)", conflicts(script { .writes = a }, script { .partition_reads = a_1 }), true);
+    test_equal("scripts: conflicts (partition write/type read)", conflicts(script { .partition_writes = a_0 }, script { .reads = a }), true);
+    test_equal("scripts: conflicts (type read/partition read)", conflicts(script { .reads = a }, script { .partition_reads = a_0 }), false);
+    test_equal("scripts: conflicts (partition/unrelated type)", conflicts(script { .partition_writes = a_0 }, script { .writes = b }), false);
+
+    auto inst = instance();
+    allocate<script>(inst, 6);
+
+    auto order = std::vector<uint32_t>();
+    auto reads = std::atomic<uint32_t>(0);
+    auto reads_before_exclusive = uint32_t(0);
+
+    add(inst, script { .function = [&](instance&) { order.push_back(1); }, .writes = a });
+    add(inst, script { .function = [&](instance&) { reads++; }, .reads = b });
+    add(inst, script { .function = [&](instance&) { order.push_back(2); }, .writes = a });
+    add(inst, script { .function = [&](instance&) { reads++; }, .reads = b });
+    add(inst, script { .function = [&](instance&) { reads_before_exclusive = reads; order.push_back(3); } });
+    add(inst, script { .function = [&](instance&) { order.push_back(4); }, .reads = a });
+
+    frame(inst);
+    test_equal("scripts: frame (order)", order == std::vector<uint32_t> { 1, 2, 3, 4 }, true);
+    test_equal("scripts: frame (exclusive)", reads_before_exclusive, 2u);
+
+    thread_pool_start(4);
+
+    for (auto iteration = 0; iteration < 100; iteration++)
+    {
+      order.clear();
+      reads = 0;
+      reads_before_exclusive = 0;
+
+      frame(inst);
+    }
+
+    test_equal("scripts: concurrent frame (order)", order == std::vector<uint32_t> { 1, 2, 3, 4 }, true);
+    test_equal("scripts: concurrent frame (exclusive)", reads_before_exclusive, 2u);
+    test_equal("scripts: concurrent frame (reads)", reads.load(), 2u);
+
+    thread_pool_stop();
+
+    deallocate<script>(inst);
+
+    auto partition_inst = instance();
+    allocate<script>(partition_inst, 2);
+
+    // Each script waits (for a while) for the other to start, which they only can if they are executed concurrently.
+    auto started = std::atomic<uint32_t>(0);
+    auto overlapped = std::atomic<uint32_t>(0);
+    auto rendezvous = [&](instance&)
+    {
+      started++;
+
+      auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+      while (started < 2 && std::chrono::steady_clock::now() < deadline)
+      {
+        std::this_thread::yield();
+      }
+
+      if (started == 2)
+      {
+        overlapped++;
+      }
+    };
+
+    add(partition_inst, script { .function = rendezvous, .partition_writes = a_0 });
+    add(partition_inst, script { .function = rendezvous, .partition_writes = a_1 });
+
+    thread_pool_start(4);
+
+    frame(partition_inst);
+    test_equal("scripts: concurrent frame (different partitions)", overlapped.load(), 2u);
+
+    thread_pool_stop();
+
+    deallocate<script>(partition_inst);
+
+    auto function_inst = instance();
+    allocate<script>(function_inst, 1);
+
+    auto function_calls = uint32_t(0);
+    auto function_script = add<script>(function_inst, [&](instance&) { function_calls++; });
+    test_equal("scripts: add function (name)", function_script->name, std::string("ludo::script"));
+
+    frame(function_inst);
+    test_equal("scripts: add function (executed)", function_calls, 1u);
+
+    deallocate<script>(function_inst);
+
+    auto changing_inst = instance();
+    allocate<script>(changing_inst, 3);
+
+    auto executed = std::vector<uint32_t>();
+    add(changing_inst, script { .function = [&](instance& inst)
+    {
+      executed.push_back(1);
+      if (data<script>(inst).length == 3)
+      {
+        remove(inst, &data<script>(inst)[1], "default");
+      }
+    }, .writes = type_indices<script, test_script_data_a>() });
+    add(changing_inst, script { .function = [&](instance&) { executed.push_back(2); }, .writes = a });
+    add(changing_inst, script { .function = [&](instance&) { executed.push_back(3); }, .writes = a });
+
+    thread_pool_start(4);
+
+    frame(changing_inst);
+    test_equal("scripts: frame (removed during frame)", executed == std::vector<uint32_t> { 1, 2, 3 }, true);
+
+    executed.clear();
+    frame(changing_inst);
+    test_equal("scripts: frame (removed after frame)", executed == std::vector<uint32_t> { 1, 3 }, true);
+
+    auto& changing_scripts = data<script>(changing_inst, "default");
+    remove(changing_inst, changing_scripts.begin(), "default");
+    add(changing_inst, script { .function = [&](instance& inst)
+    {
+      executed.push_back(4);
+      if (data<script>(inst).length == 2)
+      {
+        add(inst, script { .function = [&](instance&) { executed.push_back(5); } });
+      }
+    } });
+
+    executed.clear();
+    frame(changing_inst);
+    test_equal("scripts: frame (added during frame)", executed == std::vector<uint32_t> { 3, 4 }, true);
+
+    executed.clear();
+    frame(changing_inst);
+    test_equal("scripts: frame (added after frame)", executed == std::vector<uint32_t> { 3, 4, 5 }, true);
+
+    thread_pool_stop();
+
+    deallocate<script>(changing_inst);
+  }
+}
@@ -68,5 +68,74 @@ namespace ludo
       return intersect(bounds_3, bounds) ? 0 : -1;
     });
     test_equal("grid2: find 2", meshes_4.size(), std::size_t(0));
+
+    auto results_1 = std::array<uint64_t, 4>();
+    auto count_1 = find(grid_1, [&](const aabb2& bounds)
+    {
+      return intersect(bounds_2, bounds) ? 0 : -1;
+    }, results_1);
+    test_equal("grid2: find span", count_1, uint32_t(1));
+    test_equal("grid2: find span (render mesh id)", results_1[0], uint64_t(1));
+
+    auto count_2 = find(grid_1, [&](const aabb2&)
+    {
+      return 0;
+    }, std::span<uint64_t>());
+    test_equal("grid2: find span (empty)", count_2, uint32_t(1));
+
+    auto render_mesh_ids_1 = std::vector<uint64_t>();
+    find_each(grid_1, [&](const aabb2& bounds)
+    {
+      return intersect(bounds_3, bounds) ? 0 : -1;
+    }, [&](uint64_t render_mesh_id)
+    {
+      render_mesh_ids_1.push_back(render_mesh_id);
+    });
+    test_equal("grid2: find each", render_mesh_ids_1.size(), std::size_t(0));
+
+    // The header, the render mesh count of each cell and 40 bytes per render mesh
+    auto header_size = uint64_t(3 * 8);
+    auto cell_size = uint64_t(8 + 16 * 40);
+
+    auto grid_2 = grid2 { .bounds = bounds_1, .cell_count_1d = 4 };
+    init(grid_2);
+
+    commit(grid_2);
+    test_equal("grid2: commit (initial bytes copied)", grid_2.commit_size, header_size + 16 * 8);
+
+    commit(grid_2);
+    test_equal("grid2: commit (unchanged bytes copied)", grid_2.commit_size, header_size);
+
+    auto position_2 = vec2 { -0.75f, -0.75f };
+    auto position_3 = vec2 { 0.75f, 0.75f };
+    auto render_mesh_3 = render_mesh { .id = 3 };
+    auto render_mesh_4 = render_mesh { .id = 4 };
+    auto render_mesh_5 = render_mesh { .id = 5 };
+    add(grid_2, render_mesh_3, position_2);
+    add(grid_2, render_mesh_4, position_2);
+    add(grid_2, render_mesh_5, position_3);
+    commit(grid_2);
+    test_equal("grid2: commit (added bytes copied)", grid_2.commit_size, header_size + (8 + 2 * 40) + (8 + 40));
+    test_equal("grid2: commit (front render mesh count)", cast<uint32_t>(grid_2.buffer.front, header_size), uint32_t(2));
+    test_equal("grid2: commit (front render mesh count)", cast<uint32_t>(grid_2.buffer.front, header_size + 15 * cell_size), uint32_t(1));
+    test_equal("grid2: commit (front render mesh id)", cast<uint64_t>(grid_2.buffer.front, header_size + 15 * cell_size + 8), uint64_t(5));
+
+    // Many swaps within a frame are coalesced into a single copy of the cell
+    for (auto swap_index = 0; swap_index < 10; swap_index++)
+    {
+      remove(grid_2, render_mesh_3, position_2);
+      add(grid_2, render_mesh_3, position_2);
+    }
+    commit(grid_2);
+    test_equal("grid2: commit (swapped bytes copied)", grid_2.commit_size, header_size + (8 + 2 * 40));
+    test_equal("grid2: commit (front render mesh id)", cast<uint64_t>(grid_2.buffer.front, header_size + 8), uint64_t(4));
+    test_equal("grid2: commit (front render mesh id)", cast<uint64_t>(grid_2.buffer.front, header_size + 8 + 40), uint64_t(3));
+
+    remove(grid_2, render_mesh_5, position_3);
+    commit(grid_2);
+    test_equal("grid2: commit (removed bytes copied)", grid_2.commit_size, header_size + 8);
+    test_equal("grid2: commit (front render mesh count)", cast<uint32_t>(grid_2.buffer.front, header_size + 15 * cell_size), uint32_t(0));
+
+    de_init(grid_2);
   }
 }
@@ -5,6 +5,7 @@
 #include <ludo/rendering.h>
 #include <ludo/spatial/grid3.h>
 #include <ludo/testing.h>
+#include <ludo/thread_pool.h>
 
 #include "grid3.h"
 
@@ -69,5 +70,182 @@ namespace ludo
       return intersect(bounds_3, bounds) ? 0 : -1;
     });
     test_equal("grid3: find 2", meshes_4.size(), std::size_t(0));
+
+    auto results_1 = std::array<uint64_t, 4>();
+    auto count_1 = find(grid_1, [&](const aabb3& bounds)
+    {
+      return intersect(bounds_2, bounds) ? 0 : -1;
+    }, results_1);
+    test_equal("grid3: find span", count_1, uint32_t(1));
+    test_equal("grid3: find span (render mesh id)", results_1[0], uint64_t(1));
+
+    auto count_2 = find(grid_1, [&](const aabb3&)
+    {
+      return 0;
+    }, std::span<uint64_t>());
+    test_equal("grid3: find span (empty)", count_2, uint32_t(1));
+
+    auto render_mesh_ids_1 = std::vector<uint64_t>();
+    find_each(grid_1, [&](const aabb3& bounds)
+    {
+      return intersect(bounds_3, bounds) ? 0 : -1;
+    }, [&](uint64_t render_mesh_id)
+    {
+      render_mesh_ids_1.push_back(render_mesh_id);
+    });
+    test_equal("grid3: find each", render_mesh_ids_1.size(), std::size_t(0));
+
+    // The header, the render mesh count of each cell and 40 bytes per render mesh
+    auto header_size = uint64_t(3 * 16);
+    auto cell_size = uint64_t(8 + 16 * 40);
+
+    auto grid_2 = grid3 { .bounds = bounds_1, .cell_count_1d = 4 };
+    init(grid_2);
+
+    commit(grid_2);
+    test_equal("grid3: commit (initial bytes copied)", grid_2.commit_size, header_size + 64 * 8);
+
+    commit(grid_2);
+    test_equal("grid3: commit (unchanged bytes copied)", grid_2.commit_size, header_size);
+
+    auto position_2 = vec3 { -0.75f, -0.75f, -0.75f };
+    auto position_3 = vec3 { 0.75f, 0.75f, 0.75f };
+    auto render_mesh_3 = render_mesh { .id = 3 };
+    auto render_mesh_4 = render_mesh { .id = 4 };
+    auto render_mesh_5 = render_mesh { .id = 5 };
+    add(grid_2, render_mesh_3, position_2);
+    add(grid_2, render_mesh_4, position_2);
+    add(grid_2, render_mesh_5, position_3);
+    commit(grid_2);
+    test_equal("grid3: commit (added bytes copied)", grid_2.commit_size, header_size + (8 + 2 * 40) + (8 + 40));
+    test_equal("grid3: commit (front render mesh count)", cast<uint32_t>(grid_2.buffer.front, header_size), uint32_t(2));
+    test_equal("grid3: commit (front render mesh count)", cast<uint32_t>(grid_2.buffer.front, header_size + 63 * cell_size), uint32_t(1));
+    test_equal("grid3: commit (front render mesh id)", cast<uint64_t>(grid_2.buffer.front, header_size + 63 * cell_size + 8), uint64_t(5));
+
+    // Many swaps within a frame are coalesced into a single copy of the cell
+    for (auto swap_index = 0; swap_index < 10; swap_index++)
+    {
+      remove(grid_2, render_mesh_3, position_2);
+      add(grid_2, render_mesh_3, position_2);
+    }
+    commit(grid_2);
+    test_equal("grid3: commit (swapped bytes copied)", grid_2.commit_size, header_size + (8 + 2 * 40));
+    test_equal("grid3: commit (front render mesh id)", cast<uint64_t>(grid_2.buffer.front, header_size + 8), uint64_t(4));
+    test_equal("grid3: commit (front render mesh id)", cast<uint64_t>(grid_2.buffer.front, header_size + 8 + 40), uint64_t(3));
+
+    remove(grid_2, render_mesh_5, position_3);
+    commit(grid_2);
+    test_equal("grid3: commit (removed bytes copied)", grid_2.commit_size, header_size + 8);
+    test_equal("grid3: commit (front render mesh count)", cast<uint32_t>(grid_2.buffer.front, header_size + 63 * cell_size), uint32_t(0));
+
+    de_init(grid_2);
+
+    // Looking down the negative z axis from the origin, with cells 8 units wide
+    auto grid_3 = grid3 { .bounds = { .min = { -32.0f, -32.0f, -32.0f }, .max = { 32.0f, 32.0f, 32.0f } }, .cell_count_1d = 8 };
+    init(grid_3);
+
+    auto render_program_1 = render_program { .id = 1, .command_buffer = allocate(8 * sizeof(render_command)) };
+    auto render_programs = allocate_array<render_program>(1);
+    add(render_programs, render_program_1);
+
+    auto render_mesh_6 = render_mesh { .id = 6, .render_program_id = 1, .instances = { 1, 2 }, .indices = { 3, 4 }, .vertices = { 5, 6 } }; // In front
+    auto render_mesh_7 = render_mesh { .id = 7, .render_program_id = 1 }; // Behind
+    auto render_mesh_8 = render_mesh { .id = 8, .render_program_id = 1 }; // Beyond the far clipping plane
+    auto render_mesh_9 = render_mesh { .id = 9, .render_program_id = 2 }; // In front, but without a render program
+    auto render_mesh_10 = render_mesh { .id = 10, .render_program_id = 1, .indices = { 0, 7 } }; // In front, in a neighbouring cell
+    add(grid_3, render_mesh_6, { 1.0f, 1.0f, -2.0f });
+    add(grid_3, render_mesh_7, { 1.0f, 1.0f, 28.0f });
+    add(grid_3, render_mesh_8, { 1.0f, 1.0f, -30.0f });
+    add(grid_3, render_mesh_9, { 1.0f, 1.0f, -2.0f });
+    add(grid_3, render_mesh_10, { 1.0f, 1.0f, -10.0f });
+
+    auto camera_1 = camera { .view = mat4_identity, .projection = perspective(90.0f, 1.0f, 0.1f, 4.0f) };
+
+    auto test_render_commands = [&](const std::string& name, const grid3& grid)
+    {
+      auto grids = allocate_array<grid3>(1);
+      add(grids, grid);
+
+      render_programs[0].active_commands = { 2, 0 };
+      add_render_commands(grids, render_programs, camera_1);
+
+      test_equal(name + " (count)", render_programs[0].active_commands.count, uint32_t(2));
+
+      auto& command_1 = cast<render_command>(render_programs[0].command_buffer, 2 * sizeof(render_command));
+      test_equal(name + " (index count)", command_1.index_count, uint32_t(7));
+
+      auto& command_2 = cast<render_command>(render_programs[0].command_buffer, 3 * sizeof(render_command));
+      test_equal(name + " (index count)", command_2.index_count, uint32_t(4));
+      test_equal(name + " (index start)", command_2.index_start, uint32_t(3));
+      test_equal(name + " (vertex start)", command_2.vertex_start, uint32_t(5));
+      test_equal(name + " (instance start)", command_2.instance_start, uint32_t(1));
+      test_equal(name + " (instance count)", command_2.instance_count, uint32_t(2));
+
+      deallocate(grids);
+    };
+
+    test_render_commands("grid3: add_render_commands (cpu)", grid_3);
+
+    thread_pool_start(4);
+    test_render_commands("grid3: add_render_commands (cpu, concurrent)", grid_3);
+    thread_pool_stop();
+
+    // The same render meshes, added all at once to a grid with a Morton layout
+    auto grid_4 = grid3 { .bounds = grid_3.bounds, .cell_count_1d = 8, .morton = true };
+    init(grid_4);
+
+    auto render_meshes_1 = std::array<render_mesh, 5> { render_mesh_6, render_mesh_7, render_mesh_8, render_mesh_9, render_mesh_10 };
+    auto positions_1 = std::array<vec3, 5>
+    {{
+      { 1.0f, 1.0f, -2.0f },
+      { 1.0f, 1.0f, 28.0f },
+      { 1.0f, 1.0f, -30.0f },
+      { 1.0f, 1.0f, -2.0f },
+      { 1.0f, 1.0f, -10.0f }
+    }};
+    add(grid_4, render_meshes_1, positions_1);
+
+    auto ids_1 = cell_render_mesh_ids(grid_4, morton_encode({ 4, 4, 3 }));
+    test_equal("grid3: add many (cell render mesh count)", ids_1.size(), std::size_t(2));
+    if (ids_1.size() == 2)
+    {
+      test_equal("grid3: add many (cell render mesh id)", ids_1[0], uint64_t(6));
+      test_equal("grid3: add many (cell render mesh id)", ids_1[1], uint64_t(9));
+    }
+
+    auto ids_2 = cell_render_mesh_ids(grid_4, morton_encode({ 4, 4, 2 }));
+    test_equal("grid3: add many (neighbouring cell render mesh count)", ids_2.size(), std::size_t(1));
+
+    auto results_2 = std::array<uint64_t, 8>();
+    auto count_3 = find(grid_4, [&](const aabb3& bounds)
+    {
+      return contains(bounds, vec3 { 1.0f, 1.0f, -10.0f }) ? 0 : -1;
+    }, results_2);
+    test_equal("grid3: find (morton)", count_3, uint32_t(1));
+    test_equal("grid3: find (morton render mesh id)", results_2[0], uint64_t(10));
+
+    commit(grid_4);
+    commit(grid_4);
+    remove(grid_4, render_mesh_9, { 1.0f, 1.0f, -2.0f });
+    commit(grid_4);
+    test_equal("grid3: commit (morton removed bytes copied)", grid_4.commit_size, header_size + (8 + 40));
+
+    test_render_commands("grid3: add_render_commands (cpu, morton)", grid_4);
+
+    de_init(grid_4);
+
+    // Positions on the max bounds belong to the last cell
+    auto grid_5 = grid3 { .bounds = grid_3.bounds, .cell_count_1d = 8 };
+    init(grid_5);
+
+    add(grid_5, render_mesh_6, grid_5.bounds.max);
+    add(grid_5, std::array<render_mesh, 1> { render_mesh_7 }, std::array<vec3, 1> { grid_5.bounds.max });
+    test_equal("grid3: add on max bounds (cell render mesh count)", cell_render_mesh_ids(grid_5, 511).size(), std::size_t(2));
+
+    de_init(grid_5);
+
+    deallocate(render_programs[0].command_buffer);
+    deallocate(render_programs);
+    de_init(grid_3);
   }
 }
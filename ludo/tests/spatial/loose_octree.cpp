@@ -0,0 +1,167 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <ludo/spatial/loose_octree.h>
+#include <ludo/testing.h>
+
+#include "loose_octree.h"
+
+namespace ludo
+{
+  void test_spatial_loose_octree()
+  {
+    test_group("loose_octree");
+
+    auto bounds_1 = aabb3 { .min = { -1.0f, -1.0f, -1.0f }, .max = { 1.0f, 1.0f, 1.0f } };
+    auto bounds_2 = aabb3 { .min = { -0.5f, -0.5f, -0.5f }, .max = { 0.5f, 0.5f, 0.5f } };
+    auto bounds_3 = aabb3 { .min = { 0.75f, 0.75f, 0.75f }, .max = { 1.0f, 1.0f, 1.0f } };
+
+    auto octree_1 = loose_octree { .bounds = bounds_1 };
+    init(octree_1);
+
+    // 17 render meshes spread across the octants of the root's first octant
+    auto render_meshes = std::vector<render_mesh>();
+    auto positions = std::vector<vec3>();
+    for (auto index = uint32_t(0); index < 17; index++)
+    {
+      render_meshes.push_back({ .id = index + 1 });
+      positions.push_back(
+      {
+        (index & 1 ? -0.25f : -0.75f) + 0.01f * static_cast<float>(index / 8),
+        (index & 2 ? -0.25f : -0.75f),
+        (index & 4 ? -0.25f : -0.75f)
+      });
+    }
+
+    for (auto index = uint32_t(0); index < 16; index++)
+    {
+      add(octree_1, render_meshes[index], positions[index]);
+    }
+    test_equal("loose_octree: add (node count)", octree_1.nodes.size(), std::size_t(1));
+    test_equal("loose_octree: add (render mesh count)", octree_1.nodes[0].count, uint32_t(16));
+
+    add(octree_1, render_meshes[16], positions[16]);
+    test_equal("loose_octree: add (split node count)", octree_1.nodes.size(), std::size_t(17));
+    test_equal("loose_octree: add (split render mesh count)", octree_1.nodes[0].count, uint32_t(17));
+    test_equal("loose_octree: add (split root render mesh count)", octree_1.nodes[0].render_meshes.size(), std::size_t(0));
+    test_equal("loose_octree: add (split child render mesh count)", octree_1.nodes[1].count, uint32_t(17));
+    test_equal("loose_octree: add (split empty child render mesh count)", octree_1.nodes[2].count, uint32_t(0));
+
+    // Too large to fit within a child, so it is held by the root
+    auto render_mesh_18 = render_mesh { .id = 18 };
+    add(octree_1, render_mesh_18, { 0.5f, 0.5f, 0.5f }, 0.75f);
+    test_equal("loose_octree: add (large render mesh count)", octree_1.nodes[0].render_meshes.size(), std::size_t(1));
+
+    auto test_count = 0;
+    auto meshes_1 = find(octree_1, [&](const aabb3&)
+    {
+      test_count++;
+      return 1;
+    });
+    test_equal("loose_octree: find (inside)", meshes_1.size(), std::size_t(18));
+    test_equal("loose_octree: find (inside test count)", test_count, 1);
+
+    auto meshes_2 = find(octree_1, [&](const aabb3& bounds)
+    {
+      return intersect(bounds_2, bounds) ? 0 : -1;
+    });
+    test_equal("loose_octree: find (intersecting)", meshes_2.size(), std::size_t(18));
+
+    auto meshes_3 = find(octree_1, [&](const aabb3& bounds)
+    {
+      return intersect(bounds_3, bounds) ? 0 : -1;
+    });
+    test_equal("loose_octree: find (intersecting large render mesh)", meshes_3.size(), std::size_t(1));
+    if (meshes_3.size() == 1)
+    {
+      test_equal("loose_octree: find (intersecting large render mesh id)", meshes_3[0], uint64_t(18));
+    }
+
+    auto results_1 = std::array<uint64_t, 4>();
+    auto count_1 = find(octree_1, [&](const aabb3& bounds)
+    {
+      return intersect(bounds_3, bounds) ? 0 : -1;
+    }, results_1);
+    test_equal("loose_octree: find span", count_1, uint32_t(1));
+    test_equal("loose_octree: find span (render mesh id)", results_1[0], uint64_t(18));
+
+    auto test_count_2 = 0;
+    auto count_2 = find(octree_1, [&](const aabb3&)
+    {
+      test_count_2++;
+      return 1;
+    }, results_1);
+    test_equal("loose_octree: find span (inside)", count_2, uint32_t(18));
+    test_equal("loose_octree: find span (inside test count)", test_count_2, 1);
+
+    remove(octree_1, render_mesh_18, { 0.5f, 0.5f, 0.5f }, 0.75f);
+    for (auto index = uint32_t(0); index < 9; index++)
+    {
+      remove(octree_1, render_meshes[index], positions[index]);
+    }
+    test_equal("loose_octree: remove (render mesh count)", octree_1.nodes[0].count, uint32_t(8));
+    test_equal("loose_octree: remove (merged)", octree_1.nodes[0].child_index, uint32_t(0));
+    test_equal("loose_octree: remove (merged render mesh count)", octree_1.nodes[0].render_meshes.size(), std::size_t(8));
+    test_equal("loose_octree: remove (free nodes)", octree_1.free_node_indices.size(), std::size_t(2));
+
+    for (auto index = uint32_t(0); index < 9; index++)
+    {
+      add(octree_1, render_meshes[index], positions[index]);
+    }
+    test_equal("loose_octree: add (re-used node count)", octree_1.nodes.size(), std::size_t(17));
+    test_equal("loose_octree: add (re-used free nodes)", octree_1.free_node_indices.size(), std::size_t(0));
+
+    auto meshes_4 = find(octree_1, [&](const aabb3&)
+    {
+      return 1;
+    });
+    test_equal("loose_octree: find (re-added)", meshes_4.size(), std::size_t(17));
+
+    de_init(octree_1);
+
+    // Looking down the negative z axis from the origin
+    auto octrees = allocate_array<loose_octree>(1);
+    auto octree_2 = add(octrees, { .bounds = { .min = { -32.0f, -32.0f, -32.0f }, .max = { 32.0f, 32.0f, 32.0f } }, .split_threshold = 1 });
+    init(*octree_2);
+
+    auto render_program_1 = render_program { .id = 1, .command_buffer = allocate(8 * sizeof(render_command)) };
+    auto render_programs = allocate_array<render_program>(1);
+    add(render_programs, render_program_1);
+
+    auto render_mesh_19 = render_mesh { .id = 19, .render_program_id = 1, .instances = { 1, 2 }, .indices = { 3, 4 }, .vertices = { 5, 6 } }; // In front
+    auto render_mesh_20 = render_mesh { .id = 20, .render_program_id = 1 }; // Behind
+    auto render_mesh_21 = render_mesh { .id = 21, .render_program_id = 1 }; // Beyond the far clipping plane
+    auto render_mesh_22 = render_mesh { .id = 22, .render_program_id = 2 }; // In front, but without a render program
+    add(*octree_2, render_mesh_19, { 1.0f, 1.0f, -2.0f }, 1.0f);
+    add(*octree_2, render_mesh_20, { 1.0f, 1.0f, 28.0f }, 1.0f);
+    add(*octree_2, render_mesh_21, { 1.0f, 1.0f, -30.0f }, 1.0f);
+    add(*octree_2, render_mesh_22, { 1.0f, 1.0f, -2.0f }, 1.0f);
+
+    auto camera_1 = camera { .view = mat4_identity, .projection = perspective(90.0f, 1.0f, 0.1f, 4.0f) };
+
+    auto planes = frustum_planes(camera_1);
+    auto meshes_5 = find(*octree_2, [&](const aabb3& bounds)
+    {
+      return frustum_test(planes, bounds);
+    });
+    test_equal("loose_octree: find (frustum)", meshes_5.size(), std::size_t(2));
+
+    render_programs[0].active_commands = { 2, 0 };
+    add_render_commands(octrees, render_programs, camera_1);
+
+    test_equal("loose_octree: add_render_commands (count)", render_programs[0].active_commands.count, uint32_t(1));
+
+    auto& command_1 = cast<render_command>(render_programs[0].command_buffer, 2 * sizeof(render_command));
+    test_equal("loose_octree: add_render_commands (index count)", command_1.index_count, uint32_t(4));
+    test_equal("loose_octree: add_render_commands (index start)", command_1.index_start, uint32_t(3));
+    test_equal("loose_octree: add_render_commands (vertex start)", command_1.vertex_start, uint32_t(5));
+    test_equal("loose_octree: add_render_commands (instance start)", command_1.instance_start, uint32_t(1));
+    test_equal("loose_octree: add_render_commands (instance count)", command_1.instance_count, uint32_t(2));
+
+    deallocate(render_programs[0].command_buffer);
+    deallocate(render_programs);
+    de_init(*octree_2);
+    deallocate(octrees);
+  }
+}
@@ -68,5 +68,88 @@ namespace ludo
       return intersect(bounds_3, bounds) ? 0 : -1;
     });
     test_equal("octree: find parallel 2", meshes_4.size(), std::size_t(0));
+
+    auto octree_2 = octree { .bounds = bounds_1, .divisions = 2 };
+    init(octree_2);
+
+    auto position_2 = vec3 { 0.625f, -0.625f, -0.875f };
+    auto position_3 = vec3 { -0.875f, 0.375f, 0.625f };
+    add(octree_2, 3, position_2);
+    add(octree_2, 4, position_3);
+
+    auto bounds_4 = aabb3 { .min = { 0.5f, -0.75f, -1.0f }, .max = { 0.75f, -0.5f, -0.75f } };
+    auto results_1 = std::array<uint32_t, 4>();
+    auto count_1 = find(octree_2, [&](const aabb3& bounds)
+    {
+      return intersect(bounds_4, bounds) ? 0 : -1;
+    }, results_1);
+    test_equal("octree: find span", count_1, uint32_t(1));
+    test_equal("octree: find span (element)", results_1[0], uint32_t(3));
+
+    auto test_count_1 = 0;
+    auto count_2 = find(octree_2, [&](const aabb3&)
+    {
+      test_count_1++;
+      return 1;
+    }, std::span<uint32_t>());
+    test_equal("octree: find span (inside)", count_2, uint32_t(2));
+    test_equal("octree: find span (inside test count)", test_count_1, 1);
+
+    auto elements_1 = std::vector<uint32_t>();
+    find_each(octree_2, [&](const aabb3& bounds)
+    {
+      return intersect(bounds_1, bounds) ? 0 : -1;
+    }, [&](uint32_t element)
+    {
+      elements_1.push_back(element);
+    });
+    test_equal("octree: find each", elements_1.size(), std::size_t(2));
+
+    de_init(octree_2);
+
+    test_equal("octree: morton encode", morton_encode({ 1, 0, 0 }), uint32_t(4));
+    test_equal("octree: morton encode 2", morton_encode({ 3, 2, 1 }), uint32_t(0b110101));
+    test_equal("octree: morton decode", morton_decode(morton_encode({ 1023, 512, 7 })) == std::array<uint32_t, 3> { 1023, 512, 7 }, true);
+
+    // The same elements, added all at once to an octree with a Morton layout
+    auto octree_3 = octree { .bounds = bounds_1, .divisions = 2, .morton = true };
+    init(octree_3);
+
+    auto elements_2 = std::array<uint32_t, 3> { 3, 4, 5 };
+    auto positions_1 = std::array<vec3, 3> { position_2, position_3, position_2 };
+    add(octree_3, elements_2, positions_1);
+
+    auto cell_elements_1 = cell_elements(octree_3, morton_encode({ 3, 0, 0 }));
+    test_equal("octree: add many (cell element count)", cell_elements_1.size(), std::size_t(2));
+    if (cell_elements_1.size() == 2)
+    {
+      test_equal("octree: add many (cell element)", cell_elements_1[0], uint32_t(3));
+      test_equal("octree: add many (cell element)", cell_elements_1[1], uint32_t(5));
+    }
+
+    // Positions on the max bounds belong to the last cell
+    auto octree_4 = octree { .bounds = bounds_1, .divisions = 2 };
+    init(octree_4);
+
+    add(octree_4, 6, bounds_1.max);
+    add(octree_4, std::array<uint32_t, 1> { 7 }, std::array<vec3, 1> { bounds_1.max });
+    test_equal("octree: add on max bounds (cell element count)", cell_elements(octree_4, 63).size(), std::size_t(2));
+
+    de_init(octree_4);
+
+    auto count_3 = find(octree_3, [&](const aabb3& bounds)
+    {
+      return intersect(bounds_4, bounds) ? 0 : -1;
+    }, results_1);
+    test_equal("octree: find (morton)", count_3, uint32_t(2));
+
+    auto count_4 = find(octree_3, [&](const aabb3& bounds)
+    {
+      return bounds.max[0] <= 0.0f ? 1 : (bounds.min[0] >= 0.0f ? -1 : 0);
+    }, results_1);
+    test_equal("octree: find (morton, inside)", count_4, uint32_t(1));
+    test_equal("octree: find (morton, inside element)", results_1[0], uint32_t(4));
+
+    de_init(octree_3);
   }
 }
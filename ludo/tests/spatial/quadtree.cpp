@@ -68,5 +68,43 @@ namespace ludo
       return intersect(bounds_3, bounds) ? 0 : -1;
     });
     test_equal("quadtree: find parallel 2", meshes_4.size(), std::size_t(0));
+
+    auto quadtree_2 = quadtree { .bounds = bounds_1, .divisions = 2 };
+    init(quadtree_2);
+
+    auto position_2 = vec2 { 0.625f, -0.875f };
+    auto position_3 = vec2 { -0.875f, 0.375f };
+    add(quadtree_2, 3, position_2);
+    add(quadtree_2, 4, position_3);
+
+    auto bounds_4 = aabb2 { .min = { 0.5f, -1.0f }, .max = { 0.75f, -0.75f } };
+    auto results_1 = std::array<uint32_t, 4>();
+    auto count_1 = find(quadtree_2, [&](const aabb2& bounds)
+    {
+      return intersect(bounds_4, bounds) ? 0 : -1;
+    }, results_1);
+    test_equal("quadtree: find span", count_1, uint32_t(1));
+    test_equal("quadtree: find span (element)", results_1[0], uint32_t(3));
+
+    auto test_count_1 = 0;
+    auto count_2 = find(quadtree_2, [&](const aabb2&)
+    {
+      test_count_1++;
+      return 1;
+    }, std::span<uint32_t>());
+    test_equal("quadtree: find span (inside)", count_2, uint32_t(2));
+    test_equal("quadtree: find span (inside test count)", test_count_1, 1);
+
+    auto elements_1 = std::vector<uint32_t>();
+    find_each(quadtree_2, [&](const aabb2& bounds)
+    {
+      return intersect(bounds_1, bounds) ? 0 : -1;
+    }, [&](uint32_t element)
+    {
+      elements_1.push_back(element);
+    });
+    test_equal("quadtree: find each", elements_1.size(), std::size_t(2));
+
+    de_init(quadtree_2);
   }
 }
@@ -2,29 +2,49 @@
 #include <ludo/spatial/grid3.h>
 #include <ludo/testing.h>
 
+#include "animation.h"
 #include "data/arrays.h"
 #include "data/buffers.h"
+#include "data/data.h"
+#include "data/heaps.h"
 #include "math/mat.h"
 #include "math/projection.h"
 #include "math/quat.h"
 #include "math/vec.h"
+#include "meshes.h"
+#include "meshes/simplify.h"
+#include "meshes/util.h"
+#include "profiling.h"
+#include "scripts.h"
 #include "spatial/grid2.h"
 #include "spatial/grid3.h"
+#include "spatial/loose_octree.h"
 #include "spatial/octree.h"
 #include "spatial/quadtree.h"
+#include "thread_pool.h"
 
 int main()
 {
+  ludo::test_animation();
   ludo::test_arrays();
   ludo::test_buffers();
+  ludo::test_data();
+  ludo::test_heaps();
   ludo::test_math_mat();
   ludo::test_math_projection();
   ludo::test_math_quat();
   ludo::test_math_vec();
+  ludo::test_meshes();
+  ludo::test_meshes_simplify();
+  ludo::test_meshes_util();
+  ludo::test_profiling();
+  ludo::test_scripts();
   ludo::test_spatial_grid2();
   ludo::test_spatial_grid3();
+  ludo::test_spatial_loose_octree();
   ludo::test_spatial_octree();
   ludo::test_spatial_quadtree();
+  ludo::test_thread_pool();
 
   return ludo::test_finalize();
 }
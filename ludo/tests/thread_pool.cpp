@@ -0,0 +1,170 @@
+/*
+ * This file is part of ludo. See the LICENSE file for the full license governing this code.
+ */
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <ludo/testing.h>
+#include <ludo/thread_pool.h>
+
+#include "thread_pool.h"
+
+namespace ludo
+{
+  void test_thread_pool()
+  {
+    test_group("thread_pool");
+
+    auto not_started_executed = false;
+    auto not_started = thread_pool_enqueue([&not_started_executed]() { not_started_executed = true; });
+    test_equal("thread_pool: enqueue before start (queued)", thread_pool_complete(not_started), false);
+    thread_pool_wait(not_started);
+    test_equal("thread_pool: enqueue before start (executed by wait)", not_started_executed, true);
+
+    // Without workers, the jobs a parallel_for (or the children of a job) depend on can only be executed by the waiting thread.
+    auto not_started_dependency_executed = false;
+    auto not_started_dependency = thread_pool_enqueue([&not_started_dependency_executed]() { not_started_dependency_executed = true; });
+    auto not_started_batch_count = uint32_t(0);
+    thread_pool_wait(thread_pool_parallel_for(10, 3, [&not_started_batch_count](uint32_t, uint32_t) { not_started_batch_count++; }, { not_started_dependency }));
+    test_equal("thread_pool: parallel_for before start (dependency executed by wait)", not_started_dependency_executed, true);
+    test_equal("thread_pool: parallel_for before start (batches executed by wait)", not_started_batch_count, 4u);
+
+    auto not_started_child_executed = false;
+    thread_pool_wait(thread_pool_enqueue([&not_started_child_executed]()
+    {
+      auto dependency = thread_pool_enqueue([]() {});
+      thread_pool_enqueue([&not_started_child_executed]() { not_started_child_executed = true; }, { dependency }, thread_pool_current());
+    }));
+    test_equal("thread_pool: child with dependencies before start (executed by wait)", not_started_child_executed, true);
+
+    // A single worker takes the jobs queued before it started one at a time, highest priority first.
+    auto priority_order = std::vector<uint32_t>();
+    auto low = thread_pool_enqueue([&priority_order]() { priority_order.push_back(2); }, {}, {}, job_priority::low);
+    auto normal = thread_pool_enqueue([&priority_order]() { priority_order.push_back(1); });
+    auto high = thread_pool_enqueue([&priority_order]() { priority_order.push_back(0); }, {}, {}, job_priority::high);
+    thread_pool_start(1);
+    while (!thread_pool_complete(low) || !thread_pool_complete(normal) || !thread_pool_complete(high))
+    {
+      std::this_thread::yield(); // Waiting on a handle would execute jobs on this thread too.
+    }
+
+    test_equal("thread_pool: priorities", priority_order == std::vector<uint32_t> { 0, 1, 2 }, true);
+    thread_pool_stop();
+
+    auto after_stop_executed = std::atomic<bool>(false);
+    auto after_stop = thread_pool_enqueue([&after_stop_executed]() { after_stop_executed = true; });
+    thread_pool_start(4);
+    thread_pool_wait(after_stop);
+    test_equal("thread_pool: enqueue after stop", after_stop_executed.load(), true);
+
+    test_equal("thread_pool: complete (empty handle)", thread_pool_complete({}), true);
+
+    auto counter = std::atomic<uint32_t>(0);
+    auto handles = std::vector<job_handle>();
+    for (auto index = 0; index < 1000; index++)
+    {
+      handles.emplace_back(thread_pool_enqueue([&counter]() { counter++; }));
+    }
+
+    for (auto& handle : handles)
+    {
+      thread_pool_wait(handle);
+    }
+
+    test_equal("thread_pool: enqueue", counter.load(), 1000u);
+
+    auto values = std::vector<uint32_t>(10000, 0);
+    auto parallel_for_handle = thread_pool_parallel_for(static_cast<uint32_t>(values.size()), 64, [&values](uint32_t start, uint32_t end)
+    {
+      for (auto index = start; index < end; index++)
+      {
+        values[index] += index;
+      }
+    });
+
+    thread_pool_wait(parallel_for_handle);
+    test_equal("thread_pool: parallel_for (complete)", thread_pool_complete(parallel_for_handle), true);
+
+    auto parallel_for_correct = true;
+    for (auto index = uint32_t(0); index < values.size(); index++)
+    {
+      parallel_for_correct &= values[index] == index;
+    }
+
+    test_equal("thread_pool: parallel_for (values)", parallel_for_correct, true);
+
+    auto order = std::vector<uint32_t>();
+    auto first = thread_pool_enqueue([&order]() { order.push_back(1); });
+    auto second = thread_pool_enqueue([&order]() { order.push_back(2); }, { first });
+    auto third = thread_pool_enqueue([&order]() { order.push_back(3); }, { second });
+    thread_pool_wait(third);
+    test_equal("thread_pool: dependencies (order)", order == std::vector<uint32_t> { 1, 2, 3 }, true);
+    test_equal("thread_pool: dependencies (complete)", thread_pool_complete(first) && thread_pool_complete(second), true);
+
+    auto children_counter = std::atomic<uint32_t>(0);
+    auto parent = thread_pool_enqueue([&children_counter]()
+    {
+      for (auto index = 0; index < 100; index++)
+      {
+        thread_pool_enqueue([&children_counter]() { children_counter++; }, {}, thread_pool_current());
+      }
+    });
+
+    auto children_complete = false;
+    auto after_parent = thread_pool_enqueue([&]() { children_complete = children_counter == 100; }, { parent });
+    thread_pool_wait(after_parent);
+    test_equal("thread_pool: children", children_complete, true);
+    test_equal("thread_pool: current (outside of a job)", thread_pool_current().job == nullptr, true);
+
+    auto nested_counter = std::atomic<uint32_t>(0);
+    auto nested = thread_pool_parallel_for(8, 1, [&nested_counter](uint32_t, uint32_t)
+    {
+      thread_pool_wait(thread_pool_parallel_for(100, 10, [&nested_counter](uint32_t start, uint32_t end)
+      {
+        nested_counter += end - start;
+      }));
+    });
+
+    thread_pool_wait(nested);
+    test_equal("thread_pool: nested parallel_for", nested_counter.load(), 800u);
+
+    // Occupy every worker so that the unrelated job can only be executed by the waiting thread
+    auto released = std::atomic<bool>(false);
+    auto blocked_count = std::atomic<uint32_t>(0);
+    auto blockers = std::vector<job_handle>();
+    for (auto index = 0; index < 4; index++)
+    {
+      blockers.emplace_back(thread_pool_enqueue([&]()
+      {
+        blocked_count++;
+        while (!released)
+        {
+          std::this_thread::yield();
+        }
+      }));
+    }
+
+    while (blocked_count < 4)
+    {
+      std::this_thread::yield();
+    }
+
+    auto waiting_thread_id = std::this_thread::get_id();
+    auto unrelated_executed_while_waiting = false;
+    auto unrelated = thread_pool_enqueue([&]() { unrelated_executed_while_waiting = std::this_thread::get_id() == waiting_thread_id && !released; });
+    auto awaited_dependency = thread_pool_enqueue([]() {});
+    auto awaited = thread_pool_enqueue([&released]() { released = true; }, { awaited_dependency });
+    thread_pool_wait(awaited);
+    test_equal("thread_pool: wait (unrelated jobs)", unrelated_executed_while_waiting, false);
+
+    thread_pool_wait(unrelated);
+    for (auto& blocker : blockers)
+    {
+      thread_pool_wait(blocker);
+    }
+
+    thread_pool_stop();
+  }
+}